@@ -212,7 +212,7 @@ namespace CC {
 	concept Invocable = std::is_invocable_v<F, A...>;
 
 	template<class F, class R, class... A>
-	concept Returns = Invocable<F> && Equal<std::invoke_result_t<F, A...>, R>;
+	concept Returns = Invocable<F, A...> && Equal<std::invoke_result_t<F, A...>, R>;
 
 	template<class T>
 	concept Exists = (sizeof(T), true);
@@ -0,0 +1,117 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mappedfile.cpp
+ */
+
+#include "mappedfile.hpp"
+#include "file.hpp"
+#include "util/log.hpp"
+
+#include <utility>
+
+
+
+MappedFile::MappedFile() noexcept : mapping(nullptr), mappingSize(0), opened(false) {}
+
+MappedFile::MappedFile(const Path& path, AccessHint hint) : MappedFile() {
+	open(path, hint);
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+
+
+MappedFile::MappedFile(MappedFile&& file) noexcept : mapping(std::exchange(file.mapping, nullptr)), mappingSize(std::exchange(file.mappingSize, 0)), buffer(std::move(file.buffer)), opened(std::exchange(file.opened, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+
+	if (this != &file) {
+
+		close();
+
+		mapping = std::exchange(file.mapping, nullptr);
+		mappingSize = std::exchange(file.mappingSize, 0);
+		buffer = std::move(file.buffer);
+		opened = std::exchange(file.opened, false);
+
+	}
+
+	return *this;
+
+}
+
+
+
+bool MappedFile::open(const Path& path, AccessHint hint) {
+
+	close();
+
+	File file(path, File::In);
+
+	if (!file.open()) {
+		return false;
+	}
+
+	SizeT fileSize = file.size();
+
+	if (fileSize >= MappingThreshold) {
+
+		mapping = mapFile(path, fileSize, hint);
+
+		if (mapping) {
+
+			mappingSize = fileSize;
+			opened = true;
+
+			return true;
+
+		}
+
+		LogW("MappedFile") << "Failed to map file " << path.toString() << ", falling back to buffered read";
+
+	}
+
+	buffer = file.readAll();
+	opened = true;
+
+	return true;
+
+}
+
+void MappedFile::close() {
+
+	if (mapping) {
+		unmapFile(mapping, mappingSize);
+	}
+
+	mapping = nullptr;
+	mappingSize = 0;
+	buffer = {};
+	opened = false;
+
+}
+
+
+
+bool MappedFile::isOpen() const noexcept {
+	return opened;
+}
+
+bool MappedFile::isMapped() const noexcept {
+	return mapping;
+}
+
+
+
+std::span<const u8> MappedFile::data() const noexcept {
+	return mapping ? std::span<const u8>(mapping, mappingSize) : std::span<const u8>(buffer);
+}
+
+SizeT MappedFile::size() const noexcept {
+	return data().size();
+}
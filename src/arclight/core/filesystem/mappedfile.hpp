@@ -0,0 +1,70 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mappedfile.hpp
+ */
+
+#pragma once
+
+#include "path.hpp"
+#include "types.hpp"
+
+#include <span>
+#include <vector>
+
+
+
+/*
+ *  Read-only view of a whole file's contents
+ *  Large files are memory-mapped so consumers can decode straight from the page cache.
+ *  Files below MappingThreshold, or ones that cannot be mapped, are read into an owned buffer instead.
+ */
+class MappedFile {
+
+public:
+
+	enum class AccessHint {
+		Sequential,
+		Random
+	};
+
+	constexpr static SizeT MappingThreshold = 0x10000;
+
+
+	MappedFile() noexcept;
+	explicit MappedFile(const Path& path, AccessHint hint = AccessHint::Sequential);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& file) noexcept;
+	MappedFile& operator=(MappedFile&& file) noexcept;
+
+	bool open(const Path& path, AccessHint hint = AccessHint::Sequential);
+	void close();
+
+	bool isOpen() const noexcept;
+	bool isMapped() const noexcept;
+
+	std::span<const u8> data() const noexcept;
+	SizeT size() const noexcept;
+
+	operator std::span<const u8>() const noexcept {
+		return data();
+	}
+
+private:
+
+	// Platform-specific, returns nullptr if mapping failed
+	static const u8* mapFile(const Path& path, SizeT size, AccessHint hint);
+	static void unmapFile(const u8* address, SizeT size);
+
+	const u8* mapping;
+	SizeT mappingSize;
+	std::vector<u8> buffer;
+	bool opened;
+
+};
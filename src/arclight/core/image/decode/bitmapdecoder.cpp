@@ -7,6 +7,7 @@
  */
 
 #include "bitmapdecoder.hpp"
+#include "scanline.hpp"
 #include "util/bool.hpp"
 
 
@@ -303,16 +304,20 @@ void BitmapDecoder::parseInfoHeader() {
 void BitmapDecoder::loadPalette() {
 
 	u32 colorCount = bitmap.paletteColors ? bitmap.paletteColors : 1 << bitmap.bitsPerPixel;
+	u32 tableSize = 1 << bitmap.bitsPerPixel;
 
-	if (reader.remainingSize() < colorCount * 4 * 4) {
+	// Excess entries can never be indexed
+	colorCount = Math::min(colorCount, tableSize);
+
+	if (reader.remainingSize() < colorCount * 4) {
 		throw ImageDecoderException("Stream size too small");
 	}
 
-	palette.clear();
-	palette.reserve(colorCount);
+	// Pad the table to the full index range so that row expansion never has to bounds-check indices
+	palette.assign(tableSize, 0);
 
 	for(u32 i = 0; i < colorCount; i++) {
-		palette.emplace_back(reader.read<u32>());
+		palette[i] = reader.read<u32>();
 	}
 
 }
@@ -324,39 +329,23 @@ void BitmapDecoder::decodeDirect() {
 	u32 bytesPerPixel = bitmap.bitsPerPixel / 8;
 	u32 rowBytes = bitmap.image.getWidth() * bytesPerPixel;
 	u32 rowBytesAligned = Math::alignUp(rowBytes, 4);
-	u32 rowAlign = rowBytesAligned - rowBytes;
 
-	if(reader.remainingSize() < rowBytesAligned * bitmap.image.getHeight()) {
+	if(reader.remainingSize() < u64(rowBytesAligned) * bitmap.image.getHeight()) {
 		throw ImageDecoderException("Stream size too small");
 	}
 
-	u8 data[4];
-
-	auto loadData = [&]<u32 N>() {
-
-		constexpr Pixel P = N == 2 ? Pixel::BGR5 : (N == 3 ? Pixel::BGR8 : Pixel::BGRA8);
-		using PixelT = PixelType<P>;
+	// Direct bitmaps are stored in the native little-endian layout of the matching pixel format
+	auto loadData = [&]<Pixel P>() {
 
 		Image<P> image(bitmap.image.getWidth(), bitmap.image.getHeight());
+		MutableImageView<P> view = image.view();
 
 		for(u32 y = 0; y < image.getHeight(); y++) {
 
 			u32 ry = bitmap.topDown ? image.getHeight() - y - 1 : y;
 
-			for(u32 x = 0; x < image.getWidth(); x++) {
-
-				reader.read<u8>({data, N});
-				image.setPixel(x, ry, PixelT({data, N}));
-
-			}
-
-			if constexpr (N == 2 || N == 3) {
-
-				if(rowAlign) {
-					reader.seek(rowAlign);
-				}
-
-			}
+			Scanline::copy<P>(reader.head(), view.row(ry));
+			reader.seek(rowBytesAligned);
 
 		}
 
@@ -367,16 +356,16 @@ void BitmapDecoder::decodeDirect() {
 	switch(bitmap.bitsPerPixel) {
 
 		case 16:
-			loadData.template operator()<2>();
+			loadData.template operator()<Pixel::BGR5>();
 			break;
 
 		case 24:
-			loadData.template operator()<3>();
+			loadData.template operator()<Pixel::BGR8>();
 			break;
 
 		default:
 		case 32:
-			loadData.template operator()<4>();
+			loadData.template operator()<Pixel::BGRA8>();
 			break;
 
 	}
@@ -390,75 +379,26 @@ void BitmapDecoder::decodeIndexed() {
 	u32 width = bitmap.image.getWidth();
 	u32 height = bitmap.image.getHeight();
 
-	u32 bitsPerRow = width * bitmap.bitsPerPixel;
-	u32 bitsPerRowAligned = Math::alignUp(bitsPerRow, 32);
-	u32 totalImageDataSize = (bitsPerRowAligned * height) / 8;
-
-	u32 leftoverPixels = (bitsPerRowAligned - bitsPerRow) / bitmap.bitsPerPixel;
-	u32 leftoverX = width - leftoverPixels;
-
-	u32 rowReads = bitsPerRow / 32;
+	u32 rowBytesAligned = Math::alignUp(width * bitmap.bitsPerPixel, 32) / 8;
 
-	if (reader.remainingSize() < totalImageDataSize) {
+	if (reader.remainingSize() < u64(rowBytesAligned) * height) {
 		throw ImageDecoderException("Stream size too small");
 	}
 
-	auto loadData = [&]<u32 BPP>() {
-
-		constexpr u32 pixelsPerRead = 32 / BPP;
-		constexpr u32 pixelsPerByte = pixelsPerRead / 4;
-		constexpr u32 bytemask = ((1 << BPP) - 1) << (8 - BPP);
-
-		Image<Pixel::BGRA8> image(width, height);
+	Image<Pixel::BGRA8> image(width, height);
+	MutableImageView<Pixel::BGRA8> view = image.view();
 
+	auto loadData = [&]<u32 BPP>() {
 
 		for (u32 y = 0; y < height; y++) {
 
 			u32 ry = bitmap.topDown ? height - y - 1 : y;
 
-			for(u32 x = 0; x < rowReads; x++) {
-
-				u32 pixelData = reader.read<u32>();
-
-				for(u32 i = 0; i < 4; i++) {
-
-					u32 mask = bytemask;
-
-					for(u32 j = 0; j < pixelsPerByte; j++) {
-
-						image.setPixel(x * pixelsPerRead + i * pixelsPerByte + j, ry, palette[(pixelData >> (8 * i) & mask) >> (8 - (j + 1) * BPP)]);
-						mask >>= BPP;
-
-					}
-
-				}
-
-			}
-
-			u32 k = 0;
-			u32 pixelData = reader.read<u32>();
-
-			for (u32 i = 0; i < Math::alignUp(leftoverPixels, 8) / 8; i++) {
-
-				u32 mask = bytemask;
-
-				for (u32 j = 0; j < pixelsPerByte; j++) {
-
-					image.setPixel(leftoverX + k, ry, palette[(pixelData >> (8 * i) & mask) >> (8 - (j + 1) * BPP)]);
-					mask >>= BPP;
-
-					if (++k == leftoverPixels) {
-						break;
-					}
-
-				}
-
-			}
+			Scanline::expandPalette<BPP>(reader.head(), view.row(ry), palette.data());
+			reader.seek(rowBytesAligned);
 
 		}
 
-		bitmap.image = image.makeRaw();
-
 	};
 
 	switch (bitmap.bitsPerPixel) {
@@ -478,6 +418,8 @@ void BitmapDecoder::decodeIndexed() {
 
 	}
 
+	bitmap.image = image.makeRaw();
+
 }
 
 
@@ -490,13 +432,30 @@ void BitmapDecoder::decodeRLE() {
 	bool eob = false;
 	constexpr u32 skipColorIdx = 0;
 
-	auto loadData = [&]<u32 N>() {
+	u32 width = bitmap.image.getWidth();
+	u32 height = bitmap.image.getHeight();
 
-		Image<Pixel::BGRA8> image(bitmap.image.getWidth(), bitmap.image.getHeight());
+	// Skipped pixels (deltas, early line ends) take the first palette color
+	Image<Pixel::BGRA8> image(width, height, PixelBGRA8(palette[skipColorIdx]));
+	MutableImageView<Pixel::BGRA8> view = image.view();
 
-		constexpr static bool IsRLE4 = N == 4;
-		constexpr static u32 directIndexBytes = IsRLE4 ? 0x80 : 0xFF;
+	// Claims the next count pixels of the current line
+	auto nextRun = [&](u32 count) {
+
+		if (y >= height || x + count > width) {
+			throw ImageDecoderException("Run-Length encoded data exceeds bitmap bounds");
+		}
+
+		auto run = view.row(y).subspan(x, count);
+		x += count;
+
+		return run;
+
+	};
+
+	auto loadData = [&]<u32 N>() {
 
+		constexpr static bool IsRLE4 = N == 4;
 
 		while (!eob) {
 
@@ -509,19 +468,27 @@ void BitmapDecoder::decodeRLE() {
 			if (ctrl[0]) {
 
 				//n times index
-				for (u32 i = 0; i < ctrl[0]; i++) {
+				auto run = nextRun(ctrl[0]);
+
+				if constexpr (IsRLE4) {
+
+					PixelBGRA8 colors[2] = { PixelBGRA8(palette[ctrl[1] >> 4]), PixelBGRA8(palette[ctrl[1] & 0xF]) };
 
-					if constexpr (IsRLE4) {
+					if (colors[0] == colors[1]) {
 
-						u32 shift = (!(i & 1) * 4);
-						image.setPixel(x++, y, palette[(ctrl[1] & (0xF << shift)) >> shift]);
+						std::fill_n(run.begin(), run.size(), colors[0]);
 
 					} else {
 
-						image.setPixel(x++, y, palette[ctrl[1]]);
+						for (u32 i = 0; i < run.size(); i++) {
+							run[i] = colors[i & 1];
+						}
 
 					}
 
+				} else {
+
+					std::fill_n(run.begin(), run.size(), PixelBGRA8(palette[ctrl[1]]));
 
 				}
 
@@ -544,26 +511,15 @@ void BitmapDecoder::decodeRLE() {
 
 					case 2:
 
-						//Delta
+						//Delta, skipped pixels keep the skip color
 						if (reader.remainingSize() < 2) {
 							throw ImageDecoderException("Stream size too small");
 						}
 
 						reader.read<u8>(ctrl);
 
-						for (u32 i = 0; i < ctrl[0]; i++) {
-							image.setPixel(x++, y, palette[skipColorIdx]);
-						}
-
-						for (u32 i = 0; i < ctrl[1]; i++) {
-
-							for(x = 0; x < image.getWidth(); x++) {
-								image.setPixel(x, y, palette[skipColorIdx]);
-							}
-
-							y++;
-
-						}
+						x += ctrl[0];
+						y += ctrl[1];
 
 						break;
 
@@ -572,38 +528,14 @@ void BitmapDecoder::decodeRLE() {
 						//Direct
 						u32 pixelCount = ctrl[1];
 						u32 byteCount = IsRLE4 ? (pixelCount + 1) / 2 : pixelCount;
-						u8 indices[directIndexBytes];
+						u32 paddedCount = Math::alignUp(byteCount, 2);
 
-						if (reader.remainingSize() < byteCount) {
+						if (reader.remainingSize() < paddedCount) {
 							throw ImageDecoderException("Stream size too small");
 						}
 
-						reader.read<u8>({indices, byteCount});
-
-						if (byteCount & 1) {
-
-							if (reader.remainingSize() < 1) {
-								throw ImageDecoderException("Stream size too small");
-							}
-
-							reader.seek(1);
-
-						}
-
-						for (u32 i = 0; i < pixelCount; i++) {
-
-							if constexpr (IsRLE4) {
-
-								u32 shift = (!(i & 1) * 4);
-								image.setPixel(x++, y, palette[(indices[i / 2] & (0xF << shift)) >> shift]);
-
-							} else {
-
-								image.setPixel(x++, y, palette[indices[i]]);
-
-							}
-
-						}
+						Scanline::expandPalette<N>(reader.head(), nextRun(pixelCount), palette.data());
+						reader.seek(paddedCount);
 
 					}
 					break;
@@ -614,8 +546,6 @@ void BitmapDecoder::decodeRLE() {
 
 		}
 
-		bitmap.image = image.makeRaw();
-
 	};
 
 	if (bitmap.compression == Bitmap::Compression::RLE4) {
@@ -624,6 +554,8 @@ void BitmapDecoder::decodeRLE() {
 		loadData.template operator()<8>();
 	}
 
+	bitmap.image = image.makeRaw();
+
 }
 
 
@@ -645,42 +577,45 @@ void BitmapDecoder::decodeMasked() {
 
 	u32 rowBytes = width * bitmap.bitsPerPixel / 8;
 	u32 rowBytesAligned = Math::alignUp(rowBytes, 4);
-	bool rowAlign = rowBytesAligned - rowBytes;
 
-	if (reader.remainingSize() < rowBytesAligned * height) {
+	if (reader.remainingSize() < u64(rowBytesAligned) * height) {
 		throw ImageDecoderException("Stream size too small");
 	}
 
-	auto loadData = [&]<u32 N>() {
+	using BGRA8Format = PixelFormat<Pixel::BGRA8>;
 
-		using T = TT::Conditional<N != 16, u32, u16>;
+	// The most common masks describe plain BGRA8 and reduce to a row copy
+	bool nativeLayout = bitmap.bitsPerPixel == 32 && redMask == BGRA8Format::RedMask && greenMask == BGRA8Format::GreenMask && blueMask == BGRA8Format::BlueMask && alphaMask == BGRA8Format::AlphaMask;
+
+	Image<Pixel::BGRA8> image(width, height);
+	MutableImageView<Pixel::BGRA8> view = image.view();
 
-		Image<Pixel::BGRA8> image(width, height);
+	auto loadData = [&]<u32 N>() {
 
+		using T = TT::Conditional<N != 16, u32, u16>;
 
 		for (u32 y = 0; y < height; y++) {
 
 			u32 ry = bitmap.topDown ? height - y - 1 : y;
+			auto row = view.row(ry);
 
-			for (u32 x = 0; x < width; x++) {
+			if (nativeLayout) {
 
-				T pixelData = reader.read<T>();
-				auto pixel = PixelConverter::convert<Pixel::BGRA8, T>(pixelData, redMask, redShift, greenMask, greenShift, blueMask, blueShift, alphaMask, alphaShift);
-				image.setPixel(x, ry, pixel);
+				Scanline::copy<Pixel::BGRA8>(reader.head(), row);
 
-			}
+			} else {
 
-			if constexpr (N == 16) {
+				BinaryReader rowReader = reader.substream(rowBytes);
 
-				if (rowAlign) {
-					reader.seek(2);
+				for (auto& pixel : row) {
+					pixel = PixelConverter::convert<Pixel::BGRA8, T>(rowReader.read<T>(), redMask, redShift, greenMask, greenShift, blueMask, blueShift, alphaMask, alphaShift);
 				}
 
 			}
 
-		}
+			reader.seek(rowBytesAligned);
 
-		bitmap.image = image.makeRaw();
+		}
 
 	};
 
@@ -690,4 +625,6 @@ void BitmapDecoder::decodeMasked() {
 		loadData.template operator()<32>();
 	}
 
+	bitmap.image = image.makeRaw();
+
 }
\ No newline at end of file
@@ -38,7 +38,7 @@ private:
 
 	BinaryReader reader;
 	Bitmap bitmap;
-	std::vector<PixelBGRA8> palette;
+	std::vector<u32> palette;
 	bool validDecode;
 
 };
\ No newline at end of file
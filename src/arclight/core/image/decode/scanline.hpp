@@ -0,0 +1,133 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 scanline.hpp
+ */
+
+#pragma once
+
+#include "image/pixel.hpp"
+#include "arcintrinsic.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+
+
+
+/*
+ *  Row-wise pixel transfer kernels shared by the decoders
+ *  All functions write exactly dest.size() pixels and expect src to hold enough data for them.
+ */
+namespace Scanline {
+
+	// Copies a row of natively stored pixels
+	template<Pixel P>
+	inline void copy(const u8* src, std::span<PixelType<P>> dest) {
+		std::memcpy(Bits::toByteArray(dest.data()), src, dest.size() * PixelFormat<P>::BytesPerPixel);
+	}
+
+	// Expands tightly packed B, G, R triplets into opaque BGRA8
+	inline void expandBGR8(const u8* src, std::span<PixelBGRA8> dest) {
+
+		u8* out = Bits::toByteArray(dest.data());
+		SizeT count = dest.size();
+		SizeT i = 0;
+
+#ifdef ARC_VECTORIZE_X86_SSSE3
+
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(0xFF000000);
+
+		// 16 bytes are loaded per 4 pixels, so stay 6 pixels away from the end of the source
+		for (; i + 6 <= count; i += 4) {
+
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+
+		}
+
+#endif
+
+		for (; i < count; i++) {
+
+			out[i * 4 + 0] = src[i * 3 + 0];
+			out[i * 4 + 1] = src[i * 3 + 1];
+			out[i * 4 + 2] = src[i * 3 + 2];
+			out[i * 4 + 3] = 0xFF;
+
+		}
+
+	}
+
+	// Expands 8-bit luminance into opaque BGRA8
+	inline void expandGrayscale8(const u8* src, std::span<PixelBGRA8> dest) {
+
+		u8* out = Bits::toByteArray(dest.data());
+
+		for (SizeT i = 0; i < dest.size(); i++) {
+
+			u32 v = src[i] * 0x010101 | 0xFF000000;
+			std::memcpy(out + i * 4, &v, 4);
+
+		}
+
+	}
+
+	/*
+	 *  Looks up BPP-bit indices (most significant bits first within a byte) in palette
+	 *  palette must hold 1 << BPP packed BGRA8 entries so that every index is valid
+	 */
+	template<u32 BPP>
+	inline void expandPalette(const u8* src, std::span<PixelBGRA8> dest, const u32* palette) {
+
+		static_assert(BPP == 1 || BPP == 2 || BPP == 4 || BPP == 8, "Illegal palette index size");
+
+		u8* out = Bits::toByteArray(dest.data());
+		SizeT count = dest.size();
+		SizeT i = 0;
+
+		if constexpr (BPP == 8) {
+
+#ifdef ARC_VECTORIZE_X86_AVX2
+
+			for (; i + 8 <= count; i += 8) {
+
+				__m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+				__m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), indices, 4);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), colors);
+
+			}
+
+#endif
+
+			for (; i < count; i++) {
+				std::memcpy(out + i * 4, palette + src[i], 4);
+			}
+
+		} else {
+
+			constexpr u32 PixelsPerByte = 8 / BPP;
+			constexpr u32 IndexMask = (1 << BPP) - 1;
+
+			for (; i < count; i++) {
+
+				u32 shift = 8 - BPP - (i % PixelsPerByte) * BPP;
+				std::memcpy(out + i * 4, palette + ((src[i / PixelsPerByte] >> shift) & IndexMask), 4);
+
+			}
+
+		}
+
+	}
+
+	// Mirrors a row in place, used for right-to-left stored images
+	template<class T>
+	inline void mirror(std::span<T> row) {
+		std::reverse(row.begin(), row.end());
+	}
+
+}
@@ -7,6 +7,7 @@
  */
 
 #include "tgadecoder.hpp"
+#include "scanline.hpp"
 #include "util/bool.hpp"
 #include "util/string.hpp"
 #include "common/exception.hpp"
@@ -82,7 +83,7 @@ constexpr bool getImageDataRLECompressed(const TGAHeader& hdr) {
 }
 
 constexpr u32 getColorMapSize(const TGAColorMapSpecification& spec) {
-	return spec.colorMapLength * spec.colorMapEntrySize / 8;
+	return spec.colorMapLength * ((spec.colorMapEntrySize + 7) / 8);
 }
 
 constexpr u8 getImageAlphaBits(const TGAImageSpecification& spec) {
@@ -97,8 +98,17 @@ constexpr u8 getImageReservedBits(const TGAImageSpecification& spec) {
 	return Bits::mask(spec.imageDescriptor, 6, 2);
 }
 
-constexpr u32 getImageDataSize(const TGAImageSpecification& spec) {
-	return spec.width * spec.height * spec.pixelDepth / 8;
+constexpr u32 getPixelSize(const TGAImageSpecification& spec) {
+	return (spec.pixelDepth + 7) / 8;
+}
+
+constexpr u64 getImageDataSize(const TGAImageSpecification& spec) {
+	return u64(spec.width) * spec.height * getPixelSize(spec);
+}
+
+// Largest expansion of an RLE stream, a packet of 1 + pixelSize bytes yields up to 128 pixels
+constexpr u64 getMaxRLEDataSize(const TGAImageSpecification& spec, SizeT streamSize) {
+	return streamSize / (1 + getPixelSize(spec)) * 128 * getPixelSize(spec);
 }
 
 constexpr bool getSupportedPixelDepth(const TGAImageSpecification& spec) {
@@ -190,17 +200,31 @@ void TGADecoder::decode(std::span<const u8> data) {
 
 	}
 	
-	// Read image data
-	if (hdr.imageType != TGAImageType::None) {
+	// Read image data, uncompressed pixels are decoded straight from the stream
+	std::span<const u8> pixelData;
 
-		u32 imageDataSize = getImageDataSize(hdr.imageSpec);
+	if (hdr.imageType != TGAImageType::None) {
 
-		imageData.resize(imageDataSize);
+		u64 imageDataSize = getImageDataSize(hdr.imageSpec);
 
 		if (getImageDataRLECompressed(hdr)) {
+
+			if (imageDataSize > getMaxRLEDataSize(hdr.imageSpec, reader.remainingSize()))
+				throw ImageDecoderException("Stream size too small");
+
+			imageData.resize(imageDataSize);
 			readImageDataRLE(hdr);
+
+			pixelData = imageData;
+
 		} else {
-			reader.read<u8>(imageData);
+
+			if (reader.remainingSize() < imageDataSize)
+				throw ImageDecoderException("Stream size too small");
+
+			pixelData = { reader.head(), imageDataSize };
+			reader.seek(imageDataSize);
+
 		}
 
 	}
@@ -213,18 +237,18 @@ void TGADecoder::decode(std::span<const u8> data) {
 
 	case TGAImageType::ColorMap:		// Uncompressed, Color mapped
 	case TGAImageType::ColorMapRLE:		// Run-length encoded, Color mapped	
-		parseColorMapImageData(hdr);
+		parseColorMapImageData(hdr, pixelData);
 		break;
 
 	case TGAImageType::TrueColor:		// Uncompressed, True color
 	case TGAImageType::TrueColorRLE:	// Run-length encoded, True color
-		parseTrueColorImageData(hdr);
+		parseTrueColorImageData(hdr, pixelData);
 		break;
 
 		// TODO: untested
 	case TGAImageType::BlackWhite:		// Uncompressed, Black and white
 	case TGAImageType::BlackWhiteRLE:	// Run-length encoded, Black and white
-		parseBlackWhiteImageData(hdr);
+		parseBlackWhiteImageData(hdr, pixelData);
 		break;
 
 		throw UnsupportedOperationException("Invalid/unsupported TGA image type");
@@ -251,70 +275,100 @@ RawImage& TGADecoder::getImage() {
 
 void TGADecoder::readImageDataRLE(const TGAHeader& hdr) {
 
-	u8 buffer[5]{};
-	u32 pixelSize = hdr.imageSpec.pixelDepth / 8;
-	u32 pixelCount = hdr.imageSpec.width * hdr.imageSpec.height;
+	u32 pixelSize = getPixelSize(hdr.imageSpec);
+	SizeT dataSize = imageData.size();
 
-	for (u32 p = 0; p < pixelCount * pixelSize;) {
+	u8* data = imageData.data();
 
-		reader.read<u8>({ buffer,  pixelSize + 1 });
+	for (SizeT p = 0; p < dataSize;) {
 
-		// Insert reference pixel
-		std::copy_n(buffer + 1, pixelSize, imageData.begin() + p);
-		p += pixelSize;
+		if (reader.remainingSize() < 1 + pixelSize)
+			throw ImageDecoderException("Stream size too small");
 
 		// RLE control byte
-		u32 n = buffer[0] & 0x7F;
+		u8 control = reader.read<u8>();
+		u32 n = (control & 0x7F) + 1;
+		u32 packetSize = n * pixelSize;
 
-		if (buffer[0] & 0x80) {
+		if (packetSize > dataSize - p)
+			throw ImageDecoderException("Run-length packet exceeds image size");
+
+		if (control & 0x80) {
 
 			// Insert pixel n times
-			for (u32 i = 0; i < n; i++) {
+			if (pixelSize == 1) {
+
+				std::fill_n(data + p, n, reader.read<u8>());
 
-				std::copy_n(buffer + 1, pixelSize, imageData.begin() + p);
-				p += pixelSize;
+			} else {
+
+				// Replicate the reference pixel by doubling the already written part of the run
+				std::copy_n(reader.head(), pixelSize, data + p);
+				reader.seek(pixelSize);
+
+				for (u32 filled = pixelSize; filled < packetSize; filled *= 2) {
+					std::copy_n(data + p, Math::min(filled, packetSize - filled), data + p + filled);
+				}
 
 			}
 
-		}
-		else {
+		} else {
 
 			// Read and insert n pixels
-			reader.read<u8>({ imageData.begin() + p, n * pixelSize });
-			p += n * pixelSize;
+			if (reader.remainingSize() < packetSize)
+				throw ImageDecoderException("Stream size too small");
+
+			std::copy_n(reader.head(), packetSize, data + p);
+			reader.seek(packetSize);
 
 		}
 
+		p += packetSize;
+
 	}
 
 }
 
 
 
-void TGADecoder::parseColorMapImageData(const TGAHeader& hdr) {
+template<class Function>
+static void buildRows(const TGAImageSpecification& spec, MutableImageView<Pixel::BGRA8> view, std::span<const u8> data, u32 pixelSize, Function&& function) {
 
-	using ColorsT = Colors<Pixel::BGRA8>;
+	u32 rowSize = spec.width * pixelSize;
+	bool mirrorX = getTransformedX(spec, 0) != 0;
 
-	std::vector<PixelBGRA8> colorMap;
+	for (u32 y = 0; y < spec.height; y++) {
 
-	auto convertColorMap = [&]<Pixel P, SizeT Size>() {
+		auto row = view.row(getTransformedY(spec, y));
 
-		auto colorMapView = std::span{ colorMapData };
+		function(data.data() + SizeT(y) * rowSize, row);
 
-		colorMap.resize(hdr.colorMapSpec.colorMapLength);
+		if (mirrorX) {
+			Scanline::mirror(row);
+		}
 
-		bool alpha15 = hdr.imageSpec.pixelDepth == 16;
+	}
 
-		for (u32 i = 0; i < hdr.colorMapSpec.colorMapLength; i++) {
+}
 
-			auto pixelData = colorMapView.subspan(i * Size, Size);
 
-			if (alpha15 && (pixelData.back() & 0x80) == 0) {
-				colorMap[i] = ColorsT::Transparent;
-			}
 
-			colorMap[i] = PixelConverter::convert<Pixel::BGRA8>(PixelType<P>(pixelData));
+void TGADecoder::parseColorMapImageData(const TGAHeader& hdr, std::span<const u8> data) {
+
+	u32 colorMapLength = hdr.colorMapSpec.colorMapLength;
+
+	// Packed BGRA8 entries
+	std::vector<u32> colorMap(colorMapLength);
 
+	auto convertColorMap = [&]<Pixel P>() {
+
+		constexpr u32 Size = PixelFormat<P>::BytesPerPixel;
+
+		if (colorMapData.size() < SizeT(colorMapLength) * Size)
+			throw ImageDecoderException("Color map size too small");
+
+		for (u32 i = 0; i < colorMapLength; i++) {
+			colorMap[i] = PixelConverter::convert<Pixel::BGRA8>(PixelType<P>(std::span{ colorMapData }.subspan(i * Size, Size))).pack();
 		}
 
 	};
@@ -323,54 +377,51 @@ void TGADecoder::parseColorMapImageData(const TGAHeader& hdr) {
 
 		Image<Pixel::BGRA8> bufImage(hdr.imageSpec.width, hdr.imageSpec.height);
 
-		BinaryReader dataReader(imageData);
-
-		bool alpha15 = hdr.imageSpec.pixelDepth == 16;
-
-		for (u32 y = 0; y < hdr.imageSpec.height; y++) {
+		// Bit 15 of 16-bit indices carries attribute data and is not part of the index
+		constexpr T IndexMask = sizeof(T) == 2 ? 0x7FFF : 0xFF;
 
-			// TODO: profile the usage of getter functions vs booleans for flipX/flipY
-			u32 ry = getTransformedY(hdr.imageSpec, y);
+		buildRows(hdr.imageSpec, bufImage.view(), data, sizeof(T), [&](const u8* src, std::span<PixelBGRA8> row) {
 
-			for (u32 x = 0; x < hdr.imageSpec.width; x++) {
+			u8* out = Bits::toByteArray(row.data());
 
-				u32 rx = getTransformedX(hdr.imageSpec, x);
+			for (u32 x = 0; x < row.size(); x++) {
 
-				T pixelData = dataReader.read<T>();
+				T index;
 
-				// TODO: just a speculation, not actually described anywhere... requires more testing
-				if (alpha15 && (pixelData & 0x8000) == 0) {
-					bufImage.setPixel(rx, ry, ColorsT::Transparent);
+				if constexpr (sizeof(T) == 2) {
+					index = Bits::assemble<T>(src[x * 2], src[x * 2 + 1]) & IndexMask;
 				} else {
-					pixelData &= 0x7FFF;
+					index = src[x];
 				}
 
-				if (pixelData >= hdr.colorMapSpec.colorMapLength)
+
+				if (index >= colorMapLength)
 					throw ImageDecoderException("Invalid color map index found in image data");
 
-				bufImage.setPixel(rx, ry, colorMap[pixelData]);
+				std::memcpy(out + x * 4, &colorMap[index], 4);
 
 			}
-		}
+
+		});
 
 		image = bufImage.makeRaw();
 
 	};
 
-	// Convert color map to ARGB8
+	// Convert color map to BGRA8
 	switch (hdr.colorMapSpec.colorMapEntrySize) {
 
 	case 15:
 	case 16:
-		convertColorMap.template operator()<Pixel::RGB5, 2>();
+		convertColorMap.template operator()<Pixel::BGR5>();
 		break;
 
 	case 24:
-		convertColorMap.template operator()<Pixel::RGB8, 3>();
+		convertColorMap.template operator()<Pixel::BGR8>();
 		break;
 
 	case 32:
-		convertColorMap.template operator()<Pixel::RGBA8, 4>();
+		convertColorMap.template operator()<Pixel::BGRA8>();
 		break;
 
 	default:
@@ -408,58 +459,45 @@ void TGADecoder::parseColorMapImageData(const TGAHeader& hdr) {
 
 
 
-void TGADecoder::parseTrueColorImageData(const TGAHeader& hdr) {
+void TGADecoder::parseTrueColorImageData(const TGAHeader& hdr, std::span<const u8> data) {
 
 	using ColorsT = Colors<Pixel::BGRA8>;
 
-	auto loadData = [&]<Pixel P, SizeT Size>() {
+	Image<Pixel::BGRA8> bufImage(hdr.imageSpec.width, hdr.imageSpec.height);
 
-		BinaryReader reader(imageData);
-		Image<Pixel::BGRA8> bufImage(hdr.imageSpec.width, hdr.imageSpec.height);
+	// TGA stores true color pixels as little-endian B, G, R(, A)
+	switch (hdr.imageSpec.pixelDepth) {
 
+	case 15:
+	case 16:
+	{
 		bool alpha15 = hdr.imageSpec.pixelDepth == 16;
 
-		for (u32 y = 0; y < hdr.imageSpec.height; y++) {
-
-			// TODO: profile the usage of getter functions vs booleans for flipX/flipY
-			u32 ry = getTransformedY(hdr.imageSpec, y);
+		buildRows(hdr.imageSpec, bufImage.view(), data, 2, [&](const u8* src, std::span<PixelBGRA8> row) {
 
-			for (u32 x = 0; x < hdr.imageSpec.width; x++) {
+			for (u32 x = 0; x < row.size(); x++) {
 
-				u32 rx = getTransformedX(hdr.imageSpec, x);
+				u16 pixelData = Bits::assemble<u16>(src[x * 2], src[x * 2 + 1]);
 
-				u8 pixelData[Size];
-				reader.read<u8>(pixelData);
-
-				if (alpha15 && (pixelData[Size - 1] & 0x80) == 0) {
-					bufImage.setPixel(rx, ry, ColorsT::Transparent);
+				if (alpha15 && (pixelData & 0x8000) == 0) {
+					row[x] = ColorsT::Transparent;
 				} else {
-
-					auto pixel = PixelConverter::convert<Pixel::BGRA8>(PixelType<P>(pixelData));
-					bufImage.setPixel(rx, ry, pixel);
-
+					row[x] = PixelConverter::convert<Pixel::BGRA8>(PixelBGR5(pixelData));
 				}
 
 			}
-		}
 
-		image = bufImage.makeRaw();
-
-	};
-
-	switch (hdr.imageSpec.pixelDepth) {
+		});
 
-	case 15:
-	case 16:
-		loadData.template operator()<Pixel::RGB5, 2>();
-		break;
+	}
+	break;
 
 	case 24:
-		loadData.template operator()<Pixel::RGB8, 3>();
+		buildRows(hdr.imageSpec, bufImage.view(), data, 3, Scanline::expandBGR8);
 		break;
 
 	case 32:
-		loadData.template operator()<Pixel::RGBA8, 4>();
+		buildRows(hdr.imageSpec, bufImage.view(), data, 4, Scanline::copy<Pixel::BGRA8>);
 		break;
 
 	default:
@@ -467,45 +505,25 @@ void TGADecoder::parseTrueColorImageData(const TGAHeader& hdr) {
 
 	}
 
-}
+	image = bufImage.makeRaw();
 
+}
 
 
-void TGADecoder::parseBlackWhiteImageData(const TGAHeader& hdr) {
 
-	using ColorsT = Colors<Pixel::BGRA8>;
+void TGADecoder::parseBlackWhiteImageData(const TGAHeader& hdr, std::span<const u8> data) {
 
-	auto loadData = [&]() {
+	switch (hdr.imageSpec.pixelDepth) {
 
-		BinaryReader reader(imageData);
+	case 8:
+	{
 		Image<Pixel::BGRA8> bufImage(hdr.imageSpec.width, hdr.imageSpec.height);
-		
-		for (u32 y = 0; y < hdr.imageSpec.height; y++) {
-
-			// TODO: profile the usage of getter functions vs booleans for flipX/flipY
-			u32 ry = getTransformedY(hdr.imageSpec, y);
 
-			for (u32 x = 0; x < hdr.imageSpec.width; x++) {
-
-				u32 rx = getTransformedX(hdr.imageSpec, x);
-
-				u8 pixelData = reader.read<u8>();
-
-				auto pixel = PixelConverter::convert<Pixel::BGRA8>(PixelRGB8(pixelData, pixelData, pixelData));
-				bufImage.setPixel(rx, ry, pixel);
-
-			}
-		}
+		buildRows(hdr.imageSpec, bufImage.view(), data, 1, Scanline::expandGrayscale8);
 
 		image = bufImage.makeRaw();
-
-	};
-
-	switch (hdr.imageSpec.pixelDepth) {
-
-	case 8:
-		loadData();
-		break;
+	}
+	break;
 
 	default:
 		throw ImageDecoderException("Invalid pixel format");
@@ -35,9 +35,9 @@ public:
 private:
 
 	void readImageDataRLE(struct TGAHeader const&);
-	void parseColorMapImageData(struct TGAHeader const&);
-	void parseTrueColorImageData(struct TGAHeader const&);
-	void parseBlackWhiteImageData(struct TGAHeader const&);
+	void parseColorMapImageData(struct TGAHeader const&, std::span<const u8> data);
+	void parseTrueColorImageData(struct TGAHeader const&, std::span<const u8> data);
+	void parseBlackWhiteImageData(struct TGAHeader const&, std::span<const u8> data);
 
 	BinaryReader reader;
 	RawImage image;
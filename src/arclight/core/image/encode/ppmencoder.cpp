@@ -13,12 +13,29 @@
 
 void PPMEncoder::encode(const RawImage& image) {
 
-	validEncode = false;
+	switch (image.getFormat()) {
+
+		case Pixel::Grayscale8: encode(image.view<Pixel::Grayscale8>()); break;
+		case Pixel::BGR5:       encode(image.view<Pixel::BGR5>());       break;
+		case Pixel::RGB5:       encode(image.view<Pixel::RGB5>());       break;
+		case Pixel::BGR8:       encode(image.view<Pixel::BGR8>());       break;
+		case Pixel::RGB8:       encode(image.view<Pixel::RGB8>());       break;
+		case Pixel::RGBA8:      encode(image.view<Pixel::RGBA8>());      break;
+		case Pixel::ABGR8:      encode(image.view<Pixel::ABGR8>());      break;
+		case Pixel::BGRA8:      encode(image.view<Pixel::BGRA8>());      break;
+		case Pixel::ARGB8:      encode(image.view<Pixel::ARGB8>());      break;
+		default: ARC_UNREACHABLE;
+
+	}
+
+}
+
+
+
+SizeT PPMEncoder::writeHeader(u32 width, u32 height) {
 
 	std::ostringstream stringWriter;
 
-	u32 width = image.getWidth();
-	u32 height = image.getHeight();
 	u32 colorRange = 255;
 
 	if (width == 0)
@@ -37,20 +54,15 @@ void PPMEncoder::encode(const RawImage& image) {
 	stringWriter << colorRange << '\n';
 
 	SizeT headerSize = stringWriter.tellp();
-	SizeT rasterSize = width * height * 3;
-	
+	SizeT rasterSize = SizeT(width) * height * 3;
+
 	buffer.resize(headerSize + rasterSize);
 	BinaryWriter writer(buffer);
-	
+
 	// Write header
 	writer.write<const char>(stringWriter.view());
 
-	// Write raster data
-	RawImage copy(image);
-	RawImage rgb8 = Image<Pixel::RGB8>::fromRaw(copy, true).makeRaw();
-	writer.write<const u8>(rgb8.getRawBuffer());
-
-	validEncode = true;
+	return headerSize;
 
 }
 
@@ -20,11 +20,50 @@ public:
 	constexpr explicit PPMEncoder(std::optional<Pixel> reqFormat) noexcept : IImageEncoder(reqFormat), validEncode(false) {}
 
 	void encode(const RawImage& image);
+
+	template<Pixel P>
+	void encode(const ImageView<P>& image);
+
 	const std::vector<u8>& getBuffer();
 
 private:
 
+	SizeT writeHeader(u32 width, u32 height);
+
 	std::vector<u8> buffer;
 	bool validEncode;
 
 };
+
+
+
+template<Pixel P>
+void PPMEncoder::encode(const ImageView<P>& image) {
+
+	validEncode = false;
+
+	SizeT headerSize = writeHeader(image.getWidth(), image.getHeight());
+	u8* raster = buffer.data() + headerSize;
+
+	// Rows are converted straight from the view, so crops and tiles never get copied beforehand
+	for (u32 y = 0; y < image.getHeight(); y++) {
+
+		auto row = image.row(y);
+
+		if constexpr (P == Pixel::RGB8) {
+
+			raster = std::copy_n(Bits::toByteArray(row.data()), row.size() * 3, raster);
+
+		} else {
+
+			for (const auto& pixel : row) {
+				raster = std::copy_n(PixelConverter::convert<Pixel::RGB8>(pixel).p, 3, raster);
+			}
+
+		}
+
+	}
+
+	validEncode = true;
+
+}
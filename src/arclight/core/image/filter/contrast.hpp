@@ -18,12 +18,11 @@ class ContrastFilter {
 public:
 
 	template<Pixel P>
-	constexpr static void run(Image<P>& image, double contrast) {
+	constexpr static void run(const MutableImageView<P>& image, double contrast) {
 
-		using Format = typename Image<P>::Format;
-		constexpr u32 maxValueRed = Image<P>::PixelType::getMaxRed();
-		constexpr u32 maxValueGreen = Image<P>::PixelType::getMaxGreen();
-		constexpr u32 maxValueBlue = Image<P>::PixelType::getMaxBlue();
+		constexpr u32 maxValueRed = ImageView<P>::PixelType::getMaxRed();
+		constexpr u32 maxValueGreen = ImageView<P>::PixelType::getMaxGreen();
+		constexpr u32 maxValueBlue = ImageView<P>::PixelType::getMaxBlue();
 		constexpr u32 halfValueRed = (maxValueRed + 1) / 2;
 		constexpr u32 halfValueGreen = (maxValueGreen + 1) / 2;
 		constexpr u32 halfValueBlue = (maxValueBlue + 1) / 2;
@@ -12,6 +12,8 @@
 #include "math/matrix.hpp"
 #include "types.hpp"
 
+#include <vector>
+
 
 // Convolution filter with a 3x3 matrix
 class ConvolutionFilter {
@@ -32,22 +34,110 @@ public:
 	};
 
 	template<Pixel P>
-	constexpr static void run(Image<P>& image, Mat3<double> convMat, u32 channels = Red | Green | Blue, EdgeHandling edgeType = Ignore) {
+	constexpr static void run(const MutableImageView<P>& image, Mat3<double> convMat, u32 channels = Red | Green | Blue, EdgeHandling edgeType = Ignore) {
 
 		if (!channels) {
 			return;
 		}
 
-		using Format = typename Image<P>::Format;
+		using PixelType = typename ImageView<P>::PixelType;
+
+		u32 width = image.getWidth();
+		u32 height = image.getHeight();
+
+		if (!width || !height) {
+			return;
+		}
+
+		// Only three padded source rows are live at any time, so keep them in a ring instead of copying the whole image
+		u32 rowSize = width + 2;
+		std::vector<PixelType> rowBuffer(rowSize * 4);
+		std::span<PixelType> firstRow(rowBuffer.data() + rowSize * 3, rowSize);
+
+		bool rowValid[3];
+
+		auto padRow = [&](std::span<PixelType> row, std::span<const PixelType> source) {
+
+			std::copy(source.begin(), source.end(), row.begin() + 1);
+
+			if (edgeType == Repeat) {
+				row[0] = source[width - 1];
+				row[width + 1] = source[0];
+			} else {
+				row[0] = source[0];
+				row[width + 1] = source[width - 1];
+			}
+
+		};
+
+		// The first row gets overwritten before the bottom border is needed, so preserve it for wrapping
+		padRow(firstRow, image.row(0));
+
+		// Loads padded row py (image row py - 1) into its ring slot
+		auto loadRow = [&](u32 py) {
+
+			u32 slot = py % 3;
+			std::span<PixelType> row(rowBuffer.data() + rowSize * slot, rowSize);
+
+			rowValid[slot] = true;
+
+			if (py >= 1 && py <= height) {
+
+				if (py == 1) {
+					std::copy(firstRow.begin(), firstRow.end(), row.begin());
+				} else {
+					padRow(row, image.row(py - 1));
+				}
+
+				return;
+
+			}
+
+			switch (edgeType) {
+
+				case Ignore:
+					rowValid[slot] = false;
+					break;
+
+				case Clamp:
+					if (py == 0) {
+						std::copy(firstRow.begin(), firstRow.end(), row.begin());
+					} else {
+						padRow(row, image.row(height - 1));
+					}
+					break;
+
+				default:
+				case Repeat:
+					if (py == 0) {
+						padRow(row, image.row(height - 1));
+					} else {
+						std::copy(firstRow.begin(), firstRow.end(), row.begin());
+					}
+					break;
+
+			}
 
-		Image<P> buffer(image.getWidth() + 2, image.getHeight() + 2);
-		image.copy(buffer, { 0, 0, image.getWidth(), image.getHeight() }, { 1, 1 });
+		};
 
 		auto function = [&]<EdgeHandling E>() {
 
-			for(u32 y = 0; y < image.getHeight(); y++) {
+			loadRow(0);
+			loadRow(1);
+
+			for(u32 y = 0; y < height; y++) {
+
+				loadRow(y + 2);
+
+				const PixelType* rows[3];
 
-				for(u32 x = 0; x < image.getWidth(); x++) {
+				for (u32 offY = 0; offY < 3; offY++) {
+					rows[offY] = rowValid[(y + offY) % 3] ? rowBuffer.data() + rowSize * ((y + offY) % 3) : nullptr;
+				}
+
+				auto dest = image.row(y);
+
+				for(u32 x = 0; x < width; x++) {
 
 					double r = 0;
 					double g = 0;
@@ -57,7 +147,7 @@ public:
 					// Used in the end to normalize the output
 					double sumChecked = 0;
 
-					auto& p = image.getPixel(x, y);
+					auto& p = dest[x];
 
 					if (!(channels & Red)) {
 						r = p.getRed();
@@ -72,11 +162,9 @@ public:
 						a = p.getAlpha();
 					}
 
-//                    LogI("ConvFilter").print("(%i, %i)", x, y);
 					for (u32 offY = 0; offY < 3; offY++) {
 						for (u32 offX = 0; offX < 3; offX++) {
-							calcPX<P, E>(buffer, convMat, channels, x + offX, y + offY, offX, offY, r, g, b, a, sumChecked);
-//                            LogI("ConvFilter").print("(%i, %i, %i), (%i, %i), %i", r, g, b, offX, offY, sumChecked);
+							calcPX<P, E>(rows[offY], width, convMat, channels, x + offX, offX, offY, r, g, b, a, sumChecked);
 						}
 					}
 
@@ -94,7 +182,7 @@ public:
 						a = Math::abs(a / sumChecked);
 					}
 
-					image.getPixel(x, y).setRGBA(r + 0.5, g + 0.5, b + 0.5, a);
+					p.setRGBA(r + 0.5, g + 0.5, b + 0.5, a);
 
 				}
 
@@ -109,23 +197,11 @@ public:
 				break;
 
 			case EdgeHandling::Clamp:
-				// Set up the borders of the buffer image so we don't have to worry about them anymore
-				buffer.copy( { 1, 1, buffer.getWidth() - 2, 1 }, { 1, 0 } );
-				buffer.copy( { 1, buffer.getHeight() - 2, buffer.getWidth() - 2, 1 }, { 1, buffer.getHeight() - 1 } );
-				buffer.copy( { 1, 0, 1, buffer.getHeight() }, { 0, 0 } );
-				buffer.copy( { buffer.getWidth() - 2, 0, 1, buffer.getHeight() }, { buffer.getWidth() - 1, 0 } );
-
 				function.template operator()<EdgeHandling::Clamp>();
 				break;
 
 			default:
 			case EdgeHandling::Repeat:
-				// Set up the borders of the buffer image so we don't have to worry about them anymore
-				buffer.copy( { 1, 1, buffer.getWidth() - 2, 1 }, { 1, buffer.getHeight() - 1 } );
-				buffer.copy( { 1, buffer.getHeight() - 2, buffer.getWidth() - 2, 1 }, { 1, 0 } );
-				buffer.copy( { 1, 0, 1, buffer.getHeight() }, { buffer.getWidth() - 1, 0 } );
-				buffer.copy( { buffer.getWidth() - 2, 0, 1, buffer.getHeight() }, { 0, 0 } );
-
 				function.template operator()<EdgeHandling::Repeat>();
 				break;
 
@@ -137,14 +213,14 @@ private:
 
 	// Multiplies the pixel with the corresponding entry in the matrix. Expects all pixel values to be valid
 	template<Pixel P, EdgeHandling E>
-	constexpr static void calcPX(Image<P>& buffer, Mat3<double> convMat, u32 channels, u32 imX, u32 imY, u32 matX, u32 matY, double& r, double& g, double& b, double& a, double& checked) {
+	constexpr static void calcPX(const PixelType<P>* row, u32 width, Mat3<double> convMat, u32 channels, u32 imX, u32 matX, u32 matY, double& r, double& g, double& b, double& a, double& checked) {
 		if constexpr (E == Ignore) {
-			if (imX == 0 || imX == buffer.getWidth() - 1 || imY == 0 || imY == buffer.getHeight() - 1) {
+			if (!row || imX == 0 || imX == width + 1) {
 				return;
 			}
 		}
 
-		auto& p = buffer.getPixel(imX, imY);
+		auto& p = row[imX];
 
 		if (channels & Red) {
 			r += convMat[matX][matY] * p.getRed();
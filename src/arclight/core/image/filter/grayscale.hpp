@@ -18,12 +18,11 @@ class GrayscaleFilter {
 public:
 
 	template<Pixel P>
-	constexpr static void run(Image<P>& image) {
+	constexpr static void run(const MutableImageView<P>& image) {
 
-		using Format = typename Image<P>::Format;
-		constexpr u32 maxValueRed = Image<P>::PixelType::getMaxRed();
-		constexpr u32 maxValueGreen = Image<P>::PixelType::getMaxGreen();
-		constexpr u32 maxValueBlue = Image<P>::PixelType::getMaxBlue();
+		constexpr u32 maxValueRed = ImageView<P>::PixelType::getMaxRed();
+		constexpr u32 maxValueGreen = ImageView<P>::PixelType::getMaxGreen();
+		constexpr u32 maxValueBlue = ImageView<P>::PixelType::getMaxBlue();
 
 		for(u32 y = 0; y < image.getHeight(); y++) {
 
@@ -24,13 +24,12 @@ public:
 	};
 
 	template<Pixel P>
-	constexpr static void run(Image<P>& image, u32 channel, double amount) {
+	constexpr static void run(const MutableImageView<P>& image, u32 channel, double amount) {
 
-		using Format = typename Image<P>::Format;
-		constexpr u32 maxValueRed = Image<P>::PixelType::getMaxRed();
-		constexpr u32 maxValueGreen = Image<P>::PixelType::getMaxGreen();
-		constexpr u32 maxValueBlue = Image<P>::PixelType::getMaxBlue();
-		constexpr u32 maxValueAlpha = Image<P>::PixelType::getMaxAlpha();
+		constexpr u32 maxValueRed = ImageView<P>::PixelType::getMaxRed();
+		constexpr u32 maxValueGreen = ImageView<P>::PixelType::getMaxGreen();
+		constexpr u32 maxValueBlue = ImageView<P>::PixelType::getMaxBlue();
+		constexpr u32 maxValueAlpha = ImageView<P>::PixelType::getMaxAlpha();
 
 		amount = Math::max(amount, 0);
 
@@ -20,12 +20,11 @@ class SepiaFilter {
 public:
 
 	template<Pixel P>
-	constexpr static void run(Image<P>& image) {
+	constexpr static void run(const MutableImageView<P>& image) {
 
-		using Format = typename Image<P>::Format;
-		constexpr u32 maxValueRed = Image<P>::PixelType::getMaxRed();
-		constexpr u32 maxValueGreen = Image<P>::PixelType::getMaxGreen();
-		constexpr u32 maxValueBlue = Image<P>::PixelType::getMaxBlue();
+		constexpr u32 maxValueRed = ImageView<P>::PixelType::getMaxRed();
+		constexpr u32 maxValueGreen = ImageView<P>::PixelType::getMaxGreen();
+		constexpr u32 maxValueBlue = ImageView<P>::PixelType::getMaxBlue();
 		constexpr Mat3f sepiaMatrix = Mat3f(0.393, 0.769, 0.189, 0.349, 0.686, 0.168, 0.272, 0.534, 0.131);
 
 		for(u32 y = 0; y < image.getHeight(); y++) {
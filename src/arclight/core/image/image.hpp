@@ -9,6 +9,7 @@
 #pragma once
 
 #include "pixel.hpp"
+#include "imageview.hpp"
 #include "rawimage.hpp"
 #include "math/vector.hpp"
 #include "math/rectangle.hpp"
@@ -20,12 +21,6 @@
 
 
 
-enum class ImageScaling {
-	Nearest,
-	Bilinear
-};
-
-
 class ImageException : public ArclightException {
 
 public:
@@ -50,6 +45,7 @@ public:
 	constexpr Image();
 	constexpr Image(u32 width, u32 height, const PixelType& pixel = PixelType());
 	constexpr Image(u32 width, u32 height, const std::span<const u8>& sourceData);
+	constexpr explicit Image(const ImageView<P>& view);
 
 	constexpr Image(const Image& image);
 	constexpr Image& operator=(const Image& image);
@@ -70,6 +66,11 @@ public:
 	constexpr std::span<PixelType> getImageBuffer();
 	constexpr std::span<const PixelType> getImageBuffer() const;
 
+	constexpr MutableImageView<P> view();
+	constexpr ImageView<P> view() const;
+	constexpr MutableImageView<P> view(const RectUI& rect);
+	constexpr ImageView<P> view(const RectUI& rect) const;
+
 	constexpr void setPixel(u32 x, u32 y, const PixelType& pixel);
 	constexpr PixelType& getPixel(u32 x, u32 y);
 	constexpr const PixelType& getPixel(u32 x, u32 y) const;
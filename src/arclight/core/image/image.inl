@@ -23,6 +23,11 @@ constexpr Image<P>::Image(u32 width, u32 height, const std::span<const u8>& sour
 	setRawData(sourceData);
 }
 
+template<Pixel P>
+constexpr Image<P>::Image(const ImageView<P>& view) : width(view.getWidth()), height(view.getHeight()), pixels(std::make_unique<PixelType[]>(width * height)) {
+	view.copyTo(this->view());
+}
+
 template<Pixel P>
 constexpr Image<P>::Image(const Image<P>& image) : width(image.getWidth()), height(image.getHeight()), pixels(std::make_unique<PixelType[]>(width * height)) {
 	std::copy_n(image.pixels.get(), pixelCount(), pixels.get());
@@ -60,16 +65,7 @@ constexpr void Image<P>::reset() {
 template<Pixel P>
 constexpr void Image<P>::clear(const PixelType& clearPixel) {
 
-	for(u32 y = 0; y < height; y++) {
-
-		for(u32 x = 0; x < width; x++) {
-
-			pixels[y * width + x] = clearPixel;
-
-		}
-
-	}
-
+	std::fill_n(pixels.get(), pixelCount(), clearPixel);
 }
 
 template<Pixel P>
@@ -119,6 +115,26 @@ constexpr std::span<const typename Image<P>::PixelType> Image<P>::getImageBuffer
 	return std::span{pixels.get(), static_cast<SizeT>(pixelCount())};
 }
 
+template<Pixel P>
+constexpr MutableImageView<P> Image<P>::view() {
+	return MutableImageView<P>(pixels.get(), width, height);
+}
+
+template<Pixel P>
+constexpr ImageView<P> Image<P>::view() const {
+	return ImageView<P>(pixels.get(), width, height);
+}
+
+template<Pixel P>
+constexpr MutableImageView<P> Image<P>::view(const RectUI& rect) {
+	return view().subview(rect);
+}
+
+template<Pixel P>
+constexpr ImageView<P> Image<P>::view(const RectUI& rect) const {
+	return view().subview(rect);
+}
+
 template<Pixel P>
 constexpr void Image<P>::setPixel(u32 x, u32 y, const PixelType& pixel) {
 
@@ -146,7 +162,7 @@ constexpr typename Image<P>::PixelType& Image<P>::getPixel(u32 x, u32 y) {
 template<Pixel P>
 template<class Filter, class... Args>
 void Image<P>::applyFilter(Args&&... args) {
-	Filter::run(*this, std::forward<Args>(args)...);
+	Filter::run(view(), std::forward<Args>(args)...);
 }
 
 template<Pixel P>
@@ -177,97 +193,7 @@ constexpr void Image<P>::resize(ImageScaling scaling, u32 w, u32 h) {
 	}
 
 	std::unique_ptr<PixelType[]> resizedPixelData = std::make_unique<PixelType[]>(w * h);
-
-	switch(scaling) {
-
-		case ImageScaling::Nearest:
-
-			for(u32 y = 0; y < h; y++) {
-
-				u32 cy = static_cast<u32>(Math::floor((y + 0.5) * height / h));
-
-				for(u32 x = 0; x < w; x++) {
-
-					u32 cx = static_cast<u32>(Math::floor((x + 0.5) * width / w));
-					resizedPixelData[y * w + x] = getPixel(cx, cy);
-
-				}
-
-			}
-
-			break;
-
-		case ImageScaling::Bilinear:
-
-			for(u32 y = 0; y < h; y++) {
-
-				float fy = (y + 0.5f) * height / h;
-				float ty = fy - static_cast<u32>(fy);
-
-				u32 cy0, cy1;
-
-				if(ty >= 0.5) {
-					cy0 = static_cast<u32>(fy);
-					cy1 = Math::min(cy0 + 1, height - 1);
-				} else {
-					cy1 = static_cast<u32>(fy);
-					cy0 = cy1 ? cy1 - 1 : 0;
-					ty += 1;
-				}
-
-				float dy = ty - 0.5f;
-
-				for(u32 x = 0; x < w; x++) {
-
-					float fx = (x + 0.5f) * width / w;
-					float tx = fx - static_cast<u32>(fx);
-					u32 cx0, cx1;
-
-					if(tx >= 0.5) {
-						cx0 = static_cast<u32>(fx);
-						cx1 = Math::min(cx0 + 1, width - 1);
-					} else {
-						cx1 = static_cast<u32>(fx);
-						cx0 = cx1 ? cx1 - 1 : 0;
-						tx += 1;
-					}
-
-					float dx = tx - 0.5f;
-
-					const PixelType& p00 = getPixel(cx0, cy0);
-					const PixelType& p01 = getPixel(cx0, cy1);
-					const PixelType& p10 = getPixel(cx1, cy0);
-					const PixelType& p11 = getPixel(cx1, cy1);
-
-					//No need to check for max pixel values since those are impossible to reach by standard interpolation
-					Vec4f v00(p00.getRed(), p00.getGreen(), p00.getBlue(), p00.getAlpha());
-					Vec4f v01(p01.getRed(), p01.getGreen(), p01.getBlue(), p01.getAlpha());
-					Vec4f v10(p10.getRed(), p10.getGreen(), p10.getBlue(), p10.getAlpha());
-					Vec4f v11(p11.getRed(), p11.getGreen(), p11.getBlue(), p11.getAlpha());
-
-					Vec4f a0 = (1.0f - dx) * v00 + dx * v10;
-					Vec4f a1 = (1.0f - dx) * v01 + dx * v11;
-					Vec4f a = (1.0f - dy) * a0 + dy * a1;
-
-					PixelType p;
-#ifdef ARC_PIXEL_EXACT
-					p.setRGBA(static_cast<u32>(Math::round(a.x)), static_cast<u32>(Math::round(a.y)), static_cast<u32>(Math::round(a.z)), static_cast<u32>(Math::round(a.w)));
-#else
-					p.setRGBA(static_cast<u32>(a.x), static_cast<u32>(a.y), static_cast<u32>(a.z), static_cast<u32>(a.w));
-#endif
-					resizedPixelData[y * w + x] = p;
-
-				}
-
-			}
-
-			break;
-
-		default:
-			arc_force_assert("Illegal scaling parameter");
-			break;
-
-	}
+	view().resampleTo(MutableImageView<P>(resizedPixelData.get(), w, h), scaling);
 
 	width = w;
 	height = h;
@@ -296,55 +222,44 @@ constexpr void Image<P>::copy(Image<P>& destImage, const RectUI& src, const Vec2
 
 	}
 
-	for (u32 y = 0; y < src.getHeight(); y++) {
-
-		for (u32 x = 0; x < src.getWidth(); x++) {
-
-			destImage.setPixel(dest.x + x, dest.y + y, this->getPixel(src.getX() + x, src.getY() + y));
-
-		}
-
-	}
+	view(src).copyTo(destImage.view({ dest.x, dest.y, src.getWidth(), src.getHeight() }));
 
 }
 
 template<Pixel P>
 constexpr void Image<P>::copy(const RectUI& src, const Vec2ui& dest) {
 
-	u32 xStart = 0;
-	u32 xEnd = 0;
-
-	u32 yStart = 0;
-	u32 yEnd = 0;
-
 	if (src.getPosition() == dest) {
-
 		return;
+	}
 
-	} else if (src.getX() + src.getY() * this->getWidth() > dest.x + dest.y * this->getWidth()) {
-
-		xEnd = src.getWidth();
-		yEnd = src.getHeight();
-
-	} else {
+	MutableImageView<P> from = view(src);
+	MutableImageView<P> to = view({ dest.x, dest.y, src.getWidth(), src.getHeight() });
 
-		xStart = src.getWidth();
-		yStart = src.getHeight();
+	// Regions may overlap, so walk the rows against the direction of the move
+	auto copyRow = [&](u32 y) {
 
-	}
+		auto s = from.row(y);
+		auto d = to.row(y);
 
-	for (u32 y = yStart; y != yEnd; y += (yStart < yEnd ? 1 : -1)) {
+		if (d.data() < s.data()) {
+			std::copy(s.begin(), s.end(), d.begin());
+		} else {
+			std::copy_backward(s.begin(), s.end(), d.end());
+		}
 
-		for (u32 x = xStart; x != xEnd; x += (xStart < xEnd ? 1 : -1)) {
+	};
 
-			x += (xStart < xEnd ? 0 : -1);
-			y += (yStart < yEnd ? 0 : -1);
+	if (dest.y <= src.getY()) {
 
-			this->setPixel(dest.x + x, dest.y + y, this->getPixel(src.getX() + x, src.getY() + y));
+		for (u32 y = 0; y < src.getHeight(); y++) {
+			copyRow(y);
+		}
 
-			x -= (xStart < xEnd ? 0 : -1);
-			y -= (yStart < yEnd ? 0 : -1);
+	} else {
 
+		for (u32 y = src.getHeight(); y > 0; y--) {
+			copyRow(y - 1);
 		}
 
 	}
@@ -361,16 +276,7 @@ Image<Q> Image<P>::convert() const {
 	}
 
 	Image<Q> img(width, height);
-
-	for (u32 y = 0; y < height; y++) {
-
-		for (u32 x = 0; x < width; x++) {
-
-			img.setPixel(x, y, PixelConverter::convert<Q>(getPixel(x, y)));
-
-		}
-
-	}
+	view().convertTo(img.view());
 
 	return img;
 
@@ -11,18 +11,15 @@
 
 
 
-std::vector<u8> ImageIO::Detail::loadFile(const Path& path) {
+MappedFile ImageIO::Detail::loadFile(const Path& path) {
 
-	File file(path);
+	MappedFile file;
 
-	if (!file.open()) {
+	if (!file.open(path)) {
 		throw ImageException("Failed to open file " + path.toString());
 	}
 
-	std::vector<u8> data = file.readAll();
-	file.close();
-
-	return data;
+	return file;
 
 }
 
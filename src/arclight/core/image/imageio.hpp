@@ -18,6 +18,7 @@
 #include "encode/encoder.hpp"
 #include "encode/ppmencoder.hpp"
 #include "util/bool.hpp"
+#include "filesystem/mappedfile.hpp"
 
 
 
@@ -25,7 +26,7 @@ namespace ImageIO {
 
 	namespace Detail {
 
-		std::vector<u8> loadFile(const Path& path);
+		MappedFile loadFile(const Path& path);
 
 		void saveFile(const Path& path, std::span<const u8> data);
 
@@ -48,7 +49,7 @@ namespace ImageIO {
 
 	template<CC::ImageDecoder Decoder, class... Args>
 	Decoder decode(const Path& path, std::optional<Pixel> reqFormat = {}, Args&&... args) {
-		return decode<Decoder, Args...>(Detail::loadFile(path), reqFormat, std::forward<Args>(args)...);
+		return decode<Decoder, Args...>(Detail::loadFile(path).data(), reqFormat, std::forward<Args>(args)...);
 	}
 
 	template<CC::ImageEncoder Encoder, class Img, class... Args>
@@ -56,8 +57,10 @@ namespace ImageIO {
 
 		Encoder encoder(reqFormat, std::forward<Args>(args)...);
 
-		if constexpr (CC::Equal<Img, RawImage>)
+		if constexpr (CC::Equal<Img, RawImage> || requires { encoder.encode(image); })
 			encoder.encode(image);
+		else if constexpr (requires { encoder.encode(image.view()); })
+			encoder.encode(image.view());
 		else
 			encoder.encode(Img(image).makeRaw());
 
@@ -77,7 +80,7 @@ namespace ImageIO {
 
 	template<Pixel P, CC::ImageDecoder Decoder, class... Args>
 	Image<P> load(const Path& path, Args&&... args) {
-		return load<P, Decoder, Args...>(Detail::loadFile(path), std::forward<Args>(args)...);
+		return load<P, Decoder, Args...>(Detail::loadFile(path).data(), std::forward<Args>(args)...);
 	}
 
 	template<Pixel P, CC::ImageEncoder Encoder, class Img, class... Args>
@@ -102,7 +105,7 @@ namespace ImageIO {
 
 	template<CC::ImageDecoder Decoder, class... Args>
 	RawImage load(const Path& path, Args&&... args) {
-		return load<Decoder, Args...>(Detail::loadFile(path), std::forward<Args>(args)...);
+		return load<Decoder, Args...>(Detail::loadFile(path).data(), std::forward<Args>(args)...);
 	}
 
 	template<CC::ImageEncoder Encoder, class Img, class... Args>
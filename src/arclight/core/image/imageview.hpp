@@ -0,0 +1,311 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 imageview.hpp
+ */
+
+#pragma once
+
+#include "pixel.hpp"
+#include "math/vector.hpp"
+#include "math/rectangle.hpp"
+#include "common/typetraits.hpp"
+#include "util/assert.hpp"
+#include "util/log.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <span>
+
+
+
+enum class ImageScaling {
+	Nearest,
+	Bilinear
+};
+
+
+
+/*
+ *  Non-owning window into pixel memory
+ *  Rows are stride pixels apart, which allows views to address sub-rectangles of larger images without copying
+ */
+template<Pixel P, bool Const = true>
+class ImageView {
+
+public:
+
+	using Format = PixelFormat<P>;
+	using PixelType = ::PixelType<P>;
+	using PixelPtr = TT::ConditionalConst<Const, PixelType>*;
+
+	constexpr static u32 PixelBytes = Format::BytesPerPixel;
+
+
+	constexpr ImageView() noexcept : pixels(nullptr), width(0), height(0), stride(0) {}
+	constexpr ImageView(PixelPtr pixels, u32 width, u32 height) noexcept : ImageView(pixels, width, height, width) {}
+
+	constexpr ImageView(PixelPtr pixels, u32 width, u32 height, SizeT stride) noexcept : pixels(pixels), width(width), height(height), stride(stride) {
+		arc_assert(stride >= width, "Image view stride must not be smaller than its width");
+	}
+
+	// Mutable views decay to constant views
+	constexpr ImageView(const ImageView<P, false>& view) noexcept requires (Const) : ImageView(view.data(), view.getWidth(), view.getHeight(), view.getStride()) {}
+
+
+	constexpr u32 getWidth() const noexcept {
+		return width;
+	}
+
+	constexpr u32 getHeight() const noexcept {
+		return height;
+	}
+
+	constexpr SizeT getStride() const noexcept {
+		return stride;
+	}
+
+	constexpr u64 pixelCount() const noexcept {
+		return u64(width) * height;
+	}
+
+	constexpr bool empty() const noexcept {
+		return !width || !height;
+	}
+
+	constexpr bool isContiguous() const noexcept {
+		return stride == width || height <= 1;
+	}
+
+	constexpr PixelPtr data() const noexcept {
+		return pixels;
+	}
+
+	constexpr std::span<TT::ConditionalConst<Const, PixelType>> row(u32 y) const noexcept {
+
+		arc_assert(y < height, "Row access out of bounds");
+		return { pixels + y * stride, width };
+
+	}
+
+	constexpr auto& getPixel(u32 x, u32 y) const noexcept {
+
+		arc_assert(x < width && y < height, "Pixel access out of bounds");
+		return pixels[y * stride + x];
+
+	}
+
+	constexpr void setPixel(u32 x, u32 y, const PixelType& pixel) const noexcept requires (!Const) {
+
+		arc_assert(x < width && y < height, "Pixel access out of bounds");
+		pixels[y * stride + x] = pixel;
+
+	}
+
+
+	constexpr ImageView subview(u32 x, u32 y, u32 w, u32 h) const noexcept {
+
+		arc_assert(x + w <= width && y + h <= height, "Subview exceeds image view bounds");
+		return ImageView(pixels + y * stride + x, w, h, stride);
+
+	}
+
+	constexpr ImageView subview(const RectUI& rect) const noexcept {
+		return subview(rect.getX(), rect.getY(), rect.getWidth(), rect.getHeight());
+	}
+
+	constexpr ImageView rows(u32 y, u32 count) const noexcept {
+		return subview(0, y, width, count);
+	}
+
+
+	constexpr void fill(const PixelType& pixel) const noexcept requires (!Const) {
+
+		for (u32 y = 0; y < height; y++) {
+			std::fill_n(pixels + y * stride, width, pixel);
+		}
+
+	}
+
+	template<class Filter, class... Args>
+	void applyFilter(Args&&... args) const requires (!Const) {
+		Filter::run(*this, std::forward<Args>(args)...);
+	}
+
+	// Copies the view into dest, which must have the same dimensions. Both views must not overlap.
+	constexpr void copyTo(const ImageView<P, false>& dest) const noexcept {
+
+		arc_assert(dest.getWidth() == width && dest.getHeight() == height, "Image view copy dimension mismatch");
+
+		if (isContiguous() && dest.isContiguous()) {
+
+			std::copy_n(pixels, pixelCount(), dest.data());
+			return;
+
+		}
+
+		for (u32 y = 0; y < height; y++) {
+			std::copy_n(pixels + y * stride, width, dest.data() + y * dest.getStride());
+		}
+
+	}
+
+	template<Pixel Q>
+	constexpr void convertTo(const ImageView<Q, false>& dest) const {
+
+		arc_assert(dest.getWidth() == width && dest.getHeight() == height, "Image view conversion dimension mismatch");
+
+		if constexpr (P == Q) {
+
+			copyTo(dest);
+
+		} else {
+
+			for (u32 y = 0; y < height; y++) {
+
+				const PixelType* src = pixels + y * stride;
+				auto dst = dest.data() + y * dest.getStride();
+
+				for (u32 x = 0; x < width; x++) {
+					dst[x] = PixelConverter::convert<Q>(src[x]);
+				}
+
+			}
+
+		}
+
+	}
+
+	// Resamples the view into dest, stretching it to the destination dimensions
+	constexpr void resampleTo(const ImageView<P, false>& dest, ImageScaling scaling) const;
+
+	constexpr static Pixel getFormat() {
+		return P;
+	}
+
+private:
+
+	PixelPtr pixels;
+	u32 width;
+	u32 height;
+	SizeT stride;
+
+};
+
+
+template<Pixel P>
+using MutableImageView = ImageView<P, false>;
+
+
+
+template<Pixel P, bool Const>
+constexpr void ImageView<P, Const>::resampleTo(const ImageView<P, false>& dest, ImageScaling scaling) const {
+
+	u32 w = dest.getWidth();
+	u32 h = dest.getHeight();
+
+	if (empty()) {
+		LogE("Image") << "Cannot resample zero-dimensioned image";
+		return;
+	}
+
+	switch(scaling) {
+
+		case ImageScaling::Nearest:
+
+			for(u32 y = 0; y < h; y++) {
+
+				u32 cy = static_cast<u32>(Math::floor((y + 0.5) * height / h));
+				const PixelType* src = pixels + cy * stride;
+				auto dst = dest.row(y);
+
+				for(u32 x = 0; x < w; x++) {
+
+					u32 cx = static_cast<u32>(Math::floor((x + 0.5) * width / w));
+					dst[x] = src[cx];
+
+				}
+
+			}
+
+			break;
+
+		case ImageScaling::Bilinear:
+
+			for(u32 y = 0; y < h; y++) {
+
+				float fy = (y + 0.5f) * height / h;
+				float ty = fy - static_cast<u32>(fy);
+
+				u32 cy0, cy1;
+
+				if(ty >= 0.5) {
+					cy0 = static_cast<u32>(fy);
+					cy1 = Math::min(cy0 + 1, height - 1);
+				} else {
+					cy1 = static_cast<u32>(fy);
+					cy0 = cy1 ? cy1 - 1 : 0;
+					ty += 1;
+				}
+
+				float dy = ty - 0.5f;
+
+				const PixelType* src0 = pixels + cy0 * stride;
+				const PixelType* src1 = pixels + cy1 * stride;
+				auto dst = dest.row(y);
+
+				for(u32 x = 0; x < w; x++) {
+
+					float fx = (x + 0.5f) * width / w;
+					float tx = fx - static_cast<u32>(fx);
+					u32 cx0, cx1;
+
+					if(tx >= 0.5) {
+						cx0 = static_cast<u32>(fx);
+						cx1 = Math::min(cx0 + 1, width - 1);
+					} else {
+						cx1 = static_cast<u32>(fx);
+						cx0 = cx1 ? cx1 - 1 : 0;
+						tx += 1;
+					}
+
+					float dx = tx - 0.5f;
+
+					const PixelType& p00 = src0[cx0];
+					const PixelType& p01 = src1[cx0];
+					const PixelType& p10 = src0[cx1];
+					const PixelType& p11 = src1[cx1];
+
+					//No need to check for max pixel values since those are impossible to reach by standard interpolation
+					Vec4f v00(p00.getRed(), p00.getGreen(), p00.getBlue(), p00.getAlpha());
+					Vec4f v01(p01.getRed(), p01.getGreen(), p01.getBlue(), p01.getAlpha());
+					Vec4f v10(p10.getRed(), p10.getGreen(), p10.getBlue(), p10.getAlpha());
+					Vec4f v11(p11.getRed(), p11.getGreen(), p11.getBlue(), p11.getAlpha());
+
+					Vec4f a0 = (1.0f - dx) * v00 + dx * v10;
+					Vec4f a1 = (1.0f - dx) * v01 + dx * v11;
+					Vec4f a = (1.0f - dy) * a0 + dy * a1;
+
+					PixelType p;
+#ifdef ARC_PIXEL_EXACT
+					p.setRGBA(static_cast<u32>(Math::round(a.x)), static_cast<u32>(Math::round(a.y)), static_cast<u32>(Math::round(a.z)), static_cast<u32>(Math::round(a.w)));
+#else
+					p.setRGBA(static_cast<u32>(a.x), static_cast<u32>(a.y), static_cast<u32>(a.z), static_cast<u32>(a.w));
+#endif
+					dst[x] = p;
+
+				}
+
+			}
+
+			break;
+
+		default:
+			arc_force_assert("Illegal scaling parameter");
+			break;
+
+	}
+
+}
@@ -194,6 +194,28 @@ struct PixelFormat<Pixel::BGR5> {
 
 
 
+//Runtime pixel size query
+constexpr u32 getPixelBytes(Pixel pixel) {
+
+	switch (pixel) {
+
+		case Pixel::Grayscale8: return PixelFormat<Pixel::Grayscale8>::BytesPerPixel;
+		case Pixel::BGR5:       return PixelFormat<Pixel::BGR5>::BytesPerPixel;
+		case Pixel::RGB5:       return PixelFormat<Pixel::RGB5>::BytesPerPixel;
+		case Pixel::BGR8:       return PixelFormat<Pixel::BGR8>::BytesPerPixel;
+		case Pixel::RGB8:       return PixelFormat<Pixel::RGB8>::BytesPerPixel;
+		case Pixel::RGBA8:      return PixelFormat<Pixel::RGBA8>::BytesPerPixel;
+		case Pixel::ABGR8:      return PixelFormat<Pixel::ABGR8>::BytesPerPixel;
+		case Pixel::BGRA8:      return PixelFormat<Pixel::BGRA8>::BytesPerPixel;
+		case Pixel::ARGB8:      return PixelFormat<Pixel::ARGB8>::BytesPerPixel;
+		default: ARC_UNREACHABLE;
+
+	}
+
+}
+
+
+
 //Pixel Storages
 template<Pixel P, class ColorT>
 struct PixelStorage {
@@ -9,8 +9,10 @@
 #pragma once
 
 #include "pixel.hpp"
+#include "imageview.hpp"
 
 #include <vector>
+#include <memory>
 
 
 
@@ -18,14 +20,22 @@ class RawImage {
 
 public:
 
-	constexpr RawImage() noexcept : width(0), height(0), format(Pixel::RGB8), bufferSize(0) {}
-	constexpr RawImage(u32 width, u32 height) noexcept : width(width), height(height), format(Pixel::RGB8), bufferSize(0), buffer(nullptr) {}
+	constexpr RawImage() noexcept : width(0), height(0), format(Pixel::RGB8), bufferSize(0), data(nullptr) {}
+	constexpr RawImage(u32 width, u32 height) noexcept : width(width), height(height), format(Pixel::RGB8), bufferSize(0), buffer(nullptr), data(nullptr) {}
 
 	template<class T>
-	inline RawImage(u32 width, u32 height, T* pixels) : width(width), height(height), format(T::PixelType), bufferSize(pixels ? T::Format::BytesPerPixel * width * height : 0), buffer(Bits::toByteArray(pixels)) {}
+	inline RawImage(u32 width, u32 height, T* pixels) : width(width), height(height), format(T::PixelType), bufferSize(pixels ? T::Format::BytesPerPixel * width * height : 0), buffer(Bits::toByteArray(pixels)), data(buffer.get()) {}
+
+	/*
+	 *  Wraps externally owned, tightly packed pixel memory (e.g. mapped files or buffers) without taking ownership.
+	 *  The memory must outlive the image; copies and release() detach into an owned buffer.
+	 */
+	inline RawImage(u32 width, u32 height, Pixel format, std::span<u8> external) : width(width), height(height), format(format), bufferSize(external.size()), buffer(nullptr), data(external.data()) {
+		arc_assert(external.size() >= SizeT(width) * height * getPixelBytes(format), "External buffer too small for image");
+	}
 
-	inline RawImage(const RawImage& image) : width(image.width), height(image.height), format(image.format), bufferSize(image.bufferSize), buffer(std::make_unique<u8[]>(image.bufferSize)) {
-		std::copy_n(image.buffer.get(), bufferSize, buffer.get());
+	inline RawImage(const RawImage& image) : width(image.width), height(image.height), format(image.format), bufferSize(image.bufferSize), buffer(std::make_unique<u8[]>(image.bufferSize)), data(buffer.get()) {
+		std::copy_n(image.data, bufferSize, data);
 	}
 
 	inline RawImage& operator=(const RawImage& image) {
@@ -34,8 +44,9 @@ public:
 
 			SizeT otherSize = image.getRawBuffer().size();
 
-			if (getRawBuffer().size() != otherSize) {
+			if (!isOwning() || getRawBuffer().size() != otherSize) {
 				buffer = std::make_unique<u8[]>(otherSize);
+				data = buffer.get();
 			}
 
 			width = image.getWidth();
@@ -43,7 +54,7 @@ public:
 			format = image.getFormat();
 			bufferSize = otherSize;
 
-			std::copy_n(image.buffer.get(), bufferSize, buffer.get());
+			std::copy_n(image.data, bufferSize, data);
 
 		}
 
@@ -51,11 +62,31 @@ public:
 
 	}
 
-	RawImage(RawImage&&) = default;
-	RawImage& operator=(RawImage&&) = default;
+	inline RawImage(RawImage&& image) noexcept : width(image.width), height(image.height), format(image.format), bufferSize(image.bufferSize), buffer(std::move(image.buffer)), data(image.data) {
+		image.detach();
+	}
+
+	inline RawImage& operator=(RawImage&& image) noexcept {
+
+		if (this != &image) {
+
+			width = image.width;
+			height = image.height;
+			format = image.format;
+			bufferSize = image.bufferSize;
+			buffer = std::move(image.buffer);
+			data = image.data;
+
+			image.detach();
+
+		}
+
+		return *this;
+
+	}
 
 	inline bool operator==(const RawImage& image) const noexcept {
-		return buffer.get() == image.buffer.get();
+		return data == image.data;
 	}
 
 	constexpr u32 getWidth() const noexcept {
@@ -74,28 +105,68 @@ public:
 		return bufferSize;
 	}
 
+	constexpr bool isOwning() const noexcept {
+		return buffer.get() == data;
+	}
+
 	inline std::span<const u8> getRawBuffer() const noexcept {
-		return std::span{buffer.get(), bufferSize};
+		return std::span{data, bufferSize};
 	}
 
+	inline std::span<u8> getRawBuffer() noexcept {
+		return std::span{data, bufferSize};
+	}
+
+	template<Pixel P>
+	inline ImageView<P> view() const noexcept {
+
+		arc_assert(format == P, "Bad image view format");
+		return ImageView<P>(reinterpret_cast<const PixelType<P>*>(data), width, height);
+
+	}
+
+	template<Pixel P>
+	inline MutableImageView<P> view() noexcept {
+
+		arc_assert(format == P, "Bad image view format");
+		return MutableImageView<P>(reinterpret_cast<PixelType<P>*>(data), width, height);
+
+	}
+
+	// Releases ownership of the pixel buffer. External memory is copied first since the caller takes ownership.
 	inline std::span<u8> release() {
 
-		std::span<u8> data = { buffer.release(), bufferSize };
+		if (!isOwning()) {
 
-		width = 0;
-		height = 0;
-		bufferSize = 0;
+			buffer = std::make_unique<u8[]>(bufferSize);
+			std::copy_n(data, bufferSize, buffer.get());
+
+		}
 
-		return data;
+		std::span<u8> released = { buffer.release(), bufferSize };
+
+		detach();
+
+		return released;
 
 	}
 
 private:
 
+	inline void detach() noexcept {
+
+		width = 0;
+		height = 0;
+		bufferSize = 0;
+		data = nullptr;
+
+	}
+
 	u32 width;
 	u32 height;
 	Pixel format;
 	SizeT bufferSize;
 	std::unique_ptr<u8[]> buffer;
+	u8* data;
 
 };
\ No newline at end of file
@@ -66,6 +66,10 @@ public:
 		return items.empty();
 	}
 
+	constexpr SizeT size() const {
+		return items.size();
+	}
+
 	ItemIterator begin();
 	ItemConstIterator begin() const;
 	ItemConstIterator cbegin() const;
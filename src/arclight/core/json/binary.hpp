@@ -0,0 +1,171 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 binary.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "stream/binaryreader.hpp"
+#include "stream/binarywriter.hpp"
+
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <span>
+
+
+
+/*
+ *  Primitives shared by the binary JSON codecs
+ *  Fields are written and read big endian byte by byte, independent of the stream's byte order. Reads are bounds checked
+ *  and throw JsonSyntaxError, writes rely on the caller having reserved the exact encoded size.
+ */
+namespace JsonBinary {
+
+	constexpr u32 MaxDepth = 1024;
+
+
+	template<CC::UnsignedType T>
+	inline void write(BinaryWriter& writer, T value) {
+
+		u8* p = writer.head();
+
+		for (SizeT i = sizeof(T); i-- > 0;) {
+			*p++ = u8(value >> (i * 8));
+		}
+
+		writer.seek(sizeof(T));
+
+	}
+
+	inline void writeBytes(BinaryWriter& writer, const void* data, SizeT size) {
+
+		std::memcpy(writer.head(), data, size);
+		writer.seek(size);
+
+	}
+
+
+	inline void require(const BinaryReader& reader, u64 size) {
+
+		if (reader.remainingSize() < size) {
+			throw JsonSyntaxError("Unexpected end of binary data");
+		}
+
+	}
+
+	template<CC::UnsignedType T>
+	inline T read(BinaryReader& reader) {
+
+		require(reader, sizeof(T));
+
+		const u8* p = reader.head();
+		T value = 0;
+
+		for (SizeT i = 0; i < sizeof(T); i++) {
+			value = (value << 8) | p[i];
+		}
+
+		reader.seek(sizeof(T));
+
+		return value;
+
+	}
+
+	inline std::span<const u8> readBytes(BinaryReader& reader, u64 size) {
+
+		require(reader, size);
+
+		std::span<const u8> bytes(reader.head(), size);
+		reader.seek(size);
+
+		return bytes;
+
+	}
+
+	inline Json::StringView toStringView(std::span<const u8> bytes) {
+		return Json::StringView(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	}
+
+
+	//True if the float holds value exactly, NaNs included
+	inline bool fitsFloat(double value) {
+		return std::isnan(value) || (std::fabs(value) <= FLT_MAX && double(float(value)) == value) || std::isinf(value);
+	}
+
+	//Returns the IEEE 754 half precision bits of value if it can be represented exactly
+	inline std::optional<u16> toHalf(double value) {
+
+		if (!fitsFloat(value)) {
+			return std::nullopt;
+		}
+
+		u32 bits = std::bit_cast<u32>(float(value));
+		u16 sign = (bits >> 16) & 0x8000;
+		i32 exponent = i32((bits >> 23) & 0xFF) - 127;
+		u32 mantissa = bits & 0x7FFFFF;
+
+		if (std::isnan(value)) {
+			return u16(0x7E00);
+		}
+
+		if (std::isinf(value)) {
+			return u16(sign | 0x7C00);
+		}
+
+		if (exponent == -127 && mantissa == 0) {
+			return sign;
+		}
+
+		if (exponent >= -14 && exponent <= 15) {
+
+			if (mantissa & 0x1FFF) {
+				return std::nullopt;
+			}
+
+			return u16(sign | ((exponent + 15) << 10) | (mantissa >> 13));
+
+		}
+
+		if (exponent >= -24 && exponent < -14) {
+
+			u32 shift = 13 + (-14 - exponent);
+			u32 significand = mantissa | 0x800000;
+
+			if (significand & ((1u << shift) - 1)) {
+				return std::nullopt;
+			}
+
+			return u16(sign | (significand >> shift));
+
+		}
+
+		return std::nullopt;
+
+	}
+
+	inline double fromHalf(u16 half) {
+
+		u32 exponent = (half >> 10) & 0x1F;
+		u32 mantissa = half & 0x3FF;
+		double value;
+
+		if (exponent == 0) {
+			value = std::ldexp(mantissa, -24);
+		} else if (exponent != 31) {
+			value = std::ldexp(mantissa + 1024, i32(exponent) - 25);
+		} else {
+			value = mantissa ? NAN : INFINITY;
+		}
+
+		return (half & 0x8000) ? -value : value;
+
+	}
+
+}
@@ -0,0 +1,476 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 cbor.cpp
+ */
+
+#include "cbor.hpp"
+#include "binary.hpp"
+#include "array.hpp"
+#include "object.hpp"
+
+#include <algorithm>
+#include <limits>
+
+
+
+namespace {
+
+	enum Major : u8 {
+		Unsigned,
+		Negative,
+		Bytes,
+		Text,
+		Array,
+		Map,
+		Tag,
+		Simple
+	};
+
+	constexpr u8 Indefinite = 31;
+	constexpr u8 Break = 0xFF;
+
+	constexpr u8 False = 0xF4;
+	constexpr u8 True = 0xF5;
+	constexpr u8 Null = 0xF6;
+	constexpr u8 Undefined = 0xF7;
+	constexpr u8 Half = 0xF9;
+	constexpr u8 Single = 0xFA;
+	constexpr u8 Double = 0xFB;
+
+
+	SizeT headerSize(u64 argument) {
+		return argument < 24 ? 1 : argument <= 0xFF ? 2 : argument <= 0xFFFF ? 3 : argument <= 0xFFFFFFFF ? 5 : 9;
+	}
+
+	void writeHeader(BinaryWriter& writer, Major major, u64 argument) {
+
+		u8 type = major << 5;
+
+		if (argument < 24) {
+
+			JsonBinary::write<u8>(writer, type | argument);
+
+		} else if (argument <= 0xFF) {
+
+			JsonBinary::write<u8>(writer, type | 24);
+			JsonBinary::write<u8>(writer, argument);
+
+		} else if (argument <= 0xFFFF) {
+
+			JsonBinary::write<u8>(writer, type | 25);
+			JsonBinary::write<u16>(writer, argument);
+
+		} else if (argument <= 0xFFFFFFFF) {
+
+			JsonBinary::write<u8>(writer, type | 26);
+			JsonBinary::write<u32>(writer, argument);
+
+		} else {
+
+			JsonBinary::write<u8>(writer, type | 27);
+			JsonBinary::write<u64>(writer, argument);
+
+		}
+
+	}
+
+	u64 integerArgument(Json::IntegerType value) {
+		return value >= 0 ? u64(value) : ~u64(value);
+	}
+
+	SizeT floatSize(Json::FloatType value) {
+		return JsonBinary::toHalf(value) ? 3 : JsonBinary::fitsFloat(value) ? 5 : 9;
+	}
+
+	//Deterministic key order: shorter keys first, equally long keys bytewise
+	bool keyLess(const Json::StringType& a, const Json::StringType& b) {
+		return a.size() != b.size() ? a.size() < b.size() : a < b;
+	}
+
+
+	u64 readArgument(BinaryReader& reader, u8 info) {
+
+		switch (info) {
+
+			case 24:	return JsonBinary::read<u8>(reader);
+			case 25:	return JsonBinary::read<u16>(reader);
+			case 26:	return JsonBinary::read<u32>(reader);
+			case 27:	return JsonBinary::read<u64>(reader);
+
+			default:
+
+				if (info < 24) {
+					return info;
+				}
+
+				throw JsonSyntaxError("Invalid CBOR argument encoding");
+
+		}
+
+	}
+
+	bool atBreak(BinaryReader& reader) {
+
+		JsonBinary::require(reader, 1);
+
+		if (*reader.head() == Break) {
+
+			reader.seek(1);
+			return true;
+
+		}
+
+		return false;
+
+	}
+
+	//Reads a byte or text string whose initial byte has been consumed, concatenating indefinite length chunks into scratch
+	std::span<const u8> readString(BinaryReader& reader, Major major, u8 info, Json::StringType& scratch) {
+
+		if (info != Indefinite) {
+			return JsonBinary::readBytes(reader, readArgument(reader, info));
+		}
+
+		scratch.clear();
+
+		while (!atBreak(reader)) {
+
+			u8 initial = JsonBinary::read<u8>(reader);
+
+			if ((initial >> 5) != major || (initial & 0x1F) == Indefinite) {
+				throw JsonSyntaxError("Invalid chunk in indefinite length CBOR string");
+			}
+
+			Json::StringView chunk = JsonBinary::toStringView(JsonBinary::readBytes(reader, readArgument(reader, initial & 0x1F)));
+			scratch.append(chunk);
+
+		}
+
+		return { reinterpret_cast<const u8*>(scratch.data()), scratch.size() };
+
+	}
+
+	void decodeItem(BinaryReader& reader, JsonHandler& handler, u32 depth, Json::StringType& scratch) {
+
+		if (depth == JsonBinary::MaxDepth) {
+			throw JsonSyntaxError("Maximum nesting depth exceeded");
+		}
+
+		u8 initial = JsonBinary::read<u8>(reader);
+		Major major = Major(initial >> 5);
+		u8 info = initial & 0x1F;
+
+		switch (major) {
+
+			case Unsigned:
+			case Negative:
+			{
+				u64 argument = readArgument(reader, info);
+
+				if (argument <= u64(std::numeric_limits<Json::IntegerType>::max())) {
+					handler.integer(major == Unsigned ? Json::IntegerType(argument) : -1 - Json::IntegerType(argument));
+				} else {
+					handler.floating(major == Unsigned ? Json::FloatType(argument) : -1.0 - Json::FloatType(argument));
+				}
+
+				break;
+			}
+
+			case Bytes:
+				handler.binary(readString(reader, major, info, scratch));
+				break;
+
+			case Text:
+				handler.string(JsonBinary::toStringView(readString(reader, major, info, scratch)));
+				break;
+
+			case Array:
+
+				handler.startArray();
+
+				if (info == Indefinite) {
+
+					while (!atBreak(reader)) {
+						decodeItem(reader, handler, depth + 1, scratch);
+					}
+
+				} else {
+
+					for (u64 i = readArgument(reader, info); i > 0; i--) {
+						decodeItem(reader, handler, depth + 1, scratch);
+					}
+
+				}
+
+				handler.endArray();
+				break;
+
+			case Map:
+			{
+				handler.startObject();
+
+				bool indefinite = info == Indefinite;
+				u64 count = indefinite ? 0 : readArgument(reader, info);
+
+				for (u64 i = 0; indefinite ? !atBreak(reader) : i < count; i++) {
+
+					u8 key = JsonBinary::read<u8>(reader);
+
+					if ((key >> 5) != Text) {
+						throw JsonSyntaxError("CBOR map key is not a text string");
+					}
+
+					handler.name(JsonBinary::toStringView(readString(reader, Text, key & 0x1F, scratch)));
+					decodeItem(reader, handler, depth + 1, scratch);
+
+				}
+
+				handler.endObject();
+				break;
+			}
+
+			case Tag:
+
+				readArgument(reader, info);
+				decodeItem(reader, handler, depth + 1, scratch);
+
+				break;
+
+			case Simple:
+
+				switch (initial) {
+
+					case False:		handler.boolean(false);											break;
+					case True:		handler.boolean(true);											break;
+					case Null:
+					case Undefined:	handler.null();													break;
+					case Half:		handler.floating(JsonBinary::fromHalf(JsonBinary::read<u16>(reader)));				break;
+					case Single:	handler.floating(std::bit_cast<float>(JsonBinary::read<u32>(reader)));	break;
+					case Double:	handler.floating(std::bit_cast<double>(JsonBinary::read<u64>(reader)));	break;
+
+					default:
+						throw JsonSyntaxError("Unsupported CBOR simple value");
+
+				}
+
+				break;
+
+		}
+
+	}
+
+}
+
+
+
+SizeT CborCodec::getEncodedSize(const JsonValue& value) {
+
+	switch (value.getType()) {
+
+		case Json::Type::String:
+		{
+			SizeT size = value.toStringView().size();
+			return headerSize(size) + size;
+		}
+
+		case Json::Type::Number:
+			return value.isInteger() ? headerSize(integerArgument(value.toNumber<Json::IntegerType>())) : floatSize(value.toNumber<Json::FloatType>());
+
+		case Json::Type::Object:
+			return getEncodedSize(value.toObject());
+
+		case Json::Type::Array:
+			return getEncodedSize(value.toArray());
+
+		default:
+			return 1;
+
+	}
+
+}
+
+SizeT CborCodec::getEncodedSize(const JsonObject& object) {
+
+	SizeT size = headerSize(object.size());
+
+	for (const auto& [name, value] : object) {
+		size += headerSize(name.size()) + name.size() + getEncodedSize(value);
+	}
+
+	return size;
+
+}
+
+SizeT CborCodec::getEncodedSize(const JsonArray& array) {
+
+	SizeT size = headerSize(array.size());
+
+	for (const JsonValue& value : array) {
+		size += getEncodedSize(value);
+	}
+
+	return size;
+
+}
+
+
+
+void CborCodec::encode(const JsonValue& value, BinaryWriter& writer) {
+
+	switch (value.getType()) {
+
+		case Json::Type::String:
+		{
+			Json::StringView string = value.toStringView();
+
+			writeHeader(writer, Text, string.size());
+			JsonBinary::writeBytes(writer, string.data(), string.size());
+
+			break;
+		}
+
+		case Json::Type::Number:
+
+			if (value.isInteger()) {
+
+				Json::IntegerType integer = value.toNumber<Json::IntegerType>();
+				writeHeader(writer, integer >= 0 ? Unsigned : Negative, integerArgument(integer));
+
+			} else {
+
+				Json::FloatType floating = value.toNumber<Json::FloatType>();
+
+				if (std::optional<u16> half = JsonBinary::toHalf(floating)) {
+
+					JsonBinary::write<u8>(writer, Half);
+					JsonBinary::write<u16>(writer, *half);
+
+				} else if (JsonBinary::fitsFloat(floating)) {
+
+					JsonBinary::write<u8>(writer, Single);
+					JsonBinary::write<u32>(writer, std::bit_cast<u32>(float(floating)));
+
+				} else {
+
+					JsonBinary::write<u8>(writer, Double);
+					JsonBinary::write<u64>(writer, std::bit_cast<u64>(floating));
+
+				}
+
+			}
+
+			break;
+
+		case Json::Type::Object:
+			encode(value.toObject(), writer);
+			break;
+
+		case Json::Type::Array:
+			encode(value.toArray(), writer);
+			break;
+
+		case Json::Type::Boolean:
+			JsonBinary::write<u8>(writer, value.toBoolean() ? True : False);
+			break;
+
+		case Json::Type::Null:
+		case Json::Type::None:
+			JsonBinary::write<u8>(writer, Null);
+			break;
+
+	}
+
+}
+
+void CborCodec::encode(const JsonObject& object, BinaryWriter& writer) {
+
+	using Member = std::pair<const Json::StringType, JsonValue>;
+
+	writeHeader(writer, Map, object.size());
+
+	auto write = [&writer](const Member& member) {
+
+		writeHeader(writer, Text, member.first.size());
+		JsonBinary::writeBytes(writer, member.first.data(), member.first.size());
+
+		encode(member.second, writer);
+
+	};
+
+	//Objects iterate bytewise, which already is the deterministic order if no shorter key follows a longer one
+	bool ordered = std::is_sorted(object.begin(), object.end(), [](const Member& a, const Member& b) {
+		return a.first.size() < b.first.size();
+	});
+
+	if (ordered) {
+
+		for (const Member& member : object) {
+			write(member);
+		}
+
+		return;
+
+	}
+
+	std::vector<const Member*> members;
+	members.reserve(object.size());
+
+	for (const Member& member : object) {
+		members.push_back(&member);
+	}
+
+	std::sort(members.begin(), members.end(), [](const Member* a, const Member* b) {
+		return keyLess(a->first, b->first);
+	});
+
+	for (const Member* member : members) {
+		write(*member);
+	}
+
+}
+
+void CborCodec::encode(const JsonArray& array, BinaryWriter& writer) {
+
+	writeHeader(writer, Array, array.size());
+
+	for (const JsonValue& value : array) {
+		encode(value, writer);
+	}
+
+}
+
+
+
+void CborCodec::decode(BinaryReader& reader, JsonHandler& handler) {
+
+	Json::StringType scratch;
+
+	decodeItem(reader, handler, 0, scratch);
+	handler.endRecord();
+
+}
+
+JsonValue CborCodec::decode(BinaryReader& reader) {
+
+	JsonValueBuilder builder;
+	decode(reader, builder);
+
+	return std::move(builder.getValue());
+
+}
+
+JsonValue CborCodec::decode(std::span<const u8> data) {
+
+	BinaryReader reader(data);
+	JsonValue value = decode(reader);
+
+	if (reader.remainingSize()) {
+		throw JsonSyntaxError("Unexpected data after CBOR item");
+	}
+
+	return value;
+
+}
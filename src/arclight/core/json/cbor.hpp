@@ -0,0 +1,66 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 cbor.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "reader.hpp"
+#include "stream/binaryreader.hpp"
+#include "stream/binarywriter.hpp"
+
+#include <span>
+#include <vector>
+
+
+
+class JsonObject;
+class JsonArray;
+
+
+
+/*
+ *  CBOR (RFC 8949) encoding of the JSON value model
+ *  Encoding is deterministic as defined in RFC 8949 4.2.1: integers and lengths take the shortest form, floats the narrowest
+ *  width that holds their value exactly and map keys are ordered by their encoded bytes, so equal values produce equal output.
+ *  getEncodedSize() returns the exact size ahead of encoding, the BinaryWriter passed to encode() needs that much space left.
+ *  Decoding accepts indefinite lengths and skips tags. Byte strings are reported through JsonHandler::binary and decoded strings
+ *  are views into the input. Map keys must be text strings.
+ *  Multi-byte fields are big endian regardless of the stream's byte order.
+ */
+class CborCodec {
+
+public:
+
+	static SizeT getEncodedSize(const JsonValue& value);
+	static SizeT getEncodedSize(const JsonObject& object);
+	static SizeT getEncodedSize(const JsonArray& array);
+
+	static void encode(const JsonValue& value, BinaryWriter& writer);
+	static void encode(const JsonObject& object, BinaryWriter& writer);
+	static void encode(const JsonArray& array, BinaryWriter& writer);
+
+	template<class T>
+	static std::vector<u8> encode(const T& value) {
+
+		std::vector<u8> data(getEncodedSize(value));
+		BinaryWriter writer(data);
+
+		encode(value, writer);
+
+		return data;
+
+	}
+
+	//Decodes one item and advances the reader past it
+	static void decode(BinaryReader& reader, JsonHandler& handler);
+	static JsonValue decode(BinaryReader& reader);
+
+	//Decodes data, which must contain exactly one item
+	static JsonValue decode(std::span<const u8> data);
+
+};
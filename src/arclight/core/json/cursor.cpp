@@ -0,0 +1,586 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 cursor.cpp
+ */
+
+#include "cursor.hpp"
+#include "document.hpp"
+#include "scanner.hpp"
+#include "filesystem/path.hpp"
+#include "math/math.hpp"
+#include "util/bits.hpp"
+
+#include <charconv>
+
+
+
+static bool isWhitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool matchesLiteral(const char* p, const char* end, const Json::StringView& word) {
+	return SizeT(end - p) >= word.size() && Json::StringView(p, word.size()) == word && JsonScanner::isDelimiter(p + word.size(), end);
+}
+
+//Compares a raw member name against a decoded one, decoding only if the raw name contains escape sequences
+static bool nameEquals(const Json::StringView& rawName, const Json::StringView& name) {
+
+	if (rawName.find('\\') == Json::StringView::npos) {
+		return rawName == name;
+	}
+
+	Json::StringType decoded;
+	JsonScanner::readString(rawName.data() - 1, rawName.data() + rawName.size() + 1, decoded, true);
+
+	return decoded == name;
+
+}
+
+
+
+JsonCursor::JsonCursor(const StringView& json) : end(json.data() + json.size()) {
+
+	cur = skipWhitespace(json.data(), end);
+
+	if (cur == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading value");
+	}
+
+}
+
+
+
+auto JsonCursor::getType() const -> Type {
+
+	switch (*cur) {
+
+		case '{':
+			return Type::Object;
+
+		case '[':
+			return Type::Array;
+
+		case '"':
+			return Type::String;
+
+		case 't':
+		case 'f':
+			return Type::Boolean;
+
+		case 'n':
+			return Type::Null;
+
+		case '-':
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+			return Type::Number;
+
+		default:
+			throw JsonSyntaxError(String::format("Unexpected symbol '%c' at start of value", *cur));
+
+	}
+
+}
+
+
+
+std::optional<JsonCursor> JsonCursor::find(const StringView& name) const {
+
+	checkType(Type::Object);
+
+	for (const Member& member : getMembers()) {
+
+		if (nameEquals(member.rawName, name)) {
+			return member.value;
+		}
+
+	}
+
+	return std::nullopt;
+
+}
+
+std::optional<JsonCursor> JsonCursor::find(SizeT index) const {
+
+	checkType(Type::Array);
+
+	for (JsonCursor element : getElements()) {
+
+		if (index-- == 0) {
+			return element;
+		}
+
+	}
+
+	return std::nullopt;
+
+}
+
+/*
+ *  Resolves a JSON pointer relative to this value
+ *  Reference tokens are unescaped (~1 to '/', ~0 to '~') and index arrays if the value is one.
+ */
+std::optional<JsonCursor> JsonCursor::findPath(const StringView& pointer) const {
+
+	if (!pointer.empty() && pointer[0] != '/') {
+		throw JsonException("JSON pointer must be empty or start with '/'");
+	}
+
+	JsonCursor cursor = *this;
+	StringType unescaped;
+
+	for (SizeT start = 1; start <= pointer.size(); ) {
+
+		SizeT next = Math::min(pointer.find('/', start), pointer.size());
+		StringView token = pointer.substr(start, next - start);
+		start = next + 1;
+
+		if (token.find('~') != StringView::npos) {
+
+			unescaped.clear();
+
+			for (SizeT i = 0; i < token.size(); i++) {
+
+				if (token[i] == '~' && i + 1 < token.size() && (token[i + 1] == '0' || token[i + 1] == '1')) {
+					unescaped += token[++i] == '0' ? '~' : '/';
+				} else {
+					unescaped += token[i];
+				}
+
+			}
+
+			token = unescaped;
+
+		}
+
+		std::optional<JsonCursor> child;
+
+		switch (cursor.getType()) {
+
+			case Type::Object:
+				child = cursor.find(token);
+				break;
+
+			case Type::Array:
+			{
+				SizeT index;
+				auto result = std::from_chars(token.data(), token.data() + token.size(), index);
+
+				if (result.ec != std::errc() || result.ptr != token.data() + token.size() || (token.size() > 1 && token[0] == '0')) {
+					return std::nullopt;
+				}
+
+				child = cursor.find(index);
+				break;
+			}
+
+			default:
+				return std::nullopt;
+
+		}
+
+		if (!child) {
+			return std::nullopt;
+		}
+
+		cursor = *child;
+
+	}
+
+	return cursor;
+
+}
+
+
+
+JsonCursor JsonCursor::operator[](const StringView& name) const {
+
+	std::optional<JsonCursor> cursor = find(name);
+
+	if (!cursor) {
+		throw JsonValueNotFoundException(StringType(name));
+	}
+
+	return *cursor;
+
+}
+
+JsonCursor JsonCursor::operator[](SizeT index) const {
+
+	std::optional<JsonCursor> cursor = find(index);
+
+	if (!cursor) {
+		throw JsonValueNotFoundException(String::format("[%zu]", index));
+	}
+
+	return *cursor;
+
+}
+
+JsonCursor JsonCursor::at(const StringView& pointer) const {
+
+	std::optional<JsonCursor> cursor = findPath(pointer);
+
+	if (!cursor) {
+		throw JsonValueNotFoundException(StringType(pointer));
+	}
+
+	return *cursor;
+
+}
+
+
+
+auto JsonCursor::getRaw() const -> StringView {
+	return StringView(cur, skipValue(cur, end) - cur);
+}
+
+auto JsonCursor::getElements() const -> Range<ElementIterator> {
+
+	checkType(Type::Array);
+
+	const char* p = skipWhitespace(cur + 1, end);
+
+	if (p == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading array");
+	}
+
+	if (*p == ']') {
+		return {};
+	}
+
+	return { ElementIterator(p, end), ElementIterator() };
+
+}
+
+auto JsonCursor::getMembers() const -> Range<MemberIterator> {
+
+	checkType(Type::Object);
+
+	const char* p = skipWhitespace(cur + 1, end);
+
+	if (p == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading object");
+	}
+
+	if (*p == '}') {
+		return {};
+	}
+
+	return { MemberIterator(p, end), MemberIterator() };
+
+}
+
+
+
+bool JsonCursor::readBoolean() const {
+
+	checkType(Type::Boolean);
+
+	if (!matchesLiteral(cur, end, *cur == 't' ? "true" : "false")) {
+		throw JsonSyntaxError("Invalid boolean literal");
+	}
+
+	return *cur == 't';
+
+}
+
+bool JsonCursor::readNumber(Json::IntegerType& i, Json::FloatType& f) const {
+
+	checkType(Type::Number);
+
+	JsonScanner::Number number;
+	const char* next = JsonScanner::readNumber(cur, end, number);
+
+	if (!next || !JsonScanner::isDelimiter(next, end)) {
+		throw JsonSyntaxError("Invalid number");
+	}
+
+	if (number.integer) {
+		i = number.i;
+	} else {
+		f = number.f;
+	}
+
+	return number.integer;
+
+}
+
+auto JsonCursor::readString() const -> StringType {
+
+	checkType(Type::String);
+
+	StringType string;
+	JsonScanner::readString(cur, end, string, false);
+
+	return string;
+
+}
+
+JsonValue JsonCursor::readValue() const {
+
+	JsonDocument document(getRaw());
+	return std::move(document.getRoot());
+
+}
+
+void JsonCursor::checkType(Type target) const {
+
+	Type type = getType();
+
+	if (type != target) {
+		throw JsonTypeCastException(type, target);
+	}
+
+}
+
+
+
+const char* JsonCursor::skipWhitespace(const char* p, const char* end) {
+
+	while (p != end && isWhitespace(*p)) {
+		p++;
+	}
+
+	return p;
+
+}
+
+//Returns the first character after the value at p
+const char* JsonCursor::skipValue(const char* p, const char* end) {
+
+	switch (*p) {
+
+		case '{':
+		case '[':
+			return skipContainer(p, end);
+
+		case '"':
+			return skipString(p, end) + 1;
+
+		default:
+
+			while (p != end && !JsonScanner::isDelimiter(p, end)) {
+				p++;
+			}
+
+			return p;
+
+	}
+
+}
+
+//Returns the closing quote of the string at p
+const char* JsonCursor::skipString(const char* p, const char* end) {
+
+	p++;
+
+	while (true) {
+
+		p = JsonScanner::findStringSpecial(p, end);
+
+		if (p == end) {
+			throw JsonSyntaxError("Unexpected EOF while reading string");
+		}
+
+		switch (*p) {
+
+			case '"':
+				return p;
+
+			case '\\':
+
+				if (end - p < 2) {
+					throw JsonSyntaxError("Unexpected EOF while reading string");
+				}
+
+				p += 2;
+				break;
+
+			default:
+				p++;
+				break;
+
+		}
+
+	}
+
+}
+
+/*
+ *  Skips the container opening at p by bracket matching 64 bytes at a time
+ *  Strings are masked out the same way the structural index does it. Since depth can only reach zero in a block
+ *  that closes at least as many containers as are open at its start, all other blocks are settled by two popcounts.
+ */
+const char* JsonCursor::skipContainer(const char* p, const char* end) {
+
+	u64 escapeCarry = 0;
+	u64 stringCarry = 0;
+	SizeT depth = 0;
+
+	for (const char* block = p; block < end; block += JsonScanner::BlockSize) {
+
+		JsonScanner::BlockMasks masks = JsonScanner::classifyBlock(block, end);
+
+		u64 escaped = JsonScanner::findEscaped(masks.backslash, escapeCarry);
+		u64 string = JsonScanner::prefixXor(masks.quote & ~escaped) ^ stringCarry;
+		stringCarry = u64(i64(string) >> 63);
+
+		u64 open = masks.open & ~string;
+		u64 close = masks.close & ~string;
+		SizeT closes = Bits::popcount(close);
+
+		if (depth > closes) {
+
+			depth += Bits::popcount(open);
+			depth -= closes;
+			continue;
+
+		}
+
+		for (u64 brackets = open | close; brackets; brackets &= brackets - 1) {
+
+			u64 bit = brackets & -brackets;
+
+			if (open & bit) {
+
+				depth++;
+
+			} else if (--depth == 0) {
+
+				return block + Bits::ctz(brackets) + 1;
+
+			}
+
+		}
+
+	}
+
+	throw JsonSyntaxError("Unexpected EOF while reading container");
+
+}
+
+
+
+JsonCursor::ElementIterator& JsonCursor::ElementIterator::operator++() {
+
+	const char* p = skipWhitespace(skipValue(cur, end), end);
+
+	if (p == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading array");
+	}
+
+	switch (*p) {
+
+		case ',':
+
+			cur = skipWhitespace(p + 1, end);
+
+			if (cur == end) {
+				throw JsonSyntaxError("Unexpected EOF while reading array");
+			}
+
+			break;
+
+		case ']':
+			cur = nullptr;
+			end = nullptr;
+			break;
+
+		default:
+			throw JsonSyntaxError(String::format("Unexpected symbol '%c' in array", *p));
+
+	}
+
+	return *this;
+
+}
+
+
+
+JsonCursor::MemberIterator::MemberIterator(const char* name, const char* end) : end(end) {
+	readMember(name);
+}
+
+JsonCursor::MemberIterator& JsonCursor::MemberIterator::operator++() {
+
+	const char* p = skipWhitespace(skipValue(member.value.cur, end), end);
+
+	if (p == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading object");
+	}
+
+	switch (*p) {
+
+		case ',':
+			readMember(skipWhitespace(p + 1, end));
+			break;
+
+		case '}':
+			member = {};
+			end = nullptr;
+			break;
+
+		default:
+			throw JsonSyntaxError(String::format("Unexpected symbol '%c' in object", *p));
+
+	}
+
+	return *this;
+
+}
+
+void JsonCursor::MemberIterator::readMember(const char* name) {
+
+	if (name == end || *name != '"') {
+		throw JsonSyntaxError("Missing member name");
+	}
+
+	const char* closing = skipString(name, end);
+	const char* p = skipWhitespace(closing + 1, end);
+
+	if (p == end || *p != ':') {
+		throw JsonSyntaxError("Missing ':' after member name");
+	}
+
+	p = skipWhitespace(p + 1, end);
+
+	if (p == end) {
+		throw JsonSyntaxError("Unexpected EOF while reading object");
+	}
+
+	member.rawName = StringView(name + 1, closing - name - 1);
+	member.value = JsonCursor(p, end);
+
+}
+
+
+
+auto JsonCursor::Member::getName() const -> StringType {
+
+	StringType name;
+	JsonScanner::readString(rawName.data() - 1, rawName.data() + rawName.size() + 1, name, true);
+
+	return name;
+
+}
+
+
+
+JsonOnDemand JsonOnDemand::fromFile(const Path& path) {
+
+	JsonOnDemand document;
+
+	if (!document.file.open(path)) {
+		throw JsonException("Failed to open file " + path.toString());
+	}
+
+	std::span<const u8> bytes = document.file.data();
+	document.json = StringView(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+	return document;
+
+}
@@ -0,0 +1,301 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 cursor.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "value.hpp"
+#include "filesystem/mappedfile.hpp"
+
+#include <optional>
+
+
+
+class Path;
+
+
+
+/*
+ *  On-demand view of a JSON value inside a buffer
+ *  Nothing is parsed up front: lookups walk the members or elements of a container and skip every value they pass
+ *  by bracket matching 64 bytes at a time, and scalars are only converted when requested through get<T>().
+ *  Skipped content is not validated and never allocates. A cursor is two pointers and the buffer must outlive it.
+ *  Paths are JSON pointers (RFC 6901), e.g. "/servers/0/port". Comments are not supported.
+ */
+class JsonCursor {
+
+public:
+
+	using StringType = Json::StringType;
+	using StringView = Json::StringView;
+	using Type = Json::Type;
+
+	struct Member;
+	class ElementIterator;
+	class MemberIterator;
+
+	template<class Iterator>
+	struct Range {
+
+		Iterator first;
+		Iterator last;
+
+		Iterator begin() const { return first; }
+		Iterator end() const { return last; }
+
+	};
+
+
+	constexpr JsonCursor() noexcept : cur(nullptr), end(nullptr) {}
+
+	//Positions the cursor on the first value in json, throws JsonSyntaxError if there is none
+	explicit JsonCursor(const StringView& json);
+
+
+	Type getType() const;
+
+	bool isString() const		{ return getType() == Type::String; }
+	bool isNumber() const		{ return getType() == Type::Number; }
+	bool isObject() const		{ return getType() == Type::Object; }
+	bool isArray() const		{ return getType() == Type::Array; }
+	bool isBoolean() const		{ return getType() == Type::Boolean; }
+	bool isNull() const			{ return getType() == Type::Null; }
+
+	constexpr bool isValid() const noexcept {
+		return cur;
+	}
+
+
+	//Returns the member with the given name
+	std::optional<JsonCursor> find(const StringView& name) const;
+
+	//Returns the element at index
+	std::optional<JsonCursor> find(SizeT index) const;
+
+	//Returns the value the JSON pointer refers to
+	std::optional<JsonCursor> findPath(const StringView& pointer) const;
+
+	//Same as the find functions but throw JsonValueNotFoundException
+	JsonCursor operator[](const StringView& name) const;
+	JsonCursor operator[](SizeT index) const;
+	JsonCursor at(const StringView& pointer) const;
+
+
+	/*
+	 *  Converts the value to T, which is either bool, a number type, Json::StringType or JsonValue
+	 *  Throws JsonTypeCastException if the value has a different type.
+	 */
+	template<class T>
+	T get() const {
+
+		if constexpr (CC::JsonBoolean<T>) {
+			return readBoolean();
+		} else if constexpr (CC::JsonNumber<T>) {
+
+			Json::IntegerType i;
+			Json::FloatType f;
+
+			return readNumber(i, f) ? static_cast<T>(i) : static_cast<T>(f);
+
+		} else if constexpr (CC::Equal<T, StringType>) {
+			return readString();
+		} else if constexpr (CC::Equal<T, JsonValue>) {
+			return readValue();
+		} else {
+			static_assert(CC::Equal<T, JsonValue>, "Unsupported cursor conversion");
+		}
+
+	}
+
+	template<class T>
+	T get(const StringView& pointer) const {
+		return at(pointer).get<T>();
+	}
+
+	//Returns defaultValue if the pointer does not resolve or the value has a different type
+	template<class T>
+	T get(const StringView& pointer, const T& defaultValue) const {
+
+		std::optional<JsonCursor> cursor = findPath(pointer);
+
+		if (!cursor) {
+			return defaultValue;
+		}
+
+		if constexpr (!CC::Equal<T, JsonValue>) {
+
+			if (cursor->getType() != Json::typeOf<T>()) {
+				return defaultValue;
+			}
+
+		}
+
+		return cursor->get<T>();
+
+	}
+
+
+	//Returns the unparsed text of the value
+	StringView getRaw() const;
+
+	//Iterates over the elements of an array or the members of an object in order
+	Range<ElementIterator> getElements() const;
+	Range<MemberIterator> getMembers() const;
+
+private:
+
+	constexpr JsonCursor(const char* cur, const char* end) noexcept : cur(cur), end(end) {}
+
+	bool readBoolean() const;
+	bool readNumber(Json::IntegerType& i, Json::FloatType& f) const;
+	StringType readString() const;
+	JsonValue readValue() const;
+
+	void checkType(Type target) const;
+
+	static const char* skipWhitespace(const char* p, const char* end);
+	static const char* skipValue(const char* p, const char* end);
+	static const char* skipString(const char* p, const char* end);
+	static const char* skipContainer(const char* p, const char* end);
+
+	const char* cur;
+	const char* end;
+
+};
+
+
+
+struct JsonCursor::Member {
+
+	//Name as it appears in the source, escape sequences included
+	StringView rawName;
+	JsonCursor value;
+
+	StringType getName() const;
+
+};
+
+
+class JsonCursor::ElementIterator {
+
+public:
+
+	using value_type = JsonCursor;
+	using difference_type = std::ptrdiff_t;
+
+	constexpr ElementIterator() noexcept : cur(nullptr), end(nullptr) {}
+	constexpr ElementIterator(const char* cur, const char* end) noexcept : cur(cur), end(end) {}
+
+	JsonCursor operator*() const {
+		return { cur, end };
+	}
+
+	ElementIterator& operator++();
+
+	ElementIterator operator++(int) {
+
+		ElementIterator it = *this;
+		++*this;
+
+		return it;
+
+	}
+
+	constexpr bool operator==(const ElementIterator& other) const noexcept = default;
+
+private:
+
+	const char* cur;
+	const char* end;
+
+};
+
+
+class JsonCursor::MemberIterator {
+
+public:
+
+	using value_type = Member;
+	using difference_type = std::ptrdiff_t;
+
+	constexpr MemberIterator() noexcept : member{}, end(nullptr) {}
+	MemberIterator(const char* name, const char* end);
+
+	const Member& operator*() const {
+		return member;
+	}
+
+	const Member* operator->() const {
+		return &member;
+	}
+
+	MemberIterator& operator++();
+
+	MemberIterator operator++(int) {
+
+		MemberIterator it = *this;
+		++*this;
+
+		return it;
+
+	}
+
+	bool operator==(const MemberIterator& other) const noexcept {
+		return member.value.cur == other.member.value.cur;
+	}
+
+private:
+
+	void readMember(const char* name);
+
+	Member member;
+	const char* end;
+
+};
+
+
+
+/*
+ *  Root of an on-demand document
+ *  Either refers to a caller-owned buffer or keeps a mapped file open for the cursors taken from it.
+ */
+class JsonOnDemand {
+
+public:
+
+	using StringView = Json::StringView;
+
+	JsonOnDemand() = default;
+	explicit JsonOnDemand(const StringView& json) : json(json) {}
+
+	JsonCursor getRoot() const {
+		return JsonCursor(json);
+	}
+
+	std::optional<JsonCursor> findPath(const StringView& pointer) const {
+		return getRoot().findPath(pointer);
+	}
+
+	template<class T>
+	T get(const StringView& pointer) const {
+		return getRoot().get<T>(pointer);
+	}
+
+	template<class T>
+	T get(const StringView& pointer, const T& defaultValue) const {
+		return getRoot().get<T>(pointer, defaultValue);
+	}
+
+	static JsonOnDemand fromFile(const Path& path);
+
+private:
+
+	MappedFile file;
+	StringView json;
+
+};
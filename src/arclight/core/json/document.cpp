@@ -7,8 +7,10 @@
  */
 
 #include "document.hpp"
+#include "scanner.hpp"
+#include "structuralindex.hpp"
 #include "filesystem/path.hpp"
-#include "filesystem/file.hpp"
+#include "filesystem/mappedfile.hpp"
 #include "util/log.hpp"
 
 
@@ -27,6 +29,15 @@ void JsonDocument::read(const StringView& json) {
 
 	clear();
 
+	JsonStructuralIndex index;
+
+	if (index.build(json) && readIndexed(json, index)) {
+		return;
+	}
+
+	// Comments and malformed input take the character based path, which reports the exact error
+	clear();
+
 	Iterator it = { json.cbegin(), json.cend() };
 
 	readValue(it, root, false);
@@ -35,11 +46,17 @@ void JsonDocument::read(const StringView& json) {
 
 auto JsonDocument::write(bool compact) const -> StringType {
 
-	StringType string;
+	JsonWriter writer(compact);
+	writer.write(root);
+
+	return writer.release();
+
+}
 
-	writeValue(string, root, compact, 0);
+void JsonDocument::write(JsonOutputSink& sink, bool compact) const {
 
-	return string;
+	JsonWriter writer(sink, compact);
+	writer.write(root);
 
 }
 
@@ -71,194 +88,323 @@ const JsonValue& JsonDocument::getRoot() const {
 
 JsonDocument JsonDocument::fromFile(const Path& path) {
 
-	File file;
+	MappedFile file(path);
 
-	file.open(path, File::Text | File::In);
+	std::span<const u8> bytes = file.data();
 
-	return JsonDocument(file.readAllText());
+	return JsonDocument(StringView(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
 
 }
 
+void JsonDocument::toFile(const Path& path, bool compact) const {
 
+	JsonFileSink sink(path);
+	write(sink, compact);
 
-bool JsonDocument::readComment(Iterator& it) {
+}
 
-	if (it.cur[0] != '/' || it.rem() < 2)
-		return false;
-		
-	if (it.cur[1] != '/' && it.cur[1] != '*')
-		return false;
 
-	bool singleLine = it.cur[1] == '/';
 
-	for (it.cur += 2; it.cur < it.end; it.cur++) {
+/*
+ *  Stage two of the indexed reader
+ *  Walks the structural index and constructs every value in place, keeping the open containers on an explicit stack.
+ *  Returns false as soon as the input deviates from strict JSON so that the caller can fall back to the regular reader.
+ */
+bool JsonDocument::readIndexed(const StringView& json, const JsonStructuralIndex& index) {
 
-		if (singleLine) {
-			
-			if (it.matchAny("\r\n")) {
-				it.cur += (it.cur[0] == '\r') ? 2 : 1;
-				return true;
-			}
-			
-		} else {
+	enum class Step {
+		Value,
+		Member,
+		Next
+	};
 
-			if (it.matchSequence("*/")) {
-				it.cur += 2;
-				return true;
-			}
+	const char* data = json.data();
+	const char* end = data + json.size();
 
-		}
+	SizeT count = index.size();
+	SizeT i = 0;
 
-	}
+	auto literal = [end](const char* p, const StringView& word) {
+		return SizeT(end - p) >= word.size() && StringView(p, word.size()) == word && JsonScanner::isDelimiter(p + word.size(), end);
+	};
 
-	// Single-line comments can be interrupted by an EOF
-	if (singleLine)
-		return true;
-	
-	// Multi-line comments require a closing sequence
-	throw JsonSyntaxError("Unteriminated multi-line comment found");
+	std::vector<JsonValue*> stack;
+	JsonValue* target = &root;
+	Step step = Step::Value;
 
-}
+	while (true) {
 
-void JsonDocument::readString(Iterator& it, StringType& string, bool name) {
+		switch (step) {
 
-	if (it.cur[0] != '"')
-		throw JsonSyntaxError("Missing string opener");
+			case Step::Value:
+			{
+				if (i == count) {
+					return false;
+				}
 
-	bool stop = false;
-	bool escape = false;
-	bool terminated = false;
+				const char* p = data + index[i++];
 
-	for (it.cur++; it.cur < it.end; it.cur++) {
+				switch (*p) {
 
-		auto ch = it.cur[0];
+					case '{':
 
-		if (escape) {
+						*target = JsonObject();
 
-			switch (ch) {
+						if (i < count && data[index[i]] == '}') {
 
-			case '\"':
-			case '\\':
-			case '/':
-			case 'b':
-			case 'f':
-			case 'n':
-			case 'r':
-			case 't':
-				escape = false;
-				break;
+							i++;
+							step = Step::Next;
 
-				// Invalid escape sequence
-			default:
-				throw JsonSyntaxError("Invalid escape sequence found");
-				return;
+						} else {
 
-			}
+							stack.push_back(target);
+							step = Step::Member;
 
-		} else {
+						}
 
-			switch (ch) {
+						break;
 
-				// Names cannot contain tabs
-			case '\t':
-				if (!name)
-					break;
-				
-				throw JsonSyntaxError("Tab found inside name");
+					case '[':
 
-				// String terminator
-			case '\"':
-				terminated = true;
-				[[fallthrough]];
+						*target = JsonArray();
 
-				// Strings cannot contain newlines
-			case '\n':
-			case '\r':
-				stop = true;
-				break;
+						if (i < count && data[index[i]] == ']') {
 
-				// Escape sequence start
-			case '\\':
-				escape = true;
-				break;
+							i++;
+							step = Step::Next;
+
+						} else {
+
+							stack.push_back(target);
+							target = &target->toArray().emplace();
+
+						}
+
+						break;
+
+					case '"':
+					{
+						StringType string;
+						JsonScanner::readString(p, end, string, false);
+
+						*target = std::move(string);
+						step = Step::Next;
+
+						break;
+					}
+
+					case 't':
+
+						if (!literal(p, "true")) {
+							return false;
+						}
 
+						*target = true;
+						step = Step::Next;
+
+						break;
+
+					case 'f':
+
+						if (!literal(p, "false")) {
+							return false;
+						}
+
+						*target = false;
+						step = Step::Next;
+
+						break;
+
+					case 'n':
+
+						if (!literal(p, "null")) {
+							return false;
+						}
+
+						*target = nullptr;
+						step = Step::Next;
+
+						break;
+
+					default:
+					{
+						JsonScanner::Number number;
+						const char* next = JsonScanner::readNumber(p, end, number);
+
+						if (!next || !JsonScanner::isDelimiter(next, end)) {
+							return false;
+						}
+
+						if (number.integer) {
+							*target = number.i;
+						} else {
+							*target = number.f;
+						}
+
+						step = Step::Next;
+
+						break;
+					}
+
+				}
+
+				break;
 			}
 
-		}
+			case Step::Member:
+			{
+				if (count - i < 2 || data[index[i]] != '"') {
+					return false;
+				}
 
-		if (stop) {
+				StringType name;
+				JsonScanner::readString(data + index[i], end, name, true);
 
-			// Unterminated string
-			if (!terminated) {
-				throw JsonSyntaxError("Unterminated string sequence found");
+				if (data[index[i + 1]] != ':') {
+					return false;
+				}
+
+				i += 2;
+
+				auto item = stack.back()->toObject().items.try_emplace(std::move(name));
+
+				if (!item.second) {
+					return false;
+				}
+
+				target = &item.first->second;
+				step = Step::Value;
+
+				break;
 			}
 
-			return;
-		}
+			case Step::Next:
+			{
+				if (stack.empty()) {
+					return true;
+				}
 
-		string += it.cur[0];
+				if (i == count) {
+					return false;
+				}
 
-	}
+				char c = data[index[i++]];
+				JsonValue* container = stack.back();
 
-	throw JsonSyntaxError("Unexpected EOF while reading string");
+				if (container->isObject()) {
 
-}
+					if (c == ',') {
 
-bool JsonDocument::readNumber(Iterator& it, JsonValue& value) {
+						step = Step::Member;
 
-	Iterator tmp = it;
+					} else if (c == '}') {
 
-	if (tmp.cur[0] == '-')
-		tmp.cur++;
+						stack.pop_back();
 
-	bool integer = true;
+					} else {
 
-	// Select the numeric type
-	for (; tmp.cur < tmp.end; tmp.cur++) {
+						return false;
 
-		if (!Character::isDigit(tmp.cur[0])) {
+					}
 
-			// Digit sequence interrupted
+				} else {
 
-			switch (tmp.cur[0]) {
+					if (c == ',') {
 
-			case '.': // Decimal point, use Json::FloatType
-				integer = false;
-				break;
+						target = &container->toArray().emplace();
+						step = Step::Value;
+
+					} else if (c == ']') {
+
+						stack.pop_back();
+
+					} else {
+
+						return false;
+
+					}
+
+				}
 
-			case 'e': // Scientific notation, use Json::FloatType
-				integer = false;
 				break;
+			}
+
+		}
+
+	}
+
+}
+
+bool JsonDocument::readComment(Iterator& it) {
 
+	if (it.cur[0] != '/' || it.rem() < 2)
+		return false;
+		
+	if (it.cur[1] != '/' && it.cur[1] != '*')
+		return false;
+
+	bool singleLine = it.cur[1] == '/';
+
+	for (it.cur += 2; it.cur < it.end; it.cur++) {
+
+		if (singleLine) {
+			
+			if (it.matchAny("\r\n")) {
+				it.cur += (it.cur[0] == '\r') ? 2 : 1;
+				return true;
 			}
+			
+		} else {
 
-			break;
+			if (it.matchSequence("*/")) {
+				it.cur += 2;
+				return true;
+			}
 
 		}
 
 	}
 
-	std::istringstream is(StringType(it.cur, it.end));
+	// Single-line comments can be interrupted by an EOF
+	if (singleLine)
+		return true;
+	
+	// Multi-line comments require a closing sequence
+	throw JsonSyntaxError("Unteriminated multi-line comment found");
 
-	if (integer) {
+}
 
-		Json::IntegerType n;
-		is >> n;
-		value = n;
+void JsonDocument::readString(Iterator& it, StringType& string, bool name) {
 
-	}
-	else {
+	const char* start = std::to_address(it.cur);
+	const char* quote = JsonScanner::readString(start, std::to_address(it.end), string, name);
 
-		Json::FloatType f;
-		is >> f;
-		value = f;
+	it.cur += quote - start;
 
+}
+
+bool JsonDocument::readNumber(Iterator& it, JsonValue& value) {
+
+	const char* start = std::to_address(it.cur);
+	JsonScanner::Number number;
+
+	const char* end = std::to_address(it.end);
+	const char* next = JsonScanner::readNumber(start, end, number);
+
+	if (!next || !JsonScanner::isDelimiter(next, end)) {
+		return false;
 	}
 
-	it.cur += is.tellg();
-	it.cur -= 1;
+	if (number.integer) {
+		value = number.i;
+	} else {
+		value = number.f;
+	}
 
-	return !is.fail();
+	// Leave the iterator on the last character of the number
+	it.cur += next - start - 1;
+
+	return true;
 
 }
 
@@ -293,7 +439,7 @@ bool JsonDocument::readValue(Iterator& it, JsonValue& value, bool array) {
 
 			readString(it, string, false);
 		
-			value = string;
+			value = std::move(string);
 			return false;
 		}
 
@@ -610,160 +756,6 @@ void JsonDocument::readObject(Iterator& it, JsonObject& object) {
 
 
 
-void JsonDocument::writeString(StringType& string, const StringType& value) const {
-
-	string += '"';
-
-	for (auto ch : value) {
-
-		switch (ch) {
-
-		case '\"': string += "\\\""; break;
-		case '\\': string += "\\\\"; break;
-		case '\b': string += "\b"; break;
-		case '\f': string += "\f"; break;
-		case '\n': string += "\n"; break;
-		case '\r': string += "\r"; break;
-		case '\t': string += "\t"; break;
-
-		default:
-			string += ch;
-			break;
-
-		}
-
-	}
-
-	string += '"';
-
-}
-
-void JsonDocument::writeValue(StringType& string, const JsonValue& value, bool compact, u32 level) const {
-
-	switch (value.getType()) {
-
-		case Json::Type::String:
-			writeString(string, value.toString());
-			break;
-
-		case Json::Type::Number:
-
-			if (value.isInteger()) {
-
-				auto n = value.toNumber<Json::IntegerType>();
-				string += std::to_string(n);
-
-			} else {
-
-				auto f = value.toNumber<Json::FloatType>();
-				string += std::to_string(f);
-
-			}
-
-			break;
-
-		case Json::Type::Object:
-			writeObject(string, value.toObject(), compact, level + 1);
-			break;
-
-		case Json::Type::Array:
-			writeArray(string, value.toArray(), compact, level + 1);
-			break;
-
-		case Json::Type::Boolean:
-			string += value.toBoolean() ? "true" : "false";
-			break;
-
-		case Json::Type::Null:
-		case Json::Type::None:
-			string += "null";
-			break;
-
-	}
-
-}
-
-void JsonDocument::writeArray(StringType& string, const JsonArray& array, bool compact, u32 level) const {
-
-	StringType lineTab(level * IndentationLevel, IndentationChar);
-	StringType lastTab = "";
-
-	if (!compact && !array.empty())
-		lastTab = StringType((level - 1) * IndentationLevel, IndentationChar);
-
-	string += "[";
-
-	bool first = true;
-
-	for (const auto& value : array) {
-
-		if (first) {
-			first = false;
-		} else {
-			string += ",";
-		}
-
-		if (!compact)
-			string += '\n' + lineTab;
-
-		writeValue(string, value, compact, level);
-
-	}
-	
-	if (!compact) {
-		string += '\n';
-		string += lastTab;
-	}
-
-	string += ']';
-
-}
-
-void JsonDocument::writeObject(StringType& string, const JsonObject& object, bool compact, u32 level) const {
-
-	StringType lineTab(level * IndentationLevel, ' ');
-	StringType lastTab = "";
-
-	if (!compact && !object.empty())
-		lastTab = StringType((level - 1) * IndentationLevel, IndentationChar);
-
-	string += "{";
-
-	bool first = true;
-
-	for (const auto& [name, value] : object) {
-
-		if (first) {
-			first = false;
-		} else {
-			string += ",";
-		}
-
-		if (!compact)
-			string += '\n' + lineTab;
-
-		writeString(string, name);
-
-		string += ':';
-
-		if (!compact)
-			string += ' ';
-
-		writeValue(string, value, compact, level);
-
-	}
-
-	if (!compact) {
-		string += '\n';
-		string += lastTab;
-	}
-
-	string += '}';
-
-}
-
-
-
 RawLog& operator<<(RawLog& log, const JsonDocument& document) {
 
 	log << document.write();
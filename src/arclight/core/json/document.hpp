@@ -11,8 +11,12 @@
 #include "common.hpp"
 #include "object.hpp"
 #include "array.hpp"
+#include "writer.hpp"
 #include "util/char.hpp"
-#include <sstream>
+
+
+
+class JsonStructuralIndex;
 
 
 
@@ -25,8 +29,8 @@ public:
 	using StringIterator = StringView::iterator;
 	using StringConstIterator = StringView::const_iterator;
 
-	static constexpr u32 IndentationLevel = 2;
-	static constexpr char IndentationChar = ' ';
+	static constexpr u32 IndentationLevel = JsonWriter::IndentationLevel;
+	static constexpr char IndentationChar = JsonWriter::IndentationChar;
 
 	JsonDocument() = default;
 	JsonDocument(const JsonObject& root);
@@ -35,6 +39,7 @@ public:
 
 	void read(const StringView& json);
 	StringType write(bool compact = false) const;
+	void write(JsonOutputSink& sink, bool compact = false) const;
 
 	void clear();
 	bool empty() const;
@@ -45,6 +50,7 @@ public:
 	const JsonValue& getRoot() const;
 
 	static JsonDocument fromFile(const Path& path);
+	void toFile(const Path& path, bool compact = false) const;
 
 private:
 
@@ -97,6 +103,8 @@ private:
 	static constexpr u32 ReadStepValue = 2;
 	static constexpr u32 ReadStepComma = 3;
 
+	bool readIndexed(const StringView& json, const JsonStructuralIndex& index);
+
 	bool readComment(Iterator& it);
 	void readString(Iterator& it, StringType& string, bool name);
 	bool readNumber(Iterator& it, JsonValue& value);
@@ -107,11 +115,6 @@ private:
 	void readArray(Iterator& it, JsonArray& array);
 	void readObject(Iterator& it, JsonObject& object);
 
-	void writeString(StringType& string, const StringType& value) const;
-	void writeValue(StringType& string, const JsonValue& value, bool compact, u32 level) const;
-	void writeArray(StringType& string, const JsonArray& array, bool compact, u32 level) const;
-	void writeObject(StringType& string, const JsonObject& object, bool compact, u32 level) const;
-
 	JsonValue root;
 
 };
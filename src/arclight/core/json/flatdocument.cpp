@@ -0,0 +1,556 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 flatdocument.cpp
+ */
+
+#include "flatdocument.hpp"
+#include "scanner.hpp"
+#include "structuralindex.hpp"
+#include "array.hpp"
+#include "object.hpp"
+#include "filesystem/path.hpp"
+#include "math/math.hpp"
+#include "memory/memory.hpp"
+#include "util/bits.hpp"
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+
+
+static u32 indexCapacity(u32 count) {
+	return Bits::ceilPowerOf2(count * 2);
+}
+
+static SizeT hashName(const Json::StringView& name) {
+	return std::hash<Json::StringView>{}(name);
+}
+
+
+
+const JsonNode& JsonNode::operator[](const StringView& name) const {
+
+	const JsonNode* node = find(name);
+
+	if (!node) {
+		throw JsonValueNotFoundException(Json::StringType(name));
+	}
+
+	return *node;
+
+}
+
+const JsonNode* JsonNode::find(const StringView& name) const {
+
+	checkType(Type::Object);
+
+	if (flags & FlagIndexed) {
+
+		const u32* index = getIndex();
+		u32 mask = indexCapacity(count) - 1;
+
+		for (SizeT slot = hashName(name) & mask; index[slot]; slot = (slot + 1) & mask) {
+
+			const JsonMember& member = members[index[slot] - 1];
+
+			if (member.name == name) {
+				return &member.value;
+			}
+
+		}
+
+		return nullptr;
+
+	}
+
+	for (u32 i = 0; i < count; i++) {
+
+		if (members[i].name == name) {
+			return &members[i].value;
+		}
+
+	}
+
+	return nullptr;
+
+}
+
+JsonValue JsonNode::toValue() const {
+
+	switch (getType()) {
+
+		case Type::String:
+			return Json::StringType(string, count);
+
+		case Type::Number:
+			return (flags & FlagInteger) ? JsonValue(integer) : JsonValue(floating);
+
+		case Type::Boolean:
+			return boolean;
+
+		case Type::Null:
+			return nullptr;
+
+		case Type::Array:
+		{
+			JsonArray array;
+
+			for (const JsonNode& element : getElements()) {
+				array.emplace() = element.toValue();
+			}
+
+			return array;
+		}
+
+		case Type::Object:
+		{
+			JsonObject object;
+
+			for (const JsonMember& member : getMembers()) {
+				object.emplace(Json::StringType(member.name), member.value.toValue());
+			}
+
+			return object;
+		}
+
+		default:
+			return {};
+
+	}
+
+}
+
+const u32* JsonNode::getIndex() const {
+	return reinterpret_cast<const u32*>(members + count);
+}
+
+
+
+JsonFlatDocument::JsonFlatDocument(const StringView& json) {
+	read(json);
+}
+
+
+
+/*
+ *  Stage two over the structural index
+ *  A first sweep over the index counts the children of every container, so that each array and object
+ *  is allocated once with its final size when it opens and every node is written in place exactly once.
+ *  The counts are only trusted as far as the second sweep validates the structure.
+ */
+void JsonFlatDocument::read(const StringView& json) {
+
+	enum class Step {
+		Value,
+		Member,
+		Next
+	};
+
+	struct Frame {
+
+		JsonNode* node;
+		u32 next;
+
+	};
+
+	arena.clear();
+	root = {};
+
+	JsonStructuralIndex index;
+
+	if (!index.build(json)) {
+		throw JsonSyntaxError("Unterminated string or comment found");
+	}
+
+	const char* data = json.data();
+	const char* end = data + json.size();
+
+	SizeT count = index.size();
+
+	if (count == 0) {
+		throw JsonSyntaxError("Unexpected EOF while reading value");
+	}
+
+	// Children per container in order of appearance
+	std::vector<u32> sizes;
+	std::vector<Frame> stack;
+
+	for (SizeT i = 0; i < count; i++) {
+
+		switch (data[index[i]]) {
+
+			case '{':
+			case '[':
+				stack.push_back({nullptr, u32(sizes.size())});
+				sizes.push_back(1);
+				break;
+
+			case ',':
+
+				if (!stack.empty()) {
+					sizes[stack.back().next]++;
+				}
+
+				break;
+
+			case '}':
+			case ']':
+
+				if (stack.empty()) {
+					break;
+				}
+
+				if (data[index[i - 1]] == '{' || data[index[i - 1]] == '[') {
+					sizes[stack.back().next] = 0;
+				}
+
+				stack.pop_back();
+				break;
+
+		}
+
+	}
+
+	stack.clear();
+
+	auto fail = [&](SizeT position) {
+		throw JsonSyntaxError(String::format("Unexpected symbol at offset %zu", position));
+	};
+
+	auto literal = [end](const char* p, const StringView& word) {
+		return SizeT(end - p) >= word.size() && StringView(p, word.size()) == word && JsonScanner::isDelimiter(p + word.size(), end);
+	};
+
+	Json::StringType escaped;
+
+	auto readString = [&](const char* p, bool isName) -> StringView {
+
+		const char* special = JsonScanner::findStringSpecial(p + 1, end);
+
+		if (special != end && *special == '"') {
+			return StringView(p + 1, special - p - 1);
+		}
+
+		escaped.clear();
+		JsonScanner::readString(p, end, escaped, isName);
+
+		return intern(escaped);
+
+	};
+
+	SizeT i = 0;
+	SizeT container = 0;
+	JsonNode* target = &root;
+	Step step = Step::Value;
+
+	while (true) {
+
+		switch (step) {
+
+			case Step::Value:
+			{
+				if (i == count) {
+					throw JsonSyntaxError("Unexpected EOF while reading value");
+				}
+
+				SizeT position = index[i++];
+				const char* p = data + position;
+
+				JsonNode& node = *Memory::construct<JsonNode>(target);
+				step = Step::Next;
+
+				switch (*p) {
+
+					case '{':
+					case '[':
+					{
+						bool object = *p == '{';
+						u32 size = sizes[container++];
+
+						node.type = u8(object ? Json::Type::Object : Json::Type::Array);
+						node.count = size;
+
+						if (size == 0) {
+
+							// Only counted as empty if a closing character follows immediately
+							if (data[index[i]] != (object ? '}' : ']')) {
+								fail(index[i]);
+							}
+
+							i++;
+							break;
+
+						}
+
+						if (object) {
+
+							bool indexed = size > JsonNode::IndexThreshold;
+							SizeT bytes = size * sizeof(JsonMember) + (indexed ? indexCapacity(size) * sizeof(u32) : 0);
+
+							node.members = static_cast<JsonMember*>(arena.allocate(bytes, alignof(JsonMember)));
+							node.flags = indexed ? JsonNode::FlagIndexed : 0;
+							step = Step::Member;
+
+						} else {
+
+							node.elements = target = arena.allocate<JsonNode>(size);
+							step = Step::Value;
+
+						}
+
+						stack.push_back({&node, 0});
+
+						break;
+					}
+
+					case '"':
+					{
+						StringView string = readString(p, false);
+
+						node.type = u8(Json::Type::String);
+						node.string = string.data();
+						node.count = string.size();
+
+						break;
+					}
+
+					case 't':
+					case 'f':
+
+						if (!literal(p, *p == 't' ? "true" : "false")) {
+							fail(position);
+						}
+
+						node.type = u8(Json::Type::Boolean);
+						node.boolean = *p == 't';
+
+						break;
+
+					case 'n':
+
+						if (!literal(p, "null")) {
+							fail(position);
+						}
+
+						node.type = u8(Json::Type::Null);
+
+						break;
+
+					default:
+					{
+						JsonScanner::Number number;
+						const char* next = JsonScanner::readNumber(p, end, number);
+
+						if (!next || !JsonScanner::isDelimiter(next, end)) {
+							fail(position);
+						}
+
+						node.type = u8(Json::Type::Number);
+
+						if (number.integer) {
+
+							node.flags = JsonNode::FlagInteger;
+							node.integer = number.i;
+
+						} else {
+
+							node.floating = number.f;
+
+						}
+
+						break;
+					}
+
+				}
+
+				break;
+			}
+
+			case Step::Member:
+			{
+				if (count - i < 2 || data[index[i]] != '"') {
+					fail(i < count ? index[i] : json.size());
+				}
+
+				Frame& frame = stack.back();
+				JsonMember* member = const_cast<JsonMember*>(frame.node->members) + frame.next;
+
+				Memory::construct<JsonMember>(member, readString(data + index[i], true), JsonNode());
+
+				if (data[index[i + 1]] != ':') {
+					fail(index[i + 1]);
+				}
+
+				i += 2;
+				target = &member->value;
+				step = Step::Value;
+
+				break;
+			}
+
+			case Step::Next:
+			{
+				if (stack.empty()) {
+					return;
+				}
+
+				if (i == count) {
+					throw JsonSyntaxError("Unexpected EOF while reading container");
+				}
+
+				SizeT position = index[i++];
+				char c = data[position];
+
+				Frame& frame = stack.back();
+				JsonNode& node = *frame.node;
+				bool object = node.isObject();
+
+				if (c == ',') {
+
+					if (++frame.next == node.count) {
+						fail(position);
+					}
+
+					if (object) {
+
+						step = Step::Member;
+
+					} else {
+
+						target = const_cast<JsonNode*>(node.elements) + frame.next;
+						step = Step::Value;
+
+					}
+
+					break;
+
+				}
+
+				if (c != (object ? '}' : ']') || frame.next + 1 != node.count) {
+					fail(position);
+				}
+
+				if (object) {
+
+					JsonMember* members = const_cast<JsonMember*>(node.members);
+
+					if (node.flags & JsonNode::FlagIndexed) {
+
+						if (!buildIndex(members, node.count)) {
+							throw JsonSyntaxError("Duplicate member name found");
+						}
+
+					} else {
+
+						for (u32 a = 1; a < node.count; a++) {
+
+							for (u32 b = 0; b < a; b++) {
+
+								if (members[a].name == members[b].name) {
+									throw JsonSyntaxError("Duplicate member name found");
+								}
+
+							}
+
+						}
+
+					}
+
+				}
+
+				stack.pop_back();
+
+				break;
+			}
+
+		}
+
+	}
+
+}
+
+
+
+void JsonFlatDocument::clear() {
+
+	arena.clear();
+	file.close();
+	root = {};
+
+}
+
+bool JsonFlatDocument::empty() const {
+	return !root.isValid();
+}
+
+const JsonNode& JsonFlatDocument::getRoot() const {
+	return root;
+}
+
+SizeT JsonFlatDocument::getMemoryUsage() const {
+	return arena.getReservedSize();
+}
+
+
+
+JsonFlatDocument JsonFlatDocument::fromFile(const Path& path) {
+
+	JsonFlatDocument document;
+
+	if (!document.file.open(path)) {
+		throw JsonException("Failed to open file " + path.toString());
+	}
+
+	std::span<const u8> bytes = document.file.data();
+	document.read(StringView(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+
+	return document;
+
+}
+
+
+
+auto JsonFlatDocument::intern(const Json::StringType& string) -> StringView {
+
+	char* copy = arena.allocate<char>(string.size());
+	std::memcpy(copy, string.data(), string.size());
+
+	return StringView(copy, string.size());
+
+}
+
+/*
+ *  Builds the hash index of an object into the storage reserved directly behind its members
+ *  Returns false if two members share a name.
+ */
+bool JsonFlatDocument::buildIndex(JsonMember* members, u32 count) {
+
+	u32 capacity = indexCapacity(count);
+	u32 mask = capacity - 1;
+
+	u32* index = reinterpret_cast<u32*>(members + count);
+	std::fill_n(index, capacity, 0);
+
+	for (u32 i = 0; i < count; i++) {
+
+		SizeT slot = hashName(members[i].name) & mask;
+
+		for (; index[slot]; slot = (slot + 1) & mask) {
+
+			if (members[index[slot] - 1].name == members[i].name) {
+				return false;
+			}
+
+		}
+
+		index[slot] = i + 1;
+
+	}
+
+	return true;
+
+}
@@ -0,0 +1,232 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 flatdocument.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "value.hpp"
+#include "filesystem/mappedfile.hpp"
+#include "memory/arenaallocator.hpp"
+
+#include <span>
+
+
+
+class Path;
+struct JsonMember;
+
+
+
+/*
+ *  Immutable node of a JsonFlatDocument
+ *  Arrays point to a contiguous run of nodes, objects to a run of members in source order.
+ *  Objects above IndexThreshold members carry an open addressing hash index right behind their members.
+ */
+class JsonNode {
+
+public:
+
+	using StringView = Json::StringView;
+	using Type = Json::Type;
+
+	constexpr static u32 IndexThreshold = 16;
+
+	constexpr JsonNode() noexcept : type(u8(Type::None)), flags(0), count(0), integer(0) {}
+
+
+	constexpr Type getType() const noexcept {
+		return static_cast<Type>(type);
+	}
+
+	constexpr bool isString() const noexcept {
+		return getType() == Type::String;
+	}
+
+	constexpr bool isNumber() const noexcept {
+		return getType() == Type::Number;
+	}
+
+	constexpr bool isInteger() const noexcept {
+		return isNumber() && (flags & FlagInteger);
+	}
+
+	constexpr bool isFloat() const noexcept {
+		return isNumber() && !(flags & FlagInteger);
+	}
+
+	constexpr bool isObject() const noexcept {
+		return getType() == Type::Object;
+	}
+
+	constexpr bool isArray() const noexcept {
+		return getType() == Type::Array;
+	}
+
+	constexpr bool isBoolean() const noexcept {
+		return getType() == Type::Boolean;
+	}
+
+	constexpr bool isNull() const noexcept {
+		return getType() == Type::Null;
+	}
+
+	constexpr bool isValid() const noexcept {
+		return getType() != Type::None;
+	}
+
+
+	template<CC::JsonNumber T>
+	T toNumber() const {
+
+		checkType(Type::Number);
+
+		return (flags & FlagInteger) ? static_cast<T>(integer) : static_cast<T>(floating);
+
+	}
+
+	bool toBoolean() const {
+
+		checkType(Type::Boolean);
+		return boolean;
+
+	}
+
+	StringView toString() const {
+
+		checkType(Type::String);
+		return { string, count };
+
+	}
+
+	std::span<const JsonNode> getElements() const {
+
+		checkType(Type::Array);
+		return { elements, count };
+
+	}
+
+	std::span<const JsonMember> getMembers() const;
+
+	//Number of elements or members, zero for scalars
+	constexpr SizeT size() const noexcept {
+		return (getType() == Type::Array || getType() == Type::Object) ? count : 0;
+	}
+
+	constexpr bool empty() const noexcept {
+		return size() == 0;
+	}
+
+
+	const JsonNode& operator[](SizeT index) const {
+		return getElements()[index];
+	}
+
+	//Throws JsonValueNotFoundException if there is no member with the given name
+	const JsonNode& operator[](const StringView& name) const;
+
+	//Returns the member with the given name or nullptr
+	const JsonNode* find(const StringView& name) const;
+
+	bool contains(const StringView& name) const {
+		return find(name);
+	}
+
+
+	//Deep-copies the node into a JsonValue
+	JsonValue toValue() const;
+
+private:
+
+	friend class JsonFlatDocument;
+
+	constexpr static u8 FlagInteger = 0x1;
+	constexpr static u8 FlagIndexed = 0x2;
+
+	void checkType(Type target) const {
+
+		if (getType() != target) {
+			throw JsonTypeCastException(getType(), target);
+		}
+
+	}
+
+	const u32* getIndex() const;
+
+	u8 type;
+	u8 flags;
+	u32 count;
+
+	union {
+		Json::IntegerType integer;
+		Json::FloatType floating;
+		bool boolean;
+		const char* string;
+		const JsonNode* elements;
+		const JsonMember* members;
+	};
+
+};
+
+
+struct JsonMember {
+
+	Json::StringView name;
+	JsonNode value;
+
+};
+
+
+inline std::span<const JsonMember> JsonNode::getMembers() const {
+
+	checkType(Type::Object);
+	return { members, count };
+
+}
+
+
+
+/*
+ *  Read-only JSON document stored in a single arena
+ *  Nodes, members, escaped strings and hash indices are bump-allocated, so reading a document performs a few dozen allocations
+ *  and freeing it releases only the arena blocks. Strings without escape sequences are views into the source, which must outlive
+ *  the document unless it was opened with fromFile(). Objects keep their members in source order.
+ *  Input is parsed through the structural index and must be strict JSON; comments are not accepted.
+ */
+class JsonFlatDocument {
+
+public:
+
+	using StringView = Json::StringView;
+
+	JsonFlatDocument() = default;
+	explicit JsonFlatDocument(const StringView& json);
+
+	JsonFlatDocument(JsonFlatDocument&& document) noexcept = default;
+	JsonFlatDocument& operator=(JsonFlatDocument&& document) noexcept = default;
+
+	void read(const StringView& json);
+
+	void clear();
+	bool empty() const;
+
+	const JsonNode& getRoot() const;
+
+	SizeT getMemoryUsage() const;
+
+	static JsonFlatDocument fromFile(const Path& path);
+
+private:
+
+	StringView intern(const Json::StringType& string);
+	static bool buildIndex(JsonMember* members, u32 count);
+
+	ArenaAllocator arena;
+	MappedFile file;
+	JsonNode root;
+
+};
@@ -13,3 +13,9 @@
 #include "array.hpp"
 #include "object.hpp"
 #include "document.hpp"
+#include "flatdocument.hpp"
+#include "cursor.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+#include "cbor.hpp"
+#include "messagepack.hpp"
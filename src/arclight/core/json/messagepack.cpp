@@ -0,0 +1,453 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 messagepack.cpp
+ */
+
+#include "messagepack.hpp"
+#include "binary.hpp"
+#include "array.hpp"
+#include "object.hpp"
+
+#include <limits>
+
+
+
+namespace {
+
+	constexpr u8 FixMap = 0x80;
+	constexpr u8 FixArray = 0x90;
+	constexpr u8 FixString = 0xA0;
+	constexpr u8 Nil = 0xC0;
+	constexpr u8 False = 0xC2;
+	constexpr u8 True = 0xC3;
+	constexpr u8 Binary8 = 0xC4;
+	constexpr u8 Binary16 = 0xC5;
+	constexpr u8 Binary32 = 0xC6;
+	constexpr u8 Float32 = 0xCA;
+	constexpr u8 Float64 = 0xCB;
+	constexpr u8 UInt8 = 0xCC;
+	constexpr u8 UInt16 = 0xCD;
+	constexpr u8 UInt32 = 0xCE;
+	constexpr u8 UInt64 = 0xCF;
+	constexpr u8 Int8 = 0xD0;
+	constexpr u8 Int16 = 0xD1;
+	constexpr u8 Int32 = 0xD2;
+	constexpr u8 Int64 = 0xD3;
+	constexpr u8 String8 = 0xD9;
+	constexpr u8 String16 = 0xDA;
+	constexpr u8 String32 = 0xDB;
+	constexpr u8 Array16 = 0xDC;
+	constexpr u8 Array32 = 0xDD;
+	constexpr u8 Map16 = 0xDE;
+	constexpr u8 Map32 = 0xDF;
+	constexpr u8 NegativeFixInt = 0xE0;
+
+
+	SizeT integerSize(Json::IntegerType value) {
+
+		if (value >= 0) {
+			return value < 0x80 ? 1 : value <= 0xFF ? 2 : value <= 0xFFFF ? 3 : value <= 0xFFFFFFFF ? 5 : 9;
+		}
+
+		return value >= -32 ? 1 : value >= -0x80 ? 2 : value >= -0x8000 ? 3 : value >= -0x80000000ll ? 5 : 9;
+
+	}
+
+	SizeT stringHeaderSize(SizeT size) {
+		return size < 32 ? 1 : size <= 0xFF ? 2 : size <= 0xFFFF ? 3 : 5;
+	}
+
+	SizeT containerHeaderSize(SizeT size) {
+		return size < 16 ? 1 : size <= 0xFFFF ? 3 : 5;
+	}
+
+
+	void writeInteger(BinaryWriter& writer, Json::IntegerType value) {
+
+		switch (integerSize(value)) {
+
+			case 1:
+				JsonBinary::write<u8>(writer, u8(value));
+				break;
+
+			case 2:
+				JsonBinary::write<u8>(writer, value >= 0 ? UInt8 : Int8);
+				JsonBinary::write<u8>(writer, u8(value));
+				break;
+
+			case 3:
+				JsonBinary::write<u8>(writer, value >= 0 ? UInt16 : Int16);
+				JsonBinary::write<u16>(writer, u16(value));
+				break;
+
+			case 5:
+				JsonBinary::write<u8>(writer, value >= 0 ? UInt32 : Int32);
+				JsonBinary::write<u32>(writer, u32(value));
+				break;
+
+			default:
+				JsonBinary::write<u8>(writer, value >= 0 ? UInt64 : Int64);
+				JsonBinary::write<u64>(writer, u64(value));
+				break;
+
+		}
+
+	}
+
+	void writeString(BinaryWriter& writer, const Json::StringView& string) {
+
+		SizeT size = string.size();
+
+		switch (stringHeaderSize(size)) {
+
+			case 1:
+				JsonBinary::write<u8>(writer, FixString | size);
+				break;
+
+			case 2:
+				JsonBinary::write<u8>(writer, String8);
+				JsonBinary::write<u8>(writer, size);
+				break;
+
+			case 3:
+				JsonBinary::write<u8>(writer, String16);
+				JsonBinary::write<u16>(writer, size);
+				break;
+
+			default:
+				JsonBinary::write<u8>(writer, String32);
+				JsonBinary::write<u32>(writer, size);
+				break;
+
+		}
+
+		JsonBinary::writeBytes(writer, string.data(), size);
+
+	}
+
+	void writeContainerHeader(BinaryWriter& writer, SizeT size, u8 fix, u8 format16) {
+
+		switch (containerHeaderSize(size)) {
+
+			case 1:
+				JsonBinary::write<u8>(writer, fix | size);
+				break;
+
+			case 3:
+				JsonBinary::write<u8>(writer, format16);
+				JsonBinary::write<u16>(writer, size);
+				break;
+
+			default:
+				JsonBinary::write<u8>(writer, format16 + 1);
+				JsonBinary::write<u32>(writer, size);
+				break;
+
+		}
+
+	}
+
+
+	//Returns the length of a str value with the given format byte, or -1 if the format is not a str
+	i64 readStringSize(BinaryReader& reader, u8 format) {
+
+		if ((format & 0xE0) == FixString) {
+			return format & 0x1F;
+		}
+
+		switch (format) {
+
+			case String8:	return JsonBinary::read<u8>(reader);
+			case String16:	return JsonBinary::read<u16>(reader);
+			case String32:	return JsonBinary::read<u32>(reader);
+			default:		return -1;
+
+		}
+
+	}
+
+	void decodeObject(BinaryReader& reader, JsonHandler& handler, u32 depth);
+
+	void decodeArray(BinaryReader& reader, JsonHandler& handler, u32 depth, u64 size) {
+
+		handler.startArray();
+
+		for (u64 i = 0; i < size; i++) {
+			decodeObject(reader, handler, depth + 1);
+		}
+
+		handler.endArray();
+
+	}
+
+	void decodeMap(BinaryReader& reader, JsonHandler& handler, u32 depth, u64 size) {
+
+		handler.startObject();
+
+		for (u64 i = 0; i < size; i++) {
+
+			i64 keySize = readStringSize(reader, JsonBinary::read<u8>(reader));
+
+			if (keySize < 0) {
+				throw JsonSyntaxError("MessagePack map key is not a string");
+			}
+
+			handler.name(JsonBinary::toStringView(JsonBinary::readBytes(reader, keySize)));
+			decodeObject(reader, handler, depth + 1);
+
+		}
+
+		handler.endObject();
+
+	}
+
+	void decodeObject(BinaryReader& reader, JsonHandler& handler, u32 depth) {
+
+		if (depth == JsonBinary::MaxDepth) {
+			throw JsonSyntaxError("Maximum nesting depth exceeded");
+		}
+
+		u8 format = JsonBinary::read<u8>(reader);
+
+		if (format < FixMap || format >= NegativeFixInt) {
+
+			handler.integer(i8(format));
+			return;
+
+		}
+
+		if (format < FixArray) {
+
+			decodeMap(reader, handler, depth, format & 0xF);
+			return;
+
+		}
+
+		if (format < FixString) {
+
+			decodeArray(reader, handler, depth, format & 0xF);
+			return;
+
+		}
+
+		if (i64 size = readStringSize(reader, format); size >= 0) {
+
+			handler.string(JsonBinary::toStringView(JsonBinary::readBytes(reader, size)));
+			return;
+
+		}
+
+		switch (format) {
+
+			case Nil:		handler.null();											break;
+			case False:		handler.boolean(false);									break;
+			case True:		handler.boolean(true);									break;
+
+			case Binary8:	handler.binary(JsonBinary::readBytes(reader, JsonBinary::read<u8>(reader)));		break;
+			case Binary16:	handler.binary(JsonBinary::readBytes(reader, JsonBinary::read<u16>(reader)));	break;
+			case Binary32:	handler.binary(JsonBinary::readBytes(reader, JsonBinary::read<u32>(reader)));	break;
+
+			case Float32:	handler.floating(std::bit_cast<float>(JsonBinary::read<u32>(reader)));	break;
+			case Float64:	handler.floating(std::bit_cast<double>(JsonBinary::read<u64>(reader)));	break;
+
+			case UInt8:		handler.integer(JsonBinary::read<u8>(reader));			break;
+			case UInt16:	handler.integer(JsonBinary::read<u16>(reader));			break;
+			case UInt32:	handler.integer(JsonBinary::read<u32>(reader));			break;
+
+			case UInt64:
+			{
+				u64 value = JsonBinary::read<u64>(reader);
+
+				if (value <= u64(std::numeric_limits<Json::IntegerType>::max())) {
+					handler.integer(Json::IntegerType(value));
+				} else {
+					handler.floating(Json::FloatType(value));
+				}
+
+				break;
+			}
+
+			case Int8:		handler.integer(i8(JsonBinary::read<u8>(reader)));		break;
+			case Int16:		handler.integer(i16(JsonBinary::read<u16>(reader)));	break;
+			case Int32:		handler.integer(i32(JsonBinary::read<u32>(reader)));	break;
+			case Int64:		handler.integer(i64(JsonBinary::read<u64>(reader)));	break;
+
+			case Array16:	decodeArray(reader, handler, depth, JsonBinary::read<u16>(reader));	break;
+			case Array32:	decodeArray(reader, handler, depth, JsonBinary::read<u32>(reader));	break;
+			case Map16:		decodeMap(reader, handler, depth, JsonBinary::read<u16>(reader));	break;
+			case Map32:		decodeMap(reader, handler, depth, JsonBinary::read<u32>(reader));	break;
+
+			default:
+				throw JsonSyntaxError("Unsupported MessagePack format");
+
+		}
+
+	}
+
+}
+
+
+
+SizeT MessagePackCodec::getEncodedSize(const JsonValue& value) {
+
+	switch (value.getType()) {
+
+		case Json::Type::String:
+		{
+			SizeT size = value.toStringView().size();
+			return stringHeaderSize(size) + size;
+		}
+
+		case Json::Type::Number:
+			return value.isInteger() ? integerSize(value.toNumber<Json::IntegerType>()) : JsonBinary::fitsFloat(value.toNumber<Json::FloatType>()) ? 5 : 9;
+
+		case Json::Type::Object:
+			return getEncodedSize(value.toObject());
+
+		case Json::Type::Array:
+			return getEncodedSize(value.toArray());
+
+		default:
+			return 1;
+
+	}
+
+}
+
+SizeT MessagePackCodec::getEncodedSize(const JsonObject& object) {
+
+	SizeT size = containerHeaderSize(object.size());
+
+	for (const auto& [name, value] : object) {
+		size += stringHeaderSize(name.size()) + name.size() + getEncodedSize(value);
+	}
+
+	return size;
+
+}
+
+SizeT MessagePackCodec::getEncodedSize(const JsonArray& array) {
+
+	SizeT size = containerHeaderSize(array.size());
+
+	for (const JsonValue& value : array) {
+		size += getEncodedSize(value);
+	}
+
+	return size;
+
+}
+
+
+
+void MessagePackCodec::encode(const JsonValue& value, BinaryWriter& writer) {
+
+	switch (value.getType()) {
+
+		case Json::Type::String:
+			writeString(writer, value.toStringView());
+			break;
+
+		case Json::Type::Number:
+
+			if (value.isInteger()) {
+
+				writeInteger(writer, value.toNumber<Json::IntegerType>());
+
+			} else {
+
+				Json::FloatType floating = value.toNumber<Json::FloatType>();
+
+				if (JsonBinary::fitsFloat(floating)) {
+
+					JsonBinary::write<u8>(writer, Float32);
+					JsonBinary::write<u32>(writer, std::bit_cast<u32>(float(floating)));
+
+				} else {
+
+					JsonBinary::write<u8>(writer, Float64);
+					JsonBinary::write<u64>(writer, std::bit_cast<u64>(floating));
+
+				}
+
+			}
+
+			break;
+
+		case Json::Type::Object:
+			encode(value.toObject(), writer);
+			break;
+
+		case Json::Type::Array:
+			encode(value.toArray(), writer);
+			break;
+
+		case Json::Type::Boolean:
+			JsonBinary::write<u8>(writer, value.toBoolean() ? True : False);
+			break;
+
+		case Json::Type::Null:
+		case Json::Type::None:
+			JsonBinary::write<u8>(writer, Nil);
+			break;
+
+	}
+
+}
+
+void MessagePackCodec::encode(const JsonObject& object, BinaryWriter& writer) {
+
+	writeContainerHeader(writer, object.size(), FixMap, Map16);
+
+	for (const auto& [name, value] : object) {
+
+		writeString(writer, name);
+		encode(value, writer);
+
+	}
+
+}
+
+void MessagePackCodec::encode(const JsonArray& array, BinaryWriter& writer) {
+
+	writeContainerHeader(writer, array.size(), FixArray, Array16);
+
+	for (const JsonValue& value : array) {
+		encode(value, writer);
+	}
+
+}
+
+
+
+void MessagePackCodec::decode(BinaryReader& reader, JsonHandler& handler) {
+
+	decodeObject(reader, handler, 0);
+	handler.endRecord();
+
+}
+
+JsonValue MessagePackCodec::decode(BinaryReader& reader) {
+
+	JsonValueBuilder builder;
+	decode(reader, builder);
+
+	return std::move(builder.getValue());
+
+}
+
+JsonValue MessagePackCodec::decode(std::span<const u8> data) {
+
+	BinaryReader reader(data);
+	JsonValue value = decode(reader);
+
+	if (reader.remainingSize()) {
+		throw JsonSyntaxError("Unexpected data after MessagePack object");
+	}
+
+	return value;
+
+}
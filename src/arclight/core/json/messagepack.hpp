@@ -0,0 +1,65 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 messagepack.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "reader.hpp"
+#include "stream/binaryreader.hpp"
+#include "stream/binarywriter.hpp"
+
+#include <span>
+#include <vector>
+
+
+
+class JsonObject;
+class JsonArray;
+
+
+
+/*
+ *  MessagePack encoding of the JSON value model
+ *  Integers, string and container lengths take the shortest format, floats are written as float 32 if that holds their value exactly.
+ *  Map members follow the object's iteration order, so equal values produce equal output.
+ *  getEncodedSize() returns the exact size ahead of encoding, the BinaryWriter passed to encode() needs that much space left.
+ *  Decoding reports bin values through JsonHandler::binary and rejects extension types. Decoded strings are views into the input.
+ *  Map keys must be strings. Multi-byte fields are big endian regardless of the stream's byte order.
+ */
+class MessagePackCodec {
+
+public:
+
+	static SizeT getEncodedSize(const JsonValue& value);
+	static SizeT getEncodedSize(const JsonObject& object);
+	static SizeT getEncodedSize(const JsonArray& array);
+
+	static void encode(const JsonValue& value, BinaryWriter& writer);
+	static void encode(const JsonObject& object, BinaryWriter& writer);
+	static void encode(const JsonArray& array, BinaryWriter& writer);
+
+	template<class T>
+	static std::vector<u8> encode(const T& value) {
+
+		std::vector<u8> data(getEncodedSize(value));
+		BinaryWriter writer(data);
+
+		encode(value, writer);
+
+		return data;
+
+	}
+
+	//Decodes one object and advances the reader past it
+	static void decode(BinaryReader& reader, JsonHandler& handler);
+	static JsonValue decode(BinaryReader& reader);
+
+	//Decodes data, which must contain exactly one object
+	static JsonValue decode(std::span<const u8> data);
+
+};
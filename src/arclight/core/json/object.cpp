@@ -38,6 +38,10 @@ bool JsonObject::empty() const {
 	return items.empty();
 }
 
+SizeT JsonObject::size() const {
+	return items.size();
+}
+
 auto JsonObject::begin() -> ItemIterator {
 	return items.begin();
 }
@@ -41,12 +41,12 @@ public:
 
 	template<class... Args>
 	JsonValue& emplace(const StringType& name, Args&&... args) {
-		return *items.try_emplace(name, std::forward<Args>(args)...).first;
+		return items.try_emplace(name, std::forward<Args>(args)...).first->second;
 	}
 
 	template<class... Args>
 	JsonValue& emplace(StringType&& name, Args&&... args) {
-		return *items.try_emplace(std::move(name), std::forward<Args>(args)...).first;
+		return items.try_emplace(std::move(name), std::forward<Args>(args)...).first->second;
 	}
 
 	void insert(const StringType& name, const JsonValue& value);
@@ -62,6 +62,7 @@ public:
 
 	void clear();
 	bool empty() const;
+	SizeT size() const;
 
 	ItemIterator begin();
 	ItemConstIterator begin() const;
@@ -0,0 +1,774 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 reader.cpp
+ */
+
+#include "reader.hpp"
+#include "array.hpp"
+#include "object.hpp"
+#include "concurrent/thread.hpp"
+#include "filesystem/path.hpp"
+#include "math/math.hpp"
+#include "util/assert.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+
+
+static bool isWhitespace(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+//Characters that may appear inside a number or literal
+static bool isTokenChar(char c) {
+	return Character::isAlpha(c) || Character::isDigit(c) || c == '-' || c == '+' || c == '.';
+}
+
+
+
+SizeT JsonStringSource::read(std::span<char> buffer) {
+
+	SizeT count = Math::min(buffer.size(), json.size() - offset);
+
+	std::memcpy(buffer.data(), json.data() + offset, count);
+	offset += count;
+
+	return count;
+
+}
+
+
+
+JsonFileSource::JsonFileSource(const Path& path) {
+
+	if (!file.open(path, File::In)) {
+		throw JsonException("Failed to open file " + path.toString());
+	}
+
+}
+
+SizeT JsonFileSource::read(std::span<char> buffer) {
+	return file.read({ reinterpret_cast<u8*>(buffer.data()), buffer.size() });
+}
+
+
+
+void JsonValueBuilder::startObject() {
+	stack.emplace_back(JsonObject());
+}
+
+void JsonValueBuilder::endObject() {
+	close();
+}
+
+void JsonValueBuilder::startArray() {
+	stack.emplace_back(JsonArray());
+}
+
+void JsonValueBuilder::endArray() {
+	close();
+}
+
+void JsonValueBuilder::name(const Json::StringView& name) {
+	names.emplace_back(name);
+}
+
+void JsonValueBuilder::string(const Json::StringView& string) {
+	add(Json::StringType(string));
+}
+
+void JsonValueBuilder::integer(Json::IntegerType value) {
+	add(value);
+}
+
+void JsonValueBuilder::floating(Json::FloatType value) {
+	add(value);
+}
+
+void JsonValueBuilder::boolean(bool value) {
+	add(value);
+}
+
+void JsonValueBuilder::null() {
+	add(nullptr);
+}
+
+void JsonValueBuilder::add(JsonValue&& element) {
+
+	if (stack.empty()) {
+
+		value = std::move(element);
+		return;
+
+	}
+
+	JsonValue& container = stack.back();
+
+	if (container.isArray()) {
+
+		container.toArray().emplace() = std::move(element);
+
+	} else {
+
+		JsonObject& object = container.toObject();
+
+		if (object.contains(names.back())) {
+			throw JsonSyntaxError("Duplicate member name found");
+		}
+
+		object.emplace(std::move(names.back()), std::move(element));
+		names.pop_back();
+
+	}
+
+}
+
+void JsonValueBuilder::close() {
+
+	JsonValue container = std::move(stack.back());
+	stack.pop_back();
+
+	add(std::move(container));
+
+}
+
+
+
+JsonReader::JsonReader(JsonInputSource& source, Mode mode, SizeT bufferSize) :
+	source(source), mode(mode), buffer(std::make_unique_for_overwrite<char[]>(bufferSize)), capacity(bufferSize),
+	size(0), position(0), consumed(0), exhausted(false), state(State::Value), number{}, boolean(false) {
+
+	arc_assert(bufferSize > 0, "JSON reader buffer cannot be empty");
+
+}
+
+
+
+JsonEvent JsonReader::next() {
+
+	while (true) {
+
+		i32 c = peek();
+
+		switch (state) {
+
+			case State::Done:
+				return JsonEvent::EndOfInput;
+
+			case State::FirstElement:
+
+				if (c == ']') {
+
+					position++;
+					stack.pop_back();
+					state = State::AfterValue;
+
+					return JsonEvent::EndArray;
+
+				}
+
+				[[fallthrough]];
+
+			case State::Value:
+
+				if (c < 0) {
+
+					if (mode == Mode::Lines && stack.empty()) {
+
+						state = State::Done;
+						return JsonEvent::EndOfInput;
+
+					}
+
+					fail("Unexpected EOF while reading value");
+
+				}
+
+				return readValue(c);
+
+			case State::FirstMember:
+
+				if (c == '}') {
+
+					position++;
+					stack.pop_back();
+					state = State::AfterValue;
+
+					return JsonEvent::EndObject;
+
+				}
+
+				[[fallthrough]];
+
+			case State::Member:
+
+				if (c != '"') {
+					fail(c < 0 ? "Unexpected EOF while reading object" : "Missing member name");
+				}
+
+				readString(true);
+				state = State::Colon;
+
+				return JsonEvent::Name;
+
+			case State::Colon:
+
+				if (c != ':') {
+					fail("Missing ':' after member name");
+				}
+
+				position++;
+				state = State::Value;
+
+				break;
+
+			case State::AfterValue:
+
+				if (stack.empty()) {
+
+					if (c < 0) {
+
+						state = State::Done;
+						return JsonEvent::EndOfInput;
+
+					}
+
+					if (mode == Mode::Document) {
+						fail("Unexpected content after value");
+					}
+
+					state = State::Value;
+					break;
+
+				}
+
+				if (c == ',') {
+
+					position++;
+					state = stack.back() ? State::Member : State::Value;
+
+					break;
+
+				}
+
+				if (c == (stack.back() ? '}' : ']')) {
+
+					bool object = stack.back();
+
+					position++;
+					stack.pop_back();
+
+					return object ? JsonEvent::EndObject : JsonEvent::EndArray;
+
+				}
+
+				fail(c < 0 ? "Unexpected EOF while reading container" : "Missing ',' or container end");
+
+		}
+
+	}
+
+}
+
+
+
+void JsonReader::skipContainer() {
+
+	SizeT depth = stack.size();
+
+	while (stack.size() >= depth && state != State::Done) {
+		next();
+	}
+
+}
+
+
+
+void JsonReader::parse(JsonHandler& handler) {
+
+	while (true) {
+
+		JsonEvent event = next();
+
+		switch (event) {
+
+			case JsonEvent::StartObject:	handler.startObject();		break;
+			case JsonEvent::EndObject:		handler.endObject();		break;
+			case JsonEvent::StartArray:		handler.startArray();		break;
+			case JsonEvent::EndArray:		handler.endArray();			break;
+			case JsonEvent::Name:			handler.name(string);		break;
+			case JsonEvent::String:			handler.string(string);		break;
+			case JsonEvent::Boolean:		handler.boolean(boolean);	break;
+			case JsonEvent::Null:			handler.null();				break;
+
+			case JsonEvent::Number:
+
+				if (number.integer) {
+					handler.integer(number.i);
+				} else {
+					handler.floating(number.f);
+				}
+
+				break;
+
+			case JsonEvent::EndOfInput:
+				return;
+
+		}
+
+		if (event != JsonEvent::Name && stack.empty()) {
+			handler.endRecord();
+		}
+
+	}
+
+}
+
+
+
+//Returns the next non-whitespace character without consuming it, -1 at the end of input
+i32 JsonReader::peek() {
+
+	while (true) {
+
+		for (; position < size; position++) {
+
+			if (!isWhitespace(buffer[position])) {
+				return u8(buffer[position]);
+			}
+
+		}
+
+		if (!refill()) {
+			return -1;
+		}
+
+	}
+
+}
+
+/*
+ *  Moves the unread part of the buffer to its front and appends new input
+ *  If the buffer is entirely occupied by an unfinished token, it is doubled first.
+ *  Returns false if no new input is available.
+ */
+bool JsonReader::refill() {
+
+	if (exhausted) {
+		return false;
+	}
+
+	SizeT remaining = size - position;
+
+	if (remaining == capacity) {
+
+		if (capacity >= MaxTokenSize) {
+			fail("Token exceeds the maximum size");
+		}
+
+		std::unique_ptr<char[]> grown = std::make_unique_for_overwrite<char[]>(capacity * 2);
+		std::memcpy(grown.get(), buffer.get() + position, remaining);
+
+		buffer = std::move(grown);
+		capacity *= 2;
+
+	} else if (position) {
+
+		std::memmove(buffer.get(), buffer.get() + position, remaining);
+
+	}
+
+	consumed += position;
+	position = 0;
+	size = remaining;
+
+	SizeT count = source.read({ buffer.get() + size, capacity - size });
+
+	if (count == 0) {
+
+		exhausted = true;
+		return false;
+
+	}
+
+	size += count;
+
+	return true;
+
+}
+
+
+
+JsonEvent JsonReader::readValue(char c) {
+
+	switch (c) {
+
+		case '{':
+		case '[':
+
+			if (stack.size() == MaxDepth) {
+				fail("Maximum nesting depth exceeded");
+			}
+
+			position++;
+			stack.push_back(c == '{');
+			state = c == '{' ? State::FirstMember : State::FirstElement;
+
+			return c == '{' ? JsonEvent::StartObject : JsonEvent::StartArray;
+
+		case '"':
+
+			readString(false);
+			state = State::AfterValue;
+
+			return JsonEvent::String;
+
+		default:
+		{
+			const char* end = scanToken();
+			const char* p = buffer.get() + position;
+			StringView token(p, end - p);
+
+			JsonEvent event;
+
+			if (token == "true" || token == "false") {
+
+				boolean = token[0] == 't';
+				event = JsonEvent::Boolean;
+
+			} else if (token == "null") {
+
+				event = JsonEvent::Null;
+
+			} else if (!token.empty() && JsonScanner::readNumber(p, end, number) == end) {
+
+				event = JsonEvent::Number;
+
+			} else {
+
+				fail("Invalid value");
+
+			}
+
+			position = end - buffer.get();
+			state = State::AfterValue;
+
+			return event;
+		}
+
+	}
+
+}
+
+/*
+ *  Reads the string starting at the current position
+ *  Strings without escape sequences or control characters are returned as views into the buffer, others are decoded.
+ */
+void JsonReader::readString(bool name) {
+
+	SizeT i = position + 1;
+	bool plain = true;
+
+	while (true) {
+
+		i = JsonScanner::findStringSpecial(buffer.get() + i, buffer.get() + size) - buffer.get();
+
+		if (i < size) {
+
+			char c = buffer[i];
+
+			if (c == '"') {
+				break;
+			}
+
+			plain = false;
+
+			if (c != '\\') {
+
+				i++;
+				continue;
+
+			}
+
+			if (i + 1 < size) {
+
+				i += 2;
+				continue;
+
+			}
+
+		}
+
+		SizeT offset = i - position;
+
+		if (!refill()) {
+			fail("Unexpected EOF while reading string");
+		}
+
+		i = position + offset;
+
+	}
+
+	const char* p = buffer.get() + position;
+
+	if (plain) {
+
+		string = StringView(p + 1, i - position - 1);
+
+	} else {
+
+		decoded.clear();
+		JsonScanner::readString(p, buffer.get() + i + 1, decoded, name);
+		string = decoded;
+
+	}
+
+	position = i + 1;
+
+}
+
+//Returns the end of the number or literal at the current position, refilling until it is complete
+const char* JsonReader::scanToken() {
+
+	SizeT i = position;
+
+	while (true) {
+
+		while (i < size && isTokenChar(buffer[i])) {
+			i++;
+		}
+
+		if (i < size) {
+			break;
+		}
+
+		SizeT offset = i - position;
+		bool filled = refill();
+
+		i = position + offset;
+
+		if (!filled) {
+			break;
+		}
+
+	}
+
+	return buffer.get() + i;
+
+}
+
+void JsonReader::fail(const char* message) const {
+	throw JsonSyntaxError(String::format("%s at offset %llu", message, static_cast<unsigned long long>(getOffset())));
+}
+
+
+
+void JsonReader::dispatchLines(JsonInputSource& source, const std::function<void(StringView, u64)>& process, u32 workers, SizeT batchSize) {
+
+	struct Batch {
+
+		std::string text;
+		u64 firstLine;
+
+	};
+
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::condition_variable space;
+
+	std::deque<Batch> queue;
+	std::vector<std::string> spare;
+	SizeT inFlight = 0;
+	bool finished = false;
+	std::atomic<bool> stopped = false;
+	std::exception_ptr error;
+
+	auto stop = [&](std::exception_ptr exception) {
+
+		std::lock_guard lock(mutex);
+
+		if (!error) {
+			error = exception;
+		}
+
+		stopped = true;
+
+	};
+
+	auto work = [&]() {
+
+		while (true) {
+
+			Batch batch;
+
+			{
+				std::unique_lock lock(mutex);
+				ready.wait(lock, [&]() { return !queue.empty() || finished; });
+
+				if (queue.empty()) {
+					return;
+				}
+
+				batch = std::move(queue.front());
+				queue.pop_front();
+			}
+
+			try {
+
+				const char* p = batch.text.data();
+				const char* end = p + batch.text.size();
+				u64 line = batch.firstLine;
+
+				while (p < end && !stopped) {
+
+					const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+					lineEnd = lineEnd ? lineEnd : end;
+
+					StringView record(p, lineEnd - p);
+
+					if (std::any_of(record.begin(), record.end(), [](char c) { return !isWhitespace(c); })) {
+						process(record, line);
+					}
+
+					p = lineEnd + 1;
+					line++;
+
+				}
+
+			} catch (...) {
+
+				stop(std::current_exception());
+
+			}
+
+			{
+				std::lock_guard lock(mutex);
+				spare.push_back(std::move(batch.text));
+				inFlight--;
+			}
+
+			space.notify_one();
+
+		}
+
+	};
+
+	workers = workers ? workers : Math::max(Thread::getHardwareThreadCount(), 1u);
+	SizeT maxInFlight = workers * 2;
+
+	std::vector<Thread> threads(workers);
+
+	for (Thread& thread : threads) {
+		thread.start(work);
+	}
+
+	try {
+
+		std::string carry;
+		u64 line = 0;
+		bool end = false;
+
+		while (!end) {
+
+			std::string text;
+
+			{
+				std::unique_lock lock(mutex);
+				space.wait(lock, [&]() { return inFlight < maxInFlight || stopped; });
+
+				if (stopped) {
+					break;
+				}
+
+				if (!spare.empty()) {
+					text = std::move(spare.back());
+					spare.pop_back();
+				}
+			}
+
+			text.assign(carry);
+
+			//Read until the batch is full and contains a line break, lines longer than a batch grow it
+			SizeT cut;
+
+			while (true) {
+
+				SizeT filled = text.size();
+				SizeT target = filled < batchSize ? batchSize : filled * 2;
+
+				text.resize(target);
+				text.resize(filled + source.read({ text.data() + filled, target - filled }));
+
+				if (text.size() == filled) {
+
+					end = true;
+					cut = text.size();
+					break;
+
+				}
+
+				if (text.size() < target) {
+					continue;
+				}
+
+				SizeT lineBreak = text.rfind('\n');
+
+				if (lineBreak != std::string::npos) {
+
+					cut = lineBreak + 1;
+					break;
+
+				}
+
+			}
+
+			carry.assign(text, cut);
+			text.resize(cut);
+
+			u64 firstLine = line;
+			line += std::count(text.begin(), text.end(), '\n');
+
+			if (!text.empty()) {
+
+				{
+					std::lock_guard lock(mutex);
+					queue.push_back({std::move(text), firstLine});
+					inFlight++;
+				}
+
+				ready.notify_one();
+
+			}
+
+		}
+
+	} catch (...) {
+
+		stop(std::current_exception());
+
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		finished = true;
+	}
+
+	ready.notify_all();
+
+	for (Thread& thread : threads) {
+		thread.finish();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+}
@@ -0,0 +1,265 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 reader.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "value.hpp"
+#include "scanner.hpp"
+#include "filesystem/file.hpp"
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+
+
+/*
+ *  Chunked input of a JsonReader
+ *  read() fills at most the whole buffer and returns the number of bytes written, zero once the input is exhausted.
+ */
+class JsonInputSource {
+
+public:
+
+	virtual ~JsonInputSource() = default;
+
+	virtual SizeT read(std::span<char> buffer) = 0;
+
+};
+
+
+class JsonStringSource : public JsonInputSource {
+
+public:
+
+	explicit JsonStringSource(const Json::StringView& json) : json(json), offset(0) {}
+
+	SizeT read(std::span<char> buffer) override;
+
+private:
+
+	Json::StringView json;
+	SizeT offset;
+
+};
+
+
+class JsonFileSource : public JsonInputSource {
+
+public:
+
+	//Throws JsonException if the file cannot be opened
+	explicit JsonFileSource(const Path& path);
+
+	SizeT read(std::span<char> buffer) override;
+
+private:
+
+	File file;
+
+};
+
+
+
+enum class JsonEvent {
+	StartObject,
+	EndObject,
+	StartArray,
+	EndArray,
+	Name,
+	String,
+	Number,
+	Boolean,
+	Null,
+	EndOfInput
+};
+
+
+/*
+ *  Callback interface of JsonReader::parse()
+ *  Strings passed to the handler are only valid for the duration of the call.
+ */
+class JsonHandler {
+
+public:
+
+	virtual ~JsonHandler() = default;
+
+	virtual void startObject() {}
+	virtual void endObject() {}
+	virtual void startArray() {}
+	virtual void endArray() {}
+	virtual void name(const Json::StringView& /*name*/) {}
+	virtual void string(const Json::StringView& /*string*/) {}
+	virtual void integer(Json::IntegerType /*value*/) {}
+	virtual void floating(Json::FloatType /*value*/) {}
+	virtual void boolean(bool /*value*/) {}
+	virtual void null() {}
+
+	//Byte strings of binary formats, reported as strings by default
+	virtual void binary(std::span<const u8> data) {
+		string(Json::StringView(reinterpret_cast<const char*>(data.data()), data.size()));
+	}
+
+	//Called after every top level value
+	virtual void endRecord() {}
+
+};
+
+
+/*
+ *  Handler assembling events into a JsonValue
+ *  Holds the most recently completed top level value. Duplicate member names throw JsonSyntaxError.
+ */
+class JsonValueBuilder final : public JsonHandler {
+
+public:
+
+	void startObject() override;
+	void endObject() override;
+	void startArray() override;
+	void endArray() override;
+	void name(const Json::StringView& name) override;
+	void string(const Json::StringView& string) override;
+	void integer(Json::IntegerType value) override;
+	void floating(Json::FloatType value) override;
+	void boolean(bool value) override;
+	void null() override;
+
+	JsonValue& getValue() {
+		return value;
+	}
+
+private:
+
+	void add(JsonValue&& element);
+	void close();
+
+	std::vector<JsonValue> stack;
+	std::vector<Json::StringType> names;
+	JsonValue value;
+
+};
+
+
+
+/*
+ *  Streaming pull reader
+ *  The input is consumed in chunks through a fixed buffer. A token cut by the end of the buffer is moved to its front
+ *  before refilling, and the buffer only grows if a single token exceeds it, up to MaxTokenSize. Memory use is therefore
+ *  bounded by the largest token and the nesting depth, not by the size of the input.
+ *  In Lines mode the input is a sequence of top level values (NDJSON), otherwise it must contain exactly one.
+ *  Strict JSON only: comments are rejected.
+ */
+class JsonReader {
+
+public:
+
+	using StringView = Json::StringView;
+
+	enum class Mode {
+		Document,
+		Lines
+	};
+
+	constexpr static SizeT DefaultBufferSize = 64 * 1024;
+	constexpr static SizeT MaxTokenSize = 256 * 1024 * 1024;
+	constexpr static SizeT MaxDepth = 4096;
+
+	explicit JsonReader(JsonInputSource& source, Mode mode = Mode::Document, SizeT bufferSize = DefaultBufferSize);
+
+	//Advances to the next event, throws JsonSyntaxError on malformed input
+	JsonEvent next();
+
+	//Skips the rest of the object or array that was just started
+	void skipContainer();
+
+	//Reads all events into handler
+	void parse(JsonHandler& handler);
+
+
+	//Name or string of the current event, valid until the next call to next()
+	StringView getString() const {
+		return string;
+	}
+
+	bool isInteger() const {
+		return number.integer;
+	}
+
+	template<CC::JsonNumber T>
+	T getNumber() const {
+		return number.integer ? static_cast<T>(number.i) : static_cast<T>(number.f);
+	}
+
+	bool getBoolean() const {
+		return boolean;
+	}
+
+	//Number of open containers
+	SizeT getDepth() const {
+		return stack.size();
+	}
+
+	//Offset of the next unread byte in the input
+	u64 getOffset() const {
+		return consumed + position;
+	}
+
+
+	/*
+	 *  Splits newline delimited JSON into records and passes them to process on a pool of worker threads
+	 *  The input is read in batches of whole lines, at most two batches per worker are in flight at any time.
+	 *  process receives the text of a record and its zero-based line number, blank lines are skipped.
+	 *  Records are processed out of order. The first exception thrown stops the input and is rethrown once all workers finished.
+	 *  A worker count of zero uses one worker per hardware thread.
+	 */
+	static void dispatchLines(JsonInputSource& source, const std::function<void(StringView, u64)>& process, u32 workers = 0, SizeT batchSize = 1024 * 1024);
+
+private:
+
+	enum class State : u8 {
+		Value,
+		FirstElement,
+		FirstMember,
+		Member,
+		Colon,
+		AfterValue,
+		Done
+	};
+
+	i32 peek();
+	bool refill();
+
+	JsonEvent readValue(char c);
+	void readString(bool name);
+	const char* scanToken();
+
+	[[noreturn]] void fail(const char* message) const;
+
+	JsonInputSource& source;
+	Mode mode;
+
+	std::unique_ptr<char[]> buffer;
+	SizeT capacity;
+	SizeT size;
+	SizeT position;
+	u64 consumed;
+	bool exhausted;
+
+	State state;
+	std::vector<bool> stack;
+
+	StringView string;
+	Json::StringType decoded;
+	JsonScanner::Number number;
+	bool boolean;
+
+};
@@ -0,0 +1,542 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 scanner.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "locale/unicode.hpp"
+#include "util/bits.hpp"
+#include "util/char.hpp"
+#include "arcintrinsic.hpp"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+
+
+/*
+ *  Low level JSON lexing shared by the readers
+ *  All functions operate on raw [p, end) ranges and never read past end.
+ */
+namespace JsonScanner {
+
+	struct Number {
+
+		bool integer;
+
+		union {
+			Json::IntegerType i;
+			Json::FloatType f;
+		};
+
+	};
+
+
+	constexpr u32 BlockSize = 64;
+
+	// Character classes of a 64 byte block, bit i standing for byte i
+	struct BlockMasks {
+
+		u64 quote;
+		u64 backslash;
+		u64 whitespace;
+		u64 open;
+		u64 close;
+		u64 op;
+		u64 slash;
+
+	};
+
+
+	/*
+	 *  Classifies the block starting at p
+	 *  Blocks running past end are padded with whitespace, which neither opens nor extends any token.
+	 */
+	inline BlockMasks classifyBlock(const char* p, const char* end) {
+
+		char padded[BlockSize];
+
+		if (end - p < BlockSize) {
+
+			std::memset(padded, ' ', BlockSize);
+			std::memcpy(padded, p, end - p);
+
+			p = padded;
+
+		}
+
+		BlockMasks masks;
+
+#ifdef ARC_VECTORIZE_X86_AVX2
+
+		auto classify = [](__m256i v, u32 (&bits)[7]) {
+
+			// ORing 0x20 maps '[' and ']' onto '{' and '}'
+			__m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+			__m256i open = _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{'));
+			__m256i close = _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'));
+			__m256i separator = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+
+			__m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+			ws = _mm256_or_si256(ws, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+
+			bits[0] = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+			bits[1] = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+			bits[2] = _mm256_movemask_epi8(ws);
+			bits[3] = _mm256_movemask_epi8(open);
+			bits[4] = _mm256_movemask_epi8(close);
+			bits[5] = _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(open, close), separator));
+			bits[6] = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+
+		};
+
+		u32 lo[7], hi[7];
+
+		classify(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), lo);
+		classify(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), hi);
+
+		masks.quote = lo[0] | u64(hi[0]) << 32;
+		masks.backslash = lo[1] | u64(hi[1]) << 32;
+		masks.whitespace = lo[2] | u64(hi[2]) << 32;
+		masks.open = lo[3] | u64(hi[3]) << 32;
+		masks.close = lo[4] | u64(hi[4]) << 32;
+		masks.op = lo[5] | u64(hi[5]) << 32;
+		masks.slash = lo[6] | u64(hi[6]) << 32;
+
+#else
+
+		masks = {};
+
+		for (u32 i = 0; i < BlockSize; i++) {
+
+			u64 bit = u64(1) << i;
+
+			switch (p[i]) {
+
+				case '"':	masks.quote |= bit;			break;
+				case '\\':	masks.backslash |= bit;		break;
+				case '/':	masks.slash |= bit;			break;
+
+				case ' ':
+				case '\t':
+				case '\r':
+				case '\n':
+					masks.whitespace |= bit;
+					break;
+
+				case '{':
+				case '[':
+					masks.open |= bit;
+					masks.op |= bit;
+					break;
+
+				case '}':
+				case ']':
+					masks.close |= bit;
+					masks.op |= bit;
+					break;
+
+				case ':':
+				case ',':
+					masks.op |= bit;
+					break;
+
+				default:
+					break;
+
+			}
+
+		}
+
+#endif
+
+		return masks;
+
+	}
+
+
+	/*
+	 *  Returns the characters escaped by a backslash
+	 *  Runs of backslashes starting on an even position escape the character after them if they end on an odd one
+	 *  and vice versa, which a single subtraction carries through the whole run.
+	 */
+	constexpr u64 findEscaped(u64 backslash, u64& carry) {
+
+		constexpr u64 OddBits = 0xAAAAAAAAAAAAAAAA;
+
+		u64 potential = backslash & ~carry;
+		u64 escapeAndTerminal = (((potential << 1) | OddBits) - potential) ^ OddBits;
+		u64 escaped = escapeAndTerminal ^ (backslash | carry);
+
+		carry = (escapeAndTerminal & backslash) >> 63;
+
+		return escaped;
+
+	}
+
+
+	// Bit i of the result is the parity of bits 0 to i
+	constexpr u64 prefixXor(u64 x) {
+
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+
+		return x;
+
+	}
+
+
+	// Returns the first '"', '\' or control character in [p, end), or end if there is none
+	ARC_FORCE_INLINE const char* findStringSpecial(const char* p, const char* end) {
+
+#ifdef ARC_VECTORIZE_X86_AVX2
+
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i control = _mm256_set1_epi8(0x1F);
+
+		for (; end - p >= 32; p += 32) {
+
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			__m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash));
+			special = _mm256_or_si256(special, _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+
+			u32 mask = _mm256_movemask_epi8(special);
+
+			if (mask) {
+				return p + Bits::ctz(mask);
+			}
+
+		}
+
+#endif
+
+#ifdef ARC_VECTORIZE_X86_SSE2
+
+		const __m128i quote16 = _mm_set1_epi8('"');
+		const __m128i backslash16 = _mm_set1_epi8('\\');
+		const __m128i control16 = _mm_set1_epi8(0x1F);
+
+		for (; end - p >= 16; p += 16) {
+
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote16), _mm_cmpeq_epi8(v, backslash16));
+			special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(v, control16), v));
+
+			u32 mask = _mm_movemask_epi8(special);
+
+			if (mask) {
+				return p + Bits::ctz(mask);
+			}
+
+		}
+
+#endif
+
+		for (; p < end; p++) {
+
+			u8 c = *p;
+
+			if (c == '"' || c == '\\' || c < 0x20) {
+				return p;
+			}
+
+		}
+
+		return end;
+
+	}
+
+
+	// Returns true if p may follow a scalar: whitespace, a structural character or the end of input
+	constexpr bool isDelimiter(const char* p, const char* end) {
+
+		if (p == end) {
+			return true;
+		}
+
+		switch (*p) {
+
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+			case ',':
+			case ':':
+			case ']':
+			case '}':
+				return true;
+
+			default:
+				return false;
+
+		}
+
+	}
+
+
+	// Parses four hex digits, returns -1 if any is invalid
+	constexpr i32 parseHex4(const char* p) {
+
+		i32 value = 0;
+
+		for (u32 i = 0; i < 4; i++) {
+
+			char c = p[i];
+			i32 digit;
+
+			if (c >= '0' && c <= '9') {
+				digit = c - '0';
+			} else if (c >= 'a' && c <= 'f') {
+				digit = c - 'a' + 10;
+			} else if (c >= 'A' && c <= 'F') {
+				digit = c - 'A' + 10;
+			} else {
+				return -1;
+			}
+
+			value = value << 4 | digit;
+
+		}
+
+		return value;
+
+	}
+
+
+	/*
+	 *  Decodes the escape sequence following the backslash at p and appends it as UTF-8.
+	 *  Returns the first character after the sequence. \uXXXX escapes of UTF-16 surrogate pairs must come as a pair.
+	 */
+	inline const char* readEscape(const char* p, const char* end, Json::StringType& string) {
+
+		if (end - p < 2) {
+			throw JsonSyntaxError("Unexpected EOF in escape sequence");
+		}
+
+		switch (p[1]) {
+
+			case '"':	string += '"';	return p + 2;
+			case '\\':	string += '\\';	return p + 2;
+			case '/':	string += '/';	return p + 2;
+			case 'b':	string += '\b';	return p + 2;
+			case 'f':	string += '\f';	return p + 2;
+			case 'n':	string += '\n';	return p + 2;
+			case 'r':	string += '\r';	return p + 2;
+			case 't':	string += '\t';	return p + 2;
+
+			case 'u':
+				break;
+
+			default:
+				throw JsonSyntaxError("Invalid escape sequence found");
+
+		}
+
+		if (end - p < 6) {
+			throw JsonSyntaxError("Unexpected EOF in unicode escape sequence");
+		}
+
+		i32 unit = parseHex4(p + 2);
+
+		if (unit < 0) {
+			throw JsonSyntaxError("Invalid unicode escape sequence found");
+		}
+
+		Unicode::Codepoint codepoint = unit;
+		p += 6;
+
+		if (unit >= 0xD800 && unit <= 0xDBFF) {
+
+			// High surrogate, the low one must follow immediately
+			if (end - p < 6 || p[0] != '\\' || p[1] != 'u') {
+				throw JsonSyntaxError("Unpaired high surrogate in unicode escape sequence");
+			}
+
+			i32 low = parseHex4(p + 2);
+
+			if (low < 0xDC00 || low > 0xDFFF) {
+				throw JsonSyntaxError("Unpaired high surrogate in unicode escape sequence");
+			}
+
+			codepoint = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+			p += 6;
+
+		} else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+
+			throw JsonSyntaxError("Unpaired low surrogate in unicode escape sequence");
+
+		}
+
+		char buffer[4];
+		SizeT size = Unicode::encode<Unicode::UTF8>(codepoint, buffer);
+
+		string.append(buffer, size);
+
+		return p;
+
+	}
+
+
+	/*
+	 *  Reads a string whose opening quote is at p and appends its decoded content.
+	 *  Unescaped runs are found with SIMD and appended in bulk. Returns the position of the closing quote.
+	 *  Strings cannot contain line breaks, names additionally cannot contain tabs.
+	 */
+	inline const char* readString(const char* p, const char* end, Json::StringType& string, bool name) {
+
+		if (p == end || *p != '"') {
+			throw JsonSyntaxError("Missing string opener");
+		}
+
+		p++;
+
+		while (true) {
+
+			const char* special = findStringSpecial(p, end);
+
+			string.append(p, special);
+			p = special;
+
+			if (p == end) {
+				throw JsonSyntaxError("Unexpected EOF while reading string");
+			}
+
+			switch (*p) {
+
+				case '"':
+					return p;
+
+				case '\\':
+					p = readEscape(p, end, string);
+					break;
+
+				case '\n':
+				case '\r':
+					throw JsonSyntaxError("Unterminated string sequence found");
+
+				case '\t':
+
+					if (name) {
+						throw JsonSyntaxError("Tab found inside name");
+					}
+
+					[[fallthrough]];
+
+				default:
+					string += *p++;
+					break;
+
+			}
+
+		}
+
+	}
+
+
+	/*
+	 *  Parses the number at p into number, returns the first character after it or nullptr if there is no valid number.
+	 *  The grammar is the one of RFC 8259, fractions and exponents need at least one digit and integer parts have no leading zeros.
+	 *  Numbers without fraction and exponent are integers unless they overflow Json::IntegerType.
+	 *  Conversion is done by std::from_chars, which is exact and allocation free.
+	 */
+	inline const char* readNumber(const char* p, const char* end, Number& number) {
+
+		auto skipDigits = [end](const char* q) {
+
+			while (q != end && Character::isDigit(*q)) {
+				q++;
+			}
+
+			return q;
+
+		};
+
+		const char* q = p;
+
+		if (q != end && *q == '-') {
+			q++;
+		}
+
+		if (q == end || !Character::isDigit(*q)) {
+			return nullptr;
+		}
+
+		// A leading zero ends the integer part, callers reject the digits following it as a missing delimiter
+		q = *q == '0' ? q + 1 : skipDigits(q);
+
+		bool integer = true;
+
+		if (q != end && *q == '.') {
+
+			q++;
+
+			if (q == end || !Character::isDigit(*q)) {
+				return nullptr;
+			}
+
+			q = skipDigits(q);
+			integer = false;
+
+		}
+
+		if (q != end && (*q == 'e' || *q == 'E')) {
+
+			q++;
+
+			if (q != end && (*q == '+' || *q == '-')) {
+				q++;
+			}
+
+			if (q == end || !Character::isDigit(*q)) {
+				return nullptr;
+			}
+
+			q = skipDigits(q);
+			integer = false;
+
+		}
+
+		if (integer) {
+
+			auto result = std::from_chars(p, q, number.i);
+
+			if (result.ec == std::errc()) {
+
+				number.integer = true;
+				return q;
+
+			}
+
+		}
+
+		auto result = std::from_chars(p, q, number.f, std::chars_format::general);
+
+		if (result.ec == std::errc::result_out_of_range) {
+
+			// from_chars leaves the value untouched on overflow and underflow, strtod rounds to infinity or zero
+			number.f = std::strtod(Json::StringType(p, q).c_str(), nullptr);
+
+		} else if (result.ec != std::errc()) {
+
+			return nullptr;
+
+		}
+
+		number.integer = false;
+
+		return q;
+
+	}
+
+}
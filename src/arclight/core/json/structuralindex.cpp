@@ -0,0 +1,83 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 structuralindex.cpp
+ */
+
+#include "structuralindex.hpp"
+#include "scanner.hpp"
+#include "util/bits.hpp"
+
+#include <limits>
+
+
+
+bool JsonStructuralIndex::build(const StringView& json) {
+
+	count = 0;
+
+	if (json.size() >= std::numeric_limits<u32>::max()) {
+		return false;
+	}
+
+	if (capacity < json.size() + BlockSize) {
+
+		capacity = json.size() + BlockSize;
+		positions = std::make_unique_for_overwrite<u32[]>(capacity);
+
+	}
+
+	u64 escapeCarry = 0;
+	u64 stringCarry = 0;
+	u64 scalarCarry = 0;
+
+	u32* out = positions.get();
+
+	for (SizeT offset = 0; offset < json.size(); offset += BlockSize) {
+
+		JsonScanner::BlockMasks masks = JsonScanner::classifyBlock(json.data() + offset, json.data() + json.size());
+
+		u64 escaped = JsonScanner::findEscaped(masks.backslash, escapeCarry);
+		u64 quote = masks.quote & ~escaped;
+
+		// Opening quotes and string contents are set, closing quotes are not
+		u64 string = JsonScanner::prefixXor(quote) ^ stringCarry;
+		stringCarry = u64(i64(string) >> 63);
+
+		if (masks.slash & ~string) {
+			return false;
+		}
+
+		u64 op = masks.op & ~string;
+		u64 scalar = ~(op | masks.whitespace | quote | string);
+		u64 scalarStart = scalar & ~(scalar << 1 | scalarCarry);
+		scalarCarry = scalar >> 63;
+
+		u64 structural = op | scalarStart | (quote & string);
+
+		u32 base = offset;
+
+		while (structural) {
+
+			*out++ = base + Bits::ctz(structural);
+			structural &= structural - 1;
+
+		}
+
+	}
+
+	count = out - positions.get();
+
+	return !stringCarry;
+
+}
+
+void JsonStructuralIndex::clear() {
+
+	positions.reset();
+	count = 0;
+	capacity = 0;
+
+}
@@ -0,0 +1,63 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 structuralindex.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+
+#include <memory>
+#include <span>
+
+
+
+/*
+ *  Stage one of the indexed JSON reader
+ *  Classifies the input 64 bytes at a time into bitmasks, resolves escaped quotes and string regions without branching
+ *  and records the offset of every structural character ({}[]:,), every opening quote and the first character of every
+ *  other scalar. Whitespace and string contents never show up in the index.
+ *  The index is not a validator: it only fails if the input cannot be indexed, that is if it contains comments,
+ *  an unterminated string or exceeds 4 GiB. Everything else is left to the consumer of the index.
+ *  The position buffer is sized for the worst case of one entry per byte but left uninitialized, so on demand paged systems
+ *  only the part actually written is committed. It is kept across builds.
+ */
+class JsonStructuralIndex {
+
+public:
+
+	using StringView = Json::StringView;
+
+	static constexpr u32 BlockSize = 64;
+
+	JsonStructuralIndex() : count(0), capacity(0) {}
+
+	bool build(const StringView& json);
+	void clear();
+
+	std::span<const u32> getPositions() const {
+		return { positions.get(), count };
+	}
+
+	SizeT size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	u32 operator[](SizeT index) const {
+		return positions[index];
+	}
+
+private:
+
+	std::unique_ptr<u32[]> positions;
+	SizeT count;
+	SizeT capacity;
+
+};
@@ -22,6 +22,10 @@ auto JsonValue::toString() const -> StringType {
 	return safeCast<StringType>();
 }
 
+Json::StringView JsonValue::toStringView() const {
+	return safeCastRef<StringType>();
+}
+
 JsonArray& JsonValue::toArray() {
 	return const_cast<JsonArray&>(std::as_const(*this).toArray());
 }
@@ -55,6 +55,7 @@ public:
 
 	bool toBoolean() const;
 	StringType toString() const;
+	Json::StringView toStringView() const;
 	JsonArray& toArray();
 	JsonObject& toObject();
 	const JsonArray& toArray() const;
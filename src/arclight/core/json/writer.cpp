@@ -0,0 +1,450 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 writer.cpp
+ */
+
+#include "writer.hpp"
+#include "flatdocument.hpp"
+#include "scanner.hpp"
+#include "value.hpp"
+#include "array.hpp"
+#include "object.hpp"
+#include "filesystem/path.hpp"
+#include "math/math.hpp"
+#include "util/assert.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+
+
+JsonFileSink::JsonFileSink(const Path& path) {
+
+	if (!file.open(path, File::Out | File::Trunc)) {
+		throw JsonException("Failed to open file " + path.toString());
+	}
+
+}
+
+void JsonFileSink::write(std::span<const char> data) {
+	file.write({ reinterpret_cast<const u8*>(data.data()), data.size() });
+}
+
+
+
+JsonWriter::JsonWriter(bool compact) : sink(nullptr), compact(compact), afterName(false), records(0), used(0), indentation("\n") {}
+
+JsonWriter::JsonWriter(JsonOutputSink& sink, bool compact, SizeT bufferSize) :
+	sink(&sink), compact(compact), afterName(false), records(0), buffer(bufferSize, '\0'), used(0), indentation("\n") {}
+
+JsonWriter::~JsonWriter() {
+	flush();
+}
+
+
+
+void JsonWriter::write(const JsonValue& value) {
+
+	switch (value.getType()) {
+
+		case Json::Type::String:
+			string(value.toStringView());
+			break;
+
+		case Json::Type::Number:
+
+			if (value.isInteger()) {
+				integer(value.toNumber<Json::IntegerType>());
+			} else {
+				floating(value.toNumber<Json::FloatType>());
+			}
+
+			break;
+
+		case Json::Type::Object:
+
+			startObject();
+
+			for (const auto& [key, member] : value.toObject()) {
+
+				name(key);
+				write(member);
+
+			}
+
+			endObject();
+			break;
+
+		case Json::Type::Array:
+
+			startArray();
+
+			for (const JsonValue& element : value.toArray()) {
+				write(element);
+			}
+
+			endArray();
+			break;
+
+		case Json::Type::Boolean:
+			boolean(value.toBoolean());
+			break;
+
+		case Json::Type::Null:
+		case Json::Type::None:
+			null();
+			break;
+
+	}
+
+}
+
+void JsonWriter::write(const JsonNode& node) {
+
+	switch (node.getType()) {
+
+		case Json::Type::String:
+			string(node.toString());
+			break;
+
+		case Json::Type::Number:
+
+			if (node.isInteger()) {
+				integer(node.toNumber<Json::IntegerType>());
+			} else {
+				floating(node.toNumber<Json::FloatType>());
+			}
+
+			break;
+
+		case Json::Type::Object:
+
+			startObject();
+
+			for (const JsonMember& member : node.getMembers()) {
+
+				name(member.name);
+				write(member.value);
+
+			}
+
+			endObject();
+			break;
+
+		case Json::Type::Array:
+
+			startArray();
+
+			for (const JsonNode& element : node.getElements()) {
+				write(element);
+			}
+
+			endArray();
+			break;
+
+		case Json::Type::Boolean:
+			boolean(node.toBoolean());
+			break;
+
+		case Json::Type::Null:
+		case Json::Type::None:
+			null();
+			break;
+
+	}
+
+}
+
+
+
+void JsonWriter::startObject() {
+
+	separate();
+	put('{');
+	counts.push_back(0);
+
+}
+
+void JsonWriter::endObject() {
+	close('}');
+}
+
+void JsonWriter::startArray() {
+
+	separate();
+	put('[');
+	counts.push_back(0);
+
+}
+
+void JsonWriter::endArray() {
+	close(']');
+}
+
+void JsonWriter::name(const StringView& name) {
+
+	separate();
+	writeString(name);
+	put(':');
+
+	if (!compact) {
+		put(' ');
+	}
+
+	afterName = true;
+
+}
+
+void JsonWriter::string(const StringView& string) {
+
+	separate();
+	writeString(string);
+
+}
+
+void JsonWriter::integer(Json::IntegerType value) {
+
+	separate();
+
+	char* p = reserve(24);
+	used = std::to_chars(p, p + 24, value).ptr - buffer.data();
+
+}
+
+void JsonWriter::floating(Json::FloatType value) {
+
+	separate();
+
+	if (!std::isfinite(value)) {
+
+		append("null", 4);
+		return;
+
+	}
+
+	char* p = reserve(32);
+	char* end = std::to_chars(p, p + 30, value).ptr;
+
+	//Keep the value a float when read back
+	if (std::find_if(p, end, [](char c) { return c == '.' || c == 'e'; }) == end) {
+
+		*end++ = '.';
+		*end++ = '0';
+
+	}
+
+	used = end - buffer.data();
+
+}
+
+void JsonWriter::boolean(bool value) {
+
+	separate();
+
+	if (value) {
+		append("true", 4);
+	} else {
+		append("false", 5);
+	}
+
+}
+
+void JsonWriter::null() {
+
+	separate();
+	append("null", 4);
+
+}
+
+
+
+void JsonWriter::flush() {
+
+	if (sink && used) {
+
+		sink->write({ buffer.data(), used });
+		used = 0;
+
+	}
+
+}
+
+auto JsonWriter::release() -> StringType {
+
+	arc_assert(!sink, "Cannot release the output of a writer with a sink");
+
+	buffer.resize(used);
+	used = 0;
+	records = 0;
+
+	return std::move(buffer);
+
+}
+
+
+
+//Writes the separator and indentation in front of a value or name
+void JsonWriter::separate() {
+
+	if (afterName) {
+
+		afterName = false;
+		return;
+
+	}
+
+	if (counts.empty()) {
+
+		if (records++) {
+			put('\n');
+		}
+
+		return;
+
+	}
+
+	if (counts.back()++) {
+		put(',');
+	}
+
+	if (!compact) {
+		newline(counts.size());
+	}
+
+}
+
+void JsonWriter::close(char c) {
+
+	arc_assert(!counts.empty(), "No container open");
+
+	u32 count = counts.back();
+	counts.pop_back();
+
+	if (!compact && count) {
+		newline(counts.size());
+	}
+
+	put(c);
+
+}
+
+//Line break followed by the indentation of level, taken from a prefix of a cached string
+void JsonWriter::newline(SizeT level) {
+
+	SizeT size = 1 + level * IndentationLevel;
+
+	if (indentation.size() < size) {
+		indentation.resize(size * 2, IndentationChar);
+	}
+
+	append(indentation.data(), size);
+
+}
+
+void JsonWriter::writeString(const StringView& string) {
+
+	static constexpr char Hex[] = "0123456789abcdef";
+
+	put('"');
+
+	const char* p = string.data();
+	const char* end = p + string.size();
+
+	while (true) {
+
+		const char* special = JsonScanner::findStringSpecial(p, end);
+		append(p, special - p);
+
+		if (special == end) {
+			break;
+		}
+
+		char* out = reserve(6);
+		u8 c = *special;
+
+		out[0] = '\\';
+
+		switch (c) {
+
+			case '"':	out[1] = '"';	used += 2; break;
+			case '\\':	out[1] = '\\';	used += 2; break;
+			case '\b':	out[1] = 'b';	used += 2; break;
+			case '\f':	out[1] = 'f';	used += 2; break;
+			case '\n':	out[1] = 'n';	used += 2; break;
+			case '\r':	out[1] = 'r';	used += 2; break;
+			case '\t':	out[1] = 't';	used += 2; break;
+
+			default:
+
+				std::memcpy(out + 1, "u00", 3);
+				out[4] = Hex[c >> 4];
+				out[5] = Hex[c & 0xF];
+				used += 6;
+
+				break;
+
+		}
+
+		p = special + 1;
+
+	}
+
+	put('"');
+
+}
+
+
+
+//Returns space for size bytes at the end of the output, which the caller commits by advancing used
+char* JsonWriter::reserve(SizeT size) {
+
+	if (buffer.size() - used < size) {
+
+		if (sink) {
+
+			flush();
+
+			if (buffer.size() < size) {
+				buffer.resize(size);
+			}
+
+		} else {
+
+			buffer.resize(Math::max(Math::max(buffer.size() * 2, used + size), SizeT(256)));
+
+		}
+
+	}
+
+	return buffer.data() + used;
+
+}
+
+void JsonWriter::append(const char* data, SizeT size) {
+
+	//Runs larger than the buffer bypass it
+	if (sink && size > buffer.size() - used && size >= buffer.size() / 2) {
+
+		flush();
+		sink->write({ data, size });
+
+		return;
+
+	}
+
+	std::memcpy(reserve(size), data, size);
+	used += size;
+
+}
+
+void JsonWriter::put(char c) {
+
+	*reserve(1) = c;
+	used++;
+
+}
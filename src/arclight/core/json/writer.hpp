@@ -0,0 +1,125 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 writer.hpp
+ */
+
+#pragma once
+
+#include "common.hpp"
+#include "reader.hpp"
+#include "filesystem/file.hpp"
+
+#include <span>
+#include <vector>
+
+
+
+class JsonValue;
+class JsonNode;
+
+
+
+/*
+ *  Output of a JsonWriter
+ *  write() receives the serialized text in chunks of arbitrary size.
+ */
+class JsonOutputSink {
+
+public:
+
+	virtual ~JsonOutputSink() = default;
+
+	virtual void write(std::span<const char> data) = 0;
+
+};
+
+
+class JsonFileSink : public JsonOutputSink {
+
+public:
+
+	//Throws JsonException if the file cannot be opened
+	explicit JsonFileSink(const Path& path);
+
+	void write(std::span<const char> data) override;
+
+private:
+
+	File file;
+
+};
+
+
+
+/*
+ *  JSON serializer
+ *  Writes either into an internal string, obtained with release(), or through a fixed buffer into a JsonOutputSink, in which case
+ *  memory use does not depend on the output size. Values are written whole with write() or as a sequence of events mirroring JsonHandler,
+ *  so a JsonReader can be piped into a writer directly. Top level values following each other are separated by line breaks (NDJSON).
+ *  Numbers are formatted by std::to_chars in their shortest round-trip form, floats always keep a fraction or exponent and
+ *  non-finite floats are written as null. Strings are scanned for characters to escape with SIMD and copied in bulk between them.
+ */
+class JsonWriter final : public JsonHandler {
+
+public:
+
+	using StringType = Json::StringType;
+	using StringView = Json::StringView;
+
+	static constexpr u32 IndentationLevel = 2;
+	static constexpr char IndentationChar = ' ';
+	static constexpr SizeT DefaultBufferSize = 64 * 1024;
+
+	explicit JsonWriter(bool compact = false);
+	explicit JsonWriter(JsonOutputSink& sink, bool compact = false, SizeT bufferSize = DefaultBufferSize);
+	~JsonWriter() override;
+
+	JsonWriter(const JsonWriter& writer) = delete;
+	JsonWriter& operator=(const JsonWriter& writer) = delete;
+
+	void write(const JsonValue& value);
+	void write(const JsonNode& node);
+
+	void startObject() override;
+	void endObject() override;
+	void startArray() override;
+	void endArray() override;
+	void name(const StringView& name) override;
+	void string(const StringView& string) override;
+	void integer(Json::IntegerType value) override;
+	void floating(Json::FloatType value) override;
+	void boolean(bool value) override;
+	void null() override;
+
+	//Passes buffered output to the sink, called on destruction
+	void flush();
+
+	//Returns the output written so far and starts over, only without a sink
+	StringType release();
+
+private:
+
+	void separate();
+	void close(char c);
+	void newline(SizeT level);
+	void writeString(const StringView& string);
+
+	char* reserve(SizeT size);
+	void append(const char* data, SizeT size);
+	void put(char c);
+
+	JsonOutputSink* sink;
+	bool compact;
+	bool afterName;
+	u64 records;
+
+	StringType buffer;
+	SizeT used;
+
+	std::vector<u32> counts;
+	StringType indentation;
+
+};
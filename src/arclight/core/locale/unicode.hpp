@@ -287,8 +287,8 @@ namespace Unicode {
 
 			if (codepoint >= 0x10000) {
 
-				T lowSurrogate = 0xDC00 + codepoint & 0x3FF;
-				T highSurrogate = 0xD800 + (codepoint >> 10);
+				T lowSurrogate = 0xDC00 + (codepoint & 0x3FF);
+				T highSurrogate = 0xD800 + ((codepoint - 0x10000) >> 10);
 
 				if constexpr (convert) {
 					lowSurrogate = Bits::swap16(lowSurrogate);
@@ -367,7 +367,7 @@ namespace Unicode {
 				c0 = Bits::swap16(c0);
 			}
 
-			if ((c0 & 0xD800) == 0xD800) {
+			if ((c0 & 0xF800) == 0xD800) {
 
 				T c1 = p[1];
 
@@ -377,7 +377,7 @@ namespace Unicode {
 
 				//Assume we have a low-surrogate in c1
 				count = 2;
-				return Codepoint(c0 & 0x3FF) << 10 | (c1 & 0x3FF);
+				return 0x10000 + (Codepoint(c0 & 0x3FF) << 10 | (c1 & 0x3FF));
 
 			} else {
 
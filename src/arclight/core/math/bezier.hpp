@@ -13,6 +13,7 @@
 #include "rectangle.hpp"
 #include "line.hpp"
 
+#include <algorithm>
 #include <array>
 #include <span>
 
@@ -27,6 +28,8 @@ public:
 	using Type = F;
 	constexpr static u32 Order = Degree;
 
+	constexpr static u32 MaxFlattenDepth = 16;
+
 
 	constexpr Bezier() : Bezier(Vec2<F>(0, 0)) {}
 
@@ -51,6 +54,202 @@ public:
 	}
 
 
+	//Evaluates the curve at points.size() equidistant parameters from 0 to 1 by forward differencing
+	constexpr void evaluateUniform(std::span<Vec2<F>> points) const {
+
+		SizeT count = points.size();
+
+		if (count < 2) {
+
+			if (count) {
+				points[0] = getStartPoint();
+			}
+
+			return;
+
+		}
+
+		double dx[Degree + 1], dy[Degree + 1];
+		forwardDifferences(dx, dy, count - 1);
+
+		for (SizeT i = 0; i < count - 1; i++) {
+
+			points[i] = Vec2<F>(dx[0], dy[0]);
+
+			for (u32 j = 0; j < Degree; j++) {
+
+				dx[j] += dx[j + 1];
+				dy[j] += dy[j + 1];
+
+			}
+
+		}
+
+		points[count - 1] = getEndPoint();
+
+	}
+
+
+	/*
+	 *  Flattens the curve into a polyline deviating at most tolerance from it by adaptive subdivision.
+	 *  Writes the start point followed by the end point of every segment and returns the number of points the polyline has.
+	 *  If points is too small, only the leading points are written; the return value tells the required size.
+	 */
+	constexpr SizeT flatten(std::span<Vec2<F>> points, F tolerance) const {
+
+		arc_assert(tolerance > 0, "Flattening tolerance must be positive");
+
+		struct Segment {
+
+			Vec2<F> points[Degree + 1];
+			u32 depth;
+
+		};
+
+		Segment stack[MaxFlattenDepth + 1];
+		u32 stackSize = 1;
+		SizeT count = 0;
+
+		auto emit = [&](const Vec2<F>& p) {
+
+			if (count < points.size()) {
+				points[count] = p;
+			}
+
+			count++;
+
+		};
+
+		std::copy_n(controlPoints, Degree + 1, stack[0].points);
+		stack[0].depth = 0;
+
+		emit(getStartPoint());
+
+		F toleranceSquared = tolerance * tolerance;
+
+		while (stackSize) {
+
+			Segment segment = stack[--stackSize];
+
+			if (segment.depth == MaxFlattenDepth || isFlat(segment.points, toleranceSquared)) {
+
+				emit(segment.points[Degree]);
+				continue;
+
+			}
+
+			//Push the right half first so that the left one is emitted first
+			Segment& right = stack[stackSize++];
+			Segment& left = stack[stackSize++];
+
+			split(segment.points, left.points, right.points);
+			left.depth = right.depth = segment.depth + 1;
+
+		}
+
+		return count;
+
+	}
+
+
+	/*
+	 *  Fills table with the cumulative arc length at table.size() equidistant parameters, returns the total length.
+	 *  Lengths are measured along the chords between the sampled points, hence larger tables approximate the curve better.
+	 */
+	constexpr F arcLengthTable(std::span<F> table) const {
+
+		SizeT count = table.size();
+
+		arc_assert(count >= 2, "Arc length table requires at least two entries");
+
+		double dx[Degree + 1], dy[Degree + 1];
+		forwardDifferences(dx, dy, count - 1);
+
+		Vec2<F> last = getStartPoint();
+		table[0] = 0;
+
+		for (SizeT i = 1; i < count; i++) {
+
+			for (u32 j = 0; j < Degree; j++) {
+
+				dx[j] += dx[j + 1];
+				dy[j] += dy[j + 1];
+
+			}
+
+			Vec2<F> current = i == count - 1 ? getEndPoint() : Vec2<F>(dx[0], dy[0]);
+
+			table[i] = table[i - 1] + static_cast<F>(last.distance(current));
+			last = current;
+
+		}
+
+		return table[count - 1];
+
+	}
+
+	//Maps an arc length to the curve parameter using a table from arcLengthTable()
+	constexpr static F parameterAtLength(std::span<const F> table, F length) {
+
+		SizeT count = table.size();
+
+		arc_assert(count >= 2, "Arc length table requires at least two entries");
+
+		if (length <= 0) {
+			return 0;
+		} else if (length >= table[count - 1]) {
+			return 1;
+		}
+
+		SizeT i = std::upper_bound(table.begin(), table.end(), length) - table.begin() - 1;
+
+		return interpolateParameter(table, i, length);
+
+	}
+
+	//Evaluates the curve at the given arc length using a table from arcLengthTable()
+	constexpr Vec2<F> evaluateAtLength(std::span<const F> table, F length) const {
+		return evaluate(parameterAtLength(table, length));
+	}
+
+	//Evaluates the curve at points.size() points spaced equally along its arc using a table from arcLengthTable()
+	constexpr void evaluateEquidistant(std::span<const F> table, std::span<Vec2<F>> points) const {
+
+		SizeT count = points.size();
+		SizeT entries = table.size();
+
+		arc_assert(entries >= 2, "Arc length table requires at least two entries");
+
+		if (count < 2) {
+
+			if (count) {
+				points[0] = getStartPoint();
+			}
+
+			return;
+
+		}
+
+		F total = table[entries - 1];
+		SizeT i = 0;
+
+		for (SizeT k = 0; k < count - 1; k++) {
+
+			F length = total * k / (count - 1);
+
+			while (i < entries - 2 && table[i + 1] <= length) {
+				i++;
+			}
+
+			points[k] = evaluate(interpolateParameter(table, i, length));
+
+		}
+
+		points[count - 1] = getEndPoint();
+
+	}
+
+
 	constexpr Bezier<Degree - 1, F> derivative() const {
 
 		static_assert(Degree >= 2, "Derivative is not a bezier curve");
@@ -143,7 +342,7 @@ public:
 
 				//Quadratic derivative
 				const Vec2<F>& d0 = drv.getStartPoint();
-				const Vec2<F>& d1 = drv.getControlPoint<1>();
+				const Vec2<F>& d1 = drv.template getControlPoint<1>();
 				const Vec2<F>& d2 = drv.getEndPoint();
 
 				Vec2<F> a = d0 - 2 * d1 + d2;
@@ -424,6 +623,121 @@ private:
 
 	}
 
+	/*
+	 *  Fills d with the value and forward differences of the curve at t = 0 for a step of 1 / steps.
+	 *  Differencing sampled points cancels catastrophically for small steps, so the differences are derived exactly
+	 *  from the power basis: with f(t) = sum c_k t^k, the j-th difference at 0 is sum c_k h^k j! S(k, j).
+	 */
+	constexpr void forwardDifferences(double (&dx)[Degree + 1], double (&dy)[Degree + 1], SizeT steps) const {
+
+		double h = 1.0 / steps;
+		double cx[Degree + 1] {};
+		double cy[Degree + 1] {};
+		double binomial = 1;
+
+		for (u32 k = 0; k <= Degree; k++) {
+
+			double inner = 1;
+
+			for (u32 i = 0; i <= k; i++) {
+
+				double factor = binomial * inner * ((k - i) % 2 ? -1 : 1);
+
+				cx[k] += factor * controlPoints[i].x;
+				cy[k] += factor * controlPoints[i].y;
+				inner = inner * (k - i) / (i + 1);
+
+			}
+
+			binomial = binomial * (Degree - k) / (k + 1);
+
+		}
+
+		//s[j] holds j! S(k, j) for the current k, with j! S(k, j) = j (j! S(k - 1, j) + (j - 1)! S(k - 1, j - 1))
+		double s[Degree + 1] {1};
+		double power = 1;
+
+		for (u32 j = 0; j <= Degree; j++) {
+			dx[j] = dy[j] = 0;
+		}
+
+		for (u32 k = 0; k <= Degree; k++) {
+
+			if (k) {
+
+				for (u32 j = k; j >= 1; j--) {
+					s[j] = j * (s[j] + s[j - 1]);
+				}
+
+				s[0] = 0;
+				power *= h;
+
+			}
+
+			for (u32 j = 0; j <= k; j++) {
+
+				dx[j] += cx[k] * power * s[j];
+				dy[j] += cy[k] * power * s[j];
+
+			}
+
+		}
+
+	}
+
+	//Splits a curve at t = 0.5 by de Casteljau's algorithm
+	constexpr static void split(const Vec2<F> (&points)[Degree + 1], Vec2<F> (&left)[Degree + 1], Vec2<F> (&right)[Degree + 1]) {
+
+		Vec2<F> p[Degree + 1];
+		std::copy_n(points, Degree + 1, p);
+
+		left[0] = p[0];
+		right[Degree] = p[Degree];
+
+		for (u32 j = 1; j <= Degree; j++) {
+
+			for (u32 i = 0; i <= Degree - j; i++) {
+				p[i] = (p[i] + p[i + 1]) * F(0.5);
+			}
+
+			left[j] = p[0];
+			right[Degree - j] = p[Degree - j];
+
+		}
+
+	}
+
+	//The curve lies in the hull of its control points, so it is flat if every inner point is close to the chord
+	constexpr static bool isFlat(const Vec2<F> (&points)[Degree + 1], F toleranceSquared) {
+
+		const Vec2<F>& a = points[0];
+		Vec2<F> chord = points[Degree] - a;
+		F chordSquared = chord.magSquared();
+
+		for (u32 i = 1; i < Degree; i++) {
+
+			Vec2<F> v = points[i] - a;
+			F t = chordSquared > 0 ? Math::clamp(v.dot(chord) / chordSquared, F(0), F(1)) : F(0);
+
+			if ((v - chord * t).magSquared() > toleranceSquared) {
+				return false;
+			}
+
+		}
+
+		return true;
+
+	}
+
+	constexpr static F interpolateParameter(std::span<const F> table, SizeT i, F length) {
+
+		F span = table[i + 1] - table[i];
+		F fraction = span > 0 ? Math::clamp((length - table[i]) / span, F(0), F(1)) : F(0);
+
+		return (i + fraction) / (table.size() - 1);
+
+	}
+
 	template<SizeT... Pack>
 	constexpr auto evaluateHelper(double t, std::index_sequence<Pack...>) const requires (Degree <= 32) {
 
@@ -16,14 +16,28 @@
 
 #include <vector>
 #include <span>
+#include <string>
 
 
 
 class BigInt {
 
-	using ValueT = u32;
+	using ValueT = u64;
+	using Limbs = std::vector<ValueT>;
+
 	constexpr static u32 ValueBits = Bits::bitCount<ValueT>();
 
+	//Operand sizes in limbs from which on the asymptotically faster algorithms take over
+	constexpr static SizeT KaratsubaThreshold = 32;
+	constexpr static SizeT Toom3Threshold = 128;
+	constexpr static SizeT NewtonThreshold = 4096;
+	constexpr static SizeT ReciprocalThreshold = 512;
+	constexpr static SizeT RadixThreshold = 32;
+
+	//Largest power of ten fitting into a limb, radix conversion works on chunks of that many digits
+	constexpr static ValueT DecimalChunk = 10000000000000000000ULL;
+	constexpr static SizeT DecimalChunkDigits = 19;
+
 	template<class T>
 	struct _DivResult {
 		T quotient;
@@ -56,7 +70,7 @@ public:
 		set(i);
 	}
 
-	explicit BigInt(std::string_view view) {
+	constexpr explicit BigInt(std::string_view view) {
 		*this = parseString(view);
 	}
 
@@ -69,11 +83,13 @@ public:
 
 		} else {
 
-			SizeT bits = Bits::bitCount<I>() - Bits::clz(i);
+			using U = TT::MakeUnsigned<I>;
+
+			//Negate in unsigned arithmetic so that the minimum value does not overflow
+			U u = i >= I(0) ? U(i) : U(U(0) - U(i));
 
 			signum = i >= I(0) ? 1 : -1;
-			magnitude.resize((bits + ValueBits - 1) / ValueBits);
-			Bits::disassemble(Math::abs(i), magnitude.data(), magnitude.size());
+			magnitude.assign(1, ValueT(u));
 
 		}
 
@@ -442,9 +458,9 @@ public:
 			if (isNegative()) {
 
 				SizeT bits = magnitudeBitSize();
-				ValueT upper = ValueT(1) << ((bits % ValueBits) - 1);
+				ValueT upper = ValueT(1) << ((bits - 1) % ValueBits);
 
-				for (SizeT i = 0; i < bits / ValueBits; i++) {
+				for (SizeT i = 0; i < (bits - 1) / ValueBits; i++) {
 
 					if (magnitude[i]) {
 						return false;
@@ -473,27 +489,39 @@ public:
 
 	constexpr std::string toString() const {
 
+		if (isZero()) {
+			return "0";
+		}
+
 		std::string result;
 
-		BigInt b = *this;
+		if (isNegative()) {
+			result += '-';
+		}
 
-		while (!b.isZero()) {
+		BigInt b = abs();
 
-			DivResult digit = b.divmod(10);
+		if (b.magnitude.size() < RadixThreshold) {
 
-			result += char('0') + digit.remainder.toInteger<i8>();
-			b = digit.quotient;
+			appendDecimalBasecase(result, b.magnitude, 0);
+			return result;
 
 		}
 
-		if (result.empty()) {
-			return "0";
-		}
+		if (std::is_constant_evaluated()) {
 
-		std::reverse(result.begin(), result.end());
+			std::vector<BigInt> powers;
+			SizeT level = extendDecimalPowersFor(powers, b.magnitude.size());
+
+			appendDecimal(result, b, powers, level, 0);
+
+		} else {
+
+			std::vector<BigInt>& powers = decimalPowerCache();
+			SizeT level = extendDecimalPowersFor(powers, b.magnitude.size());
+
+			appendDecimal(result, b, powers, level, 0);
 
-		if (isNegative()) {
-			result = '-' + result;
 		}
 
 		return result;
@@ -501,17 +529,9 @@ public:
 	}
 
 
-	static BigInt parseString(std::string_view str) {
-
-		BigInt b;
+	constexpr static BigInt parseString(std::string_view str) {
 
 		bool sign = false;
-		ValueT value = 0;
-
-		SizeT bufferOps = static_cast<SizeT>(Math::floor(Math::log(std::numeric_limits<ValueT>::max())));
-		ValueT factor = static_cast<ValueT>(Math::pow(10, bufferOps));
-
-		SizeT i = 0;
 
 		if (str.size() >= 2 && str[0] == '-') {
 
@@ -530,24 +550,39 @@ public:
 				throw std::runtime_error("Bad integer string");
 			}
 
-			value *= 10;
-			value += c - '0';
+		}
 
-			i++;
+		BigInt b;
+
+		if (str.size() <= RadixThreshold * DecimalChunkDigits) {
 
-			if (i == bufferOps) {
+			b = parseDecimalBasecase(str);
 
-				b = addCoreUnchecked(multiplyMagnitudeSingle(b, factor), value);
-				value = 0;
-				i = 0;
+		} else {
 
+			//Pick the smallest level whose doubled chunk covers the string
+			SizeT level = 0;
+
+			while ((DecimalChunkDigits << (level + 1)) < str.size()) {
+				level++;
 			}
 
-		}
+			if (std::is_constant_evaluated()) {
+
+				std::vector<BigInt> powers;
+				extendDecimalPowers(powers, level);
+
+				b = parseDecimal(str, powers, level);
+
+			} else {
+
+				std::vector<BigInt>& powers = decimalPowerCache();
+				extendDecimalPowers(powers, level);
+
+				b = parseDecimal(str, powers, level);
+
+			}
 
-		//Add the remaining digits
-		if (i) {
-			b = addCoreUnchecked(multiplyMagnitudeSingle(b, static_cast<ValueT>(Math::pow(10, i))), value);
 		}
 
 		if (!b.checkZero()) {
@@ -570,7 +605,7 @@ private:
 		}
 
 		if (a.isPositive() ^ b.isPositive()) {
-			return subtractCoreUnchecked(a, b.negate());
+			return subtractCore(a, b.negate());
 		}
 
 		return addCoreUnchecked(a, b);
@@ -589,9 +624,12 @@ private:
 			return addCoreUnchecked(a, b.negate());
 		}
 
-		if (b > a) {
+		//Signs are equal, the larger magnitude determines the result sign
+		auto order = compareMagnitude(a, b);
+
+		if (order < 0) {
 			return subtractCoreUnchecked(b, a).negate();
-		} else if (b == a) {
+		} else if (order == 0) {
 			return {};
 		} else {
 			return subtractCoreUnchecked(a, b);
@@ -643,6 +681,24 @@ private:
 
 	}
 
+	constexpr static std::strong_ordering compareMagnitude(const BigInt& a, const BigInt& b) {
+
+		if (a.magnitude.size() != b.magnitude.size()) {
+			return a.magnitude.size() <=> b.magnitude.size();
+		}
+
+		for (SizeT i = a.magnitude.size(); i-- > 0;) {
+
+			if (a.magnitude[i] != b.magnitude[i]) {
+				return a.magnitude[i] <=> b.magnitude[i];
+			}
+
+		}
+
+		return std::strong_ordering::equal;
+
+	}
+
 	constexpr static BigInt addCoreUnchecked(BigInt a, const BigInt& b) {
 
 		a.widen(b.magnitude.size());
@@ -709,13 +765,9 @@ private:
 
 	constexpr static BigInt multiplyCoreUnchecked(const BigInt& a, const BigInt& b) {
 
-		BigInt result;
 		bool sign = a.isPositive() ^ b.isPositive();
 
-		for (SizeT i = 0; ValueT v : b.magnitude) {
-			result = addCore(result, multiplyMagnitudeSingle(a, v).shiftLeft(i++ * ValueBits));
-		}
-
+		BigInt result = multiplyMagnitude(a.magnitude, b.magnitude);
 		result.signum = sign ? -1 : 1;
 
 		return result;
@@ -724,77 +776,689 @@ private:
 
 	constexpr static BigInt multiplyMagnitudeSingle(BigInt a, ValueT b) {
 
-		bool carry = false;
-		ValueT prevTop = 0;
+		multiplyAddLimbs(a.magnitude, b, 0);
+		return a;
 
-		OverflowMultiplyResult<ValueT> multiplyResult;
-		OverflowAddResult<ValueT> addResult;
+	}
 
-		for (ValueT& v : a.magnitude) {
+	/*
+	 *  Magnitude product, dispatching on the operand sizes
+	 *  Unbalanced operands are cut into slices of the shorter length so that the recursive algorithms always see balanced inputs.
+	 */
+	constexpr static BigInt multiplyMagnitude(std::span<const ValueT> a, std::span<const ValueT> b) {
 
-			multiplyResult = Math::overflowMultiply(v, b);
-			addResult = Math::overflowAdd(multiplyResult.bottom, prevTop);
+		a = trimLimbs(a);
+		b = trimLimbs(b);
 
-			v = addResult.value + carry;
-			carry = addResult.overflown || (carry && addResult.value == -1);
-			prevTop = multiplyResult.top;
+		if (a.size() < b.size()) {
+			std::swap(a, b);
+		}
 
+		if (b.empty()) {
+			return {};
 		}
 
-		prevTop += carry;
+		if (b.size() < KaratsubaThreshold) {
+
+			Limbs result(a.size() + b.size());
+			multiplySchoolbook(a, b, result);
+
+			return fromLimbs(std::move(result));
 
-		if (multiplyResult.overflown) {
-			a.magnitude.emplace_back(prevTop);
 		}
 
-		return a;
+		if (a.size() >= 2 * b.size()) {
+
+			Limbs result(a.size() + b.size());
+
+			for (SizeT i = 0; i < a.size(); i += b.size()) {
+
+				BigInt partial = multiplyMagnitude(a.subspan(i, Math::min(b.size(), a.size() - i)), b);
+				addLimbsAt(result, partial.magnitude, i);
+
+			}
+
+			return fromLimbs(std::move(result));
+
+		}
+
+		if (b.size() < Toom3Threshold) {
+			return multiplyKaratsuba(a, b);
+		}
+
+		return multiplyToom3(a, b);
 
 	}
 
-	constexpr static DivResult divideCoreUnchecked(BigInt a, BigInt b) {
+	constexpr static void multiplySchoolbook(std::span<const ValueT> a, std::span<const ValueT> b, std::span<ValueT> result) {
+
+		for (SizeT i = 0; i < b.size(); i++) {
+
+			ValueT carry = 0;
+
+			for (SizeT j = 0; j < a.size(); j++) {
+
+				ValueT high;
+				ValueT low = multiplyWide(a[j], b[i], high);
+
+				low += carry;
+				high += low < carry;
+
+				ValueT sum = result[i + j] + low;
+				high += sum < low;
+
+				result[i + j] = sum;
+				carry = high;
+
+			}
+
+			result[i + a.size()] = carry;
+
+		}
+
+	}
+
+	//(a1 * x + a0)(b1 * x + b0) = a1b1 * x^2 + ((a0 + a1)(b0 + b1) - a0b0 - a1b1) * x + a0b0, requires a.size() >= b.size() > a.size() / 2
+	constexpr static BigInt multiplyKaratsuba(std::span<const ValueT> a, std::span<const ValueT> b) {
+
+		SizeT h = (a.size() + 1) / 2;
+
+		std::span<const ValueT> a0 = a.first(h);
+		std::span<const ValueT> a1 = a.subspan(h);
+		std::span<const ValueT> b0 = b.first(Math::min(h, b.size()));
+		std::span<const ValueT> b1 = b.subspan(b0.size());
+
+		BigInt z0 = multiplyMagnitude(a0, b0);
+		BigInt z2 = multiplyMagnitude(a1, b1);
+
+		Limbs sa = addLimbs(a0, a1);
+		Limbs sb = addLimbs(b0, b1);
+
+		BigInt z1 = multiplyMagnitude(sa, sb);
+		z1 = subtractCore(subtractCore(z1, z0), z2);
+
+		Limbs result(a.size() + b.size() + 1);
+
+		addLimbsAt(result, z0.magnitude, 0);
+		addLimbsAt(result, z1.magnitude, h);
+		addLimbsAt(result, z2.magnitude, 2 * h);
+
+		return fromLimbs(std::move(result));
+
+	}
+
+	/*
+	 *  Toom-Cook 3-way split evaluated at 0, 1, -1, -2 and infinity
+	 *  Interpolation follows Bodrato's sequence, which only needs exact divisions by 2 and 3.
+	 */
+	constexpr static BigInt multiplyToom3(std::span<const ValueT> a, std::span<const ValueT> b) {
+
+		SizeT k = (a.size() + 2) / 3;
+
+		auto split = [k](std::span<const ValueT> x, SizeT i) {
+
+			SizeT start = Math::min(i * k, x.size());
+			return fromLimbs(Limbs(x.begin() + start, x.begin() + Math::min(start + k, x.size())));
+
+		};
+
+		BigInt a0 = split(a, 0), a1 = split(a, 1), a2 = split(a, 2);
+		BigInt b0 = split(b, 0), b1 = split(b, 1), b2 = split(b, 2);
+
+		BigInt pt = addCore(a0, a2);
+		BigInt p1 = addCore(pt, a1);
+		BigInt pm1 = subtractCore(pt, a1);
+		BigInt pm2 = subtractCore(addCore(pm1, a2) << 1, a0);
+
+		BigInt qt = addCore(b0, b2);
+		BigInt q1 = addCore(qt, b1);
+		BigInt qm1 = subtractCore(qt, b1);
+		BigInt qm2 = subtractCore(addCore(qm1, b2) << 1, b0);
+
+		BigInt r0 = multiplyCore(a0, b0);
+		BigInt r1 = multiplyCore(p1, q1);
+		BigInt rm1 = multiplyCore(pm1, qm1);
+		BigInt rm2 = multiplyCore(pm2, qm2);
+		BigInt rinf = multiplyCore(a2, b2);
+
+		BigInt r3 = divideExact(subtractCore(rm2, r1), 3);
+		r1 = subtractCore(r1, rm1) >> 1;
+		BigInt r2 = subtractCore(rm1, r0);
+		r3 = addCore(subtractCore(r2, r3) >> 1, rinf << 1);
+		r2 = subtractCore(addCore(r2, r1), rinf);
+		r1 = subtractCore(r1, r3);
+
+		//All coefficients are products of non-negative parts, hence non-negative
+		Limbs result(a.size() + b.size() + 1);
+
+		addLimbsAt(result, r0.magnitude, 0);
+		addLimbsAt(result, r1.magnitude, k);
+		addLimbsAt(result, r2.magnitude, 2 * k);
+		addLimbsAt(result, r3.magnitude, 3 * k);
+		addLimbsAt(result, rinf.magnitude, 4 * k);
 
-		BigInt result;
+		return fromLimbs(std::move(result));
+
+	}
+
+	constexpr static DivResult divideCoreUnchecked(BigInt a, BigInt b) {
 
 		bool sign = a.isPositive() ^ b.isPositive();
 		a = a.abs();
 		b = b.abs();
 
+		DivResult result = divideMagnitude(a, b);
+
+		if (!result.quotient.isZero()) {
+			result.quotient.signum = sign ? -1 : 1;
+		}
+
+		return result;
+
+	}
+
+	//Quotient and remainder of two positive values
+	constexpr static DivResult divideMagnitude(const BigInt& a, const BigInt& b) {
+
 		if (a < b) {
 			return {{}, a};
 		}
 
-		SizeT bitsA = a.magnitudeBitSize();
-		SizeT bitsB = b.magnitudeBitSize();
+		SizeT n = b.magnitude.size();
+		SizeT m = a.magnitude.size() - n;
 
-		SizeT shift = bitsA - bitsB;
-		b.shiftLeft(shift);
+		if (n == 1) {
+			return divideSingle(a, b.magnitude.front());
+		}
 
-		//Divisor may be greater than dividend, shift once to correct
-		if (a < b) {
+		if (n >= NewtonThreshold && m >= NewtonThreshold) {
+			return divideNewton(a, b);
+		}
+
+		return divideKnuth(a, b);
+
+	}
+
+	constexpr static DivResult divideSingle(const BigInt& a, ValueT d) {
+
+		Limbs quotient = a.magnitude;
+		ValueT remainder = divideLimbsSingle(quotient, d);
+
+		return {fromLimbs(std::move(quotient)), BigInt(remainder)};
+
+	}
+
+	//Divides a value known to be a multiple of d, keeping its sign
+	constexpr static BigInt divideExact(const BigInt& a, ValueT d) {
+
+		if (a.isZero()) {
+			return a;
+		}
+
+		BigInt q = divideSingle(a.abs(), d).quotient;
+		q.signum = a.signum;
+
+		return q;
+
+	}
+
+	//Knuth's algorithm D (TAOCP Vol. 2, 4.3.1), requires a >= b and b to span at least two limbs
+	constexpr static DivResult divideKnuth(const BigInt& a, const BigInt& b) {
+
+		SizeT n = b.magnitude.size();
+		SizeT m = a.magnitude.size() - n;
+		u32 shift = Bits::clz(b.magnitude.back());
+
+		//Normalize so that the top bit of the divisor is set
+		Limbs v(n);
+		Limbs u(a.magnitude.size() + 1);
+
+		shiftLimbsLeft(b.magnitude, v, shift);
+		u[a.magnitude.size()] = shiftLimbsLeft(a.magnitude, std::span<ValueT>(u).first(a.magnitude.size()), shift);
+
+		Limbs q(m + 1);
+
+		ValueT vTop = v[n - 1];
+		ValueT vNext = v[n - 2];
+
+		for (SizeT j = m + 1; j-- > 0;) {
+
+			ValueT qhat, rhat;
+			bool rhatOverflow = false;
+
+			//Estimate the quotient limb from the top two dividend limbs
+			if (u[j + n] >= vTop) {
+
+				qhat = ~ValueT(0);
+				rhat = u[j + n - 1] + vTop;
+				rhatOverflow = rhat < vTop;
+
+			} else {
+
+				qhat = divideWide(u[j + n], u[j + n - 1], vTop, rhat);
+
+			}
+
+			//Correct the estimate using the next divisor limb, making it exceed the true limb by at most one
+			while (!rhatOverflow) {
+
+				ValueT high;
+				ValueT low = multiplyWide(qhat, vNext, high);
+
+				if (high < rhat || (high == rhat && low <= u[j + n - 2])) {
+					break;
+				}
+
+				qhat--;
+				rhat += vTop;
+				rhatOverflow = rhat < vTop;
+
+			}
+
+			//Multiply and subtract
+			ValueT carry = 0;
+			ValueT borrow = 0;
+
+			for (SizeT i = 0; i < n; i++) {
 
-			b.shiftRight(1);
-			shift--;
+				ValueT high;
+				ValueT low = multiplyWide(qhat, v[i], high);
+
+				low += carry;
+				high += low < carry;
+				carry = high;
+
+				ValueT t = u[i + j];
+				ValueT d = t - low;
+				ValueT b0 = t < low;
+				ValueT d1 = d - borrow;
+				ValueT b1 = d < borrow;
+
+				u[i + j] = d1;
+				borrow = b0 + b1;
+
+			}
+
+			ValueT t = u[j + n];
+			ValueT d = t - carry;
+			bool negative = t < carry;
+
+			negative |= d < borrow;
+			u[j + n] = d - borrow;
+
+			//The estimate was one too large, add back
+			if (negative) {
+
+				qhat--;
+
+				ValueT c = 0;
+
+				for (SizeT i = 0; i < n; i++) {
+
+					ValueT sum = u[i + j] + v[i];
+					ValueT c0 = sum < v[i];
+					ValueT sum1 = sum + c;
+					ValueT c1 = sum1 < c;
+
+					u[i + j] = sum1;
+					c = c0 + c1;
+
+				}
+
+				u[j + n] += c;
+
+			}
+
+			q[j] = qhat;
 
 		}
 
-		for (SizeT i = 0; i <= shift; i++) {
+		Limbs r(n);
+		shiftLimbsRight(std::span<const ValueT>(u).first(n), r, shift);
+
+		return {fromLimbs(std::move(q)), fromLimbs(std::move(r))};
+
+	}
+
+	/*
+	 *  Division by Newton reciprocal and Barrett reduction
+	 *  The normalized divisor b spans k bits, its reciprocal mu = floor(2^2k / b) turns every k-bit quotient block into two multiplications.
+	 */
+	constexpr static DivResult divideNewton(const BigInt& a, const BigInt& b) {
+
+		u32 shift = Bits::clz(b.magnitude.back());
+
+		BigInt na = a << shift;
+		BigInt nb = b << shift;
+
+		SizeT n = nb.magnitude.size();
+		SizeT k = n * ValueBits;
+
+		BigInt mu = reciprocal(nb, k);
+
+		SizeT blocks = (na.magnitude.size() + n - 1) / n;
 
-			result.shiftLeft(1);
+		Limbs q(blocks * n);
+		BigInt r;
 
-			if (a >= b) {
+		for (SizeT i = blocks; i-- > 0;) {
 
-				a.subtract(b);
-				result.increment();
+			SizeT start = i * n;
+			SizeT end = Math::min(start + n, na.magnitude.size());
+
+			//t = r * 2^k + block < b * 2^k
+			Limbs tl(na.magnitude.begin() + start, na.magnitude.begin() + end);
+			tl.resize(n);
+
+			if (!r.isZero()) {
+				tl.insert(tl.end(), r.magnitude.begin(), r.magnitude.end());
+			}
+
+			BigInt t = fromLimbs(std::move(tl));
+			BigInt qb = multiplyCore(t >> (k - 1), mu) >> (k + 1);
+
+			r = subtractCore(t, multiplyCore(qb, nb));
+
+			//Barrett's estimate is at most two below the true quotient
+			while (r >= nb) {
+
+				r = subtractCore(r, nb);
+				qb.increment();
 
 			}
 
-			b.shiftRight(1);
+			std::copy(qb.magnitude.begin(), qb.magnitude.end(), q.begin() + start);
 
 		}
 
-		result.signum = sign ? -1 : 1;
+		return {fromLimbs(std::move(q)), r >> shift};
+
+	}
+
+	//floor(2^2k / b) for a b of exactly k bits, refined from a half-precision reciprocal by a single Newton step
+	constexpr static BigInt reciprocal(const BigInt& b, SizeT k) {
+
+		BigInt power = BigInt(1) << (2 * k);
+
+		if (b.magnitude.size() < ReciprocalThreshold) {
+			return divideMagnitude(power, b).quotient;
+		}
+
+		SizeT h = k / 2 + 1;
+
+		BigInt y = reciprocal(b >> (k - h), h);
+		BigInt x = y << (k - h);
+
+		//x += x * (2^2k - b * x) / 2^2k
+		BigInt e = subtractCore(power, multiplyCore(b, x));
+		x = addCore(x, multiplyCore(x, e) >> (2 * k));
+
+		//Remaining error is a few units, step to the exact floor
+		e = subtractCore(power, multiplyCore(b, x));
+
+		while (e.isNegative()) {
+
+			x.decrement();
+			e = addCore(e, b);
+
+		}
+
+		while (e >= b) {
+
+			x.increment();
+			e = subtractCore(e, b);
+
+		}
+
+		return x;
 
-		return {result, a};
+	}
+
+	//Full product of two limbs, returns the lower half
+	constexpr static ValueT multiplyWide(ValueT a, ValueT b, ValueT& high) {
+
+#ifdef __SIZEOF_INT128__
+
+		__extension__ using DoubleT = unsigned __int128;
+
+		DoubleT p = static_cast<DoubleT>(a) * b;
+		high = static_cast<ValueT>(p >> ValueBits);
+
+		return static_cast<ValueT>(p);
+
+#else
+
+		constexpr ValueT lowMask = 0xFFFFFFFF;
+
+		ValueT p00 = (a & lowMask) * (b & lowMask);
+		ValueT p01 = (a & lowMask) * (b >> 32);
+		ValueT p10 = (a >> 32) * (b & lowMask);
+		ValueT p11 = (a >> 32) * (b >> 32);
+
+		ValueT mid = (p00 >> 32) + (p10 & lowMask) + (p01 & lowMask);
+
+		high = p11 + (p10 >> 32) + (p01 >> 32) + (mid >> 32);
+
+		return (mid << 32) | (p00 & lowMask);
+
+#endif
+
+	}
+
+	//(high * 2^64 + low) / d, requires high < d
+	constexpr static ValueT divideWide(ValueT high, ValueT low, ValueT d, ValueT& remainder) {
+
+#ifdef __SIZEOF_INT128__
+
+		__extension__ using DoubleT = unsigned __int128;
+
+		DoubleT n = (static_cast<DoubleT>(high) << ValueBits) | low;
+
+		remainder = static_cast<ValueT>(n % d);
+		return static_cast<ValueT>(n / d);
+
+#else
+
+		//Long division in 32-bit halves (Hacker's Delight, divlu)
+		constexpr ValueT base = ValueT(1) << 32;
+		constexpr ValueT lowMask = base - 1;
+
+		u32 s = Bits::clz(d);
+
+		d <<= s;
+
+		ValueT vn1 = d >> 32;
+		ValueT vn0 = d & lowMask;
+		ValueT un32 = s ? (high << s) | (low >> (ValueBits - s)) : high;
+		ValueT un10 = low << s;
+		ValueT un1 = un10 >> 32;
+		ValueT un0 = un10 & lowMask;
+
+		ValueT q1 = un32 / vn1;
+		ValueT rhat = un32 - q1 * vn1;
+
+		while (q1 >= base || q1 * vn0 > base * rhat + un1) {
+
+			q1--;
+			rhat += vn1;
+
+			if (rhat >= base) {
+				break;
+			}
+
+		}
+
+		ValueT un21 = un32 * base + un1 - q1 * d;
+		ValueT q0 = un21 / vn1;
+
+		rhat = un21 - q0 * vn1;
+
+		while (q0 >= base || q0 * vn0 > base * rhat + un0) {
+
+			q0--;
+			rhat += vn1;
+
+			if (rhat >= base) {
+				break;
+			}
+
+		}
+
+		remainder = (un21 * base + un0 - q0 * d) >> s;
+
+		return q1 * base + q0;
+
+#endif
+
+	}
+
+	constexpr static std::span<const ValueT> trimLimbs(std::span<const ValueT> a) {
+
+		while (!a.empty() && a.back() == 0) {
+			a = a.first(a.size() - 1);
+		}
+
+		return a;
+
+	}
+
+	constexpr static BigInt fromLimbs(Limbs&& limbs) {
+
+		BigInt b;
+
+		if (limbs.empty()) {
+			return b;
+		}
+
+		b.magnitude = std::move(limbs);
+		b.compress();
+
+		if (!b.checkZero()) {
+			b.signum = 1;
+		}
+
+		return b;
+
+	}
+
+	constexpr static Limbs addLimbs(std::span<const ValueT> a, std::span<const ValueT> b) {
+
+		if (a.size() < b.size()) {
+			std::swap(a, b);
+		}
+
+		Limbs result(a.begin(), a.end());
+		result.emplace_back(0);
+
+		addLimbsAt(result, b, 0);
+
+		return result;
+
+	}
+
+	//Adds x * 2^(64 * offset) to r, which must be large enough to hold the sum
+	constexpr static void addLimbsAt(Limbs& r, std::span<const ValueT> x, SizeT offset) {
+
+		x = trimLimbs(x);
+
+		ValueT carry = 0;
+		SizeT i = 0;
+
+		for (; i < x.size(); i++) {
+
+			ValueT sum = r[offset + i] + x[i];
+			ValueT c0 = sum < x[i];
+			ValueT sum1 = sum + carry;
+			ValueT c1 = sum1 < carry;
+
+			r[offset + i] = sum1;
+			carry = c0 + c1;
+
+		}
+
+		for (i += offset; carry; i++) {
+
+			arc_assert(i < r.size(), "Limb addition overflown");
+
+			r[i]++;
+			carry = r[i] == 0;
+
+		}
+
+	}
+
+	//Computes a = a * m + c
+	constexpr static void multiplyAddLimbs(Limbs& a, ValueT m, ValueT c) {
+
+		for (ValueT& v : a) {
+
+			ValueT high;
+			ValueT low = multiplyWide(v, m, high);
+
+			low += c;
+			high += low < c;
+
+			v = low;
+			c = high;
+
+		}
+
+		if (c) {
+			a.emplace_back(c);
+		}
+
+	}
+
+	//Divides a by d in place, returns the remainder
+	constexpr static ValueT divideLimbsSingle(std::span<ValueT> a, ValueT d) {
+
+		ValueT remainder = 0;
+
+		for (SizeT i = a.size(); i-- > 0;) {
+			a[i] = divideWide(remainder, a[i], d, remainder);
+		}
+
+		return remainder;
+
+	}
+
+	//Shifts a left by shift < 64 bits into r of equal size, returns the bits shifted out
+	constexpr static ValueT shiftLimbsLeft(std::span<const ValueT> a, std::span<ValueT> r, u32 shift) {
+
+		if (!shift) {
+
+			std::copy(a.begin(), a.end(), r.begin());
+			return 0;
+
+		}
+
+		ValueT out = 0;
+
+		for (SizeT i = 0; i < a.size(); i++) {
+
+			ValueT v = a[i];
+
+			r[i] = (v << shift) | out;
+			out = v >> (ValueBits - shift);
+
+		}
+
+		return out;
+
+	}
+
+	constexpr static void shiftLimbsRight(std::span<const ValueT> a, std::span<ValueT> r, u32 shift) {
+
+		if (!shift) {
+
+			std::copy(a.begin(), a.end(), r.begin());
+			return;
+
+		}
+
+		for (SizeT i = 0; i < a.size(); i++) {
+			r[i] = (a[i] >> shift) | (i + 1 < a.size() ? a[i + 1] << (ValueBits - shift) : 0);
+		}
 
 	}
 
@@ -817,6 +1481,166 @@ private:
 
 	}
 
+	//Appends the digits of 0 <= x < powers[level]^2, zero-padded to width if nonzero
+	constexpr static void appendDecimal(std::string& out, const BigInt& x, std::span<const BigInt> powers, SizeT level, SizeT width) {
+
+		if (x.magnitude.size() < RadixThreshold) {
+
+			appendDecimalBasecase(out, x.magnitude, width);
+			return;
+
+		}
+
+		const BigInt& power = powers[level];
+
+		if (!width && x < power) {
+
+			appendDecimal(out, x, powers, level - 1, 0);
+			return;
+
+		}
+
+		SizeT lowWidth = DecimalChunkDigits << level;
+		DivResult split = divideMagnitude(x, power);
+
+		appendDecimal(out, split.quotient, powers, level - 1, width ? width - lowWidth : 0);
+		appendDecimal(out, split.remainder, powers, level - 1, lowWidth);
+
+	}
+
+	constexpr static void appendDecimalBasecase(std::string& out, std::span<const ValueT> x, SizeT width) {
+
+		Limbs limbs(x.begin(), x.end());
+		std::span<ValueT> value = limbs;
+
+		std::string digits;
+
+		while (true) {
+
+			while (!value.empty() && value.back() == 0) {
+				value = value.first(value.size() - 1);
+			}
+
+			if (value.empty()) {
+				break;
+			}
+
+			ValueT chunk = divideLimbsSingle(value, DecimalChunk);
+
+			for (SizeT i = 0; i < DecimalChunkDigits; i++) {
+
+				digits += char('0' + chunk % 10);
+				chunk /= 10;
+
+			}
+
+		}
+
+		while (!digits.empty() && digits.back() == '0') {
+			digits.pop_back();
+		}
+
+		if (digits.size() < width) {
+			digits.append(width - digits.size(), '0');
+		}
+
+		out.append(digits.rbegin(), digits.rend());
+
+	}
+
+	//Parses at most DecimalChunkDigits * 2^(level + 1) digits
+	constexpr static BigInt parseDecimal(std::string_view str, std::span<const BigInt> powers, SizeT level) {
+
+		if (str.size() <= RadixThreshold * DecimalChunkDigits) {
+			return parseDecimalBasecase(str);
+		}
+
+		SizeT lowDigits = DecimalChunkDigits << level;
+
+		if (str.size() <= lowDigits) {
+			return parseDecimal(str, powers, level - 1);
+		}
+
+		SizeT split = str.size() - lowDigits;
+
+		BigInt high = parseDecimal(str.substr(0, split), powers, level - 1);
+		BigInt low = parseDecimal(str.substr(split), powers, level - 1);
+
+		return addCore(multiplyCore(high, powers[level]), low);
+
+	}
+
+	constexpr static BigInt parseDecimalBasecase(std::string_view str) {
+
+		Limbs limbs;
+		limbs.reserve(str.size() / DecimalChunkDigits + 1);
+
+		SizeT count = str.size() % DecimalChunkDigits;
+
+		if (!count) {
+			count = DecimalChunkDigits;
+		}
+
+		for (SizeT i = 0; i < str.size(); i += count, count = DecimalChunkDigits) {
+
+			ValueT value = 0;
+			ValueT factor = 1;
+
+			for (SizeT j = 0; j < count; j++) {
+
+				value = value * 10 + (str[i + j] - '0');
+				factor *= 10;
+
+			}
+
+			multiplyAddLimbs(limbs, factor, value);
+
+		}
+
+		return fromLimbs(std::move(limbs));
+
+	}
+
+	//Table of 10^(DecimalChunkDigits * 2^k) for k = 0 to level
+	constexpr static void extendDecimalPowers(std::vector<BigInt>& powers, SizeT level) {
+
+		if (powers.empty()) {
+			powers.emplace_back(DecimalChunk);
+		}
+
+		while (powers.size() <= level) {
+			powers.emplace_back(multiplyCoreUnchecked(powers.back(), powers.back()));
+		}
+
+	}
+
+	//Extends the table until the square of its last power exceeds any value of the given size, returns the level of that power
+	constexpr static SizeT extendDecimalPowersFor(std::vector<BigInt>& powers, SizeT limbs) {
+
+		SizeT level = 0;
+
+		while (true) {
+
+			extendDecimalPowers(powers, level);
+
+			if (powers[level].magnitude.size() * 2 - 1 > limbs) {
+				return level;
+			}
+
+			level++;
+
+		}
+
+	}
+
+	//The powers only ever grow, hence every thread keeps the largest table it needed so far
+	static std::vector<BigInt>& decimalPowerCache() {
+
+		thread_local std::vector<BigInt> powers;
+		return powers;
+
+	}
+
 	constexpr void incrementMagnitude() {
 
 		bool carry = true;
@@ -897,6 +1721,8 @@ private:
 	}
 
 
+	friend class Montgomery;
+
 	i32 signum;
 	std::vector<ValueT> magnitude;
 
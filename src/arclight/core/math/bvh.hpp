@@ -0,0 +1,1075 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 bvh.hpp
+ */
+
+#pragma once
+
+#include "math/box.hpp"
+#include "math/capsule.hpp"
+#include "math/sphere.hpp"
+#include "concurrent/thread.hpp"
+#include "util/assert.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+
+/*
+ *  Exact ray and overlap tests used by BVH leaves
+ *  Rays report the first parameter t in [tMin, tMax] at which origin + t * direction lies inside the primitive, so a ray starting
+ *  inside a primitive hits it at tMin. Capsules are upright, i.e. their axis runs along y.
+ *  Primitives without a dedicated overload are tested against their bounding box.
+ */
+namespace BVHPrimitive {
+
+	template<class P>
+	constexpr auto bounds(const P& primitive) {
+		return primitive.boundingBox();
+	}
+
+	//Caps of capsules lower than their diameter reach beyond Capsule::boundingBox()
+	template<CC::Float F>
+	constexpr Box<F> bounds(const Capsule<F>& capsule) {
+		return Box<F>(Vec3<F>(capsule.radius, Math::max(capsule.height / 2, capsule.radius), capsule.radius) * F(2), capsule.origin);
+	}
+
+
+	template<CC::Float F>
+	struct Interval {
+		F enter;
+		F exit;
+	};
+
+
+	template<CC::Float F>
+	constexpr std::optional<Interval<F>> sphereInterval(const Vec3<F>& center, F radius, const Vec3<F>& origin, const Vec3<F>& direction) {
+
+		Vec3<F> oc = origin - center;
+
+		F a = direction.dot(direction);
+		F b = oc.dot(direction);
+		F c = oc.dot(oc) - radius * radius;
+		F d = b * b - a * c;
+
+		if (d < 0 || a == 0) {
+			return {};
+		}
+
+		F s = Math::sqrt(d);
+
+		return Interval<F>{(-b - s) / a, (-b + s) / a};
+
+	}
+
+	template<CC::Float F>
+	constexpr std::optional<Interval<F>> boxInterval(const Vec3<F>& start, const Vec3<F>& end, const Vec3<F>& origin, const Vec3<F>& inverse) {
+
+		F enter = std::numeric_limits<F>::lowest();
+		F exit = std::numeric_limits<F>::max();
+
+		for (u32 i = 0; i < 3; i++) {
+
+			F t0 = (start[i] - origin[i]) * inverse[i];
+			F t1 = (end[i] - origin[i]) * inverse[i];
+
+			enter = Math::max(enter, Math::min(t0, t1));
+			exit = Math::min(exit, Math::max(t0, t1));
+
+		}
+
+		if (enter > exit) {
+			return {};
+		}
+
+		return Interval<F>{enter, exit};
+
+	}
+
+	template<CC::Float F>
+	constexpr std::optional<F> clipInterval(const std::optional<Interval<F>>& interval, F tMin, F tMax) {
+
+		if (!interval || interval->exit < tMin) {
+			return {};
+		}
+
+		F t = Math::max(interval->enter, tMin);
+
+		if (t > tMax) {
+			return {};
+		}
+
+		return t;
+
+	}
+
+
+	template<CC::Float F>
+	constexpr std::optional<F> intersect(const Box<F>& box, const Vec3<F>& origin, const Vec3<F>& /*direction*/, const Vec3<F>& inverse, F tMin, F tMax) {
+		return clipInterval(boxInterval(box.start(), box.end(), origin, inverse), tMin, tMax);
+	}
+
+	template<CC::Float F>
+	constexpr std::optional<F> intersect(const Sphere<F>& sphere, const Vec3<F>& origin, const Vec3<F>& direction, const Vec3<F>& /*inverse*/, F tMin, F tMax) {
+		return clipInterval(sphereInterval(sphere.origin, sphere.radius, origin, direction), tMin, tMax);
+	}
+
+	//Union of the two cap spheres and the cylinder between their centers
+	template<CC::Float F>
+	constexpr std::optional<F> intersect(const Capsule<F>& capsule, const Vec3<F>& origin, const Vec3<F>& direction, const Vec3<F>& /*inverse*/, F tMin, F tMax) {
+
+		F halfAxis = Math::max(capsule.height / 2 - capsule.radius, F(0));
+		F bottom = capsule.origin.y - halfAxis;
+		F top = capsule.origin.y + halfAxis;
+
+		std::optional<F> t = clipInterval(sphereInterval(Vec3<F>(capsule.origin.x, bottom, capsule.origin.z), capsule.radius, origin, direction), tMin, tMax);
+		std::optional<F> u = clipInterval(sphereInterval(Vec3<F>(capsule.origin.x, top, capsule.origin.z), capsule.radius, origin, direction), tMin, tMax);
+
+		if (!t || (u && *u < *t)) {
+			t = u;
+		}
+
+		//Infinite cylinder in the xz-plane, clipped to the slab between the cap centers
+		F ox = origin.x - capsule.origin.x;
+		F oz = origin.z - capsule.origin.z;
+		F a = direction.x * direction.x + direction.z * direction.z;
+		F b = ox * direction.x + oz * direction.z;
+		F c = ox * ox + oz * oz - capsule.radius * capsule.radius;
+
+		Interval<F> body {std::numeric_limits<F>::lowest(), std::numeric_limits<F>::max()};
+
+		if (a == 0) {
+
+			if (c > 0) {
+				return t;
+			}
+
+		} else {
+
+			F d = b * b - a * c;
+
+			if (d < 0) {
+				return t;
+			}
+
+			F s = Math::sqrt(d);
+			body = {(-b - s) / a, (-b + s) / a};
+
+		}
+
+		if (direction.y == 0) {
+
+			if (origin.y < bottom || origin.y > top) {
+				return t;
+			}
+
+		} else {
+
+			F y0 = (bottom - origin.y) / direction.y;
+			F y1 = (top - origin.y) / direction.y;
+
+			body.enter = Math::max(body.enter, Math::min(y0, y1));
+			body.exit = Math::min(body.exit, Math::max(y0, y1));
+
+			if (body.enter > body.exit) {
+				return t;
+			}
+
+		}
+
+		std::optional<F> v = clipInterval(std::optional<Interval<F>>(body), tMin, tMax);
+
+		if (!t || (v && *v < *t)) {
+			t = v;
+		}
+
+		return t;
+
+	}
+
+	template<class P, CC::Float F>
+	constexpr std::optional<F> intersect(const P& primitive, const Vec3<F>& origin, const Vec3<F>& direction, const Vec3<F>& inverse, F tMin, F tMax) {
+		return intersect(bounds(primitive), origin, direction, inverse, tMin, tMax);
+	}
+
+
+	//Squared distance between a point and an axis-aligned box given by its corners
+	template<CC::Float F>
+	constexpr F distanceSquared(const Vec3<F>& point, const Vec3<F>& start, const Vec3<F>& end) {
+
+		F d = 0;
+
+		for (u32 i = 0; i < 3; i++) {
+
+			F v = Math::max(Math::max(start[i] - point[i], point[i] - end[i]), F(0));
+			d += v * v;
+
+		}
+
+		return d;
+
+	}
+
+	template<CC::Float F>
+	constexpr bool overlaps(const Box<F>& box, const Vec3<F>& start, const Vec3<F>& end) {
+
+		Vec3<F> s = box.start();
+		Vec3<F> e = box.end();
+
+		return s.x <= end.x && e.x >= start.x && s.y <= end.y && e.y >= start.y && s.z <= end.z && e.z >= start.z;
+
+	}
+
+	template<CC::Float F>
+	constexpr bool overlaps(const Sphere<F>& sphere, const Vec3<F>& start, const Vec3<F>& end) {
+		return distanceSquared(sphere.origin, start, end) <= sphere.radius * sphere.radius;
+	}
+
+	//The distance to a vertical segment separates into the xz-distance of its axis and the gap between the y-ranges
+	template<CC::Float F>
+	constexpr bool overlaps(const Capsule<F>& capsule, const Vec3<F>& start, const Vec3<F>& end) {
+
+		F halfAxis = Math::max(capsule.height / 2 - capsule.radius, F(0));
+
+		F dx = Math::max(Math::max(start.x - capsule.origin.x, capsule.origin.x - end.x), F(0));
+		F dy = Math::max(Math::max(start.y - (capsule.origin.y + halfAxis), (capsule.origin.y - halfAxis) - end.y), F(0));
+		F dz = Math::max(Math::max(start.z - capsule.origin.z, capsule.origin.z - end.z), F(0));
+
+		return dx * dx + dy * dy + dz * dz <= capsule.radius * capsule.radius;
+
+	}
+
+	template<class P, CC::Float F>
+	constexpr bool overlaps(const P& primitive, const Vec3<F>& start, const Vec3<F>& end) {
+		return overlaps(bounds(primitive), start, end);
+	}
+
+}
+
+
+
+/*
+ *  Bounding volume hierarchy over primitives exposing boundingBox(), e.g. Box, Sphere and Capsule
+ *  Nodes are split by binned SAH and stored in 32 bytes each (for float), with both children of a node adjacent.
+ *  The hierarchy only keeps primitive indices: every call takes the primitive span it was built from, which may move between
+ *  refit() calls as long as its size stays the same.
+ *
+ *  Traversal uses a short fixed stack, visiting the nearer child first and skipping stacked nodes behind the closest hit.
+ *  Parallel builds split the upper levels serially and build the resulting subtrees on worker threads.
+ */
+template<class P> requires CC::Float<typename P::Type>
+class BVH {
+
+public:
+
+	using F = typename P::Type;
+
+	struct Ray {
+
+		Vec3<F> origin;
+		Vec3<F> direction;
+		F tMin = 0;
+		F tMax = std::numeric_limits<F>::max();
+
+	};
+
+	struct Hit {
+
+		u32 index;
+		F t;
+
+	};
+
+	struct alignas(32) Node {
+
+		Vec3<F> min;
+		u32 offset;		//First primitive slot for leaves, left child for inner nodes (the right one follows it)
+		Vec3<F> max;
+		u32 count;		//Zero for inner nodes
+
+	};
+
+	static_assert(!CC::Equal<F, float> || sizeof(Node) == 32, "BVH node layout is not compact");
+
+	constexpr static u32 MaxLeafSize = 4;
+	constexpr static u32 BinCount = 16;
+	constexpr static u32 MaxDepth = 64;
+
+
+	BVH() = default;
+
+	explicit BVH(std::span<const P> primitives, u32 threadCount = 1) {
+		build(primitives, threadCount);
+	}
+
+
+	/*
+	 *  Builds the hierarchy from scratch
+	 *  threadCount = 0 picks the hardware thread count, small inputs are always built serially.
+	 */
+	void build(std::span<const P> primitives, u32 threadCount = 1) {
+
+		arc_assert(primitives.size() < std::numeric_limits<u32>::max(), "Too many BVH primitives");
+
+		nodes.clear();
+		indices.resize(primitives.size());
+
+		if (primitives.empty()) {
+			return;
+		}
+
+		if (threadCount == 0) {
+			threadCount = Thread::getHardwareThreadCount();
+		}
+
+		if (primitives.size() < ParallelThreshold) {
+			threadCount = 1;
+		}
+
+		BuildState state;
+		state.references.resize(primitives.size());
+
+		parallelFor(primitives.size(), threadCount, [&](SizeT begin, SizeT end) {
+
+			for (SizeT i = begin; i < end; i++) {
+				state.references[i] = {primitiveBounds(primitives[i]), u32(i)};
+			}
+
+		});
+
+		nodes.reserve(primitives.size() * 2 / MaxLeafSize + 1);
+		nodes.emplace_back();
+
+		if (threadCount == 1) {
+
+			buildNode(state, nodes, 0, 0, primitives.size(), 0, nullptr);
+			finishBuild(state);
+
+			return;
+
+		}
+
+		//Upper levels are split serially until the ranges are small enough to balance across the workers
+		std::vector<Task> tasks;
+		state.taskSize = Math::max<SizeT>(primitives.size() / (threadCount * 16), ParallelThreshold / 4);
+
+		buildNode(state, nodes, 0, 0, primitives.size(), 0, &tasks);
+
+		std::sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
+			return a.count > b.count;
+		});
+
+		std::vector<std::vector<Node>> subtrees(tasks.size());
+		std::atomic<SizeT> next = 0;
+
+		auto worker = [&]() {
+
+			for (SizeT i = next++; i < tasks.size(); i = next++) {
+
+				const Task& task = tasks[i];
+				std::vector<Node>& subtree = subtrees[i];
+
+				subtree.reserve(task.count * 2 / MaxLeafSize + 1);
+				subtree.emplace_back();
+
+				buildNode(state, subtree, 0, task.first, task.count, task.depth, nullptr);
+
+			}
+
+		};
+
+		std::vector<Thread> threads(Math::clamp<SizeT>(tasks.size(), 1, threadCount) - 1);
+
+		for (Thread& thread : threads) {
+			thread.start(worker);
+		}
+
+		worker();
+
+		for (Thread& thread : threads) {
+			thread.finish();
+		}
+
+		//Subtree roots replace their placeholders, the remaining nodes are appended with rebased child indices
+		for (SizeT i = 0; i < tasks.size(); i++) {
+
+			const std::vector<Node>& subtree = subtrees[i];
+			u32 base = nodes.size() - 1;
+
+			auto rebase = [base](Node node) {
+
+				if (!node.count) {
+					node.offset += base;
+				}
+
+				return node;
+
+			};
+
+			nodes[tasks[i].node] = rebase(subtree.front());
+
+			for (SizeT j = 1; j < subtree.size(); j++) {
+				nodes.push_back(rebase(subtree[j]));
+			}
+
+		}
+
+		finishBuild(state);
+
+	}
+
+	/*
+	 *  Recomputes all bounds bottom-up for moved primitives while keeping the topology
+	 *  Quality degrades with large movements, rebuild once queries slow down noticeably.
+	 */
+	void refit(std::span<const P> primitives) {
+
+		arc_assert(primitives.size() == indices.size(), "Refit primitive count does not match the build");
+
+		//Children are always stored behind their parents
+		for (SizeT i = nodes.size(); i-- > 0;) {
+
+			Node& node = nodes[i];
+			Bounds bounds = Bounds::empty();
+
+			if (node.count) {
+
+				for (u32 j = 0; j < node.count; j++) {
+					bounds.grow(primitiveBounds(primitives[indices[node.offset + j]]));
+				}
+
+			} else {
+
+				bounds.grow(Bounds(nodes[node.offset].min, nodes[node.offset].max));
+				bounds.grow(Bounds(nodes[node.offset + 1].min, nodes[node.offset + 1].max));
+
+			}
+
+			bounds.store(node);
+
+		}
+
+	}
+
+
+	//Closest hit along the ray
+	std::optional<Hit> raycast(const Ray& ray, std::span<const P> primitives) const {
+
+		std::optional<Hit> hit;
+		F tMax = ray.tMax;
+
+		traverseRay(ray, [&](u32 index, const Vec3<F>& inverse) {
+
+			std::optional<F> t = BVHPrimitive::intersect(primitives[index], ray.origin, ray.direction, inverse, ray.tMin, tMax);
+
+			if (t) {
+
+				hit = Hit{index, *t};
+				tMax = *t;
+
+			}
+
+			return false;
+
+		}, tMax);
+
+		return hit;
+
+	}
+
+	//True if any primitive is hit within [tMin, tMax], stops at the first one found
+	bool occluded(const Ray& ray, std::span<const P> primitives) const {
+
+		bool hit = false;
+		F tMax = ray.tMax;
+
+		traverseRay(ray, [&](u32 index, const Vec3<F>& inverse) {
+
+			hit = BVHPrimitive::intersect(primitives[index], ray.origin, ray.direction, inverse, ray.tMin, tMax).has_value();
+			return hit;
+
+		}, tMax);
+
+		return hit;
+
+	}
+
+	//Invokes function(index) for every primitive overlapping the box
+	template<class Function>
+	void query(const Box<F>& box, std::span<const P> primitives, Function&& function) const {
+
+		if (nodes.empty()) {
+			return;
+		}
+
+		Vec3<F> start = box.start();
+		Vec3<F> end = box.end();
+
+		u32 stack[MaxDepth];
+		u32 stackSize = 0;
+		u32 current = 0;
+
+		if (!overlapsNode(nodes[0], start, end)) {
+			return;
+		}
+
+		while (true) {
+
+			const Node& node = nodes[current];
+
+			if (node.count) {
+
+				for (u32 i = 0; i < node.count; i++) {
+
+					u32 index = indices[node.offset + i];
+
+					if (BVHPrimitive::overlaps(primitives[index], start, end)) {
+						function(index);
+					}
+
+				}
+
+			} else {
+
+				bool left = overlapsNode(nodes[node.offset], start, end);
+				bool right = overlapsNode(nodes[node.offset + 1], start, end);
+
+				if (left) {
+
+					if (right) {
+						stack[stackSize++] = node.offset + 1;
+					}
+
+					current = node.offset;
+					continue;
+
+				} else if (right) {
+
+					current = node.offset + 1;
+					continue;
+
+				}
+
+			}
+
+			if (!stackSize) {
+				break;
+			}
+
+			current = stack[--stackSize];
+
+		}
+
+	}
+
+	void query(const Box<F>& box, std::span<const P> primitives, std::vector<u32>& results) const {
+
+		query(box, primitives, [&](u32 index) {
+			results.push_back(index);
+		});
+
+	}
+
+
+	//Closest hits for a batch of rays, split across threadCount threads (0 picks the hardware thread count)
+	void raycast(std::span<const Ray> rays, std::span<const P> primitives, std::span<std::optional<Hit>> hits, u32 threadCount = 1) const {
+
+		arc_assert(rays.size() == hits.size(), "Ray count does not match the hit count");
+
+		if (threadCount == 0) {
+			threadCount = Thread::getHardwareThreadCount();
+		}
+
+		parallelFor(rays.size(), threadCount, [&](SizeT begin, SizeT end) {
+
+			for (SizeT i = begin; i < end; i++) {
+				hits[i] = raycast(rays[i], primitives);
+			}
+
+		});
+
+	}
+
+	/*
+	 *  Overlap queries for a batch of boxes
+	 *  The hits of box i are stored in indices[offsets[i], offsets[i + 1]), both vectors are overwritten.
+	 */
+	void query(std::span<const Box<F>> boxes, std::span<const P> primitives, std::vector<u32>& indices, std::vector<u32>& offsets) const {
+
+		indices.clear();
+		offsets.resize(boxes.size() + 1);
+
+		for (SizeT i = 0; i < boxes.size(); i++) {
+
+			offsets[i] = indices.size();
+			query(boxes[i], primitives, indices);
+
+		}
+
+		offsets.back() = indices.size();
+
+	}
+
+
+	Box<F> getBounds() const {
+
+		if (nodes.empty()) {
+			return Box<F>(Vec3<F>(0));
+		}
+
+		return Box<F>::fromPoints(nodes[0].min, nodes[0].max);
+
+	}
+
+	std::span<const Node> getNodes() const noexcept {
+		return nodes;
+	}
+
+	SizeT getNodeCount() const noexcept {
+		return nodes.size();
+	}
+
+	SizeT getPrimitiveCount() const noexcept {
+		return indices.size();
+	}
+
+	bool empty() const noexcept {
+		return nodes.empty();
+	}
+
+private:
+
+	constexpr static SizeT ParallelThreshold = 1 << 14;
+
+	//Trivially constructible so that bin arrays cost nothing to declare, empty() yields the identity for grow()
+	struct Bounds {
+
+		Bounds() = default;
+
+		constexpr Bounds(const Vec3<F>& start, const Vec3<F>& end) : min{start.x, start.y, start.z}, max{end.x, end.y, end.z} {}
+
+		constexpr static Bounds empty() {
+
+			Bounds b;
+
+			for (u32 i = 0; i < 3; i++) {
+
+				b.min[i] = std::numeric_limits<F>::max();
+				b.max[i] = std::numeric_limits<F>::lowest();
+
+			}
+
+			return b;
+
+		}
+
+		constexpr void grow(const F (&p)[3]) {
+
+			for (u32 i = 0; i < 3; i++) {
+
+				min[i] = Math::min(min[i], p[i]);
+				max[i] = Math::max(max[i], p[i]);
+
+			}
+
+		}
+
+		constexpr void grow(const Bounds& b) {
+
+			for (u32 i = 0; i < 3; i++) {
+
+				min[i] = Math::min(min[i], b.min[i]);
+				max[i] = Math::max(max[i], b.max[i]);
+
+			}
+
+		}
+
+		constexpr F area() const {
+
+			F dx = max[0] - min[0];
+			F dy = max[1] - min[1];
+			F dz = max[2] - min[2];
+
+			if (dx < 0) {
+				return 0;
+			}
+
+			return 2 * (dx * dy + dx * dz + dy * dz);
+
+		}
+
+		constexpr void store(Node& node) const {
+
+			node.min = Vec3<F>(min[0], min[1], min[2]);
+			node.max = Vec3<F>(max[0], max[1], max[2]);
+
+		}
+
+		F min[3];
+		F max[3];
+
+	};
+
+	struct Bin {
+
+		Bounds bounds;
+		u32 count;
+
+	};
+
+	struct Task {
+
+		u32 node;
+		u32 first;
+		u32 count;
+		u32 depth;
+
+	};
+
+	//Primitives are partitioned by value during the build so that every pass streams through memory
+	struct Reference {
+
+		Bounds bounds;
+		u32 index;
+
+	};
+
+	struct BuildState {
+
+		std::vector<Reference> references;
+		SizeT taskSize = 0;
+
+	};
+
+
+	static Bounds primitiveBounds(const P& primitive) {
+
+		Box<F> box = BVHPrimitive::bounds(primitive);
+		return Bounds(box.start(), box.end());
+
+	}
+
+	void finishBuild(const BuildState& state) {
+
+		for (SizeT i = 0; i < indices.size(); i++) {
+			indices[i] = state.references[i].index;
+		}
+
+	}
+
+	constexpr static F centroid(const Reference& reference, u32 axis) {
+		return (reference.bounds.min[axis] + reference.bounds.max[axis]) / 2;
+	}
+
+	void buildNode(BuildState& state, std::vector<Node>& target, u32 nodeIndex, u32 first, u32 count, u32 depth, std::vector<Task>* tasks) {
+
+		Reference* range = state.references.data() + first;
+		Bounds bounds = Bounds::empty();
+		Bounds centroidBounds = Bounds::empty();
+
+		for (u32 i = 0; i < count; i++) {
+
+			F c[3] = {centroid(range[i], 0), centroid(range[i], 1), centroid(range[i], 2)};
+
+			bounds.grow(range[i].bounds);
+			centroidBounds.grow(c);
+
+		}
+
+		bounds.store(target[nodeIndex]);
+
+		auto makeLeaf = [&]() {
+
+			target[nodeIndex].offset = first;
+			target[nodeIndex].count = count;
+
+		};
+
+		if (count <= 1 || depth + 1 >= MaxDepth) {
+
+			makeLeaf();
+			return;
+
+		}
+
+		if (tasks && count <= state.taskSize) {
+
+			tasks->push_back({nodeIndex, first, count, depth});
+			return;
+
+		}
+
+		//Binned SAH, all three axes are binned in a single pass over the centroids. Small nodes need fewer bins.
+		u32 binCount = Math::min(count, BinCount);
+		F scale[3];
+		Bin bins[3][BinCount];
+
+		for (u32 axis = 0; axis < 3; axis++) {
+
+			F extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+			scale[axis] = extent > 0 ? binCount / extent : 0;
+
+			for (u32 i = 0; i < binCount; i++) {
+				bins[axis][i] = {Bounds::empty(), 0};
+			}
+
+		}
+
+		auto binIndex = [&](const Reference& reference, u32 axis) {
+			return Math::min(u32((centroid(reference, axis) - centroidBounds.min[axis]) * scale[axis]), binCount - 1);
+		};
+
+		for (u32 i = 0; i < count; i++) {
+
+			for (u32 axis = 0; axis < 3; axis++) {
+
+				Bin& bin = bins[axis][binIndex(range[i], axis)];
+
+				bin.count++;
+				bin.bounds.grow(range[i].bounds);
+
+			}
+
+		}
+
+		F bestCost = std::numeric_limits<F>::max();
+		u32 bestAxis = 0;
+		u32 bestSplit = 0;
+
+		for (u32 axis = 0; axis < 3; axis++) {
+
+			if (scale[axis] == 0) {
+				continue;
+			}
+
+			F leftArea[BinCount - 1];
+			u32 leftCount[BinCount - 1];
+			Bounds sweep = Bounds::empty();
+			u32 sweepCount = 0;
+
+			for (u32 i = 0; i < binCount - 1; i++) {
+
+				sweepCount += bins[axis][i].count;
+				sweep.grow(bins[axis][i].bounds);
+
+				leftCount[i] = sweepCount;
+				leftArea[i] = sweep.area();
+
+			}
+
+			sweep = Bounds::empty();
+			sweepCount = 0;
+
+			for (u32 i = binCount - 1; i > 0; i--) {
+
+				sweepCount += bins[axis][i].count;
+				sweep.grow(bins[axis][i].bounds);
+
+				if (leftCount[i - 1] && sweepCount) {
+
+					F cost = leftCount[i - 1] * leftArea[i - 1] + sweepCount * sweep.area();
+
+					if (cost < bestCost) {
+
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i;
+
+					}
+
+				}
+
+			}
+
+		}
+
+		//Identical centroids cannot be separated
+		if (bestCost == std::numeric_limits<F>::max()) {
+
+			makeLeaf();
+			return;
+
+		}
+
+		//Splitting costs one traversal step against intersecting every primitive of the leaf
+		F area = bounds.area();
+
+		if (count <= MaxLeafSize && bestCost + area >= count * area) {
+
+			makeLeaf();
+			return;
+
+		}
+
+		Reference* middle = std::partition(range, range + count, [&](const Reference& reference) {
+			return binIndex(reference, bestAxis) < bestSplit;
+		});
+
+		u32 leftCount = middle - range;
+		u32 left = target.size();
+
+		target[nodeIndex].offset = left;
+		target[nodeIndex].count = 0;
+
+		target.emplace_back();
+		target.emplace_back();
+
+		buildNode(state, target, left, first, leftCount, depth + 1, tasks);
+		buildNode(state, target, left + 1, first + leftCount, count - leftCount, depth + 1, tasks);
+
+	}
+
+	//Slab test against a node, returns the entry distance or infinity on a miss
+	static F intersectNode(const Node& node, const Vec3<F>& origin, const Vec3<F>& inverse, F tMin, F tMax) {
+
+		F tx0 = (node.min.x - origin.x) * inverse.x;
+		F tx1 = (node.max.x - origin.x) * inverse.x;
+		F ty0 = (node.min.y - origin.y) * inverse.y;
+		F ty1 = (node.max.y - origin.y) * inverse.y;
+		F tz0 = (node.min.z - origin.z) * inverse.z;
+		F tz1 = (node.max.z - origin.z) * inverse.z;
+
+		F enter = Math::max(Math::max(Math::min(tx0, tx1), Math::min(ty0, ty1)), Math::max(Math::min(tz0, tz1), tMin));
+		F exit = Math::min(Math::min(Math::max(tx0, tx1), Math::max(ty0, ty1)), Math::min(Math::max(tz0, tz1), tMax));
+
+		return enter <= exit ? enter : std::numeric_limits<F>::infinity();
+
+	}
+
+	static bool overlapsNode(const Node& node, const Vec3<F>& start, const Vec3<F>& end) {
+		return node.min.x <= end.x && node.max.x >= start.x && node.min.y <= end.y && node.max.y >= start.y && node.min.z <= end.z && node.max.z >= start.z;
+	}
+
+	/*
+	 *  Visits the leaves along the ray front to back
+	 *  visit(index, inverse) returns true to stop, tMax is read after every leaf so that a shrinking hit distance culls the rest.
+	 */
+	template<class Function>
+	void traverseRay(const Ray& ray, Function&& visit, const F& tMax) const {
+
+		if (nodes.empty()) {
+			return;
+		}
+
+		Vec3<F> inverse(F(1) / ray.direction.x, F(1) / ray.direction.y, F(1) / ray.direction.z);
+
+		u32 stack[MaxDepth];
+		F stackDistance[MaxDepth];
+		u32 stackSize = 0;
+		u32 current = 0;
+
+		constexpr F Miss = std::numeric_limits<F>::infinity();
+
+		if (intersectNode(nodes[0], ray.origin, inverse, ray.tMin, tMax) == Miss) {
+			return;
+		}
+
+		while (true) {
+
+			const Node& node = nodes[current];
+
+			if (node.count) {
+
+				for (u32 i = 0; i < node.count; i++) {
+
+					if (visit(indices[node.offset + i], inverse)) {
+						return;
+					}
+
+				}
+
+			} else {
+
+				u32 near = node.offset;
+				u32 far = node.offset + 1;
+
+				F nearDistance = intersectNode(nodes[near], ray.origin, inverse, ray.tMin, tMax);
+				F farDistance = intersectNode(nodes[far], ray.origin, inverse, ray.tMin, tMax);
+
+				if (farDistance < nearDistance) {
+
+					std::swap(near, far);
+					std::swap(nearDistance, farDistance);
+
+				}
+
+				if (nearDistance != Miss) {
+
+					if (farDistance != Miss) {
+
+						stack[stackSize] = far;
+						stackDistance[stackSize] = farDistance;
+						stackSize++;
+
+					}
+
+					current = near;
+					continue;
+
+				}
+
+			}
+
+			//Pop the next node that still lies in front of the closest hit
+			do {
+
+				if (!stackSize) {
+					return;
+				}
+
+				stackSize--;
+
+			} while (stackDistance[stackSize] > tMax);
+
+			current = stack[stackSize];
+
+		}
+
+	}
+
+	template<class Function>
+	static void parallelFor(SizeT count, u32 threadCount, Function&& function) {
+
+		threadCount = Math::max(Math::min<SizeT>(threadCount, count / 1024), SizeT(1));
+
+		if (threadCount == 1) {
+
+			function(0, count);
+			return;
+
+		}
+
+		SizeT chunk = (count + threadCount - 1) / threadCount;
+		std::vector<Thread> threads(threadCount - 1);
+
+		for (u32 i = 0; i < threads.size(); i++) {
+
+			threads[i].start([&function, i, chunk, count]() {
+				function(Math::min(chunk * (i + 1), count), Math::min(chunk * (i + 2), count));
+			});
+
+		}
+
+		function(0, Math::min(chunk, count));
+
+		for (Thread& thread : threads) {
+			thread.finish();
+		}
+
+	}
+
+
+	std::vector<Node> nodes;
+	std::vector<u32> indices;
+
+};
@@ -109,7 +109,7 @@ public:
 	template<CC::Arithmetic B>
 	constexpr bool intersects(const Capsule<B>& other) const {
 
-		static_assert(false, "Incomplete or missing functionality");
+		static_assert(sizeof(B) == 0, "Incomplete or missing functionality");
 
 		// TODO: Check cylinder-top hemisphere intersection
 
@@ -146,7 +146,7 @@ public:
 	template<CC::Arithmetic B>
 	constexpr bool contains(const Capsule<B>& other) const {
 
-		static_assert(false, "Incomplete or missing functionality");
+		static_assert(sizeof(B) == 0, "Incomplete or missing functionality");
 
 		// TODO: figure out a clean to do this
 		return false;
@@ -0,0 +1,379 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 culling.hpp
+ */
+
+#pragma once
+
+#include "math/frustum.hpp"
+#include "math/vectorpacket.hpp"
+#include "memory/alignedallocator.hpp"
+#include "util/bits.hpp"
+#include "types.hpp"
+
+#include <span>
+#include <vector>
+
+
+/*
+ *  Batch visibility culling
+ *  Bounds are kept in structure-of-arrays sets padded to whole packets, so every test handles eight objects per step
+ *  (one AVX register for float, see vectorpacket.hpp) and writes their results as one byte of the visibility bitmask.
+ *  Bit i of the mask is set if object i is potentially visible. Padding lanes never pass any test.
+ */
+namespace Culling {
+
+	constexpr static SizeT Lanes = 8;
+
+
+	// Returns the number of bytes a visibility bitmask for count objects requires
+	constexpr SizeT maskSize(SizeT count) {
+		return (count + Lanes - 1) / Lanes;
+	}
+
+
+	template<CC::Float T>
+	class SphereSet {
+
+	public:
+
+		using Storage = std::vector<T, AlignedAllocator<T, 32>>;
+
+		SphereSet() : count(0) {}
+
+		explicit SphereSet(std::span<const Sphere<T>> spheres) : SphereSet() {
+			assign(spheres);
+		}
+
+		void assign(std::span<const Sphere<T>> spheres) {
+
+			resize(spheres.size());
+
+			for (SizeT i = 0; i < spheres.size(); i++) {
+				set(i, spheres[i]);
+			}
+
+		}
+
+		void resize(SizeT size) {
+
+			SizeT padded = maskSize(size) * Lanes;
+
+			x.resize(padded, T(0));
+			y.resize(padded, T(0));
+			z.resize(padded, T(0));
+			radius.resize(padded, T(0));
+
+			//Negative infinite radii make the padding fail every test
+			for (SizeT i = size; i < padded; i++) {
+				radius[i] = -std::numeric_limits<T>::infinity();
+			}
+
+			count = size;
+
+		}
+
+		void set(SizeT index, const Sphere<T>& sphere) {
+
+			arc_assert(index < count, "Sphere index %d out of bounds", index);
+
+			x[index] = sphere.origin.x;
+			y[index] = sphere.origin.y;
+			z[index] = sphere.origin.z;
+			radius[index] = sphere.radius;
+
+		}
+
+		Sphere<T> get(SizeT index) const {
+
+			arc_assert(index < count, "Sphere index %d out of bounds", index);
+			return Sphere<T>(radius[index], Vec3<T>(x[index], y[index], z[index]));
+
+		}
+
+		void clear() {
+
+			x.clear();
+			y.clear();
+			z.clear();
+			radius.clear();
+			count = 0;
+
+		}
+
+		SizeT size() const {
+			return count;
+		}
+
+		Storage x, y, z, radius;
+
+	private:
+
+		SizeT count;
+
+	};
+
+
+	// Boxes are stored as center and half extent
+	template<CC::Float T>
+	class BoxSet {
+
+	public:
+
+		using Storage = std::vector<T, AlignedAllocator<T, 32>>;
+
+		BoxSet() : count(0) {}
+
+		explicit BoxSet(std::span<const Box<T>> boxes) : BoxSet() {
+			assign(boxes);
+		}
+
+		void assign(std::span<const Box<T>> boxes) {
+
+			resize(boxes.size());
+
+			for (SizeT i = 0; i < boxes.size(); i++) {
+				set(i, boxes[i]);
+			}
+
+		}
+
+		void resize(SizeT size) {
+
+			SizeT padded = maskSize(size) * Lanes;
+
+			x.resize(padded, T(0));
+			y.resize(padded, T(0));
+			z.resize(padded, T(0));
+			extentX.resize(padded, T(0));
+			extentY.resize(padded, T(0));
+			extentZ.resize(padded, T(0));
+
+			//Negative infinite extents make the padding fail every test
+			for (SizeT i = size; i < padded; i++) {
+				extentX[i] = extentY[i] = extentZ[i] = -std::numeric_limits<T>::infinity();
+			}
+
+			count = size;
+
+		}
+
+		void set(SizeT index, const Box<T>& box) {
+
+			arc_assert(index < count, "Box index %d out of bounds", index);
+
+			x[index] = box.origin.x;
+			y[index] = box.origin.y;
+			z[index] = box.origin.z;
+			extentX[index] = box.size.x / T(2);
+			extentY[index] = box.size.y / T(2);
+			extentZ[index] = box.size.z / T(2);
+
+		}
+
+		Box<T> get(SizeT index) const {
+
+			arc_assert(index < count, "Box index %d out of bounds", index);
+			return Box<T>(Vec3<T>(extentX[index], extentY[index], extentZ[index]) * T(2), Vec3<T>(x[index], y[index], z[index]));
+
+		}
+
+		void clear() {
+
+			x.clear();
+			y.clear();
+			z.clear();
+			extentX.clear();
+			extentY.clear();
+			extentZ.clear();
+			count = 0;
+
+		}
+
+		SizeT size() const {
+			return count;
+		}
+
+		Storage x, y, z, extentX, extentY, extentZ;
+
+	private:
+
+		SizeT count;
+
+	};
+
+
+
+	namespace Detail {
+
+		template<CC::Float T>
+		struct FrustumPackets {
+
+			explicit FrustumPackets(const Frustum<T>& frustum) {
+
+				for (u32 i = 0; i < Frustum<T>::PlaneCount; i++) {
+
+					const Vec4<T>& p = frustum.planes[i];
+
+					x[i] = Packet8<T>(p.x);
+					y[i] = Packet8<T>(p.y);
+					z[i] = Packet8<T>(p.z);
+					w[i] = Packet8<T>(p.w);
+					absX[i] = Packet8<T>(Math::abs(p.x));
+					absY[i] = Packet8<T>(Math::abs(p.y));
+					absZ[i] = Packet8<T>(Math::abs(p.z));
+
+				}
+
+			}
+
+			Packet8<T> x[6], y[6], z[6], w[6];
+			Packet8<T> absX[6], absY[6], absZ[6];
+
+		};
+
+	}
+
+
+	// Tests every sphere against the frustum, returns the number of visible spheres
+	template<CC::Float T>
+	SizeT cull(const Frustum<T>& frustum, const SphereSet<T>& spheres, std::span<u8> visibility) {
+
+		using P = Packet8<T>;
+
+		arc_assert(visibility.size() >= maskSize(spheres.size()), "Visibility mask too small");
+
+		Detail::FrustumPackets<T> planes(frustum);
+		SizeT visible = 0;
+
+		for (SizeT i = 0; i < spheres.size(); i += Lanes) {
+
+			P x = P::loadAligned(&spheres.x[i]);
+			P y = P::loadAligned(&spheres.y[i]);
+			P z = P::loadAligned(&spheres.z[i]);
+			P r = -P::loadAligned(&spheres.radius[i]);
+
+			auto inside = planes.x[0] * x + planes.y[0] * y + planes.z[0] * z + planes.w[0] >= r;
+
+			for (u32 j = 1; j < Frustum<T>::PlaneCount; j++) {
+				inside = inside & (planes.x[j] * x + planes.y[j] * y + planes.z[j] * z + planes.w[j] >= r);
+			}
+
+			u32 bits = inside.bits();
+
+			visibility[i / Lanes] = bits;
+			visible += Bits::popcount(bits);
+
+		}
+
+		return visible;
+
+	}
+
+
+	// Tests every box against the frustum, returns the number of visible boxes
+	template<CC::Float T>
+	SizeT cull(const Frustum<T>& frustum, const BoxSet<T>& boxes, std::span<u8> visibility) {
+
+		using P = Packet8<T>;
+
+		arc_assert(visibility.size() >= maskSize(boxes.size()), "Visibility mask too small");
+
+		Detail::FrustumPackets<T> planes(frustum);
+		SizeT visible = 0;
+
+		for (SizeT i = 0; i < boxes.size(); i += Lanes) {
+
+			P x = P::loadAligned(&boxes.x[i]);
+			P y = P::loadAligned(&boxes.y[i]);
+			P z = P::loadAligned(&boxes.z[i]);
+			P ex = P::loadAligned(&boxes.extentX[i]);
+			P ey = P::loadAligned(&boxes.extentY[i]);
+			P ez = P::loadAligned(&boxes.extentZ[i]);
+
+			auto test = [&](u32 j) {
+
+				P distance = planes.x[j] * x + planes.y[j] * y + planes.z[j] * z + planes.w[j];
+				P radius = planes.absX[j] * ex + planes.absY[j] * ey + planes.absZ[j] * ez;
+
+				return distance + radius >= P(0);
+
+			};
+
+			auto inside = test(0);
+
+			for (u32 j = 1; j < Frustum<T>::PlaneCount; j++) {
+				inside = inside & test(j);
+			}
+
+			u32 bits = inside.bits();
+
+			visibility[i / Lanes] = bits;
+			visible += Bits::popcount(bits);
+
+		}
+
+		return visible;
+
+	}
+
+
+	// Tests every box against a query box, returns the number of overlapping boxes
+	template<CC::Float T>
+	SizeT overlap(const Box<T>& box, const BoxSet<T>& boxes, std::span<u8> visibility) {
+
+		using P = Packet8<T>;
+
+		arc_assert(visibility.size() >= maskSize(boxes.size()), "Visibility mask too small");
+
+		P cx(box.origin.x), cy(box.origin.y), cz(box.origin.z);
+		P hx(box.size.x / T(2)), hy(box.size.y / T(2)), hz(box.size.z / T(2));
+		SizeT visible = 0;
+
+		for (SizeT i = 0; i < boxes.size(); i += Lanes) {
+
+			P dx = (P::loadAligned(&boxes.x[i]) - cx).abs();
+			P dy = (P::loadAligned(&boxes.y[i]) - cy).abs();
+			P dz = (P::loadAligned(&boxes.z[i]) - cz).abs();
+
+			auto inside = (dx <= P::loadAligned(&boxes.extentX[i]) + hx) & (dy <= P::loadAligned(&boxes.extentY[i]) + hy) & (dz <= P::loadAligned(&boxes.extentZ[i]) + hz);
+			u32 bits = inside.bits();
+
+			visibility[i / Lanes] = bits;
+			visible += Bits::popcount(bits);
+
+		}
+
+		return visible;
+
+	}
+
+
+	// Appends the indices of all set bits in the first count bits of the mask, e.g. to build a submission list
+	inline void gather(std::span<const u8> visibility, SizeT count, std::vector<u32>& indices) {
+
+		SizeT bytes = maskSize(count);
+
+		for (SizeT i = 0; i < bytes; i++) {
+
+			u32 bits = visibility[i];
+
+			if (i == bytes - 1 && count % Lanes) {
+				bits &= (1 << (count % Lanes)) - 1;
+			}
+
+			while (bits) {
+
+				indices.push_back(i * Lanes + Bits::ctz(bits));
+				bits &= bits - 1;
+
+			}
+
+		}
+
+	}
+
+}
@@ -9,15 +9,54 @@
 #pragma once
 
 #include "parser.hpp"
+#include "mathprogram.hpp"
 
+#include <initializer_list>
 
 
+
+/*
+ *  Compiled math expression
+ *  The expression is parsed once into a folded, deduplicated graph and compiled to a MathProgram.
+ *  Variables are bound by index in the order given on construction or, if none are given, in order of appearance.
+ */
 class MathExpression {
 
 public:
 
-	MathExpression(const std::string& expression) {
-		Parser(expression).parse();
+	MathExpression(const std::string& expression) : graph(Parser(expression).parse()), program(graph) {}
+
+	MathExpression(const std::string& expression, std::span<const std::string> variables) : graph(Parser(expression).parse(variables)), program(graph) {}
+
+
+	double evaluate(std::span<const double> variables = {}) const {
+		return program.evaluate(variables);
+	}
+
+	double evaluate(std::initializer_list<double> variables) const {
+		return program.evaluate(std::span{variables.begin(), variables.size()});
+	}
+
+	void evaluate(std::span<const std::span<const double>> variables, std::span<double> results) const {
+		program.evaluate(variables, results);
 	}
 
-};
\ No newline at end of file
+
+	const std::vector<std::string>& getVariables() const {
+		return graph.getVariables();
+	}
+
+	std::optional<u32> getVariableIndex(std::string_view name) const {
+		return graph.findVariable(name);
+	}
+
+	const MathProgram& getProgram() const {
+		return program;
+	}
+
+private:
+
+	MathGraph graph;
+	MathProgram program;
+
+};
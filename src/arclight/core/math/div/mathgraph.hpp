@@ -0,0 +1,300 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mathgraph.hpp
+ */
+
+#pragma once
+
+#include "math/math.hpp"
+#include "types.hpp"
+
+#include <bit>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+
+enum class MathOp : u8 {
+
+	Constant,
+	Variable,
+
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Modulo,
+	Power,
+	Min,
+	Max,
+	Atan2,
+
+	Negate,
+	Abs,
+	Sqrt,
+	Cbrt,
+	Exp,
+	Ln,
+	Log,
+	Sin,
+	Cos,
+	Tan,
+	Asin,
+	Acos,
+	Atan,
+	Floor,
+	Ceil,
+	Round,
+	Trunc
+
+};
+
+
+struct MathNode {
+
+	MathOp op;
+	u32 a;
+	u32 b;
+	double value;
+
+};
+
+
+
+/*
+ *  Expression DAG
+ *  Nodes are created bottom-up and deduplicated on creation, so equal subexpressions share one node (CSE).
+ *  Operations on constants are folded immediately, and identities that hold exactly for every operand
+ *  (x * 1, x / 1, x + -0, x ^ 1, -(-x)) are removed.
+ *  Since children always precede their parents, the node order is a valid evaluation order.
+ */
+class MathGraph {
+
+public:
+
+	constexpr static bool isUnary(MathOp op) {
+		return op >= MathOp::Negate;
+	}
+
+	// Min and Max are left out, Math::min/max pick an operand for NaN and signed zeros depending on the order
+	constexpr static bool isCommutative(MathOp op) {
+		return op == MathOp::Add || op == MathOp::Multiply;
+	}
+
+	ARC_FORCE_INLINE static double apply(MathOp op, double x, double y) {
+
+		switch (op) {
+
+			case MathOp::Add:		return x + y;
+			case MathOp::Subtract:	return x - y;
+			case MathOp::Multiply:	return x * y;
+			case MathOp::Divide:	return x / y;
+			case MathOp::Modulo:	return std::fmod(x, y);
+			case MathOp::Power:		return std::pow(x, y);
+			case MathOp::Min:		return Math::min(x, y);
+			case MathOp::Max:		return Math::max(x, y);
+			case MathOp::Atan2:		return std::atan2(x, y);
+			case MathOp::Negate:	return -x;
+			case MathOp::Abs:		return std::abs(x);
+			case MathOp::Sqrt:		return std::sqrt(x);
+			case MathOp::Cbrt:		return std::cbrt(x);
+			case MathOp::Exp:		return std::exp(x);
+			case MathOp::Ln:		return std::log(x);
+			case MathOp::Log:		return std::log10(x);
+			case MathOp::Sin:		return std::sin(x);
+			case MathOp::Cos:		return std::cos(x);
+			case MathOp::Tan:		return std::tan(x);
+			case MathOp::Asin:		return std::asin(x);
+			case MathOp::Acos:		return std::acos(x);
+			case MathOp::Atan:		return std::atan(x);
+			case MathOp::Floor:		return std::floor(x);
+			case MathOp::Ceil:		return std::ceil(x);
+			case MathOp::Round:		return std::round(x);
+			case MathOp::Trunc:		return std::trunc(x);
+			default:				return 0;
+
+		}
+
+	}
+
+
+	u32 constant(double value) {
+		return insert({MathOp::Constant, 0, 0, value});
+	}
+
+	u32 variable(u32 index) {
+		return insert({MathOp::Variable, index, 0, 0});
+	}
+
+	u32 unary(MathOp op, u32 x) {
+
+		const MathNode& n = nodes[x];
+
+		if (n.op == MathOp::Constant) {
+			return constant(apply(op, n.value, 0));
+		}
+
+		if (op == MathOp::Negate && n.op == MathOp::Negate) {
+			return n.a;
+		}
+
+		return insert({op, x, 0, 0});
+
+	}
+
+	u32 binary(MathOp op, u32 x, u32 y) {
+
+		const MathNode& n = nodes[x];
+		const MathNode& m = nodes[y];
+
+		if (n.op == MathOp::Constant && m.op == MathOp::Constant) {
+			return constant(apply(op, n.value, m.value));
+		}
+
+		bool rightConstant = m.op == MathOp::Constant;
+
+		switch (op) {
+
+			case MathOp::Add:
+
+				if (rightConstant && m.value == 0 && std::signbit(m.value)) {
+					return x;
+				} else if (n.op == MathOp::Constant && n.value == 0 && std::signbit(n.value)) {
+					return y;
+				}
+
+				break;
+
+			case MathOp::Multiply:
+
+				if (rightConstant && m.value == 1) {
+					return x;
+				} else if (n.op == MathOp::Constant && n.value == 1) {
+					return y;
+				}
+
+				break;
+
+			case MathOp::Divide:
+
+				if (rightConstant && m.value == 1) {
+					return x;
+				}
+
+				//Division by a power of two equals multiplication by its exact reciprocal
+				if (rightConstant && std::isnormal(m.value) && std::isnormal(1 / m.value) && std::bit_cast<u64>(m.value) << 12 == 0) {
+					return binary(MathOp::Multiply, x, constant(1 / m.value));
+				}
+
+				break;
+
+			case MathOp::Subtract:
+
+				if (rightConstant) {
+					return binary(MathOp::Add, x, constant(-m.value));
+				}
+
+				break;
+
+			case MathOp::Power:
+
+				if (rightConstant && m.value == 1) {
+					return x;
+				} else if (rightConstant && m.value == 2) {
+					return binary(MathOp::Multiply, x, x);
+				} else if (rightConstant && m.value == -1) {
+					return binary(MathOp::Divide, constant(1), x);
+				}
+
+				break;
+
+			default:
+				break;
+
+		}
+
+		//Canonical operand order lets a + b and b + a share a node
+		if (isCommutative(op) && x > y) {
+			std::swap(x, y);
+		}
+
+		return insert({op, x, y, 0});
+
+	}
+
+
+	u32 addVariable(const std::string& name) {
+
+		variables.push_back(name);
+		return variables.size() - 1;
+
+	}
+
+	std::optional<u32> findVariable(std::string_view name) const {
+
+		for (u32 i = 0; i < variables.size(); i++) {
+
+			if (variables[i] == name) {
+				return i;
+			}
+
+		}
+
+		return {};
+
+	}
+
+
+	const std::vector<MathNode>& getNodes() const {
+		return nodes;
+	}
+
+	const MathNode& getNode(u32 index) const {
+		return nodes[index];
+	}
+
+	const std::vector<std::string>& getVariables() const {
+		return variables;
+	}
+
+	u32 getRoot() const {
+		return root;
+	}
+
+	void setRoot(u32 node) {
+		root = node;
+	}
+
+private:
+
+	using Key = std::tuple<MathOp, u32, u32, u64>;
+
+	u32 insert(const MathNode& node) {
+
+		Key key {node.op, node.a, node.b, std::bit_cast<u64>(node.value)};
+		auto it = lookup.find(key);
+
+		if (it != lookup.end()) {
+			return it->second;
+		}
+
+		nodes.push_back(node);
+		lookup.emplace(key, nodes.size() - 1);
+
+		return nodes.size() - 1;
+
+	}
+
+	std::vector<MathNode> nodes;
+	std::vector<std::string> variables;
+	std::map<Key, u32> lookup;
+	u32 root = 0;
+
+};
@@ -0,0 +1,306 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mathprogram.hpp
+ */
+
+#pragma once
+
+#include "mathgraph.hpp"
+#include "memory/alignedallocator.hpp"
+#include "util/assert.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+
+
+namespace Detail {
+
+	constexpr u32 MathBlockSize = 64;
+
+	using MathKernel = void(*)(double*, const double*, const double*);
+
+	template<MathOp Op>
+	void mathKernel(double* __restrict d, const double* __restrict a, const double* __restrict b) {
+
+		for (u32 i = 0; i < MathBlockSize; i++) {
+			d[i] = MathGraph::apply(Op, a[i], b[i]);
+		}
+
+	}
+
+	template<SizeT... I>
+	constexpr auto makeMathKernels(std::index_sequence<I...>) {
+		return std::array<MathKernel, sizeof...(I)> { &mathKernel<static_cast<MathOp>(I)>... };
+	}
+
+	constexpr auto mathKernels = makeMathKernels(std::make_index_sequence<static_cast<SizeT>(MathOp::Trunc) + 1>{});
+
+}
+
+
+
+/*
+ *  Register bytecode compiled from a MathGraph
+ *  Constants and variables live in fixed registers, intermediate results in registers reused once their last reader ran.
+ *  A destination never aliases its operands, so batch evaluation runs every instruction as one tight loop over
+ *  a block of BlockSize lanes per register, which the compiler vectorizes for the arithmetic operations.
+ */
+class MathProgram {
+
+public:
+
+	constexpr static u32 BlockSize = Detail::MathBlockSize;
+
+	struct Instruction {
+
+		MathOp op;
+		u32 dst;
+		u32 a;
+		u32 b;
+
+	};
+
+
+	MathProgram() : registerCount(1), result(0), variableCount(0), constants{{0, 0}} {}
+
+	explicit MathProgram(const MathGraph& graph) : MathProgram() {
+		compile(graph);
+	}
+
+
+	void compile(const MathGraph& graph) {
+
+		const std::vector<MathNode>& nodes = graph.getNodes();
+		u32 root = graph.getRoot();
+
+		instructions.clear();
+		constants.clear();
+		loads.clear();
+		registerCount = 0;
+		variableCount = graph.getVariables().size();
+
+		if (nodes.empty()) {
+
+			constants.push_back({0, 0});
+			registerCount = 1;
+			result = 0;
+
+			return;
+
+		}
+
+		//Children precede parents, so a single reverse sweep finds every node the root depends on
+		std::vector<bool> live(root + 1);
+		std::vector<u32> lastUse(root + 1, 0);
+		live[root] = true;
+
+		for (u32 i = root + 1; i-- > 0;) {
+
+			const MathNode& node = nodes[i];
+
+			if (!live[i] || node.op == MathOp::Constant || node.op == MathOp::Variable) {
+				continue;
+			}
+
+			live[node.a] = true;
+			lastUse[node.a] = Math::max(lastUse[node.a], i);
+
+			if (!MathGraph::isUnary(node.op)) {
+
+				live[node.b] = true;
+				lastUse[node.b] = Math::max(lastUse[node.b], i);
+
+			}
+
+		}
+
+		lastUse[root] = std::numeric_limits<u32>::max();
+
+		std::vector<u32> registers(root + 1);
+		std::vector<u32> freeRegisters;
+
+		auto release = [&](u32 node, u32 current) {
+
+			const MathNode& n = nodes[node];
+
+			if (lastUse[node] == current && n.op != MathOp::Constant && n.op != MathOp::Variable) {
+				freeRegisters.push_back(registers[node]);
+			}
+
+		};
+
+		for (u32 i = 0; i <= root; i++) {
+
+			if (!live[i]) {
+				continue;
+			}
+
+			const MathNode& node = nodes[i];
+
+			if (node.op == MathOp::Constant) {
+
+				registers[i] = registerCount++;
+				constants.push_back({registers[i], node.value});
+
+			} else if (node.op == MathOp::Variable) {
+
+				registers[i] = registerCount++;
+				loads.push_back({registers[i], node.a});
+
+			} else {
+
+				//Allocate before releasing the operands so that the destination never aliases them
+				if (freeRegisters.empty()) {
+
+					registers[i] = registerCount++;
+
+				} else {
+
+					registers[i] = freeRegisters.back();
+					freeRegisters.pop_back();
+
+				}
+
+				bool unary = MathGraph::isUnary(node.op);
+				instructions.push_back({node.op, registers[i], registers[node.a], unary ? registers[node.a] : registers[node.b]});
+
+				release(node.a, i);
+
+				if (!unary && node.b != node.a) {
+					release(node.b, i);
+				}
+
+			}
+
+		}
+
+		result = registers[root];
+
+	}
+
+
+	//Evaluates the program for one set of variable values
+	double evaluate(std::span<const double> variables) const {
+
+		arc_assert(variables.size() >= variableCount, "Expected %d variables, got %d", variableCount, variables.size());
+
+		constexpr u32 StackRegisters = 64;
+
+		double stackRegisters[StackRegisters];
+		std::vector<double> heapRegisters;
+		double* r = stackRegisters;
+
+		if (registerCount > StackRegisters) {
+
+			heapRegisters.resize(registerCount);
+			r = heapRegisters.data();
+
+		}
+
+		for (const Constant& c : constants) {
+			r[c.reg] = c.value;
+		}
+
+		for (const Load& l : loads) {
+			r[l.reg] = variables[l.variable];
+		}
+
+		for (const Instruction& i : instructions) {
+			r[i.dst] = MathGraph::apply(i.op, r[i.a], r[i.b]);
+		}
+
+		return r[result];
+
+	}
+
+	/*
+	 *  Evaluates the program results.size() times, variables[v][i] holding the value of variable v for result i.
+	 *  Works through the spans in blocks of BlockSize, interpreting each instruction once per block.
+	 */
+	void evaluate(std::span<const std::span<const double>> variables, std::span<double> results) const {
+
+		SizeT count = results.size();
+
+		arc_assert(variables.size() >= variableCount, "Expected %d variables, got %d", variableCount, variables.size());
+
+		for ([[maybe_unused]] const Load& l : loads) {
+			arc_assert(variables[l.variable].size() >= count, "Variable %d holds too few values", l.variable);
+		}
+
+		std::vector<double, AlignedAllocator<double, 64>> storage(registerCount * BlockSize);
+		double* r = storage.data();
+
+		for (const Constant& c : constants) {
+			std::fill_n(r + c.reg * BlockSize, BlockSize, c.value);
+		}
+
+		for (SizeT start = 0; start < count; start += BlockSize) {
+
+			SizeT n = Math::min(count - start, BlockSize);
+
+			for (const Load& l : loads) {
+
+				double* dst = r + l.reg * BlockSize;
+
+				std::copy_n(variables[l.variable].data() + start, n, dst);
+				std::fill(dst + n, dst + BlockSize, 0.0);
+
+			}
+
+			for (const Instruction& i : instructions) {
+				Detail::mathKernels[static_cast<u32>(i.op)](r + i.dst * BlockSize, r + i.a * BlockSize, r + i.b * BlockSize);
+			}
+
+			std::copy_n(r + result * BlockSize, n, results.data() + start);
+
+		}
+
+	}
+
+
+	const std::vector<Instruction>& getInstructions() const {
+		return instructions;
+	}
+
+	u32 getRegisterCount() const {
+		return registerCount;
+	}
+
+	u32 getVariableCount() const {
+		return variableCount;
+	}
+
+private:
+
+	struct Constant {
+
+		u32 reg;
+		double value;
+
+	};
+
+	struct Load {
+
+		u32 reg;
+		u32 variable;
+
+	};
+
+	std::vector<Instruction> instructions;
+	u32 registerCount;
+	u32 result;
+	u32 variableCount;
+
+	std::vector<Constant> constants;
+	std::vector<Load> loads;
+
+};
@@ -8,10 +8,14 @@
 
 #pragma once
 
+#include "mathgraph.hpp"
 #include "common/exception.hpp"
 #include "util/log.hpp"
 
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <span>
 #include <string_view>
 
 
@@ -43,7 +47,9 @@ private:
 enum class TokenType {
 
 	Constant,
+	Identifier,
 	Operator,
+	Comma,
 	LeftBracket,
 	RightBracket,
 	End
@@ -53,164 +59,384 @@ enum class TokenType {
 
 struct Token {
 
-	constexpr Token() noexcept : Token("", TokenType::End) {}
-	constexpr Token(std::string_view str, TokenType type) : str(str), type(type) {}
+	constexpr Token() noexcept : Token("", TokenType::End, 0) {}
+	constexpr Token(std::string_view str, TokenType type, SizeT position) : str(str), type(type), position(position) {}
 
 	std::string_view str;
 	TokenType type;
+	SizeT position;
 
 };
 
 
-class Parser {
 
-	enum class State {
-		Expression
-	};
+/*
+ *  Recursive descent parser producing a MathGraph
+ *  Grammar, lowest precedence first:
+ *    sum     := product (('+' | '-') product)*
+ *    product := unary (('*' | '/' | '%') unary)*
+ *    unary   := ('+' | '-') unary | power
+ *    power   := primary ('^' unary)?                    right associative, -2^2 = -(2^2)
+ *    primary := number | name | name '(' sum (',' sum)* ')' | '(' sum ')'
+ *  Names are the constants pi and e, variables, or functions (see functions below).
+ */
+class Parser {
 
 public:
 
 	Parser() : Parser("") {}
-	explicit Parser(const std::string& exp) : expression(exp), cursor(0), tokenStart(0) {}
+	explicit Parser(std::string_view exp) : expression(exp), cursor(0), declaredVariables(false) {}
 
-	void parse() {
+	//Parses the expression, collecting variables in order of appearance
+	MathGraph parse() {
 
-		LogD() << expression;
+		graph = MathGraph();
+		declaredVariables = false;
 
-		u32 level = 0;
-		cursor = 0;
-		tokenStart = 0;
+		return parseExpression();
 
-		Token token = tokenize();
-		LogD() << "Token" << token.str;
+	}
 
-		while (token.type != TokenType::End) {
+	//Parses the expression, only accepting the given variables
+	MathGraph parse(std::span<const std::string> variables) {
 
-			token = tokenize();
-			LogD() << "Token" << token.str;
+		graph = MathGraph();
+		declaredVariables = true;
 
+		for (const std::string& name : variables) {
+			graph.addVariable(name);
 		}
 
-	}
+		return parseExpression();
 
+	}
 
 
 	Token tokenize() {
 
-		tokenStart = cursor;
+		while (cursor < expression.size() && isSpace(charAtCursor())) {
+			cursor++;
+		}
+
+		SizeT start = cursor;
 		TokenType type = scanNextToken();
 
-		return { std::string_view(expression.begin() + tokenStart, expression.begin() + cursor), type };
+		return { expression.substr(start, cursor - start), type, start };
 
 	}
 
 
 	TokenType scanNextToken() {
 
-		TokenType type;
+		if (cursor >= expression.size()) {
+			return TokenType::End;
+		}
 
-		while (cursor < expression.size()) {
+		char c = charAtCursor();
 
-			char c = charAtCursor();
-			cursor++;
+		switch (c) {
+
+			case '(':	cursor++; return TokenType::LeftBracket;
+			case ')':	cursor++; return TokenType::RightBracket;
+			case ',':	cursor++; return TokenType::Comma;
 
-			switch (c) {
+			case '+':
+			case '-':
+			case '*':
+			case '/':
+			case '%':
+			case '^':
+				cursor++;
+				return TokenType::Operator;
 
-				case '(':   return TokenType::LeftBracket;
-				case ')':   return TokenType::RightBracket;
+			default:
+				break;
 
-				case ' ':
-					tokenStart++;
-					break;
+		}
 
-				default:
-					throw MathSyntaxException(std::string("Illegal '") + c + "'", expression, cursor - 1);
+		if ((c >= '0' && c <= '9') || c == '.') {
 
+			parseConstant();
+			return TokenType::Constant;
+
+		}
+
+		if (isNameStart(c)) {
+
+			while (cursor < expression.size() && (isNameStart(charAtCursor()) || (charAtCursor() >= '0' && charAtCursor() <= '9'))) {
+				cursor++;
 			}
 
+			return TokenType::Identifier;
+
 		}
 
-		return type;
+		throw MathSyntaxException(std::string("Illegal '") + c + "'", expression, cursor);
 
 	}
 
 
 	void parseConstant() {
 
-		bool hasDecimal = false;
-		bool hasDigits = false;
-		bool negative = false;
-		u32 x = 0;
-		u32 y = 0;
+		double value;
+		auto result = std::from_chars(expression.data() + cursor, expression.data() + expression.size(), value);
 
-		auto c = charAtCursor();
+		if (result.ec != std::errc()) {
+			throw MathSyntaxException("Bad number in expression", expression, cursor);
+		}
 
-		if (c == '-') {
+		cursor = result.ptr - expression.data();
 
-			negative = true;
-			cursor++;
+	}
 
-		} else if (c == '+') {
 
-			cursor++;
+	constexpr bool cursorAtSpace() {
+		return isSpace(charAtCursor());
+	}
+
+
+	constexpr char charAtCursor() const {
+		return expression[cursor];
+	}
+
 
+private:
+
+	struct Function {
+
+		std::string_view name;
+		MathOp op;
+		u32 arguments;
+
+	};
+
+	constexpr static std::array<Function, 21> functions = {{
+		{"abs", MathOp::Abs, 1},		{"sqrt", MathOp::Sqrt, 1},		{"cbrt", MathOp::Cbrt, 1},
+		{"exp", MathOp::Exp, 1},		{"ln", MathOp::Ln, 1},			{"log", MathOp::Log, 1},
+		{"sin", MathOp::Sin, 1},		{"cos", MathOp::Cos, 1},		{"tan", MathOp::Tan, 1},
+		{"asin", MathOp::Asin, 1},		{"acos", MathOp::Acos, 1},		{"atan", MathOp::Atan, 1},
+		{"floor", MathOp::Floor, 1},	{"ceil", MathOp::Ceil, 1},		{"round", MathOp::Round, 1},
+		{"trunc", MathOp::Trunc, 1},	{"min", MathOp::Min, 2},		{"max", MathOp::Max, 2},
+		{"pow", MathOp::Power, 2},		{"mod", MathOp::Modulo, 2},		{"atan2", MathOp::Atan2, 2}
+	}};
+
+
+	constexpr static bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	constexpr static bool isNameStart(char c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+	}
+
+
+	MathGraph parseExpression() {
+
+		cursor = 0;
+		advance();
+
+		u32 root = parseSum();
+
+		if (token.type != TokenType::End) {
+			throw MathSyntaxException("Unexpected '" + std::string(token.str) + "'", expression, token.position);
 		}
 
-		for (cursor; cursor < expression.size(); cursor++) {
+		graph.setRoot(root);
 
-			c = charAtCursor();
+		return std::move(graph);
 
-			if (c >= '0' && c <= '9') {
+	}
 
-				u32& v = hasDecimal ? y : x;
-				v *= 10;
-				v += c - '0';
+	void advance() {
+		token = tokenize();
+	}
 
-				hasDigits = true;
+	bool atOperator(char c) const {
+		return token.type == TokenType::Operator && token.str[0] == c;
+	}
 
-			} else if (c == '.') {
+	void expect(TokenType type, const char* what) {
 
-				if (hasDecimal) {
-					throw MathSyntaxException("Double decimal point in number", expression, cursor);
-				}
+		if (token.type != type) {
+			throw MathSyntaxException(std::string("Expected ") + what, expression, token.position);
+		}
 
-				hasDecimal = true;
+		advance();
 
-			} else {
+	}
 
-				break;
+	u32 parseSum() {
+
+		u32 node = parseProduct();
+
+		while (atOperator('+') || atOperator('-')) {
+
+			MathOp op = atOperator('+') ? MathOp::Add : MathOp::Subtract;
+			advance();
+
+			node = graph.binary(op, node, parseProduct());
 
-			}
-			
 		}
 
-		if (!hasDigits) {
-			throw MathSyntaxException("Bad decimal point in expression", expression, cursor);
+		return node;
+
+	}
+
+	u32 parseProduct() {
+
+		u32 node = parseUnary();
+
+		while (atOperator('*') || atOperator('/') || atOperator('%')) {
+
+			MathOp op = atOperator('*') ? MathOp::Multiply : (atOperator('/') ? MathOp::Divide : MathOp::Modulo);
+			advance();
+
+			node = graph.binary(op, node, parseUnary());
+
 		}
 
-		if (!hasDecimal || (hasDecimal && !y)) {
-			LogI("MathExpr").print("Constant [Int]   %c%d", negative ? '-' : '+', x);
-		} else {
-			LogI("MathExpr").print("Constant [Float] %c%d.%d", negative ? '-' : '+', x, y);
+		return node;
+
+	}
+
+	u32 parseUnary() {
+
+		if (atOperator('-')) {
+
+			advance();
+			return graph.unary(MathOp::Negate, parseUnary());
+
+		} else if (atOperator('+')) {
+
+			advance();
+			return parseUnary();
+
 		}
 
+		return parsePower();
+
 	}
 
+	u32 parsePower() {
+
+		u32 node = parsePrimary();
+
+		if (atOperator('^')) {
+
+			advance();
+			node = graph.binary(MathOp::Power, node, parseUnary());
+
+		}
+
+		return node;
 
-	constexpr bool cursorAtSpace() {
-		return charAtCursor() == ' ';
 	}
 
+	u32 parsePrimary() {
+
+		Token t = token;
+
+		switch (t.type) {
+
+			case TokenType::Constant:
+			{
+				double value = 0;
+				std::from_chars(t.str.data(), t.str.data() + t.str.size(), value);
+				advance();
+
+				return graph.constant(value);
+			}
+
+			case TokenType::LeftBracket:
+			{
+				advance();
+				u32 node = parseSum();
+				expect(TokenType::RightBracket, "')'");
+
+				return node;
+			}
+
+			case TokenType::Identifier:
+				advance();
+				return token.type == TokenType::LeftBracket ? parseCall(t) : parseName(t);
+
+			case TokenType::End:
+				throw MathSyntaxException("Unexpected end of expression", expression, t.position);
+
+			default:
+				throw MathSyntaxException("Unexpected '" + std::string(t.str) + "'", expression, t.position);
+
+		}
 
-	constexpr char charAtCursor() const {
-		return expression[cursor];
 	}
 
+	u32 parseCall(const Token& name) {
+
+		auto it = std::find_if(functions.begin(), functions.end(), [&](const Function& f) { return f.name == name.str; });
+
+		if (it == functions.end()) {
+			throw MathSyntaxException("Unknown function '" + std::string(name.str) + "'", expression, name.position);
+		}
+
+		advance();
+
+		u32 args[2] {};
+		u32 count = 0;
+
+		while (true) {
+
+			u32 node = parseSum();
+
+			if (count < it->arguments) {
+				args[count] = node;
+			}
+
+			count++;
+
+			if (token.type != TokenType::Comma) {
+				break;
+			}
+
+			advance();
+
+		}
+
+		if (count != it->arguments) {
+			throw MathSyntaxException("Function '" + std::string(it->name) + "' takes " + std::to_string(it->arguments) + " argument(s)", expression, name.position);
+		}
+
+		expect(TokenType::RightBracket, "')'");
+
+		return it->arguments == 1 ? graph.unary(it->op, args[0]) : graph.binary(it->op, args[0], args[1]);
+
+	}
+
+	u32 parseName(const Token& name) {
+
+		if (auto index = graph.findVariable(name.str)) {
+			return graph.variable(*index);
+		}
+
+		if (name.str == "pi") {
+			return graph.constant(Math::pi);
+		} else if (name.str == "e") {
+			return graph.constant(Math::e);
+		}
+
+		if (declaredVariables) {
+			throw MathSyntaxException("Unknown variable '" + std::string(name.str) + "'", expression, name.position);
+		}
+
+		return graph.variable(graph.addVariable(std::string(name.str)));
+
+	}
 
-private:
 
 	std::string_view expression;
 	SizeT cursor;
-	SizeT tokenStart;
 
-};
\ No newline at end of file
+	Token token;
+	MathGraph graph;
+	bool declaredVariables;
+
+};
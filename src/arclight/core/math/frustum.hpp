@@ -0,0 +1,170 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 frustum.hpp
+ */
+
+#pragma once
+
+#include "math/box.hpp"
+#include "math/matrix.hpp"
+#include "math/sphere.hpp"
+#include "math/vector.hpp"
+#include "util/log.hpp"
+#include "types.hpp"
+
+
+
+/*
+ *  View frustum given by six inward facing planes
+ *  Each plane is stored as (nx, ny, nz, d) with a unit normal, a point p lies inside the plane if dot(n, p) + d >= 0.
+ *  Intersection tests are conservative: they never reject visible volumes but may accept some near the frustum corners.
+ */
+template<CC::Float T>
+class Frustum {
+
+public:
+
+	using Type		= T;
+	using VecT		= Vec3<Type>;
+	using PlaneT	= Vec4<Type>;
+
+	enum Plane : u32 {
+		Left,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far
+	};
+
+	constexpr static u32 PlaneCount = 6;
+
+
+	// Constructs a degenerate frustum that contains everything
+	constexpr Frustum() : planes{} {}
+
+	// Extracts the frustum from a (view-)projection matrix mapping depth to [-1, 1] like Mat4::perspective()
+	constexpr static Frustum fromMatrix(const Mat4<T>& m) {
+
+		Frustum frustum;
+
+		PlaneT r0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		PlaneT r1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		PlaneT r2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		PlaneT r3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		frustum.planes[Left]	= r3 + r0;
+		frustum.planes[Right]	= r3 - r0;
+		frustum.planes[Bottom]	= r3 + r1;
+		frustum.planes[Top]		= r3 - r1;
+		frustum.planes[Near]	= r3 + r2;
+		frustum.planes[Far]		= r3 - r2;
+
+		for (PlaneT& p : frustum.planes) {
+
+			T length = VecT(p.x, p.y, p.z).length();
+
+			if (length > T(0)) {
+				p /= length;
+			}
+
+		}
+
+		return frustum;
+
+	}
+
+	// Returns the given plane
+	constexpr const PlaneT& getPlane(u32 plane) const {
+		return planes[plane];
+	}
+
+	// Calculates the signed distance from a point to the given plane, positive towards the inside
+	constexpr T distance(u32 plane, const VecT& point) const {
+
+		const PlaneT& p = planes[plane];
+		return p.x * point.x + p.y * point.y + p.z * point.z + p.w;
+
+	}
+
+	// Checks whether the point lies inside the frustum
+	constexpr bool contains(const VecT& point) const {
+
+		for (u32 i = 0; i < PlaneCount; i++) {
+
+			if (distance(i, point) < T(0)) {
+				return false;
+			}
+
+		}
+
+		return true;
+
+	}
+
+	// Checks whether the sphere intersects the frustum
+	constexpr bool intersects(const Sphere<T>& sphere) const {
+
+		for (u32 i = 0; i < PlaneCount; i++) {
+
+			if (distance(i, sphere.origin) < -sphere.radius) {
+				return false;
+			}
+
+		}
+
+		return true;
+
+	}
+
+	// Checks whether the box intersects the frustum
+	constexpr bool intersects(const Box<T>& box) const {
+
+		VecT extent = box.size / T(2);
+
+		for (u32 i = 0; i < PlaneCount; i++) {
+
+			const PlaneT& p = planes[i];
+			T radius = Math::abs(p.x) * extent.x + Math::abs(p.y) * extent.y + Math::abs(p.z) * extent.z;
+
+			if (distance(i, box.origin) < -radius) {
+				return false;
+			}
+
+		}
+
+		return true;
+
+	}
+
+	PlaneT planes[PlaneCount];
+
+};
+
+
+template<CC::Float F>
+RawLog& operator<<(RawLog& log, const Frustum<F>& frustum) {
+
+	log << "Frustum[";
+
+	for (u32 i = 0; i < Frustum<F>::PlaneCount; i++) {
+
+		const auto& p = frustum.planes[i];
+		log << (i ? ", " : "") << "[" << p.x << ", " << p.y << ", " << p.z << ", " << p.w << "]";
+
+	}
+
+	log << "]";
+
+	return log;
+
+}
+
+
+using FrustumF     = Frustum<float>;
+using FrustumD     = Frustum<double>;
+using FrustumLD    = Frustum<long double>;
+using FrustumX     = Frustum<ARC_STD_FLOAT_TYPE>;
@@ -0,0 +1,584 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 matrixbatch.hpp
+ */
+
+#pragma once
+
+#include "math/matrix.hpp"
+#include "math/vectorpacket.hpp"
+#include "arcintrinsic.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <span>
+
+
+/*
+ *  Bulk matrix kernels
+ *  Every kernel processes a whole span per call and loads matrices straight from their aligned storage.
+ *  Outputs may alias their inputs element for element.
+ *
+ *  transform/multiply run on SSE/AVX registers for float and fall back to the member operators otherwise.
+ *  invert/normalMatrix evaluate eight matrices at once in structure-of-arrays packets (see vectorpacket.hpp).
+ *  They use cofactor expansion over 2x2 subdeterminants, so results may differ from Mat4::inverse() in the last bits.
+ *  Kernels built on packets only use them if ARC_VECTOR_PACKET_NATIVE is defined, emulated packets are slower than the member functions.
+ */
+namespace MatrixBatch {
+
+	namespace Detail {
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+		ARC_FORCE_INLINE void transpose8x8(__m256 (&r)[8]) {
+
+			__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+			__m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+			__m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+			__m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+			__m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+			__m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+			__m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+			__m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+			__m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+			__m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+			__m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+			__m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+			__m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+			__m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+			__m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+			__m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+			r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+			r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+			r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+			r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+			r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+			r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+			r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+			r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+
+		}
+
+#endif
+
+		/*
+		 *  Transposes count matrices into 16 packets, element e[c * 4 + r] holds column c, row r
+		 *  Missing lanes are filled with the identity so that they stay invertible.
+		 */
+		template<CC::Float T>
+		ARC_FORCE_INLINE void loadMatrices(const Mat4<T>* m, SizeT count, Packet8<T> (&e)[16]) {
+
+			alignas(32) T lanes[16][8];
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+			if constexpr (CC::Equal<T, float>) {
+
+				if (count == 8) {
+
+					for (u32 h = 0; h < 2; h++) {
+
+						__m256 r[8];
+
+						for (u32 i = 0; i < 8; i++) {
+							r[i] = _mm256_loadu_ps(&m[i][h * 2].x);
+						}
+
+						transpose8x8(r);
+
+						for (u32 i = 0; i < 8; i++) {
+							_mm256_store_ps(lanes[h * 8 + i], r[i]);
+						}
+
+					}
+
+					for (u32 i = 0; i < 16; i++) {
+						e[i] = Packet8<T>::loadAligned(lanes[i]);
+					}
+
+					return;
+
+				}
+
+			}
+
+#endif
+
+			const Mat4<T> identity;
+
+			for (SizeT i = 0; i < 8; i++) {
+
+				const Mat4<T>& n = i < count ? m[i] : identity;
+
+				for (u32 j = 0; j < 16; j++) {
+					lanes[j][i] = n[j / 4][j % 4];
+				}
+
+			}
+
+			for (u32 i = 0; i < 16; i++) {
+				e[i] = Packet8<T>::loadAligned(lanes[i]);
+			}
+
+		}
+
+		template<CC::Float T>
+		ARC_FORCE_INLINE void storeMatrices(Mat4<T>* m, SizeT count, const Packet8<T> (&e)[16]) {
+
+			alignas(32) T lanes[16][8];
+
+			for (u32 i = 0; i < 16; i++) {
+				e[i].storeAligned(lanes[i]);
+			}
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+			if constexpr (CC::Equal<T, float>) {
+
+				if (count == 8) {
+
+					for (u32 h = 0; h < 2; h++) {
+
+						__m256 r[8];
+
+						for (u32 i = 0; i < 8; i++) {
+							r[i] = _mm256_load_ps(lanes[h * 8 + i]);
+						}
+
+						transpose8x8(r);
+
+						for (u32 i = 0; i < 8; i++) {
+							_mm256_storeu_ps(&m[i][h * 2].x, r[i]);
+						}
+
+					}
+
+					return;
+
+				}
+
+			}
+
+#endif
+
+			for (SizeT i = 0; i < count; i++) {
+				for (u32 j = 0; j < 16; j++) {
+					m[i][j / 4][j % 4] = lanes[j][i];
+				}
+			}
+
+		}
+
+		template<CC::Float T>
+		ARC_FORCE_INLINE void storeMatrices(Mat3<T>* m, SizeT count, const Packet8<T> (&e)[9]) {
+
+			alignas(32) T lanes[9][8];
+
+			for (u32 i = 0; i < 9; i++) {
+				e[i].storeAligned(lanes[i]);
+			}
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+			if constexpr (CC::Equal<T, float>) {
+
+				if (count == 8) {
+
+					__m256 r[8];
+
+					for (u32 i = 0; i < 8; i++) {
+						r[i] = _mm256_load_ps(lanes[i]);
+					}
+
+					transpose8x8(r);
+
+					// Each store covers elements 0 to 7 of one matrix, the last element is written separately
+					for (u32 i = 0; i < 8; i++) {
+
+						_mm256_storeu_ps(&m[i][0].x, r[i]);
+						m[i][2][2] = lanes[8][i];
+
+					}
+
+					return;
+
+				}
+
+			}
+
+#endif
+
+			for (SizeT i = 0; i < count; i++) {
+				for (u32 j = 0; j < 9; j++) {
+					m[i][j / 3][j % 3] = lanes[j][i];
+				}
+			}
+
+		}
+
+	}
+
+
+
+	// out[i] = m * in[i]
+	template<CC::Float T>
+	void transform(const Mat4<T>& m, TT::TypeIdentity<std::span<const Vec4<T>>> in, TT::TypeIdentity<std::span<Vec4<T>>> out) {
+
+		arc_assert(in.size() == out.size(), "Input and output spans differ in size");
+
+		SizeT i = 0;
+
+#ifdef ARC_VECTORIZE_X86_SSE
+
+		if constexpr (CC::Equal<T, float>) {
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+			__m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[0].x));
+			__m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[1].x));
+			__m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[2].x));
+			__m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[3].x));
+
+			for (; i + 2 <= in.size(); i += 2) {
+
+				__m256 v = _mm256_loadu_ps(&in[i].x);
+
+				__m256 x = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+				__m256 y = _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55));
+				__m256 z = _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA));
+				__m256 w = _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF));
+
+				_mm256_storeu_ps(&out[i].x, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), w));
+
+			}
+
+#endif
+
+			__m128 d0 = _mm_load_ps(&m[0].x);
+			__m128 d1 = _mm_load_ps(&m[1].x);
+			__m128 d2 = _mm_load_ps(&m[2].x);
+			__m128 d3 = _mm_load_ps(&m[3].x);
+
+			for (; i < in.size(); i++) {
+
+				__m128 v = _mm_load_ps(&in[i].x);
+
+				__m128 x = _mm_mul_ps(d0, _mm_shuffle_ps(v, v, 0x00));
+				__m128 y = _mm_mul_ps(d1, _mm_shuffle_ps(v, v, 0x55));
+				__m128 z = _mm_mul_ps(d2, _mm_shuffle_ps(v, v, 0xAA));
+				__m128 w = _mm_mul_ps(d3, _mm_shuffle_ps(v, v, 0xFF));
+
+				_mm_store_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), w));
+
+			}
+
+		}
+
+#endif
+
+		for (; i < in.size(); i++) {
+			out[i] = m * in[i];
+		}
+
+	}
+
+
+	/*
+	 *  out[i] = (m * Vec4(in[i], w)).xyz
+	 *  Points are transformed with w = 1, directions with w = 0. No perspective division is performed.
+	 */
+	template<CC::Float T>
+	void transform(const Mat4<T>& m, TT::TypeIdentity<std::span<const Vec3<T>>> in, TT::TypeIdentity<std::span<Vec3<T>>> out, T w) {
+
+		arc_assert(in.size() == out.size(), "Input and output spans differ in size");
+
+		SizeT i = 0;
+
+#ifdef ARC_VECTORIZE_X86_SSE
+
+		if constexpr (CC::Equal<T, float>) {
+
+			__m128 c0 = _mm_load_ps(&m[0].x);
+			__m128 c1 = _mm_load_ps(&m[1].x);
+			__m128 c2 = _mm_load_ps(&m[2].x);
+			__m128 c3 = _mm_mul_ps(_mm_load_ps(&m[3].x), _mm_set1_ps(w));
+
+			for (; i < in.size(); i++) {
+
+				__m128 x = _mm_mul_ps(c0, _mm_load1_ps(&in[i].x));
+				__m128 y = _mm_mul_ps(c1, _mm_load1_ps(&in[i].y));
+				__m128 z = _mm_mul_ps(c2, _mm_load1_ps(&in[i].z));
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), c3);
+
+				// Vec3 is not padded, a full store would overwrite the next vector
+				_mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+				_mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+
+			}
+
+			return;
+
+		}
+
+#endif
+
+#ifdef ARC_VECTOR_PACKET_NATIVE
+
+		using P = Packet8<T>;
+
+		P m00(m[0][0]), m01(m[0][1]), m02(m[0][2]);
+		P m10(m[1][0]), m11(m[1][1]), m12(m[1][2]);
+		P m20(m[2][0]), m21(m[2][1]), m22(m[2][2]);
+		P m30(m[3][0] * w), m31(m[3][1] * w), m32(m[3][2] * w);
+
+		for (; i < in.size(); i += 8) {
+
+			SizeT count = std::min<SizeT>(8, in.size() - i);
+			Vec3x8<T> v = Vec3x8<T>::load(&in[i], count);
+
+			Vec3x8<T> r {
+				m00 * v.x + m10 * v.y + m20 * v.z + m30,
+				m01 * v.x + m11 * v.y + m21 * v.z + m31,
+				m02 * v.x + m12 * v.y + m22 * v.z + m32
+			};
+
+			r.store(&out[i], count);
+
+		}
+
+#else
+
+		for (; i < in.size(); i++) {
+
+			Vec4<T> v = m * Vec4<T>(in[i].x, in[i].y, in[i].z, w);
+			out[i] = Vec3<T>(v.x, v.y, v.z);
+
+		}
+
+#endif
+
+	}
+
+	template<CC::Float T>
+	void transformPoints(const Mat4<T>& m, TT::TypeIdentity<std::span<const Vec3<T>>> in, TT::TypeIdentity<std::span<Vec3<T>>> out) {
+		transform<T>(m, in, out, T(1));
+	}
+
+	template<CC::Float T>
+	void transformDirections(const Mat4<T>& m, TT::TypeIdentity<std::span<const Vec3<T>>> in, TT::TypeIdentity<std::span<Vec3<T>>> out) {
+		transform<T>(m, in, out, T(0));
+	}
+
+
+	// out[i] = a[i] * b[i]
+	template<CC::Float T>
+	void multiply(std::span<const Mat4<T>> a, std::span<const Mat4<T>> b, std::span<Mat4<T>> out) {
+
+		arc_assert(a.size() == b.size() && a.size() == out.size(), "Matrix spans differ in size");
+
+#ifdef ARC_VECTORIZE_X86_SSE
+
+		if constexpr (CC::Equal<T, float>) {
+
+			for (SizeT i = 0; i < a.size(); i++) {
+
+#ifdef ARC_VECTORIZE_X86_AVX
+
+				// Computes two result columns per register, summed in the same order as Mat4::multiply
+				__m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][0].x));
+				__m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][1].x));
+				__m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][2].x));
+				__m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][3].x));
+
+				__m256 r01 = _mm256_loadu_ps(&b[i][0].x);
+				__m256 r23 = _mm256_loadu_ps(&b[i][2].x);
+
+				__m256 c01 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(l0, _mm256_permute_ps(r01, 0x00)), _mm256_mul_ps(l1, _mm256_permute_ps(r01, 0x55))),
+										   _mm256_add_ps(_mm256_mul_ps(l2, _mm256_permute_ps(r01, 0xAA)), _mm256_mul_ps(l3, _mm256_permute_ps(r01, 0xFF))));
+
+				__m256 c23 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(l0, _mm256_permute_ps(r23, 0x00)), _mm256_mul_ps(l1, _mm256_permute_ps(r23, 0x55))),
+										   _mm256_add_ps(_mm256_mul_ps(l2, _mm256_permute_ps(r23, 0xAA)), _mm256_mul_ps(l3, _mm256_permute_ps(r23, 0xFF))));
+
+				_mm256_storeu_ps(&out[i][0].x, c01);
+				_mm256_storeu_ps(&out[i][2].x, c23);
+
+#else
+
+				__m128 l0 = _mm_load_ps(&a[i][0].x);
+				__m128 l1 = _mm_load_ps(&a[i][1].x);
+				__m128 l2 = _mm_load_ps(&a[i][2].x);
+				__m128 l3 = _mm_load_ps(&a[i][3].x);
+
+				__m128 c[4];
+
+				for (u32 j = 0; j < 4; j++) {
+
+					__m128 r = _mm_load_ps(&b[i][j].x);
+
+					c[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_shuffle_ps(r, r, 0x00)), _mm_mul_ps(l1, _mm_shuffle_ps(r, r, 0x55))),
+									  _mm_add_ps(_mm_mul_ps(l2, _mm_shuffle_ps(r, r, 0xAA)), _mm_mul_ps(l3, _mm_shuffle_ps(r, r, 0xFF))));
+
+				}
+
+				for (u32 j = 0; j < 4; j++) {
+					_mm_store_ps(&out[i][j].x, c[j]);
+				}
+
+#endif
+
+			}
+
+			return;
+
+		}
+
+#endif
+
+		for (SizeT i = 0; i < a.size(); i++) {
+			out[i] = a[i] * b[i];
+		}
+
+	}
+
+
+	// out[i] = in[i]^-1
+	template<CC::Float T>
+	void invert(std::span<const Mat4<T>> in, std::span<Mat4<T>> out) {
+
+		arc_assert(in.size() == out.size(), "Input and output spans differ in size");
+
+#ifdef ARC_VECTOR_PACKET_NATIVE
+
+		using P = Packet8<T>;
+
+		for (SizeT first = 0; first < in.size(); first += 8) {
+
+			SizeT count = std::min<SizeT>(8, in.size() - first);
+
+			P x[16];
+			Detail::loadMatrices(&in[first], count, x);
+
+			// Row-major element names
+			const P& a = x[0], & b = x[4], & c = x[8],  & d = x[12];
+			const P& e = x[1], & f = x[5], & g = x[9],  & h = x[13];
+			const P& i = x[2], & j = x[6], & k = x[10], & l = x[14];
+			const P& m = x[3], & n = x[7], & o = x[11], & p = x[15];
+
+			P s0 = a * f - e * b;
+			P s1 = a * g - e * c;
+			P s2 = a * h - e * d;
+			P s3 = b * g - f * c;
+			P s4 = b * h - f * d;
+			P s5 = c * h - g * d;
+
+			P c5 = k * p - o * l;
+			P c4 = j * p - n * l;
+			P c3 = j * o - n * k;
+			P c2 = i * p - m * l;
+			P c1 = i * o - m * k;
+			P c0 = i * n - m * j;
+
+			P det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			arc_assert((det == P(0)).none(), "Mat4 inverse failed: Matrix not invertible");
+
+			P s = P(1) / det;
+
+			// Column-major result
+			P r[16] = {
+				(f * c5 - g * c4 + h * c3) * s,
+				(-e * c5 + g * c2 - h * c1) * s,
+				(e * c4 - f * c2 + h * c0) * s,
+				(-e * c3 + f * c1 - g * c0) * s,
+				(-b * c5 + c * c4 - d * c3) * s,
+				(a * c5 - c * c2 + d * c1) * s,
+				(-a * c4 + b * c2 - d * c0) * s,
+				(a * c3 - b * c1 + c * c0) * s,
+				(n * s5 - o * s4 + p * s3) * s,
+				(-m * s5 + o * s2 - p * s1) * s,
+				(m * s4 - n * s2 + p * s0) * s,
+				(-m * s3 + n * s1 - o * s0) * s,
+				(-j * s5 + k * s4 - l * s3) * s,
+				(i * s5 - k * s2 + l * s1) * s,
+				(-i * s4 + j * s2 - l * s0) * s,
+				(i * s3 - j * s1 + k * s0) * s
+			};
+
+			Detail::storeMatrices(&out[first], count, r);
+
+		}
+
+#else
+
+		for (SizeT i = 0; i < in.size(); i++) {
+			out[i] = in[i].inverse();
+		}
+
+#endif
+
+	}
+
+
+	// out[i] = transpose(inverse(mat3(in[i]))), the matrix transforming normals under in[i]
+	template<CC::Float T>
+	void normalMatrix(std::span<const Mat4<T>> in, std::span<Mat3<T>> out) {
+
+		arc_assert(in.size() == out.size(), "Input and output spans differ in size");
+
+#ifdef ARC_VECTOR_PACKET_NATIVE
+
+		using P = Packet8<T>;
+
+		for (SizeT first = 0; first < in.size(); first += 8) {
+
+			SizeT count = std::min<SizeT>(8, in.size() - first);
+
+			P x[16];
+			Detail::loadMatrices(&in[first], count, x);
+
+			// Row-major element names of the upper 3x3 block
+			const P& a = x[0], & b = x[4], & c = x[8];
+			const P& d = x[1], & e = x[5], & f = x[9];
+			const P& g = x[2], & h = x[6], & i = x[10];
+
+			P c00 = e * i - f * h;
+			P c01 = f * g - d * i;
+			P c02 = d * h - e * g;
+
+			P det = a * c00 + b * c01 + c * c02;
+			arc_assert((det == P(0)).none(), "Mat3 inverse failed: Matrix not invertible");
+
+			P s = P(1) / det;
+
+			// The normal matrix is the cofactor matrix divided by the determinant, stored column-major
+			P r[9] = {
+				c00 * s,
+				(c * h - b * i) * s,
+				(b * f - c * e) * s,
+				c01 * s,
+				(a * i - c * g) * s,
+				(c * d - a * f) * s,
+				c02 * s,
+				(b * g - a * h) * s,
+				(a * e - b * d) * s
+			};
+
+			Detail::storeMatrices(&out[first], count, r);
+
+		}
+
+#else
+
+		for (SizeT i = 0; i < in.size(); i++) {
+			out[i] = in[i].toMat3().inverse().transposed();
+		}
+
+#endif
+
+	}
+
+}
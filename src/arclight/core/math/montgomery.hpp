@@ -0,0 +1,347 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 montgomery.hpp
+ */
+
+#pragma once
+
+#include "math/bigint.hpp"
+#include "util/assert.hpp"
+#include "types.hpp"
+
+#include <vector>
+#include <span>
+
+
+
+/*
+ *  Modular arithmetic context for a fixed odd modulus N > 1
+ *  Values in Montgomery form are stored as aR mod N with R = 2^(64 * limbs). Products are reduced by interleaved
+ *  word-wise reduction (CIOS), which avoids any division once the context has been built.
+ */
+class Montgomery {
+
+	using ValueT = BigInt::ValueT;
+	using Limbs = BigInt::Limbs;
+
+	constexpr static u32 ValueBits = BigInt::ValueBits;
+
+public:
+
+	constexpr explicit Montgomery(const BigInt& modulus) : modulus(modulus), size(modulus.magnitude.size()) {
+
+		arc_assert(modulus > 1 && modulus.lowestBitSet(), "Montgomery modulus must be odd and greater than 1");
+
+		//Newton iteration for N^-1 mod 2^64, every step doubles the number of correct low bits
+		ValueT n0 = modulus.magnitude.front();
+		ValueT inv = n0;
+
+		for (u32 i = 0; i < 5; i++) {
+			inv *= 2 - n0 * inv;
+		}
+
+		inverse = ValueT(0) - inv;
+
+		one = toLimbs((BigInt(1) << (ValueBits * size)) % modulus);
+		r2 = toLimbs((BigInt(1) << (2 * ValueBits * size)) % modulus);
+
+	}
+
+
+	//Converts a into Montgomery form, a can be any integer
+	constexpr BigInt toMontgomery(const BigInt& a) const {
+
+		Limbs x = toLimbs(reduce(a));
+		Limbs t(size + 2);
+
+		multiply(x, r2, x, t);
+
+		return BigInt::fromLimbs(std::move(x));
+
+	}
+
+	constexpr BigInt fromMontgomery(const BigInt& a) const {
+
+		Limbs x = toLimbs(a);
+		Limbs unit(size);
+		Limbs t(size + 2);
+
+		unit[0] = 1;
+		multiply(x, unit, x, t);
+
+		return BigInt::fromLimbs(std::move(x));
+
+	}
+
+	//Montgomery product abR^-1 mod N of two values in Montgomery form
+	constexpr BigInt multiply(const BigInt& a, const BigInt& b) const {
+
+		Limbs x = toLimbs(a);
+		Limbs y = toLimbs(b);
+		Limbs t(size + 2);
+
+		multiply(x, y, x, t);
+
+		return BigInt::fromLimbs(std::move(x));
+
+	}
+
+	constexpr BigInt square(const BigInt& a) const {
+		return multiply(a, a);
+	}
+
+	//Computes base^exp mod N for exp >= 0, both given and returned in ordinary form
+	constexpr BigInt pow(const BigInt& base, const BigInt& exp) const {
+
+		arc_assert(!exp.isNegative(), "Montgomery exponent must not be negative");
+
+		if (exp.isZero()) {
+			return 1;
+		}
+
+		SizeT bits = exp.magnitudeBitSize();
+		u32 window = windowSize(bits);
+
+		Limbs t(size + 2);
+		Limbs g2(size);
+
+		//Odd powers g, g^3, ..., g^(2^window - 1) in Montgomery form
+		Limbs table(size << (window - 1));
+		std::span<ValueT> g = std::span(table).first(size);
+
+		Limbs b = toLimbs(reduce(base));
+		multiply(b, r2, g, t);
+		multiply(g, g, g2, t);
+
+		for (SizeT i = 1; i < (SizeT(1) << (window - 1)); i++) {
+			multiply(std::span(table).subspan((i - 1) * size, size), g2, std::span(table).subspan(i * size, size), t);
+		}
+
+		Limbs result = one;
+		bool started = false;
+
+		for (SizeT i = bits; i-- > 0;) {
+
+			if (!exponentBit(exp, i)) {
+
+				multiply(result, result, result, t);
+				continue;
+
+			}
+
+			//Longest window starting at bit i that ends on a set bit
+			SizeT low = i + 1 > window ? i + 1 - window : 0;
+
+			while (!exponentBit(exp, low)) {
+				low++;
+			}
+
+			SizeT value = 0;
+
+			for (SizeT j = i + 1; j-- > low;) {
+				value = (value << 1) | exponentBit(exp, j);
+			}
+
+			std::span<const ValueT> factor = std::span(table).subspan((value >> 1) * size, size);
+
+			if (started) {
+
+				for (SizeT j = low; j <= i; j++) {
+					multiply(result, result, result, t);
+				}
+
+				multiply(result, factor, result, t);
+
+			} else {
+
+				std::copy(factor.begin(), factor.end(), result.begin());
+				started = true;
+
+			}
+
+			i = low;
+
+		}
+
+		//Leave Montgomery form
+		Limbs unit(size);
+		unit[0] = 1;
+
+		multiply(result, unit, result, t);
+
+		return BigInt::fromLimbs(std::move(result));
+
+	}
+
+	//Reduces a into [0, N)
+	constexpr BigInt reduce(const BigInt& a) const {
+
+		if (!a.isNegative() && a < modulus) {
+			return a;
+		}
+
+		BigInt r = a.abs() % modulus;
+
+		if (a.isNegative() && !r.isZero()) {
+			r = modulus - r;
+		}
+
+		return r;
+
+	}
+
+
+	constexpr const BigInt& getModulus() const noexcept {
+		return modulus;
+	}
+
+	constexpr SizeT getLimbCount() const noexcept {
+		return size;
+	}
+
+private:
+
+	//Sliding window widths minimizing the number of multiplications for the given exponent size
+	constexpr static u32 windowSize(SizeT bits) {
+
+		if (bits > 671) {
+			return 6;
+		} else if (bits > 239) {
+			return 5;
+		} else if (bits > 79) {
+			return 4;
+		} else if (bits > 23) {
+			return 3;
+		}
+
+		return 1;
+
+	}
+
+	constexpr static bool exponentBit(const BigInt& exp, SizeT i) {
+		return (exp.magnitude[i / ValueBits] >> (i % ValueBits)) & 1;
+	}
+
+	//Expands a reduced value to exactly size limbs
+	constexpr Limbs toLimbs(const BigInt& a) const {
+
+		arc_assert(a.magnitude.size() <= size, "Value exceeds the Montgomery modulus");
+
+		Limbs x(size);
+		std::copy(a.magnitude.begin(), a.magnitude.end(), x.begin());
+
+		return x;
+
+	}
+
+	/*
+	 *  out = abR^-1 mod N with a, b < N, t is scratch of size + 2 limbs
+	 *  out may alias a or b since the result is only written once the product has been fully reduced.
+	 */
+	constexpr void multiply(std::span<const ValueT> a, std::span<const ValueT> b, std::span<ValueT> out, std::span<ValueT> t) const {
+
+		const Limbs& n = modulus.magnitude;
+
+		std::fill(t.begin(), t.end(), 0);
+
+		for (SizeT i = 0; i < size; i++) {
+
+			//t += a * b[i]
+			ValueT carry = 0;
+
+			for (SizeT j = 0; j < size; j++) {
+
+				ValueT high;
+				ValueT low = BigInt::multiplyWide(a[j], b[i], high);
+
+				low += t[j];
+				high += low < t[j];
+				low += carry;
+				high += low < carry;
+
+				t[j] = low;
+				carry = high;
+
+			}
+
+			t[size] += carry;
+			t[size + 1] = t[size] < carry;
+
+			//t = (t + m * N) / 2^64, where m is chosen to clear the lowest limb
+			ValueT m = t[0] * inverse;
+			ValueT high;
+			ValueT low = BigInt::multiplyWide(m, n[0], high);
+
+			low += t[0];
+			carry = high + (low < t[0]);
+
+			for (SizeT j = 1; j < size; j++) {
+
+				low = BigInt::multiplyWide(m, n[j], high);
+
+				low += t[j];
+				high += low < t[j];
+				low += carry;
+				high += low < carry;
+
+				t[j - 1] = low;
+				carry = high;
+
+			}
+
+			t[size - 1] = t[size] + carry;
+			t[size] = t[size + 1] + (t[size - 1] < carry);
+
+		}
+
+		//t < 2N, one conditional subtraction completes the reduction
+		bool subtract = t[size] != 0;
+
+		if (!subtract) {
+
+			subtract = true;
+
+			for (SizeT j = size; j-- > 0;) {
+
+				if (t[j] != n[j]) {
+
+					subtract = t[j] > n[j];
+					break;
+
+				}
+
+			}
+
+		}
+
+		if (subtract) {
+
+			bool borrow = false;
+
+			for (SizeT j = 0; j < size; j++) {
+
+				ValueT d = t[j] - n[j];
+				bool b = t[j] < n[j] || (d == 0 && borrow);
+
+				t[j] = d - borrow;
+				borrow = b;
+
+			}
+
+		}
+
+		std::copy(t.begin(), t.begin() + size, out.begin());
+
+	}
+
+
+	BigInt modulus;
+	SizeT size;
+	ValueT inverse;
+	Limbs one;
+	Limbs r2;
+
+};
@@ -0,0 +1,936 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 vectorpacket.hpp
+ */
+
+#pragma once
+
+#include "math/vector.hpp"
+#include "arcintrinsic.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+
+// Defined if packet lanes map to SIMD registers, kernels that only pay off with them check it
+#if defined(ARC_VECTORIZE_X86_AVX) || defined(ARC_VECTORIZE_X86_SSE2)
+	#define ARC_VECTOR_PACKET_NATIVE
+#endif
+
+
+/*
+ *  Structure-of-arrays vector packets
+ *  A packet holds eight vectors with one lane register per component, so every operation processes all eight at once.
+ *  Lanes map to AVX registers if available (one per float packet, two per double packet) and to SSE2 registers otherwise.
+ *  Without either, packets fall back to plain arrays the compiler is free to vectorize.
+ */
+template<CC::Float T>
+class Packet8;
+
+template<CC::Float T>
+class PacketMask8;
+
+template<CC::Float T>
+class Vec2x8;
+
+template<CC::Float T>
+class Vec3x8;
+
+template<CC::Float T>
+class Vec4x8;
+
+
+namespace Detail {
+
+	template<CC::Float T>
+	struct PacketNative;
+
+#if defined(ARC_VECTORIZE_X86_AVX)
+
+	template<>
+	struct PacketNative<float> {
+
+		using Register = __m256;
+		using Mask = __m256;
+
+		constexpr static SizeT Width = 8;
+
+		ARC_FORCE_INLINE static Register splat(float f)							{ return _mm256_set1_ps(f); }
+		ARC_FORCE_INLINE static Register load(const float* p)					{ return _mm256_loadu_ps(p); }
+		ARC_FORCE_INLINE static Register loadAligned(const float* p)			{ return _mm256_load_ps(p); }
+		ARC_FORCE_INLINE static void store(float* p, Register a)				{ _mm256_storeu_ps(p, a); }
+		ARC_FORCE_INLINE static void storeAligned(float* p, Register a)			{ _mm256_store_ps(p, a); }
+
+		ARC_FORCE_INLINE static Register add(Register a, Register b)			{ return _mm256_add_ps(a, b); }
+		ARC_FORCE_INLINE static Register sub(Register a, Register b)			{ return _mm256_sub_ps(a, b); }
+		ARC_FORCE_INLINE static Register mul(Register a, Register b)			{ return _mm256_mul_ps(a, b); }
+		ARC_FORCE_INLINE static Register div(Register a, Register b)			{ return _mm256_div_ps(a, b); }
+		ARC_FORCE_INLINE static Register min(Register a, Register b)			{ return _mm256_min_ps(a, b); }
+		ARC_FORCE_INLINE static Register max(Register a, Register b)			{ return _mm256_max_ps(a, b); }
+		ARC_FORCE_INLINE static Register sqrt(Register a)						{ return _mm256_sqrt_ps(a); }
+		ARC_FORCE_INLINE static Register abs(Register a)						{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+		ARC_FORCE_INLINE static Mask less(Register a, Register b)				{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		ARC_FORCE_INLINE static Mask lessEqual(Register a, Register b)			{ return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		ARC_FORCE_INLINE static Mask equal(Register a, Register b)				{ return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+		ARC_FORCE_INLINE static Mask maskAnd(Mask a, Mask b)					{ return _mm256_and_ps(a, b); }
+		ARC_FORCE_INLINE static Mask maskOr(Mask a, Mask b)						{ return _mm256_or_ps(a, b); }
+		ARC_FORCE_INLINE static Mask maskNot(Mask a)							{ return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+		ARC_FORCE_INLINE static u32 maskBits(Mask a)							{ return _mm256_movemask_ps(a); }
+
+		ARC_FORCE_INLINE static Register select(Mask m, Register a, Register b)	{ return _mm256_blendv_ps(b, a, m); }
+
+	};
+
+	template<>
+	struct PacketNative<double> {
+
+		using Register = __m256d;
+		using Mask = __m256d;
+
+		constexpr static SizeT Width = 4;
+
+		ARC_FORCE_INLINE static Register splat(double d)						{ return _mm256_set1_pd(d); }
+		ARC_FORCE_INLINE static Register load(const double* p)					{ return _mm256_loadu_pd(p); }
+		ARC_FORCE_INLINE static Register loadAligned(const double* p)			{ return _mm256_load_pd(p); }
+		ARC_FORCE_INLINE static void store(double* p, Register a)				{ _mm256_storeu_pd(p, a); }
+		ARC_FORCE_INLINE static void storeAligned(double* p, Register a)		{ _mm256_store_pd(p, a); }
+
+		ARC_FORCE_INLINE static Register add(Register a, Register b)			{ return _mm256_add_pd(a, b); }
+		ARC_FORCE_INLINE static Register sub(Register a, Register b)			{ return _mm256_sub_pd(a, b); }
+		ARC_FORCE_INLINE static Register mul(Register a, Register b)			{ return _mm256_mul_pd(a, b); }
+		ARC_FORCE_INLINE static Register div(Register a, Register b)			{ return _mm256_div_pd(a, b); }
+		ARC_FORCE_INLINE static Register min(Register a, Register b)			{ return _mm256_min_pd(a, b); }
+		ARC_FORCE_INLINE static Register max(Register a, Register b)			{ return _mm256_max_pd(a, b); }
+		ARC_FORCE_INLINE static Register sqrt(Register a)						{ return _mm256_sqrt_pd(a); }
+		ARC_FORCE_INLINE static Register abs(Register a)						{ return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+		ARC_FORCE_INLINE static Mask less(Register a, Register b)				{ return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		ARC_FORCE_INLINE static Mask lessEqual(Register a, Register b)			{ return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+		ARC_FORCE_INLINE static Mask equal(Register a, Register b)				{ return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+
+		ARC_FORCE_INLINE static Mask maskAnd(Mask a, Mask b)					{ return _mm256_and_pd(a, b); }
+		ARC_FORCE_INLINE static Mask maskOr(Mask a, Mask b)						{ return _mm256_or_pd(a, b); }
+		ARC_FORCE_INLINE static Mask maskNot(Mask a)							{ return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+		ARC_FORCE_INLINE static u32 maskBits(Mask a)							{ return _mm256_movemask_pd(a); }
+
+		ARC_FORCE_INLINE static Register select(Mask m, Register a, Register b)	{ return _mm256_blendv_pd(b, a, m); }
+
+	};
+
+#elif defined(ARC_VECTORIZE_X86_SSE2)
+
+	template<>
+	struct PacketNative<float> {
+
+		using Register = __m128;
+		using Mask = __m128;
+
+		constexpr static SizeT Width = 4;
+
+		ARC_FORCE_INLINE static Register splat(float f)							{ return _mm_set1_ps(f); }
+		ARC_FORCE_INLINE static Register load(const float* p)					{ return _mm_loadu_ps(p); }
+		ARC_FORCE_INLINE static Register loadAligned(const float* p)			{ return _mm_load_ps(p); }
+		ARC_FORCE_INLINE static void store(float* p, Register a)				{ _mm_storeu_ps(p, a); }
+		ARC_FORCE_INLINE static void storeAligned(float* p, Register a)			{ _mm_store_ps(p, a); }
+
+		ARC_FORCE_INLINE static Register add(Register a, Register b)			{ return _mm_add_ps(a, b); }
+		ARC_FORCE_INLINE static Register sub(Register a, Register b)			{ return _mm_sub_ps(a, b); }
+		ARC_FORCE_INLINE static Register mul(Register a, Register b)			{ return _mm_mul_ps(a, b); }
+		ARC_FORCE_INLINE static Register div(Register a, Register b)			{ return _mm_div_ps(a, b); }
+		ARC_FORCE_INLINE static Register min(Register a, Register b)			{ return _mm_min_ps(a, b); }
+		ARC_FORCE_INLINE static Register max(Register a, Register b)			{ return _mm_max_ps(a, b); }
+		ARC_FORCE_INLINE static Register sqrt(Register a)						{ return _mm_sqrt_ps(a); }
+		ARC_FORCE_INLINE static Register abs(Register a)						{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+		ARC_FORCE_INLINE static Mask less(Register a, Register b)				{ return _mm_cmplt_ps(a, b); }
+		ARC_FORCE_INLINE static Mask lessEqual(Register a, Register b)			{ return _mm_cmple_ps(a, b); }
+		ARC_FORCE_INLINE static Mask equal(Register a, Register b)				{ return _mm_cmpeq_ps(a, b); }
+
+		ARC_FORCE_INLINE static Mask maskAnd(Mask a, Mask b)					{ return _mm_and_ps(a, b); }
+		ARC_FORCE_INLINE static Mask maskOr(Mask a, Mask b)						{ return _mm_or_ps(a, b); }
+		ARC_FORCE_INLINE static Mask maskNot(Mask a)							{ return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+		ARC_FORCE_INLINE static u32 maskBits(Mask a)							{ return _mm_movemask_ps(a); }
+
+		ARC_FORCE_INLINE static Register select(Mask m, Register a, Register b)	{ return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+	};
+
+	template<>
+	struct PacketNative<double> {
+
+		using Register = __m128d;
+		using Mask = __m128d;
+
+		constexpr static SizeT Width = 2;
+
+		ARC_FORCE_INLINE static Register splat(double d)						{ return _mm_set1_pd(d); }
+		ARC_FORCE_INLINE static Register load(const double* p)					{ return _mm_loadu_pd(p); }
+		ARC_FORCE_INLINE static Register loadAligned(const double* p)			{ return _mm_load_pd(p); }
+		ARC_FORCE_INLINE static void store(double* p, Register a)				{ _mm_storeu_pd(p, a); }
+		ARC_FORCE_INLINE static void storeAligned(double* p, Register a)		{ _mm_store_pd(p, a); }
+
+		ARC_FORCE_INLINE static Register add(Register a, Register b)			{ return _mm_add_pd(a, b); }
+		ARC_FORCE_INLINE static Register sub(Register a, Register b)			{ return _mm_sub_pd(a, b); }
+		ARC_FORCE_INLINE static Register mul(Register a, Register b)			{ return _mm_mul_pd(a, b); }
+		ARC_FORCE_INLINE static Register div(Register a, Register b)			{ return _mm_div_pd(a, b); }
+		ARC_FORCE_INLINE static Register min(Register a, Register b)			{ return _mm_min_pd(a, b); }
+		ARC_FORCE_INLINE static Register max(Register a, Register b)			{ return _mm_max_pd(a, b); }
+		ARC_FORCE_INLINE static Register sqrt(Register a)						{ return _mm_sqrt_pd(a); }
+		ARC_FORCE_INLINE static Register abs(Register a)						{ return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+		ARC_FORCE_INLINE static Mask less(Register a, Register b)				{ return _mm_cmplt_pd(a, b); }
+		ARC_FORCE_INLINE static Mask lessEqual(Register a, Register b)			{ return _mm_cmple_pd(a, b); }
+		ARC_FORCE_INLINE static Mask equal(Register a, Register b)				{ return _mm_cmpeq_pd(a, b); }
+
+		ARC_FORCE_INLINE static Mask maskAnd(Mask a, Mask b)					{ return _mm_and_pd(a, b); }
+		ARC_FORCE_INLINE static Mask maskOr(Mask a, Mask b)						{ return _mm_or_pd(a, b); }
+		ARC_FORCE_INLINE static Mask maskNot(Mask a)							{ return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+		ARC_FORCE_INLINE static u32 maskBits(Mask a)							{ return _mm_movemask_pd(a); }
+
+		ARC_FORCE_INLINE static Register select(Mask m, Register a, Register b)	{ return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+
+	};
+
+#else
+
+	template<CC::Float T>
+	struct PacketNative {
+
+		using Register = T;
+		using Mask = bool;
+
+		constexpr static SizeT Width = 1;
+
+		ARC_FORCE_INLINE static Register splat(T t)								{ return t; }
+		ARC_FORCE_INLINE static Register load(const T* p)						{ return *p; }
+		ARC_FORCE_INLINE static Register loadAligned(const T* p)				{ return *p; }
+		ARC_FORCE_INLINE static void store(T* p, Register a)					{ *p = a; }
+		ARC_FORCE_INLINE static void storeAligned(T* p, Register a)				{ *p = a; }
+
+		ARC_FORCE_INLINE static Register add(Register a, Register b)			{ return a + b; }
+		ARC_FORCE_INLINE static Register sub(Register a, Register b)			{ return a - b; }
+		ARC_FORCE_INLINE static Register mul(Register a, Register b)			{ return a * b; }
+		ARC_FORCE_INLINE static Register div(Register a, Register b)			{ return a / b; }
+		ARC_FORCE_INLINE static Register min(Register a, Register b)			{ return a < b ? a : b; }
+		ARC_FORCE_INLINE static Register max(Register a, Register b)			{ return a > b ? a : b; }
+		ARC_FORCE_INLINE static Register sqrt(Register a)						{ return std::sqrt(a); }
+		ARC_FORCE_INLINE static Register abs(Register a)						{ return std::abs(a); }
+
+		ARC_FORCE_INLINE static Mask less(Register a, Register b)				{ return a < b; }
+		ARC_FORCE_INLINE static Mask lessEqual(Register a, Register b)			{ return a <= b; }
+		ARC_FORCE_INLINE static Mask equal(Register a, Register b)				{ return a == b; }
+
+		ARC_FORCE_INLINE static Mask maskAnd(Mask a, Mask b)					{ return a && b; }
+		ARC_FORCE_INLINE static Mask maskOr(Mask a, Mask b)						{ return a || b; }
+		ARC_FORCE_INLINE static Mask maskNot(Mask a)							{ return !a; }
+		ARC_FORCE_INLINE static u32 maskBits(Mask a)							{ return a; }
+
+		ARC_FORCE_INLINE static Register select(Mask m, Register a, Register b)	{ return m ? a : b; }
+
+	};
+
+#endif
+
+}
+
+
+
+// Comparison result of two packets, one flag per lane
+template<CC::Float T>
+class PacketMask8 {
+
+	using Native = Detail::PacketNative<T>;
+	using Mask = typename Native::Mask;
+
+	constexpr static SizeT Registers = 8 / Native::Width;
+
+public:
+
+	ARC_FORCE_INLINE PacketMask8 operator&(const PacketMask8& m) const {
+		return map([](Mask a, Mask b) { return Native::maskAnd(a, b); }, *this, m);
+	}
+
+	ARC_FORCE_INLINE PacketMask8 operator|(const PacketMask8& m) const {
+		return map([](Mask a, Mask b) { return Native::maskOr(a, b); }, *this, m);
+	}
+
+	ARC_FORCE_INLINE PacketMask8 operator~() const {
+		return map([](Mask a, Mask) { return Native::maskNot(a); }, *this, *this);
+	}
+
+	// Bit i is set if lane i is set
+	ARC_FORCE_INLINE u32 bits() const {
+
+		u32 b = 0;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			b |= Native::maskBits(m[i]) << (i * Native::Width);
+		}
+
+		return b;
+
+	}
+
+	ARC_FORCE_INLINE bool any() const {
+		return bits() != 0;
+	}
+
+	ARC_FORCE_INLINE bool all() const {
+		return bits() == 0xFF;
+	}
+
+	ARC_FORCE_INLINE bool none() const {
+		return bits() == 0;
+	}
+
+private:
+
+	friend class Packet8<T>;
+
+	template<class Func>
+	ARC_FORCE_INLINE static PacketMask8 map(Func&& func, const PacketMask8& a, const PacketMask8& b) {
+
+		PacketMask8 r;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			r.m[i] = func(a.m[i], b.m[i]);
+		}
+
+		return r;
+
+	}
+
+	Mask m[Registers];
+
+};
+
+
+
+template<CC::Float T>
+class Packet8 {
+
+	using Native = Detail::PacketNative<T>;
+	using Register = typename Native::Register;
+
+	constexpr static SizeT Registers = 8 / Native::Width;
+
+public:
+
+	using Type = T;
+	using MaskType = PacketMask8<T>;
+
+	constexpr static SizeT Size = 8;
+
+
+	ARC_FORCE_INLINE Packet8() : Packet8(T(0)) {}
+
+	ARC_FORCE_INLINE explicit Packet8(T value) {
+
+		for (SizeT i = 0; i < Registers; i++) {
+			r[i] = Native::splat(value);
+		}
+
+	}
+
+
+	ARC_FORCE_INLINE static Packet8 load(const T* p) {
+
+		Packet8 a;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			a.r[i] = Native::load(p + i * Native::Width);
+		}
+
+		return a;
+
+	}
+
+	// p must be aligned to 32 bytes
+	ARC_FORCE_INLINE static Packet8 loadAligned(const T* p) {
+
+		Packet8 a;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			a.r[i] = Native::loadAligned(p + i * Native::Width);
+		}
+
+		return a;
+
+	}
+
+	ARC_FORCE_INLINE void store(T* p) const {
+
+		for (SizeT i = 0; i < Registers; i++) {
+			Native::store(p + i * Native::Width, r[i]);
+		}
+
+	}
+
+	ARC_FORCE_INLINE void storeAligned(T* p) const {
+
+		for (SizeT i = 0; i < Registers; i++) {
+			Native::storeAligned(p + i * Native::Width, r[i]);
+		}
+
+	}
+
+	ARC_FORCE_INLINE T operator[](SizeT lane) const {
+
+		arc_assert(lane < Size, "Packet8 access out of bounds (index=%d)", lane);
+
+		alignas(32) T t[Size];
+		storeAligned(t);
+
+		return t[lane];
+
+	}
+
+
+	ARC_FORCE_INLINE Packet8 operator+(const Packet8& p) const	{ return map([](Register a, Register b) { return Native::add(a, b); }, *this, p); }
+	ARC_FORCE_INLINE Packet8 operator-(const Packet8& p) const	{ return map([](Register a, Register b) { return Native::sub(a, b); }, *this, p); }
+	ARC_FORCE_INLINE Packet8 operator*(const Packet8& p) const	{ return map([](Register a, Register b) { return Native::mul(a, b); }, *this, p); }
+	ARC_FORCE_INLINE Packet8 operator/(const Packet8& p) const	{ return map([](Register a, Register b) { return Native::div(a, b); }, *this, p); }
+
+	ARC_FORCE_INLINE Packet8 operator+(T t) const				{ return *this + Packet8(t); }
+	ARC_FORCE_INLINE Packet8 operator-(T t) const				{ return *this - Packet8(t); }
+	ARC_FORCE_INLINE Packet8 operator*(T t) const				{ return *this * Packet8(t); }
+	ARC_FORCE_INLINE Packet8 operator/(T t) const				{ return *this / Packet8(t); }
+
+	ARC_FORCE_INLINE Packet8 operator-() const					{ return Packet8() - *this; }
+
+	ARC_FORCE_INLINE Packet8& operator+=(const Packet8& p)		{ return *this = *this + p; }
+	ARC_FORCE_INLINE Packet8& operator-=(const Packet8& p)		{ return *this = *this - p; }
+	ARC_FORCE_INLINE Packet8& operator*=(const Packet8& p)		{ return *this = *this * p; }
+	ARC_FORCE_INLINE Packet8& operator/=(const Packet8& p)		{ return *this = *this / p; }
+
+	ARC_FORCE_INLINE MaskType operator<(const Packet8& p) const	{ return compare([](Register a, Register b) { return Native::less(a, b); }, *this, p); }
+	ARC_FORCE_INLINE MaskType operator<=(const Packet8& p) const	{ return compare([](Register a, Register b) { return Native::lessEqual(a, b); }, *this, p); }
+	ARC_FORCE_INLINE MaskType operator>(const Packet8& p) const	{ return p < *this; }
+	ARC_FORCE_INLINE MaskType operator>=(const Packet8& p) const	{ return p <= *this; }
+	ARC_FORCE_INLINE MaskType operator==(const Packet8& p) const	{ return compare([](Register a, Register b) { return Native::equal(a, b); }, *this, p); }
+
+
+	ARC_FORCE_INLINE Packet8 abs() const {
+		return map([](Register a, Register) { return Native::abs(a); }, *this, *this);
+	}
+
+	ARC_FORCE_INLINE Packet8 sqrt() const {
+		return map([](Register a, Register) { return Native::sqrt(a); }, *this, *this);
+	}
+
+	// Per lane a < b ? a : b, matching Math::min for ordered values
+	ARC_FORCE_INLINE static Packet8 min(const Packet8& a, const Packet8& b) {
+		return map([](Register x, Register y) { return Native::min(x, y); }, a, b);
+	}
+
+	ARC_FORCE_INLINE static Packet8 max(const Packet8& a, const Packet8& b) {
+		return map([](Register x, Register y) { return Native::max(x, y); }, a, b);
+	}
+
+	ARC_FORCE_INLINE static Packet8 lerp(const Packet8& start, const Packet8& end, const Packet8& factor) {
+		return start + factor * (end - start);
+	}
+
+	// Picks a where mask is set, b otherwise
+	ARC_FORCE_INLINE static Packet8 select(const MaskType& mask, const Packet8& a, const Packet8& b) {
+
+		Packet8 s;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			s.r[i] = Native::select(mask.m[i], a.r[i], b.r[i]);
+		}
+
+		return s;
+
+	}
+
+private:
+
+	template<class Func>
+	ARC_FORCE_INLINE static Packet8 map(Func&& func, const Packet8& a, const Packet8& b) {
+
+		Packet8 p;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			p.r[i] = func(a.r[i], b.r[i]);
+		}
+
+		return p;
+
+	}
+
+	template<class Func>
+	ARC_FORCE_INLINE static MaskType compare(Func&& func, const Packet8& a, const Packet8& b) {
+
+		MaskType m;
+
+		for (SizeT i = 0; i < Registers; i++) {
+			m.m[i] = func(a.r[i], b.r[i]);
+		}
+
+		return m;
+
+	}
+
+	Register r[Registers];
+
+};
+
+
+template<CC::Float T>
+ARC_FORCE_INLINE Packet8<T> operator*(T t, const Packet8<T>& p) {
+	return p * t;
+}
+
+
+
+namespace Detail {
+
+	// Transposes up to eight AoS vectors into component packets, missing vectors are zero
+	template<SizeT N, class V, class T = typename V::Type>
+	ARC_FORCE_INLINE void loadPacketComponents(const V* v, SizeT count, Packet8<T> (&components)[N]) {
+
+		alignas(32) T lanes[N][8] {};
+
+		for (SizeT i = 0; i < count; i++) {
+			for (u32 c = 0; c < N; c++) {
+				lanes[c][i] = v[i][c];
+			}
+		}
+
+		for (u32 c = 0; c < N; c++) {
+			components[c] = Packet8<T>::loadAligned(lanes[c]);
+		}
+
+	}
+
+	template<SizeT N, class V, class T = typename V::Type>
+	ARC_FORCE_INLINE void storePacketComponents(V* v, SizeT count, const Packet8<T> (&components)[N]) {
+
+		alignas(32) T lanes[N][8];
+
+		for (u32 c = 0; c < N; c++) {
+			components[c].storeAligned(lanes[c]);
+		}
+
+		for (SizeT i = 0; i < count; i++) {
+			for (u32 c = 0; c < N; c++) {
+				v[i][c] = lanes[c][i];
+			}
+		}
+
+	}
+
+}
+
+
+
+template<CC::Float T>
+class Vec2x8 {
+
+public:
+
+	using Type = T;
+	using PacketType = Packet8<T>;
+	using VectorType = Vec2<T>;
+
+	constexpr static SizeT Size = 2;
+	constexpr static SizeT Lanes = 8;
+
+
+	ARC_FORCE_INLINE Vec2x8() = default;
+
+	ARC_FORCE_INLINE Vec2x8(const PacketType& x, const PacketType& y) : x(x), y(y) {}
+
+	ARC_FORCE_INLINE explicit Vec2x8(const VectorType& v) : x(v.x), y(v.y) {}
+
+
+	// Loads count consecutive vectors from v, remaining lanes are zero
+	ARC_FORCE_INLINE static Vec2x8 load(const VectorType* v, SizeT count = Lanes) {
+
+		PacketType c[Size];
+		Detail::loadPacketComponents(v, count, c);
+
+		return { c[0], c[1] };
+
+	}
+
+	ARC_FORCE_INLINE void store(VectorType* v, SizeT count = Lanes) const {
+		Detail::storePacketComponents(v, count, { x, y });
+	}
+
+	ARC_FORCE_INLINE VectorType get(SizeT lane) const {
+		return { x[lane], y[lane] };
+	}
+
+
+	ARC_FORCE_INLINE Vec2x8 operator+(const Vec2x8& v) const		{ return { x + v.x, y + v.y }; }
+	ARC_FORCE_INLINE Vec2x8 operator-(const Vec2x8& v) const		{ return { x - v.x, y - v.y }; }
+	ARC_FORCE_INLINE Vec2x8 operator*(const Vec2x8& v) const		{ return { x * v.x, y * v.y }; }
+	ARC_FORCE_INLINE Vec2x8 operator/(const Vec2x8& v) const		{ return { x / v.x, y / v.y }; }
+	ARC_FORCE_INLINE Vec2x8 operator*(const PacketType& s) const	{ return { x * s, y * s }; }
+	ARC_FORCE_INLINE Vec2x8 operator/(const PacketType& s) const	{ return { x / s, y / s }; }
+	ARC_FORCE_INLINE Vec2x8 operator*(T s) const					{ return { x * s, y * s }; }
+	ARC_FORCE_INLINE Vec2x8 operator/(T s) const					{ return { x / s, y / s }; }
+	ARC_FORCE_INLINE Vec2x8 operator-() const						{ return { -x, -y }; }
+
+	ARC_FORCE_INLINE Vec2x8& operator+=(const Vec2x8& v)			{ return *this = *this + v; }
+	ARC_FORCE_INLINE Vec2x8& operator-=(const Vec2x8& v)			{ return *this = *this - v; }
+	ARC_FORCE_INLINE Vec2x8& operator*=(const PacketType& s)		{ return *this = *this * s; }
+	ARC_FORCE_INLINE Vec2x8& operator*=(T s)						{ return *this = *this * s; }
+
+
+	ARC_FORCE_INLINE PacketType dot(const Vec2x8& v) const {
+		return x * v.x + y * v.y;
+	}
+
+	// z component of the 3D cross product
+	ARC_FORCE_INLINE PacketType cross(const Vec2x8& v) const {
+		return x * v.y - y * v.x;
+	}
+
+	ARC_FORCE_INLINE PacketType magSquared() const {
+		return dot(*this);
+	}
+
+	ARC_FORCE_INLINE PacketType length() const {
+		return magSquared().sqrt();
+	}
+
+	ARC_FORCE_INLINE PacketType distance(const Vec2x8& v) const {
+		return (*this - v).length();
+	}
+
+	ARC_FORCE_INLINE void normalize() {
+		*this = normalized();
+	}
+
+	ARC_FORCE_INLINE Vec2x8 normalized() const {
+		return *this / length();
+	}
+
+
+	ARC_FORCE_INLINE static Vec2x8 min(const Vec2x8& a, const Vec2x8& b) {
+		return { PacketType::min(a.x, b.x), PacketType::min(a.y, b.y) };
+	}
+
+	ARC_FORCE_INLINE static Vec2x8 max(const Vec2x8& a, const Vec2x8& b) {
+		return { PacketType::max(a.x, b.x), PacketType::max(a.y, b.y) };
+	}
+
+	ARC_FORCE_INLINE static Vec2x8 lerp(const Vec2x8& start, const Vec2x8& end, const PacketType& factor) {
+		return { PacketType::lerp(start.x, end.x, factor), PacketType::lerp(start.y, end.y, factor) };
+	}
+
+	ARC_FORCE_INLINE static Vec2x8 select(const typename PacketType::MaskType& mask, const Vec2x8& a, const Vec2x8& b) {
+		return { PacketType::select(mask, a.x, b.x), PacketType::select(mask, a.y, b.y) };
+	}
+
+
+	PacketType x, y;
+
+};
+
+
+
+template<CC::Float T>
+class Vec3x8 {
+
+public:
+
+	using Type = T;
+	using PacketType = Packet8<T>;
+	using VectorType = Vec3<T>;
+
+	constexpr static SizeT Size = 3;
+	constexpr static SizeT Lanes = 8;
+
+
+	ARC_FORCE_INLINE Vec3x8() = default;
+
+	ARC_FORCE_INLINE Vec3x8(const PacketType& x, const PacketType& y, const PacketType& z) : x(x), y(y), z(z) {}
+
+	ARC_FORCE_INLINE explicit Vec3x8(const VectorType& v) : x(v.x), y(v.y), z(v.z) {}
+
+
+	// Loads count consecutive vectors from v, remaining lanes are zero
+	ARC_FORCE_INLINE static Vec3x8 load(const VectorType* v, SizeT count = Lanes) {
+
+		PacketType c[Size];
+		Detail::loadPacketComponents(v, count, c);
+
+		return { c[0], c[1], c[2] };
+
+	}
+
+	ARC_FORCE_INLINE void store(VectorType* v, SizeT count = Lanes) const {
+		Detail::storePacketComponents(v, count, { x, y, z });
+	}
+
+	ARC_FORCE_INLINE VectorType get(SizeT lane) const {
+		return { x[lane], y[lane], z[lane] };
+	}
+
+
+	ARC_FORCE_INLINE Vec3x8 operator+(const Vec3x8& v) const		{ return { x + v.x, y + v.y, z + v.z }; }
+	ARC_FORCE_INLINE Vec3x8 operator-(const Vec3x8& v) const		{ return { x - v.x, y - v.y, z - v.z }; }
+	ARC_FORCE_INLINE Vec3x8 operator*(const Vec3x8& v) const		{ return { x * v.x, y * v.y, z * v.z }; }
+	ARC_FORCE_INLINE Vec3x8 operator/(const Vec3x8& v) const		{ return { x / v.x, y / v.y, z / v.z }; }
+	ARC_FORCE_INLINE Vec3x8 operator*(const PacketType& s) const	{ return { x * s, y * s, z * s }; }
+	ARC_FORCE_INLINE Vec3x8 operator/(const PacketType& s) const	{ return { x / s, y / s, z / s }; }
+	ARC_FORCE_INLINE Vec3x8 operator*(T s) const					{ return { x * s, y * s, z * s }; }
+	ARC_FORCE_INLINE Vec3x8 operator/(T s) const					{ return { x / s, y / s, z / s }; }
+	ARC_FORCE_INLINE Vec3x8 operator-() const						{ return { -x, -y, -z }; }
+
+	ARC_FORCE_INLINE Vec3x8& operator+=(const Vec3x8& v)			{ return *this = *this + v; }
+	ARC_FORCE_INLINE Vec3x8& operator-=(const Vec3x8& v)			{ return *this = *this - v; }
+	ARC_FORCE_INLINE Vec3x8& operator*=(const PacketType& s)		{ return *this = *this * s; }
+	ARC_FORCE_INLINE Vec3x8& operator*=(T s)						{ return *this = *this * s; }
+
+
+	ARC_FORCE_INLINE PacketType dot(const Vec3x8& v) const {
+		return x * v.x + y * v.y + z * v.z;
+	}
+
+	ARC_FORCE_INLINE Vec3x8 cross(const Vec3x8& v) const {
+		return { y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x };
+	}
+
+	ARC_FORCE_INLINE PacketType magSquared() const {
+		return dot(*this);
+	}
+
+	ARC_FORCE_INLINE PacketType length() const {
+		return magSquared().sqrt();
+	}
+
+	ARC_FORCE_INLINE PacketType distance(const Vec3x8& v) const {
+		return (*this - v).length();
+	}
+
+	ARC_FORCE_INLINE void normalize() {
+		*this = normalized();
+	}
+
+	ARC_FORCE_INLINE Vec3x8 normalized() const {
+		return *this / length();
+	}
+
+
+	ARC_FORCE_INLINE static Vec3x8 min(const Vec3x8& a, const Vec3x8& b) {
+		return { PacketType::min(a.x, b.x), PacketType::min(a.y, b.y), PacketType::min(a.z, b.z) };
+	}
+
+	ARC_FORCE_INLINE static Vec3x8 max(const Vec3x8& a, const Vec3x8& b) {
+		return { PacketType::max(a.x, b.x), PacketType::max(a.y, b.y), PacketType::max(a.z, b.z) };
+	}
+
+	ARC_FORCE_INLINE static Vec3x8 lerp(const Vec3x8& start, const Vec3x8& end, const PacketType& factor) {
+		return { PacketType::lerp(start.x, end.x, factor), PacketType::lerp(start.y, end.y, factor), PacketType::lerp(start.z, end.z, factor) };
+	}
+
+	ARC_FORCE_INLINE static Vec3x8 select(const typename PacketType::MaskType& mask, const Vec3x8& a, const Vec3x8& b) {
+		return { PacketType::select(mask, a.x, b.x), PacketType::select(mask, a.y, b.y), PacketType::select(mask, a.z, b.z) };
+	}
+
+
+	PacketType x, y, z;
+
+};
+
+
+
+template<CC::Float T>
+class Vec4x8 {
+
+public:
+
+	using Type = T;
+	using PacketType = Packet8<T>;
+	using VectorType = Vec4<T>;
+
+	constexpr static SizeT Size = 4;
+	constexpr static SizeT Lanes = 8;
+
+
+	ARC_FORCE_INLINE Vec4x8() = default;
+
+	ARC_FORCE_INLINE Vec4x8(const PacketType& x, const PacketType& y, const PacketType& z, const PacketType& w) : x(x), y(y), z(z), w(w) {}
+
+	ARC_FORCE_INLINE explicit Vec4x8(const VectorType& v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
+
+
+	// Loads count consecutive vectors from v, remaining lanes are zero
+	ARC_FORCE_INLINE static Vec4x8 load(const VectorType* v, SizeT count = Lanes) {
+
+		PacketType c[Size];
+		Detail::loadPacketComponents(v, count, c);
+
+		return { c[0], c[1], c[2], c[3] };
+
+	}
+
+	ARC_FORCE_INLINE void store(VectorType* v, SizeT count = Lanes) const {
+		Detail::storePacketComponents(v, count, { x, y, z, w });
+	}
+
+	ARC_FORCE_INLINE VectorType get(SizeT lane) const {
+		return { x[lane], y[lane], z[lane], w[lane] };
+	}
+
+
+	ARC_FORCE_INLINE Vec4x8 operator+(const Vec4x8& v) const		{ return { x + v.x, y + v.y, z + v.z, w + v.w }; }
+	ARC_FORCE_INLINE Vec4x8 operator-(const Vec4x8& v) const		{ return { x - v.x, y - v.y, z - v.z, w - v.w }; }
+	ARC_FORCE_INLINE Vec4x8 operator*(const Vec4x8& v) const		{ return { x * v.x, y * v.y, z * v.z, w * v.w }; }
+	ARC_FORCE_INLINE Vec4x8 operator/(const Vec4x8& v) const		{ return { x / v.x, y / v.y, z / v.z, w / v.w }; }
+	ARC_FORCE_INLINE Vec4x8 operator*(const PacketType& s) const	{ return { x * s, y * s, z * s, w * s }; }
+	ARC_FORCE_INLINE Vec4x8 operator/(const PacketType& s) const	{ return { x / s, y / s, z / s, w / s }; }
+	ARC_FORCE_INLINE Vec4x8 operator*(T s) const					{ return { x * s, y * s, z * s, w * s }; }
+	ARC_FORCE_INLINE Vec4x8 operator/(T s) const					{ return { x / s, y / s, z / s, w / s }; }
+	ARC_FORCE_INLINE Vec4x8 operator-() const						{ return { -x, -y, -z, -w }; }
+
+	ARC_FORCE_INLINE Vec4x8& operator+=(const Vec4x8& v)			{ return *this = *this + v; }
+	ARC_FORCE_INLINE Vec4x8& operator-=(const Vec4x8& v)			{ return *this = *this - v; }
+	ARC_FORCE_INLINE Vec4x8& operator*=(const PacketType& s)		{ return *this = *this * s; }
+	ARC_FORCE_INLINE Vec4x8& operator*=(T s)						{ return *this = *this * s; }
+
+
+	ARC_FORCE_INLINE PacketType dot(const Vec4x8& v) const {
+		return x * v.x + y * v.y + z * v.z + w * v.w;
+	}
+
+	ARC_FORCE_INLINE PacketType magSquared() const {
+		return dot(*this);
+	}
+
+	ARC_FORCE_INLINE PacketType length() const {
+		return magSquared().sqrt();
+	}
+
+	ARC_FORCE_INLINE PacketType distance(const Vec4x8& v) const {
+		return (*this - v).length();
+	}
+
+	ARC_FORCE_INLINE void normalize() {
+		*this = normalized();
+	}
+
+	ARC_FORCE_INLINE Vec4x8 normalized() const {
+		return *this / length();
+	}
+
+
+	ARC_FORCE_INLINE static Vec4x8 min(const Vec4x8& a, const Vec4x8& b) {
+		return { PacketType::min(a.x, b.x), PacketType::min(a.y, b.y), PacketType::min(a.z, b.z), PacketType::min(a.w, b.w) };
+	}
+
+	ARC_FORCE_INLINE static Vec4x8 max(const Vec4x8& a, const Vec4x8& b) {
+		return { PacketType::max(a.x, b.x), PacketType::max(a.y, b.y), PacketType::max(a.z, b.z), PacketType::max(a.w, b.w) };
+	}
+
+	ARC_FORCE_INLINE static Vec4x8 lerp(const Vec4x8& start, const Vec4x8& end, const PacketType& factor) {
+		return { PacketType::lerp(start.x, end.x, factor), PacketType::lerp(start.y, end.y, factor), PacketType::lerp(start.z, end.z, factor), PacketType::lerp(start.w, end.w, factor) };
+	}
+
+	ARC_FORCE_INLINE static Vec4x8 select(const typename PacketType::MaskType& mask, const Vec4x8& a, const Vec4x8& b) {
+		return { PacketType::select(mask, a.x, b.x), PacketType::select(mask, a.y, b.y), PacketType::select(mask, a.z, b.z), PacketType::select(mask, a.w, b.w) };
+	}
+
+
+	PacketType x, y, z, w;
+
+};
+
+
+
+namespace TT {
+
+	namespace Detail {
+
+		template<CC::FloatVector V>
+		struct VectorPacket {
+			using Type = TT::Conditional<V::Size == 2, Vec2x8<typename V::Type>, TT::Conditional<V::Size == 3, Vec3x8<typename V::Type>, Vec4x8<typename V::Type>>>;
+		};
+
+	}
+
+	template<CC::FloatVector V>
+	using VectorPacket = typename Detail::VectorPacket<V>::Type;
+
+}
+
+
+
+/*
+ *  Conversions between AoS vector spans and packets
+ *  Partial packets at the end of a span are padded with zero vectors on packing and truncated on unpacking.
+ */
+namespace VectorPacket {
+
+	constexpr SizeT packetCount(SizeT vectors) {
+		return (vectors + 7) / 8;
+	}
+
+	template<CC::FloatVector V>
+	void pack(std::span<const V> vectors, std::span<TT::VectorPacket<V>> packets) {
+
+		arc_assert(packets.size() == packetCount(vectors.size()), "Packet count does not match the vector count");
+
+		for (SizeT i = 0; i < packets.size(); i++) {
+			packets[i] = TT::VectorPacket<V>::load(&vectors[i * 8], std::min<SizeT>(8, vectors.size() - i * 8));
+		}
+
+	}
+
+	template<CC::FloatVector V>
+	void unpack(std::span<const TT::VectorPacket<V>> packets, std::span<V> vectors) {
+
+		arc_assert(packets.size() == packetCount(vectors.size()), "Packet count does not match the vector count");
+
+		for (SizeT i = 0; i < packets.size(); i++) {
+			packets[i].store(&vectors[i * 8], std::min<SizeT>(8, vectors.size() - i * 8));
+		}
+
+	}
+
+	// Replaces every vector v with func(v), evaluated eight vectors at a time
+	template<CC::FloatVector V, class Func>
+	void transform(std::span<V> vectors, Func&& func) {
+
+		for (SizeT i = 0; i < vectors.size(); i += 8) {
+
+			SizeT count = std::min<SizeT>(8, vectors.size() - i);
+
+			TT::VectorPacket<V> packet = func(TT::VectorPacket<V>::load(&vectors[i], count));
+			packet.store(&vectors[i], count);
+
+		}
+
+	}
+
+}
+
+
+
+#define VECTOR_PACKET_DEFINE_NDT(dim, type, suffix) typedef Vec##dim##x8<type> Vec##dim##suffix##x8;
+
+#define VECTOR_PACKET_DEFINE_N(dim) \
+	VECTOR_PACKET_DEFINE_NDT(dim, float, f) \
+	VECTOR_PACKET_DEFINE_NDT(dim, double, d)
+
+VECTOR_PACKET_DEFINE_N(2)
+VECTOR_PACKET_DEFINE_N(3)
+VECTOR_PACKET_DEFINE_N(4)
+
+typedef Packet8<float> Packet8f;
+typedef Packet8<double> Packet8d;
+
+#undef VECTOR_PACKET_DEFINE_N
+#undef VECTOR_PACKET_DEFINE_NDT
@@ -0,0 +1,91 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 arenaallocator.cpp
+ */
+
+#include "arenaallocator.hpp"
+#include "math/math.hpp"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+
+ArenaAllocator::~ArenaAllocator() noexcept {
+	clear();
+}
+
+
+
+ArenaAllocator::ArenaAllocator(ArenaAllocator&& allocator) noexcept :
+	head(std::exchange(allocator.head, nullptr)),
+	cursor(std::exchange(allocator.cursor, nullptr)),
+	limit(std::exchange(allocator.limit, nullptr)),
+	nextBlockSize(allocator.nextBlockSize),
+	totalSize(std::exchange(allocator.totalSize, 0)) {}
+
+
+
+ArenaAllocator& ArenaAllocator::operator=(ArenaAllocator&& allocator) noexcept {
+
+	if (this != &allocator) {
+
+		clear();
+
+		head = std::exchange(allocator.head, nullptr);
+		cursor = std::exchange(allocator.cursor, nullptr);
+		limit = std::exchange(allocator.limit, nullptr);
+		nextBlockSize = allocator.nextBlockSize;
+		totalSize = std::exchange(allocator.totalSize, 0);
+
+	}
+
+	return *this;
+
+}
+
+
+
+void ArenaAllocator::clear() noexcept {
+
+	while (head) {
+
+		Block* previous = head->previous;
+		::operator delete(head, std::align_val_t(alignof(std::max_align_t)));
+
+		head = previous;
+
+	}
+
+	cursor = nullptr;
+	limit = nullptr;
+	totalSize = 0;
+
+}
+
+
+
+void* ArenaAllocator::allocateBlock(SizeT size, AlignT align) {
+
+	constexpr SizeT HeaderSize = Math::alignUp(sizeof(Block), alignof(std::max_align_t));
+
+	//Oversized requests get a block of their own, everything else doubles the block size
+	SizeT blockSize = Math::max(nextBlockSize, HeaderSize + size + align);
+	nextBlockSize = Math::min(nextBlockSize * 2, MaxBlockSize);
+
+	u8* memory = static_cast<u8*>(::operator new(blockSize, std::align_val_t(alignof(std::max_align_t))));
+
+	Block* block = ::new(memory) Block {head, blockSize};
+	head = block;
+	totalSize += blockSize;
+
+	cursor = memory + HeaderSize;
+	limit = memory + blockSize;
+
+	return allocate(size, align);
+
+}
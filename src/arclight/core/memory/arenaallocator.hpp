@@ -0,0 +1,92 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 arenaallocator.hpp
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "arcintrinsic.hpp"
+
+
+/*
+	ArenaAllocator
+
+	Bump allocator over a chain of blocks that grow geometrically up to MaxBlockSize.
+	Memory is only released as a whole, so clearing the arena touches a handful of blocks regardless of the number of allocations.
+	Destructors are never called, the arena is meant for trivially destructible data.
+*/
+class ArenaAllocator {
+
+public:
+
+	constexpr static SizeT DefaultBlockSize = 64 * 1024;
+	constexpr static SizeT MaxBlockSize = 64 * 1024 * 1024;
+
+	//Creates a new ArenaAllocator instance. No memory is allocated upon construction.
+	constexpr explicit ArenaAllocator(SizeT blockSize = DefaultBlockSize) noexcept : head(nullptr), cursor(nullptr), limit(nullptr), nextBlockSize(blockSize), totalSize(0) {}
+
+	~ArenaAllocator() noexcept;
+
+	//Move allowed, copy disabled.
+	ArenaAllocator(const ArenaAllocator& allocator) = delete;
+	ArenaAllocator& operator=(const ArenaAllocator& allocator) = delete;
+	ArenaAllocator(ArenaAllocator&& allocator) noexcept;
+	ArenaAllocator& operator=(ArenaAllocator&& allocator) noexcept;
+
+
+	/*
+		Acquires size bytes aligned to align, which must be a power of two not larger than alignof(std::max_align_t).
+		May throw std::bad_alloc if a new block cannot be allocated.
+	*/
+	[[nodiscard]] ARC_FORCE_INLINE void* allocate(SizeT size, AlignT align) {
+
+		AddressT address = (reinterpret_cast<AddressT>(cursor) + align - 1) & ~AddressT(align - 1);
+
+		if (address + size > reinterpret_cast<AddressT>(limit)) {
+			return allocateBlock(size, align);
+		}
+
+		cursor = reinterpret_cast<u8*>(address + size);
+
+		return reinterpret_cast<void*>(address);
+
+	}
+
+	//Acquires uninitialized storage for count objects of type T
+	template<class T>
+	[[nodiscard]] T* allocate(SizeT count) {
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+
+	//Releases all blocks
+	void clear() noexcept;
+
+	//Returns the number of bytes reserved from the system
+	constexpr SizeT getReservedSize() const noexcept {
+		return totalSize;
+	}
+
+private:
+
+	//Block header preceding the usable memory
+	struct Block {
+
+		Block* previous;
+		SizeT size;
+
+	};
+
+	void* allocateBlock(SizeT size, AlignT align);
+
+	Block* head;
+	u8* cursor;
+	u8* limit;
+	SizeT nextBlockSize;
+	SizeT totalSize;
+
+};
@@ -0,0 +1,269 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 noisebaker.hpp
+ */
+
+#pragma once
+
+#include "noisebase.hpp"
+#include "noisecache.hpp"
+#include "image/image.hpp"
+#include "common/exception.hpp"
+
+#include <cmath>
+#include <string>
+
+
+
+class NoiseException : public ArclightException {
+
+public:
+	using ArclightException::ArclightException;
+	virtual const char* name() const noexcept override { return "Noise Exception"; }
+
+};
+
+
+
+/*
+ *  Bakes 2D noise regions into float buffers or grayscale images
+ *  Regions are split into chunks of chunkSize² samples that are baked independently, each chunk is looked up in and written
+ *  to the cache if one is set. Tileable regions repeat seamlessly: Every octave wraps its lattice after exactly the region size,
+ *  which requires extent * step * frequency * lacunarity^octave to be a power of two of at most 256 cells along both axes.
+ */
+template<class N>
+class NoiseBaker {
+
+	static_assert(CC::NoiseType<N>, "NoiseBaker requires a noise type");
+
+public:
+
+	struct Settings {
+
+		float frequency = 1;
+		u32 octaves = 1;
+		float lacunarity = 2;
+		float persistence = 0.5;
+		bool tileable = false;
+
+	};
+
+	static constexpr u32 DefaultChunkSize = 256;
+
+
+	explicit NoiseBaker(u32 seed, const Settings& settings = Settings(), const N& noise = N()) : noise(noise), seed(seed), settings(settings), chunkSize(DefaultChunkSize) {
+
+		arc_assert(settings.octaves >= 1, "Octaves count cannot be 0");
+
+		this->noise.permutate(seed);
+
+	}
+
+
+	void setCache(const NoiseCache& cache) {
+		this->cache = cache;
+	}
+
+	void setChunkSize(u32 size) {
+
+		arc_assert(size > 0, "Chunk size cannot be 0");
+
+		chunkSize = size;
+
+	}
+
+	const NoiseCache& getCache() const {
+		return cache;
+	}
+
+	u32 getChunkSize() const {
+		return chunkSize;
+	}
+
+	const Settings& getSettings() const {
+		return settings;
+	}
+
+
+	// Samples origin + step * (x, y) for every x, y below extent, rows first
+	void bake(const Vec2f& origin, const Vec2f& step, const Vec2ui& extent, std::span<float> samples) const {
+
+		arc_assert(samples.size() == SizeT(extent.x) * extent.y, "The amount of samples needs to match the region extent");
+
+		std::vector<N> octaveNoise = createOctaveNoise(step, extent);
+		std::vector<float> chunk;
+		std::vector<float> scratch;
+
+		for (u32 y0 = 0; y0 < extent.y; y0 += chunkSize) {
+
+			for (u32 x0 = 0; x0 < extent.x; x0 += chunkSize) {
+
+				const Vec2f chunkOrigin(origin.x + float(x0) * step.x, origin.y + float(y0) * step.y);
+				const Vec2ui chunkExtent(std::min(chunkSize, extent.x - x0), std::min(chunkSize, extent.y - y0));
+
+				chunk.resize(SizeT(chunkExtent.x) * chunkExtent.y);
+
+				NoiseCache::Key key = createKey(chunkOrigin, step, chunkExtent, extent);
+
+				if (!cache.load(key, chunk)) {
+
+					bakeChunk(octaveNoise, chunkOrigin, step, chunkExtent, chunk, scratch);
+					cache.store(key, chunk);
+
+				}
+
+				for (u32 y = 0; y < chunkExtent.y; y++) {
+					std::copy_n(&chunk[SizeT(y) * chunkExtent.x], chunkExtent.x, &samples[SizeT(y0 + y) * extent.x + x0]);
+				}
+
+			}
+
+		}
+
+	}
+
+	std::vector<float> bake(const Vec2f& origin, const Vec2f& step, const Vec2ui& extent) const {
+
+		std::vector<float> samples(SizeT(extent.x) * extent.y);
+		bake(origin, step, extent, samples);
+
+		return samples;
+
+	}
+
+	// Maps samples from [-1, 1] to [0, 255]
+	Image<Pixel::Grayscale8> bakeImage(const Vec2f& origin, const Vec2f& step, const Vec2ui& extent) const {
+
+		std::vector<float> samples = bake(origin, step, extent);
+
+		Image<Pixel::Grayscale8> image(extent.x, extent.y);
+		std::span<PixelGrayscale8> pixels = image.getImageBuffer();
+
+		for (SizeT i = 0; i < samples.size(); i++) {
+			pixels[i] = PixelGrayscale8(u8((Math::clamp(samples[i], -1.0f, 1.0f) + 1) * 127.5f + 0.5f));
+		}
+
+		return image;
+
+	}
+
+private:
+
+	// Tileable regions need a differently wrapped lattice per octave, otherwise all octaves share the noise as is
+	std::vector<N> createOctaveNoise(const Vec2f& step, const Vec2ui& extent) const {
+
+		if (!settings.tileable) {
+			return { noise };
+		}
+
+		if constexpr (!N::Tileable) {
+
+			throw UnsupportedOperationException("This noise type cannot be baked tileable");
+
+		} else {
+
+			std::vector<N> octaveNoise(settings.octaves, noise);
+
+			float frequency = settings.frequency;
+
+			for (N& octave : octaveNoise) {
+
+				octave.setPeriod(getPeriod(extent.x * step.x * frequency), getPeriod(extent.y * step.y * frequency));
+				frequency *= settings.lacunarity;
+
+			}
+
+			return octaveNoise;
+
+		}
+
+	}
+
+	static u32 getPeriod(double cells) {
+
+		double period = std::round(cells);
+
+		if (std::abs(cells - period) > 1E-3 || period < 1 || period > NoiseBase::maxPeriod || !Bits::isPowerOf2(u32(period))) {
+			throw NoiseException("Tileable region spans " + std::to_string(cells) + " lattice cells, expected a power of two up to 256");
+		}
+
+		return u32(period);
+
+	}
+
+	void bakeChunk(const std::vector<N>& octaveNoise, const Vec2f& origin, const Vec2f& step, const Vec2ui& extent, std::span<float> samples, std::vector<float>& scratch) const {
+
+		if (octaveNoise.size() == 1) {
+			octaveNoise[0].sampleGrid2D(origin, step, extent, samples, settings.frequency, settings.octaves, settings.lacunarity, settings.persistence);
+			return;
+		}
+
+		scratch.resize(samples.size() * 3);
+
+		NoiseBase::fractalAccumulate<N::FractalType>([&](u32 octave, std::span<float> octaveSamples) {
+
+			float frequency = settings.frequency;
+
+			for (u32 i = 0; i < octave; i++) {
+				frequency *= settings.lacunarity;
+			}
+
+			octaveNoise[octave].sampleGrid2D(origin, step, extent, octaveSamples, frequency);
+
+		}, samples, std::span<float>(scratch), settings.octaves, settings.persistence);
+
+	}
+
+	// Chunks are identified by everything that affects their samples, so they can be shared between overlapping regions
+	NoiseCache::Key createKey(const Vec2f& origin, const Vec2f& step, const Vec2ui& extent, const Vec2ui& regionExtent) const {
+
+		NoiseCache::Key key;
+
+		NoiseCache::append(key, N::TypeID);
+		NoiseCache::append(key, seed);
+		NoiseCache::append(key, settings.frequency);
+		NoiseCache::append(key, settings.octaves);
+		NoiseCache::append(key, settings.lacunarity);
+		NoiseCache::append(key, settings.persistence);
+		NoiseCache::append(key, settings.tileable);
+
+		for (float f : {origin.x, origin.y, step.x, step.y}) {
+			NoiseCache::append(key, f);
+		}
+
+		NoiseCache::append(key, extent.x);
+		NoiseCache::append(key, extent.y);
+
+		// The lattice period of tileable regions depends on the size of the whole region, other regions keep the period of the noise
+		if (settings.tileable) {
+
+			NoiseCache::append(key, regionExtent.x);
+			NoiseCache::append(key, regionExtent.y);
+
+		} else {
+
+			Vec4ui period = noise.getPeriod();
+
+			NoiseCache::append(key, noise.isPeriodic());
+
+			for (u32 i = 0; i < 4; i++) {
+				NoiseCache::append(key, period[i]);
+			}
+
+		}
+
+		return key;
+
+	}
+
+
+	N noise;
+	u32 seed;
+	Settings settings;
+	u32 chunkSize;
+	NoiseCache cache;
+
+};
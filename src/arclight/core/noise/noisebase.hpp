@@ -8,12 +8,24 @@
 
 #pragma once
 
+#include "noisesimd.hpp"
 #include "math/math.hpp"
 #include "math/vector.hpp"
+#include "util/bits.hpp"
 #include "common/concepts.hpp"
+#include "concurrent/thread.hpp"
+#include <atomic>
 #include <numeric>
 #include <random>
+#include <algorithm>
 #include <array>
+#include <span>
+#include <utility>
+#include <vector>
+
+
+template<class N>
+class NoiseBaker;
 
 
 enum class NoiseFractal {
@@ -22,14 +34,31 @@ enum class NoiseFractal {
 	RidgedSq,
 };
 
+// Values are part of persisted baked chunk keys and must never change
+enum class NoiseFamily {
+	Perlin	= 0,
+	Simplex	= 1,
+	Value	= 2,
+	Worley	= 3
+};
+
 
 class NoiseBase {
 
+	template<class N>
+	friend class NoiseBaker;
+
 public:
 
 	constexpr NoiseBase() : p(defaultP) {};
 
 
+	// Identifies a noise type independently of the compiler, unlike typeid names
+	static constexpr u32 makeTypeID(NoiseFamily family, NoiseFractal fractal, u32 flag = 0) {
+		return u32(family) << 16 | u32(fractal) << 8 | flag;
+	}
+
+
 	inline void permutate(u32 seed) {
 		p = genPermutation(seed);
 	}
@@ -39,8 +68,51 @@ public:
 		permutate(rd());
 	}
 
+
+	/*
+	 *  Repeats the lattice every period cells along each axis, so grids spanning whole periods tile seamlessly
+	 *  Periods must be powers of two no larger than 256. Simplex noise uses a skewed lattice and ignores them.
+	 */
+	constexpr void setPeriod(u32 x, u32 y = maxPeriod, u32 z = maxPeriod, u32 w = maxPeriod) {
+
+		const u32 periods[4] = {x, y, z, w};
+
+		for (u32 i = 0; i < 4; i++) {
+
+			arc_assert(periods[i] && periods[i] <= maxPeriod && Bits::isPowerOf2(periods[i]), "Noise period must be a power of two up to 256");
+
+			periodMask[i] = periods[i] - 1;
+
+		}
+
+		periodic = true;
+
+	}
+
+	constexpr void resetPeriod() {
+
+		periodMask.fill(hashMask);
+		periodic = false;
+
+	}
+
+	constexpr Vec4ui getPeriod() const {
+		return Vec4ui(periodMask[0] + 1, periodMask[1] + 1, periodMask[2] + 1, periodMask[3] + 1);
+	}
+
+	constexpr bool isPeriodic() const {
+		return periodic;
+	}
+
+
+	static constexpr u32 maxPeriod = 256;
+
 protected:
 
+	using FloatPack = NoiseSIMD::FloatPack;
+	using IntPack = NoiseSIMD::IntPack;
+
+
 	template<NoiseFractal Fractal, CC::Float F>
 	static constexpr F applyFractal(F sample) {
 
@@ -59,6 +131,24 @@ protected:
 
 	}
 
+	template<NoiseFractal Fractal>
+	static FloatPack applyFractal(FloatPack sample) {
+
+		if constexpr (Fractal != NoiseFractal::Standard) {
+
+			sample = FloatPack::splat(1) - sample.abs();
+
+			if constexpr (Fractal == NoiseFractal::RidgedSq) {
+				sample = sample * sample;
+			}
+
+			sample = sample * 2 - 1;
+		}
+
+		return sample;
+
+	}
+
 	template<NoiseFractal Fractal, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L, CC::Arithmetic P, CC::Invocable<T, A> Func>
 	static constexpr TT::CommonArithmeticType<T> fractalSample(Func&& func, const T& point, A frequency, u32 octaves, L lacunarity, P persistence) {
 
@@ -95,19 +185,229 @@ protected:
 
 	}
 
-	template<NoiseFractal Fractal, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L, CC::Arithmetic P, CC::Invocable<T, A> Func, CC::Float F = TT::CommonArithmeticType<T>>
-	static constexpr std::vector<F> fractalSample(Func&& func, std::span<const T> points, std::span<const A> frequencies, u32 octaves, L lacunarity, P persistence) {
+	template<NoiseFractal Fractal, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L, CC::Arithmetic P, class Func, CC::Float F = TT::CommonArithmeticType<T>>
+	static constexpr void fractalSample(Func&& func, std::span<const T> points, std::span<const A> frequencies, std::span<F> samples, u32 octaves, L lacunarity, P persistence) {
 
 		arc_assert(octaves >= 1, "Octaves count cannot be 0");
 		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+		arc_assert(points.size() == samples.size(), "The amount of points need to match the amount of samples");
 
 		if (octaves == 1) {
-			return func(points, frequencies);
+			func(points, frequencies, samples);
+			return;
 		}
 
-		arc_force_assert("Fractal span sampling not yet supported");
+		// Points are processed in blocks that run through all octaves, keeping the octave buffers in cache
+		constexpr SizeT BlockSize = 1024;
+
+		const SizeT count = points.size();
+		const SizeT blockSize = std::min(BlockSize, count);
+
+		std::vector<A> blockFrequencies(blockSize);
+		std::vector<F> scratch(blockSize * 3);
+
+		for (SizeT i = 0; i < count; i += BlockSize) {
+
+			const SizeT n = std::min(BlockSize, count - i);
+
+			std::span<const T> blockPoints = points.subspan(i, n);
+			std::span<A> octaveFrequencies(blockFrequencies.data(), n);
+
+			std::copy_n(&frequencies[i], n, octaveFrequencies.begin());
+
+			fractalAccumulate<Fractal>([&](u32 octave, std::span<F> octaveSamples) constexpr {
+
+				if (octave) {
+
+					for (A& frequency : octaveFrequencies) {
+						frequency *= lacunarity;
+					}
+
+				}
+
+				func(blockPoints, std::span<const A>(octaveFrequencies), octaveSamples);
 
-		return {};
+			}, samples.subspan(i, n), std::span<F>(scratch).first(n * 3), octaves, persistence);
+
+		}
+
+	}
+
+	/*
+	 *  Sums the octaves written by octave(i, out) into samples the same way the scalar fractalSample does
+	 *  scratch has to hold three values per sample: The octave itself, its scale and the accumulated range.
+	 */
+	template<NoiseFractal Fractal, CC::Float F, CC::Arithmetic P, class Func>
+	static constexpr void fractalAccumulate(Func&& octave, std::span<F> samples, std::span<F> scratch, u32 octaves, P persistence) {
+
+		const SizeT count = samples.size();
+
+		arc_assert(scratch.size() >= count * 3, "Fractal scratch buffer too small");
+
+		std::span<F> octaveSamples = scratch.subspan(0, count);
+		std::span<F> scale = scratch.subspan(count, count);
+		std::span<F> range = scratch.subspan(count * 2, count);
+
+		std::fill(samples.begin(), samples.end(), 0);
+		std::fill(scale.begin(), scale.end(), 1);
+		std::fill(range.begin(), range.end(), 0);
+
+		for (u32 i = 0; i < octaves; i++) {
+
+			octave(i, octaveSamples);
+
+			for (SizeT k = 0; k < count; k++) {
+
+				F sample = octaveSamples[k];
+
+				samples[k] += sample * scale[k];
+				range[k] += scale[k];
+
+				if constexpr (Fractal == NoiseFractal::Standard) {
+					scale[k] *= persistence;
+				} else {
+					scale[k] *= 1 - Math::abs(sample);
+					scale[k] *= 0.5;
+				}
+
+			}
+
+		}
+
+		for (SizeT k = 0; k < count; k++) {
+			samples[k] /= range[k];
+		}
+
+	}
+
+
+	/*
+	 *  Samples the points origin + step * (x, y, z) of a grid with the given extent, x running fastest in samples
+	 *  The grid is cut into tiles that are handed out to worker threads. Column coordinates are computed once per tile and octave,
+	 *  every other coordinate stays constant along a row, so no point arrays are built.
+	 */
+	template<NoiseFractal Fractal, CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L, CC::Arithmetic P, class ScalarFunc, class BatchFunc, CC::Float F = typename V::Type>
+	static void gridSample(const V& origin, const V& step, const Vec3ui& extent, std::span<F> samples, A frequency, u32 octaves, L lacunarity, P persistence, ScalarFunc&& scalar, BatchFunc&& kernel) {
+
+		static_assert(V::Size == 2 || V::Size == 3, "Grids can only be sampled in 2D or 3D");
+
+		arc_assert(octaves >= 1, "Octaves count cannot be 0");
+		arc_assert(samples.size() == SizeT(extent.x) * extent.y * extent.z, "The amount of samples needs to match the grid extent");
+
+		if (samples.empty()) {
+			return;
+		}
+
+		const u32 tilesX = (extent.x + gridTileWidth - 1) / gridTileWidth;
+		const u32 tilesY = (extent.y + gridTileHeight - 1) / gridTileHeight;
+		const u32 tiles = tilesX * tilesY * extent.z;
+
+		// Octave frequencies follow the exact progression of fractalSample, including truncation for integral frequencies
+		std::vector<A> frequencies(octaves);
+
+		for (u32 i = 0; i < octaves; i++) {
+			frequencies[i] = frequency;
+			frequency *= lacunarity;
+		}
+
+		std::atomic<u32> nextTile = 0;
+
+		auto worker = [&]() {
+
+			std::vector<F> columns(SizeT(octaves) * gridTileWidth);
+			std::vector<F> scratch(gridTileWidth * 3);
+
+			u32 tile;
+
+			while ((tile = nextTile.fetch_add(1, std::memory_order_relaxed)) < tiles) {
+
+				const u32 x0 = tile % tilesX * gridTileWidth;
+				const u32 y0 = tile / tilesX % tilesY * gridTileHeight;
+				const u32 z = tile / tilesX / tilesY;
+
+				const u32 width = std::min(gridTileWidth, extent.x - x0);
+				const u32 height = std::min(gridTileHeight, extent.y - y0);
+
+				for (u32 o = 0; o < octaves; o++) {
+
+					for (u32 i = 0; i < width; i++) {
+						columns[o * gridTileWidth + i] = (origin.x + F(x0 + i) * step.x) * frequencies[o];
+					}
+
+				}
+
+				V row = origin;
+
+				if constexpr (V::Size == 3) {
+					row.z = origin.z + F(z) * step.z;
+				}
+
+				for (u32 y = y0; y < y0 + height; y++) {
+
+					row.y = origin.y + F(y) * step.y;
+
+					auto sampleRow = [&](u32 octave, std::span<F> rowSamples) {
+						gridSampleRow(&columns[octave * gridTileWidth], row, frequencies[octave], rowSamples, scalar, kernel);
+					};
+
+					std::span<F> rowSamples = samples.subspan((SizeT(z) * extent.y + y) * extent.x + x0, width);
+
+					if (octaves == 1) {
+						sampleRow(0, rowSamples);
+					} else {
+						fractalAccumulate<Fractal>(sampleRow, rowSamples, std::span<F>(scratch).first(width * 3), octaves, persistence);
+					}
+
+				}
+
+			}
+
+		};
+
+		// Small grids are not worth the thread startup
+		u32 threadCount = 1;
+
+		if (samples.size() * octaves >= gridThreadThreshold) {
+			threadCount = std::clamp(Thread::getHardwareThreadCount(), 1u, tiles);
+		}
+
+		std::vector<Thread> threads(threadCount - 1);
+
+		for (Thread& thread : threads) {
+			thread.start(worker);
+		}
+
+		worker();
+
+		for (Thread& thread : threads) {
+			thread.finish();
+		}
+
+	}
+
+
+	/*
+	 *  Evaluates points in packs of NoiseSIMD::Lanes through kernel, falling back to scalar for everything else
+	 *  Only float vectors of rank 2 to 4 are batched.
+	 */
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F, class ScalarFunc, class BatchFunc>
+	static constexpr void batchSample(std::span<const T> points, std::span<const A> frequencies, std::span<F> samples, ScalarFunc&& scalar, BatchFunc&& kernel) {
+
+		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+		arc_assert(points.size() == samples.size(), "The amount of points need to match the amount of samples");
+
+		if constexpr (NoiseSIMD::Lanes > 1 && CC::FloatVector<T> && CC::Equal<F, float>) {
+
+			if (!std::is_constant_evaluated()) {
+				batchSampleVector<T::Size>(points, frequencies, samples, kernel);
+				return;
+			}
+
+		}
+
+		for (SizeT i = 0; i < points.size(); i++) {
+			samples[i] = scalar(points[i], frequencies[i]);
+		}
 
 	}
 
@@ -170,9 +470,33 @@ protected:
 		{ 0, 1, 0,-1},
 	};
 
+	// Component-major copy of the gradient tables for pack lookups: gradientTable<D>[c][i] == gradient<VecD>[i][c]
+	template<SizeT D> requires(D >= 2 && D <= 4)
+	static constexpr auto gradientTable = []() {
+
+		using V = TT::Conditional<D == 2, Vec2<float>, TT::Conditional<D == 3, Vec3<float>, Vec4<float>>>;
+
+		constexpr SizeT N = std::size(gradient<V>);
+
+		std::array<std::array<float, N>, D> table {};
+
+		for (SizeT i = 0; i < N; i++) {
+			for (SizeT c = 0; c < D; c++) {
+				table[c][i] = gradient<V>[i][c];
+			}
+		}
+
+		return table;
+
+	}();
+
 
 	static constexpr u32 hashMask = 0xFF;
 
+	// Lattice coordinates are wrapped with these before hashing, the defaults match hashMask
+	std::array<u32, 4> periodMask = {hashMask, hashMask, hashMask, hashMask};
+	bool periodic = false;
+
 	constexpr u32 hash(u32 x) const {
 		return p[x];
 	}
@@ -189,8 +513,167 @@ protected:
 		return p[hash(x, y, z) + w];
 	}
 
+	IntPack hash(const IntPack& x) const {
+		return x.gather(p.data());
+	}
+
+	IntPack hash(const IntPack& x, const IntPack& y) const {
+		return rehash(hash(x), y);
+	}
+
+	IntPack hash(const IntPack& x, const IntPack& y, const IntPack& z) const {
+		return rehash(hash(x, y), z);
+	}
+
+	IntPack hash(const IntPack& x, const IntPack& y, const IntPack& z, const IntPack& w) const {
+		return rehash(hash(x, y, z), w);
+	}
+
+	// Continues a partial hash h with the next coordinate, so that rehash(hash(x), y) == hash(x, y)
+	IntPack rehash(const IntPack& h, const IntPack& x) const {
+		return (h + x).gather(p.data());
+	}
+
+
+	// Looks up component C of the D-dimensional gradients, index must be in [0, N)
+	template<SizeT D, SizeT C, SizeT N = SizeT(1) << (D + 1)>
+	static FloatPack gradientComponent(const IntPack& index) {
+		return FloatPack::lookup<N>(gradientTable<D>[C].data(), index);
+	}
+
+	static FloatPack lerp(const FloatPack& start, const FloatPack& end, const FloatPack& factor) {
+		return start + factor * (end - start);
+	}
+
 private:
 
+	static constexpr u32 gridTileWidth = 64;
+	static constexpr u32 gridTileHeight = 16;
+	static constexpr SizeT gridThreadThreshold = 0x10000;
+
+
+	// Samples one grid row whose x coordinates have already been scaled by frequency, the rest of row is still in point space
+	template<CC::FloatVector V, CC::Arithmetic A, class ScalarFunc, class BatchFunc, CC::Float F = typename V::Type>
+	static void gridSampleRow(const F* columns, const V& row, A frequency, std::span<F> samples, ScalarFunc&& scalar, BatchFunc&& kernel) {
+
+		const SizeT count = samples.size();
+
+		V point = row;
+
+		for (u32 c = 1; c < V::Size; c++) {
+			point[c] = row[c] * frequency;
+		}
+
+		if constexpr (NoiseSIMD::Lanes > 1 && CC::Equal<F, float>) {
+
+			constexpr SizeT Lanes = NoiseSIMD::Lanes;
+
+			auto evaluate = [&](const FloatPack& x) {
+
+				if constexpr (V::Size == 2) {
+					return kernel(x, FloatPack::splat(point.y));
+				} else {
+					return kernel(x, FloatPack::splat(point.y), FloatPack::splat(point.z));
+				}
+
+			};
+
+			SizeT i = 0;
+
+			for (; i + Lanes <= count; i += Lanes) {
+				evaluate(FloatPack::load(&columns[i])).store(&samples[i]);
+			}
+
+			if (i < count) {
+
+				alignas(32) float x[Lanes];
+				alignas(32) float out[Lanes];
+
+				for (SizeT j = 0; j < Lanes; j++) {
+					x[j] = columns[std::min(i + j, count - 1)];
+				}
+
+				evaluate(FloatPack::load(x)).store(out);
+				std::copy_n(out, count - i, &samples[i]);
+
+			}
+
+		} else {
+
+			// Coordinates are already scaled, a unit frequency leaves them untouched
+			for (SizeT i = 0; i < count; i++) {
+
+				point.x = columns[i];
+				samples[i] = scalar(point, A(1));
+
+			}
+
+		}
+
+	}
+
+
+	template<SizeT D, CC::FloatVector V, CC::Arithmetic A, class BatchFunc>
+	static void batchSampleVector(std::span<const V> points, std::span<const A> frequencies, std::span<float> samples, BatchFunc&& kernel) {
+
+		constexpr SizeT Lanes = NoiseSIMD::Lanes;
+		constexpr u32 Stride = sizeof(V) / sizeof(float);
+
+		const SizeT count = points.size();
+
+		SizeT i = 0;
+
+		auto evaluate = [&]<SizeT... I>(std::index_sequence<I...>, auto&& load) {
+			return kernel(load(I)...);
+		};
+
+		if constexpr (CC::Equal<A, float>) {
+
+			// Coordinates are gathered straight out of the point array, float frequencies scale them without rounding differences
+			for (; i + Lanes <= count; i += Lanes) {
+
+				FloatPack frequency = FloatPack::load(&frequencies[i]);
+
+				FloatPack sample = evaluate(std::make_index_sequence<D>{}, [&](u32 c) {
+					return FloatPack::gather(&points[i][c], Stride) * frequency;
+				});
+
+				sample.store(&samples[i]);
+
+			}
+
+		}
+
+		// Remaining points are transposed through the stack, the last pack is padded with copies of the final point
+		alignas(32) float coords[D][Lanes];
+		alignas(32) float out[Lanes];
+
+		for (; i < count; i += Lanes) {
+
+			const SizeT n = std::min(Lanes, count - i);
+
+			for (SizeT j = 0; j < Lanes; j++) {
+
+				SizeT k = i + std::min(j, n - 1);
+
+				for (u32 c = 0; c < D; c++) {
+					coords[c][j] = points[k][c] * frequencies[k];
+				}
+
+			}
+
+			FloatPack sample = evaluate(std::make_index_sequence<D>{}, [&](u32 c) {
+				return FloatPack::load(coords[c]);
+			});
+
+			sample.store(out);
+			std::copy_n(out, n, &samples[i]);
+
+		}
+
+	}
+
+
 	using PermutationT = std::array<u32, 512>;
 
 	static PermutationT genPermutation(u32 seed) {
@@ -0,0 +1,128 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 noisecache.cpp
+ */
+
+#include "noisecache.hpp"
+#include "crypto/hash/sha2.hpp"
+#include "filesystem/directory.hpp"
+#include "filesystem/file.hpp"
+#include "util/log.hpp"
+
+
+
+constexpr static u32 cacheMagic = 0x4E435241;	// "ARCN"
+constexpr static u32 cacheVersion = 1;
+
+
+
+static std::vector<u8> createHeader(const NoiseCache::Key& key, u64 count) {
+
+	std::vector<u8> header;
+
+	NoiseCache::append(header, cacheMagic);
+	NoiseCache::append(header, cacheVersion);
+	NoiseCache::append(header, u32(key.size()));
+	header.insert(header.end(), key.begin(), key.end());
+	NoiseCache::append(header, count);
+
+	return header;
+
+}
+
+
+
+NoiseCache::NoiseCache() : enabled(false) {}
+
+NoiseCache::NoiseCache(const Path& directory) : directory(directory), enabled(true) {}
+
+
+
+bool NoiseCache::isEnabled() const {
+	return enabled;
+}
+
+
+
+Path NoiseCache::getDirectory() const {
+	return directory;
+}
+
+
+
+bool NoiseCache::load(const Key& key, std::span<float> samples) const {
+
+	if (!enabled) {
+		return false;
+	}
+
+	File file(getEntryPath(key), File::In);
+
+	if (!file.exists() || !file.open()) {
+		return false;
+	}
+
+	std::vector<u8> expected = createHeader(key, samples.size());
+
+	if (file.size() != expected.size() + samples.size_bytes()) {
+		return false;
+	}
+
+	std::vector<u8> header(expected.size());
+
+	if (file.read(header) != header.size() || header != expected) {
+		return false;
+	}
+
+	std::span<u8> data(reinterpret_cast<u8*>(samples.data()), samples.size_bytes());
+
+	return file.read(data) == data.size();
+
+}
+
+
+
+void NoiseCache::store(const Key& key, std::span<const float> samples) const {
+
+	if (!enabled) {
+		return;
+	}
+
+	Directory dir(directory);
+
+	if (!dir.exists() && !dir.create()) {
+		LogW("NoiseCache") << "Failed to create cache directory " << directory.toString();
+		return;
+	}
+
+	Path path = getEntryPath(key);
+	File file(path, File::Out | File::Trunc);
+
+	if (!file.open()) {
+		LogW("NoiseCache") << "Failed to write cache entry " << path.toString();
+		return;
+	}
+
+	file.write(createHeader(key, samples.size()));
+	file.write(std::span<const u8>(reinterpret_cast<const u8*>(samples.data()), samples.size_bytes()));
+	file.close();
+
+}
+
+
+
+void NoiseCache::append(Key& key, const std::string& str) {
+
+	append(key, u32(str.size()));
+	key.insert(key.end(), str.begin(), str.end());
+
+}
+
+
+
+Path NoiseCache::getEntryPath(const Key& key) const {
+	return directory / Path(SHA2::hash256(key).toString() + ".noise");
+}
@@ -0,0 +1,62 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 noisecache.hpp
+ */
+
+#pragma once
+
+#include "filesystem/path.hpp"
+#include "types.hpp"
+
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+
+/*
+ *  On-disk store for baked noise samples
+ *  Entries are named after the SHA-256 of their key and repeat the full key in their header, so hash collisions read as misses.
+ *  Samples are stored in native byte order, the cache is meant to stay on the machine that produced it.
+ */
+class NoiseCache {
+
+public:
+
+	using Key = std::vector<u8>;
+
+	NoiseCache();
+	explicit NoiseCache(const Path& directory);
+
+	bool isEnabled() const;
+	Path getDirectory() const;
+
+	// Returns false on a miss, samples are left in an unspecified state then
+	bool load(const Key& key, std::span<float> samples) const;
+	void store(const Key& key, std::span<const float> samples) const;
+
+	template<class T> requires std::is_trivially_copyable_v<T>
+	static void append(Key& key, const T& value) {
+
+		u8 bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+
+		key.insert(key.end(), bytes, bytes + sizeof(T));
+
+	}
+
+	static void append(Key& key, const std::string& str);
+
+private:
+
+	Path getEntryPath(const Key& key) const;
+
+	Path directory;
+	bool enabled;
+
+};
@@ -105,18 +105,139 @@ public:
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
 	constexpr std::vector<F> sample(std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
 
+		std::vector<F> samples(points.size());
+		sample(points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::Arithmetic C, SizeT N, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr std::vector<F> sample(ContributionT<C, N> contribution, std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		std::vector<F> samples(points.size());
+		sample(contribution, points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>, CC::Returns<F, ArgsHelper<F, Types>...> Func>
+	constexpr std::vector<F> sample(Func&& transform, std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		std::vector<F> samples(points.size());
+		sample(transform, points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void sample(std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
 		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
 
-		const u32 count = points.size();
+		mix(samples, [&](const auto& type, std::span<F> out) constexpr {
+			type.sample(points, frequencies, out, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::Arithmetic C, SizeT N, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void sample(ContributionT<C, N> contribution, std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+
+		mixContribution(contribution, samples, [&](const auto& type, std::span<F> out) constexpr {
+			type.sample(points, frequencies, out, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>, CC::Returns<F, ArgsHelper<F, Types>...> Func>
+	constexpr void sample(Func&& transform, std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+
+		mixTransform(transform, samples, [&](const auto& type, std::span<F> out) constexpr {
+			type.sample(points, frequencies, out, octaves, lacunarity, persistence);
+		});
+
+	}
+
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type> requires(V::Size == 2)
+	void sampleGrid2D(const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		mix(samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid2D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::Arithmetic C, SizeT N, CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type> requires(V::Size == 2)
+	void sampleGrid2D(ContributionT<C, N> contribution, const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		mixContribution(contribution, samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid2D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type, CC::Returns<F, ArgsHelper<F, Types>...> Func> requires(V::Size == 2)
+	void sampleGrid2D(Func&& transform, const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
 
-		std::vector<F> out(count);
+		mixTransform(transform, samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid2D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type> requires(V::Size == 3)
+	void sampleGrid3D(const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		mix(samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid3D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::Arithmetic C, SizeT N, CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type> requires(V::Size == 3)
+	void sampleGrid3D(ContributionT<C, N> contribution, const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		mixContribution(contribution, samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid3D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = typename V::Type, CC::Returns<F, ArgsHelper<F, Types>...> Func> requires(V::Size == 3)
+	void sampleGrid3D(Func&& transform, const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+
+		mixTransform(transform, samples, [&](const auto& type, std::span<F> out) {
+			type.sampleGrid3D(origin, step, extent, out, frequency, octaves, lacunarity, persistence);
+		});
+
+	}
+
+private:
+
+	// The mix functions combine the samples each noise type writes through sampleType(type, out)
+	template<CC::Float F, class Func>
+	constexpr void mix(std::span<F> samples, Func&& sampleType) const {
+
+		const SizeT count = samples.size();
+
+		std::vector<F> typeSamples(count);
+		std::fill(samples.begin(), samples.end(), 0);
 
 		auto calculate = [&](const auto& type) constexpr {
 
-			std::vector<F> samples = type.sample(points, frequencies, octaves, lacunarity, persistence);
+			sampleType(type, std::span<F>(typeSamples));
 
-			for (u32 i = 0; i < count; i++) {
-				out[i] += samples[i];
+			for (SizeT i = 0; i < count; i++) {
+				samples[i] += typeSamples[i];
 			}
 
 		};
@@ -125,35 +246,32 @@ public:
 			(calculate(args), ...);
 		}, types);
 
-		for (F& sample : out) {
+		for (F& sample : samples) {
 			sample /= TypesCount;
 		}
 
-		return out;
-
 	}
 
-	template<CC::Arithmetic C, SizeT N, CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
-	constexpr std::vector<F> sample(ContributionT<C, N> contribution, std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+	template<CC::Arithmetic C, SizeT N, CC::Float F, class Func>
+	constexpr void mixContribution(ContributionT<C, N> contribution, std::span<F> samples, Func&& sampleType) const {
 
-		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+		const SizeT count = samples.size();
 
-		const u32 count = points.size();
-
-		std::vector<F> out(count);
+		std::vector<F> typeSamples(count);
+		std::fill(samples.begin(), samples.end(), 0);
 
 		auto calculate = [&](const auto& type, u32 idx) constexpr {
 
 			F scale = (idx == 0) ? 1 : contribution[idx - 1];
 
-			std::vector<F> samples = type.sample(points, frequencies, octaves, lacunarity, persistence);
+			sampleType(type, std::span<F>(typeSamples));
 
-			for (u32 i = 0; i < count; i++) {
+			for (SizeT i = 0; i < count; i++) {
 
-				out[i] += samples[i] * scale;
+				samples[i] += typeSamples[i] * scale;
 
 				if (idx != TypesCount - 1) {
-					out[i] *= 1 - contribution[idx];
+					samples[i] *= 1 - contribution[idx];
 				}
 			}
 
@@ -164,37 +282,28 @@ public:
 			(calculate(args, idx++), ...);
 		}, types);
 
-		return out;
-
 	}
 
-	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>, CC::Returns<F, ArgsHelper<F, Types>...> Func>
-	constexpr std::vector<F> sample(Func&& transform, std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+	template<CC::Float F, class Transform, class Func>
+	constexpr void mixTransform(Transform&& transform, std::span<F> samples, Func&& sampleType) const {
 
-		arc_assert(points.size() == frequencies.size(), "The amount of points need to match the amount of frequencies");
+		const SizeT count = samples.size();
 
-		const u32 count = points.size();
+		std::array<std::vector<F>, TypesCount> typeSamples;
 
-		std::vector<F> out(count);
+		[&]<SizeT... I>(std::index_sequence<I...>) constexpr {
 
-		auto calculate = [&](const auto&... samples) constexpr {
+			(typeSamples[I].resize(count), ...);
+			(sampleType(std::get<I>(types), std::span<F>(typeSamples[I])), ...);
 
-			for (u32 i = 0; i < count; i++) {
-				out[i] = transform(samples[i]...);
+			for (SizeT i = 0; i < count; i++) {
+				samples[i] = transform(typeSamples[I][i]...);
 			}
 
-		};
-
-		std::apply([&](const auto&... args) constexpr {
-			calculate(args.sample(points, frequencies, octaves, lacunarity, persistence)...);
-		}, types);
-
-		return out;
+		}(std::make_index_sequence<TypesCount>{});
 
 	}
 
-private:
-
 	std::tuple<Types...> types;
 
 };
@@ -0,0 +1,384 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 noisesimd.hpp
+ */
+
+#pragma once
+
+#include "arcintrinsic.hpp"
+#include "types.hpp"
+
+#include <cmath>
+
+
+/*
+ *  Lane types for batched noise evaluation
+ *  With AVX2, a pack holds 8 floats, permutation lookups are gathered and gradient tables are shuffled in registers.
+ *  With SSE2, a pack holds 4 floats and table lookups fall back to per-lane loads.
+ *  Otherwise, a pack degenerates to a single float and batched sampling uses the scalar path.
+ *
+ *  Pack kernels perform the same float operations as their scalar counterparts and produce identical samples,
+ *  unless the compiler contracts the scalar code into FMAs. Samples then differ by less than 1E-4.
+ */
+namespace NoiseSIMD {
+
+	struct IntPack;
+	struct FloatPack;
+
+
+#if defined(ARC_VECTORIZE_X86_AVX2)
+
+	constexpr SizeT Lanes = 8;
+
+	struct IntPack {
+
+		ARC_FORCE_INLINE static IntPack splat(i32 i) {
+			return { _mm256_set1_epi32(i) };
+		}
+
+		// Converts a float comparison mask to 1 (set) or 0 (clear)
+		ARC_FORCE_INLINE static IntPack fromMask(const FloatPack& mask);
+
+		ARC_FORCE_INLINE IntPack operator+(const IntPack& i) const	{ return { _mm256_add_epi32(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator-(const IntPack& i) const	{ return { _mm256_sub_epi32(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator&(const IntPack& i) const	{ return { _mm256_and_si256(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator+(i32 i) const				{ return *this + splat(i); }
+		ARC_FORCE_INLINE IntPack operator&(i32 i) const				{ return *this & splat(i); }
+
+		// Sets all bits where this > i
+		ARC_FORCE_INLINE IntPack operator>(i32 i) const				{ return { _mm256_cmpgt_epi32(v, _mm256_set1_epi32(i)) }; }
+
+		ARC_FORCE_INLINE IntPack abs() const {
+			return { _mm256_abs_epi32(v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack toFloat() const;
+
+		// Returns table[v] for each lane
+		ARC_FORCE_INLINE IntPack gather(const u32* table) const {
+			return { _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), v, 4) };
+		}
+
+		__m256i v;
+
+	};
+
+	struct FloatPack {
+
+		ARC_FORCE_INLINE static FloatPack splat(float f) {
+			return { _mm256_set1_ps(f) };
+		}
+
+		ARC_FORCE_INLINE static FloatPack load(const float* p) {
+			return { _mm256_loadu_ps(p) };
+		}
+
+		// Loads p[0], p[stride], ..., p[7 * stride]
+		ARC_FORCE_INLINE static FloatPack gather(const float* p, u32 stride) {
+			return { _mm256_i32gather_ps(p, _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride)), 4) };
+		}
+
+		ARC_FORCE_INLINE void store(float* p) const {
+			_mm256_storeu_ps(p, v);
+		}
+
+		ARC_FORCE_INLINE FloatPack operator+(const FloatPack& f) const	{ return { _mm256_add_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator-(const FloatPack& f) const	{ return { _mm256_sub_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator*(const FloatPack& f) const	{ return { _mm256_mul_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator/(const FloatPack& f) const	{ return { _mm256_div_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator+(float f) const				{ return *this + splat(f); }
+		ARC_FORCE_INLINE FloatPack operator-(float f) const				{ return *this - splat(f); }
+		ARC_FORCE_INLINE FloatPack operator*(float f) const				{ return *this * splat(f); }
+		ARC_FORCE_INLINE FloatPack operator/(float f) const				{ return *this / splat(f); }
+
+		ARC_FORCE_INLINE FloatPack operator>(const FloatPack& f) const	{ return { _mm256_cmp_ps(v, f.v, _CMP_GT_OQ) }; }
+		ARC_FORCE_INLINE FloatPack operator>=(const FloatPack& f) const	{ return { _mm256_cmp_ps(v, f.v, _CMP_GE_OQ) }; }
+
+		ARC_FORCE_INLINE FloatPack floor() const {
+			return { _mm256_floor_ps(v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack abs() const {
+			return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack sqrt() const {
+			return { _mm256_sqrt_ps(v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack min(const FloatPack& f) const {
+			return { _mm256_min_ps(v, f.v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack max(const FloatPack& f) const {
+			return { _mm256_max_ps(v, f.v) };
+		}
+
+		// Truncates towards zero, call floor() first for floor semantics
+		ARC_FORCE_INLINE IntPack toInt() const {
+			return { _mm256_cvttps_epi32(v) };
+		}
+
+		// Returns a where mask is set, b otherwise
+		ARC_FORCE_INLINE static FloatPack select(const FloatPack& mask, const FloatPack& a, const FloatPack& b) {
+			return { _mm256_blendv_ps(b.v, a.v, mask.v) };
+		}
+
+		// Returns table[index] for each lane, index must be in [0, N)
+		template<SizeT N>
+		ARC_FORCE_INLINE static FloatPack lookup(const float* table, const IntPack& index) {
+
+			if constexpr (N == 8) {
+
+				return { _mm256_permutevar8x32_ps(_mm256_loadu_ps(table), index.v) };
+
+			} else if constexpr (N == 16) {
+
+				__m256 lo = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table), index.v);
+				__m256 hi = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table + 8), index.v);
+
+				return { _mm256_blendv_ps(lo, hi, _mm256_castsi256_ps(_mm256_slli_epi32(index.v, 28))) };
+
+			} else if constexpr (N == 32) {
+
+				__m256 q0 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table), index.v);
+				__m256 q1 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table + 8), index.v);
+				__m256 q2 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table + 16), index.v);
+				__m256 q3 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(table + 24), index.v);
+
+				__m256 bit3 = _mm256_castsi256_ps(_mm256_slli_epi32(index.v, 28));
+				__m256 bit4 = _mm256_castsi256_ps(_mm256_slli_epi32(index.v, 27));
+
+				return { _mm256_blendv_ps(_mm256_blendv_ps(q0, q1, bit3), _mm256_blendv_ps(q2, q3, bit3), bit4) };
+
+			} else {
+
+				return { _mm256_i32gather_ps(table, index.v, 4) };
+
+			}
+
+		}
+
+		__m256 v;
+
+	};
+
+	ARC_FORCE_INLINE IntPack IntPack::fromMask(const FloatPack& mask) {
+		return { _mm256_srli_epi32(_mm256_castps_si256(mask.v), 31) };
+	}
+
+	ARC_FORCE_INLINE FloatPack IntPack::toFloat() const {
+		return { _mm256_cvtepi32_ps(v) };
+	}
+
+#elif defined(ARC_VECTORIZE_X86_SSE2)
+
+	constexpr SizeT Lanes = 4;
+
+	struct IntPack {
+
+		ARC_FORCE_INLINE static IntPack splat(i32 i) {
+			return { _mm_set1_epi32(i) };
+		}
+
+		ARC_FORCE_INLINE static IntPack fromMask(const FloatPack& mask);
+
+		ARC_FORCE_INLINE IntPack operator+(const IntPack& i) const	{ return { _mm_add_epi32(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator-(const IntPack& i) const	{ return { _mm_sub_epi32(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator&(const IntPack& i) const	{ return { _mm_and_si128(v, i.v) }; }
+		ARC_FORCE_INLINE IntPack operator+(i32 i) const				{ return *this + splat(i); }
+		ARC_FORCE_INLINE IntPack operator&(i32 i) const				{ return *this & splat(i); }
+		ARC_FORCE_INLINE IntPack operator>(i32 i) const				{ return { _mm_cmpgt_epi32(v, _mm_set1_epi32(i)) }; }
+
+		ARC_FORCE_INLINE IntPack abs() const {
+
+#ifdef ARC_VECTORIZE_X86_SSSE3
+			return { _mm_abs_epi32(v) };
+#else
+			__m128i s = _mm_srai_epi32(v, 31);
+			return { _mm_sub_epi32(_mm_xor_si128(v, s), s) };
+#endif
+
+		}
+
+		ARC_FORCE_INLINE FloatPack toFloat() const;
+
+		// SSE has no gathers, so indices are spilled and looked up one by one
+		ARC_FORCE_INLINE IntPack gather(const u32* table) const {
+
+			alignas(16) i32 i[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(i), v);
+
+			return { _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]) };
+
+		}
+
+		__m128i v;
+
+	};
+
+	struct FloatPack {
+
+		ARC_FORCE_INLINE static FloatPack splat(float f) {
+			return { _mm_set1_ps(f) };
+		}
+
+		ARC_FORCE_INLINE static FloatPack load(const float* p) {
+			return { _mm_loadu_ps(p) };
+		}
+
+		ARC_FORCE_INLINE static FloatPack gather(const float* p, u32 stride) {
+			return { _mm_setr_ps(p[0], p[stride], p[stride * 2], p[stride * 3]) };
+		}
+
+		ARC_FORCE_INLINE void store(float* p) const {
+			_mm_storeu_ps(p, v);
+		}
+
+		ARC_FORCE_INLINE FloatPack operator+(const FloatPack& f) const	{ return { _mm_add_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator-(const FloatPack& f) const	{ return { _mm_sub_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator*(const FloatPack& f) const	{ return { _mm_mul_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator/(const FloatPack& f) const	{ return { _mm_div_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator+(float f) const				{ return *this + splat(f); }
+		ARC_FORCE_INLINE FloatPack operator-(float f) const				{ return *this - splat(f); }
+		ARC_FORCE_INLINE FloatPack operator*(float f) const				{ return *this * splat(f); }
+		ARC_FORCE_INLINE FloatPack operator/(float f) const				{ return *this / splat(f); }
+
+		ARC_FORCE_INLINE FloatPack operator>(const FloatPack& f) const	{ return { _mm_cmpgt_ps(v, f.v) }; }
+		ARC_FORCE_INLINE FloatPack operator>=(const FloatPack& f) const	{ return { _mm_cmpge_ps(v, f.v) }; }
+
+		ARC_FORCE_INLINE FloatPack floor() const {
+
+#ifdef ARC_VECTORIZE_X86_SSE4_1
+			return { _mm_floor_ps(v) };
+#else
+			__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+			return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f))) };
+#endif
+
+		}
+
+		ARC_FORCE_INLINE FloatPack abs() const {
+			return { _mm_andnot_ps(_mm_set1_ps(-0.0f), v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack sqrt() const {
+			return { _mm_sqrt_ps(v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack min(const FloatPack& f) const {
+			return { _mm_min_ps(v, f.v) };
+		}
+
+		ARC_FORCE_INLINE FloatPack max(const FloatPack& f) const {
+			return { _mm_max_ps(v, f.v) };
+		}
+
+		ARC_FORCE_INLINE IntPack toInt() const {
+			return { _mm_cvttps_epi32(v) };
+		}
+
+		ARC_FORCE_INLINE static FloatPack select(const FloatPack& mask, const FloatPack& a, const FloatPack& b) {
+			return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+		}
+
+		template<SizeT N>
+		ARC_FORCE_INLINE static FloatPack lookup(const float* table, const IntPack& index) {
+
+			alignas(16) i32 i[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(i), index.v);
+
+			return { _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]) };
+
+		}
+
+		__m128 v;
+
+	};
+
+	ARC_FORCE_INLINE IntPack IntPack::fromMask(const FloatPack& mask) {
+		return { _mm_srli_epi32(_mm_castps_si128(mask.v), 31) };
+	}
+
+	ARC_FORCE_INLINE FloatPack IntPack::toFloat() const {
+		return { _mm_cvtepi32_ps(v) };
+	}
+
+#else
+
+	constexpr SizeT Lanes = 1;
+
+	struct IntPack {
+
+		static IntPack splat(i32 i)						{ return { i }; }
+		static IntPack fromMask(const FloatPack& mask);
+
+		IntPack operator+(const IntPack& i) const		{ return { v + i.v }; }
+		IntPack operator-(const IntPack& i) const		{ return { v - i.v }; }
+		IntPack operator&(const IntPack& i) const		{ return { v & i.v }; }
+		IntPack operator+(i32 i) const					{ return { v + i }; }
+		IntPack operator&(i32 i) const					{ return { v & i }; }
+		IntPack operator>(i32 i) const					{ return { v > i ? -1 : 0 }; }
+
+		IntPack abs() const								{ return { v < 0 ? -v : v }; }
+		FloatPack toFloat() const;
+		IntPack gather(const u32* table) const			{ return { static_cast<i32>(table[v]) }; }
+
+		i32 v;
+
+	};
+
+	struct FloatPack {
+
+		static FloatPack splat(float f)					{ return { f }; }
+		static FloatPack load(const float* p)			{ return { *p }; }
+		static FloatPack gather(const float* p, u32)	{ return { *p }; }
+		void store(float* p) const						{ *p = v; }
+
+		FloatPack operator+(const FloatPack& f) const	{ return { v + f.v }; }
+		FloatPack operator-(const FloatPack& f) const	{ return { v - f.v }; }
+		FloatPack operator*(const FloatPack& f) const	{ return { v * f.v }; }
+		FloatPack operator/(const FloatPack& f) const	{ return { v / f.v }; }
+		FloatPack operator+(float f) const				{ return { v + f }; }
+		FloatPack operator-(float f) const				{ return { v - f }; }
+		FloatPack operator*(float f) const				{ return { v * f }; }
+		FloatPack operator/(float f) const				{ return { v / f }; }
+
+		// Masks are encoded as 1 (set) or 0 (clear)
+		FloatPack operator>(const FloatPack& f) const	{ return { v > f.v ? 1.0f : 0.0f }; }
+		FloatPack operator>=(const FloatPack& f) const	{ return { v >= f.v ? 1.0f : 0.0f }; }
+
+		FloatPack floor() const							{ return { std::floor(v) }; }
+		FloatPack abs() const							{ return { std::fabs(v) }; }
+		FloatPack sqrt() const							{ return { std::sqrt(v) }; }
+		FloatPack min(const FloatPack& f) const			{ return { v < f.v ? v : f.v }; }
+		FloatPack max(const FloatPack& f) const			{ return { v > f.v ? v : f.v }; }
+		IntPack toInt() const							{ return { static_cast<i32>(v) }; }
+
+		static FloatPack select(const FloatPack& mask, const FloatPack& a, const FloatPack& b) {
+			return mask.v != 0 ? a : b;
+		}
+
+		template<SizeT N>
+		static FloatPack lookup(const float* table, const IntPack& index) {
+			return { table[index.v] };
+		}
+
+		float v;
+
+	};
+
+	inline IntPack IntPack::fromMask(const FloatPack& mask) {
+		return { mask.v != 0 ? 1 : 0 };
+	}
+
+	inline FloatPack IntPack::toFloat() const {
+		return { static_cast<float>(v) };
+	}
+
+#endif
+
+}
@@ -16,6 +16,10 @@ class PerlinNoiseBase : public NoiseBase {
 
 public:
 
+	static constexpr NoiseFractal FractalType = Fractal;
+	static constexpr bool Tileable = true;
+	static constexpr u32 TypeID = makeTypeID(NoiseFamily::Perlin, Fractal);
+
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
 	constexpr TT::CommonArithmeticType<T> sample(const T& point, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
 		return fractalSample<Fractal>([this](const T& p, A f) constexpr { return raw(p, f); }, point, frequency, octaves, lacunarity, persistence);
@@ -23,7 +27,27 @@ public:
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
 	constexpr std::vector<F> sample(std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
-		return fractalSample<Fractal>([this](auto p, auto f) constexpr { return raw(p, f); }, points, frequencies, octaves, lacunarity, persistence);
+
+		std::vector<F> samples(points.size());
+		sample(points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
+	constexpr void sample(std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		fractalSample<Fractal>([this](auto p, auto f, auto s) constexpr { raw(p, f, s); }, points, frequencies, samples, octaves, lacunarity, persistence);
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 2)
+	void sampleGrid2D(const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, Vec3ui(extent.x, extent.y, 1), samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 3)
+	void sampleGrid3D(const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, extent, samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 private:
@@ -40,9 +64,9 @@ private:
 		F p0 = point - ip0;
 		F p1 = p0 - 1;
 
-		ip0 &= hashMask;
+		ip0 &= periodMask[0];
 
-		u32 ip1 = ip0 + 1;
+		u32 ip1 = (ip0 + 1) & periodMask[0];
 
 		auto dot = [&](F p, u32 ip) constexpr {
 			return p * gradient<F>[hash(ip) & grad1DMask];
@@ -73,11 +97,11 @@ private:
 		F px1 = px0 - 1;
 		F py1 = py0 - 1;
 
-		ipx0 &= hashMask;
-		ipy0 &= hashMask;
+		ipx0 &= periodMask[0];
+		ipy0 &= periodMask[1];
 
-		u32 ipx1 = ipx0 + 1;
-		u32 ipy1 = ipy0 + 1;
+		u32 ipx1 = (ipx0 + 1) & periodMask[0];
+		u32 ipy1 = (ipy0 + 1) & periodMask[1];
 
 		auto dot = [&](F px, F py, u32 ipx, u32 ipy) constexpr {
 			const auto& [gx, gy] = gradient<V>[hash(ipx, ipy) & grad2DMask];
@@ -120,13 +144,13 @@ private:
 		F py1 = py0 - 1;
 		F pz1 = pz0 - 1;
 
-		ipx0 &= hashMask;
-		ipy0 &= hashMask;
-		ipz0 &= hashMask;
+		ipx0 &= periodMask[0];
+		ipy0 &= periodMask[1];
+		ipz0 &= periodMask[2];
 
-		u32 ipx1 = ipx0 + 1;
-		u32 ipy1 = ipy0 + 1;
-		u32 ipz1 = ipz0 + 1;
+		u32 ipx1 = (ipx0 + 1) & periodMask[0];
+		u32 ipy1 = (ipy0 + 1) & periodMask[1];
+		u32 ipz1 = (ipz0 + 1) & periodMask[2];
 
 		auto dot = [&](F px, F py, F pz, u32 ipx, u32 ipy, u32 ipz) constexpr {
 			const auto& [gx, gy, gz] = gradient<V>[hash(ipx, ipy, ipz) & grad3DMask];
@@ -180,15 +204,15 @@ private:
 		F pz1 = pz0 - 1;
 		F pw1 = pw0 - 1;
 
-		ipx0 &= hashMask;
-		ipy0 &= hashMask;
-		ipz0 &= hashMask;
-		ipw0 &= hashMask;
+		ipx0 &= periodMask[0];
+		ipy0 &= periodMask[1];
+		ipz0 &= periodMask[2];
+		ipw0 &= periodMask[3];
 
-		u32 ipx1 = ipx0 + 1;
-		u32 ipy1 = ipy0 + 1;
-		u32 ipz1 = ipz0 + 1;
-		u32 ipw1 = ipw0 + 1;
+		u32 ipx1 = (ipx0 + 1) & periodMask[0];
+		u32 ipy1 = (ipy0 + 1) & periodMask[1];
+		u32 ipz1 = (ipz0 + 1) & periodMask[2];
+		u32 ipw1 = (ipw0 + 1) & periodMask[3];
 
 		auto dot = [&](F px, F py, F pz, F pw, u32 ipx, u32 ipy, u32 ipz, u32 ipw) constexpr {
 			const auto& [gx, gy, gz, gw] = gradient<V>[hash(ipx, ipy, ipz, ipw) & grad4DMask];
@@ -229,16 +253,181 @@ private:
 	}
 
 
-	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
-	constexpr std::vector<F> raw(std::span<const T> points, std::span<const A> frequencies) const {
+	FloatPack raw(const FloatPack& x, const FloatPack& y) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+		FloatPack px1 = px0 - 1;
+		FloatPack py1 = py0 - 1;
+
+		IntPack ipx0 = fx.toInt() & periodMask[0];
+		IntPack ipy0 = fy.toInt() & periodMask[1];
+		IntPack ipx1 = (ipx0 + 1) & periodMask[0];
+		IntPack ipy1 = (ipy0 + 1) & periodMask[1];
+
+		IntPack hx0 = hash(ipx0);
+		IntPack hx1 = hash(ipx1);
+
+		auto dot = [&](const FloatPack& px, const FloatPack& py, const IntPack& hx, const IntPack& ipy) {
+			IntPack g = rehash(hx, ipy) & grad2DMask;
+			return px * gradientComponent<2, 0>(g) + py * gradientComponent<2, 1>(g);
+		};
+
+		FloatPack stepx = interpolate(px0);
+
+		FloatPack sample0y = lerp(dot(px0, py0, hx0, ipy0), dot(px1, py0, hx1, ipy0), stepx);
+		FloatPack sample1y = lerp(dot(px0, py1, hx0, ipy1), dot(px1, py1, hx1, ipy1), stepx);
+
+		FloatPack stepy = interpolate(py0);
+
+		constexpr float scale = 1.41421356237; // sqrt(4/2)
+
+		FloatPack sample = lerp(sample0y, sample1y, stepy) * scale;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+		FloatPack pz0 = z - fz;
+		FloatPack px1 = px0 - 1;
+		FloatPack py1 = py0 - 1;
+		FloatPack pz1 = pz0 - 1;
+
+		IntPack ipx0 = fx.toInt() & periodMask[0];
+		IntPack ipy0 = fy.toInt() & periodMask[1];
+		IntPack ipz0 = fz.toInt() & periodMask[2];
+		IntPack ipx1 = (ipx0 + 1) & periodMask[0];
+		IntPack ipy1 = (ipy0 + 1) & periodMask[1];
+		IntPack ipz1 = (ipz0 + 1) & periodMask[2];
+
+		// Corners share hash prefixes, so every partial hash is only gathered once
+		IntPack hx0 = hash(ipx0);
+		IntPack hx1 = hash(ipx1);
+		IntPack hx0y0 = rehash(hx0, ipy0);
+		IntPack hx0y1 = rehash(hx0, ipy1);
+		IntPack hx1y0 = rehash(hx1, ipy0);
+		IntPack hx1y1 = rehash(hx1, ipy1);
+
+		auto dot = [&](const FloatPack& px, const FloatPack& py, const FloatPack& pz, const IntPack& hxy, const IntPack& ipz) {
+			IntPack g = rehash(hxy, ipz) & grad3DMask;
+			return px * gradientComponent<3, 0>(g) + py * gradientComponent<3, 1>(g) + pz * gradientComponent<3, 2>(g);
+		};
 
-		std::vector<F> samples;
+		FloatPack stepx = interpolate(px0);
 
-		for (u32 i = 0; i < points.size(); i++) {
-			samples.push_back(raw(points[i], frequencies[i]));
+		FloatPack sample0x = lerp(dot(px0, py0, pz0, hx0y0, ipz0), dot(px1, py0, pz0, hx1y0, ipz0), stepx);
+		FloatPack sample1x = lerp(dot(px0, py0, pz1, hx0y0, ipz1), dot(px1, py0, pz1, hx1y0, ipz1), stepx);
+		FloatPack sample2x = lerp(dot(px0, py1, pz0, hx0y1, ipz0), dot(px1, py1, pz0, hx1y1, ipz0), stepx);
+		FloatPack sample3x = lerp(dot(px0, py1, pz1, hx0y1, ipz1), dot(px1, py1, pz1, hx1y1, ipz1), stepx);
+
+		FloatPack stepy = interpolate(py0);
+
+		FloatPack sample0y = lerp(sample0x, sample2x, stepy);
+		FloatPack sample1y = lerp(sample1x, sample3x, stepy);
+
+		FloatPack stepz = interpolate(pz0);
+
+		constexpr float scale = 1.15470053838; // sqrt(4/3)
+
+		FloatPack sample = lerp(sample0y, sample1y, stepz) * scale;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z, const FloatPack& w) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+		FloatPack fw = w.floor();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+		FloatPack pz0 = z - fz;
+		FloatPack pw0 = w - fw;
+		FloatPack px1 = px0 - 1;
+		FloatPack py1 = py0 - 1;
+		FloatPack pz1 = pz0 - 1;
+		FloatPack pw1 = pw0 - 1;
+
+		IntPack ipx0 = fx.toInt() & periodMask[0];
+		IntPack ipy0 = fy.toInt() & periodMask[1];
+		IntPack ipz0 = fz.toInt() & periodMask[2];
+		IntPack ipw0 = fw.toInt() & periodMask[3];
+		IntPack ipx1 = (ipx0 + 1) & periodMask[0];
+		IntPack ipy1 = (ipy0 + 1) & periodMask[1];
+		IntPack ipz1 = (ipz0 + 1) & periodMask[2];
+		IntPack ipw1 = (ipw0 + 1) & periodMask[3];
+
+		// hxyz[a][b][c] holds hash(ipxa, ipyb, ipzc), leaving a single gather per corner
+		IntPack hx[2] = { hash(ipx0), hash(ipx1) };
+		IntPack hxy[2][2];
+		IntPack hxyz[2][2][2];
+
+		for (u32 a = 0; a < 2; a++) {
+			for (u32 b = 0; b < 2; b++) {
+
+				hxy[a][b] = rehash(hx[a], b ? ipy1 : ipy0);
+
+				for (u32 c = 0; c < 2; c++) {
+					hxyz[a][b][c] = rehash(hxy[a][b], c ? ipz1 : ipz0);
+				}
+
+			}
 		}
 
-		return samples;
+		auto dot = [&](const FloatPack& px, const FloatPack& py, const FloatPack& pz, const FloatPack& pw, const IntPack& hxyz, const IntPack& ipw) {
+			IntPack g = rehash(hxyz, ipw) & grad4DMask;
+			return px * gradientComponent<4, 0>(g) + py * gradientComponent<4, 1>(g) + pz * gradientComponent<4, 2>(g) + pw * gradientComponent<4, 3>(g);
+		};
+
+		FloatPack stepx = interpolate(px0);
+
+		FloatPack sample0x = lerp(dot(px0, py0, pz0, pw0, hxyz[0][0][0], ipw0), dot(px1, py0, pz0, pw0, hxyz[1][0][0], ipw0), stepx);
+		FloatPack sample1x = lerp(dot(px0, py0, pz0, pw1, hxyz[0][0][0], ipw1), dot(px1, py0, pz0, pw1, hxyz[1][0][0], ipw1), stepx);
+		FloatPack sample2x = lerp(dot(px0, py0, pz1, pw0, hxyz[0][0][1], ipw0), dot(px1, py0, pz1, pw0, hxyz[1][0][1], ipw0), stepx);
+		FloatPack sample3x = lerp(dot(px0, py0, pz1, pw1, hxyz[0][0][1], ipw1), dot(px1, py0, pz1, pw1, hxyz[1][0][1], ipw1), stepx);
+		FloatPack sample4x = lerp(dot(px0, py1, pz0, pw0, hxyz[0][1][0], ipw0), dot(px1, py1, pz0, pw0, hxyz[1][1][0], ipw0), stepx);
+		FloatPack sample5x = lerp(dot(px0, py1, pz0, pw1, hxyz[0][1][0], ipw1), dot(px1, py1, pz0, pw1, hxyz[1][1][0], ipw1), stepx);
+		FloatPack sample6x = lerp(dot(px0, py1, pz1, pw0, hxyz[0][1][1], ipw0), dot(px1, py1, pz1, pw0, hxyz[1][1][1], ipw0), stepx);
+		FloatPack sample7x = lerp(dot(px0, py1, pz1, pw1, hxyz[0][1][1], ipw1), dot(px1, py1, pz1, pw1, hxyz[1][1][1], ipw1), stepx);
+
+		FloatPack stepy = interpolate(py0);
+
+		FloatPack sample0y = lerp(sample0x, sample4x, stepy);
+		FloatPack sample1y = lerp(sample1x, sample5x, stepy);
+		FloatPack sample2y = lerp(sample2x, sample6x, stepy);
+		FloatPack sample3y = lerp(sample3x, sample7x, stepy);
+
+		FloatPack stepz = interpolate(pz0);
+
+		FloatPack sample0z = lerp(sample0y, sample2y, stepz);
+		FloatPack sample1z = lerp(sample1y, sample3y, stepz);
+
+		FloatPack stepw = interpolate(pw0);
+
+		FloatPack sample = lerp(sample0z, sample1z, stepw);
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void raw(std::span<const T> points, std::span<const A> frequencies, std::span<F> samples) const {
+		batchSample(points, frequencies, samples, [this](const T& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 
@@ -247,6 +436,10 @@ private:
 		return t * t * t * (t * (t * 6 - 15) + 10);
 	}
 
+	static FloatPack interpolate(const FloatPack& t) {
+		return t * t * t * (t * (t * 6 - 15) + 10);
+	}
+
 };
 
 
@@ -16,6 +16,10 @@ class SimplexNoiseBase : public NoiseBase {
 
 public:
 
+	static constexpr NoiseFractal FractalType = Fractal;
+	static constexpr bool Tileable = false;	// The skewed simplex lattice does not repeat along the axes
+	static constexpr u32 TypeID = makeTypeID(NoiseFamily::Simplex, Fractal);
+
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
 	constexpr TT::CommonArithmeticType<T> sample(const T& point, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
 		return fractalSample<Fractal>([this](const T& p, A f) constexpr { return raw(p, f); }, point, frequency, octaves, lacunarity, persistence);
@@ -23,7 +27,27 @@ public:
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
 	constexpr std::vector<F> sample(std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
-		return fractalSample<Fractal>([this](auto p, auto f) constexpr { return raw(p, f); }, points, frequencies, octaves, lacunarity, persistence);
+
+		std::vector<F> samples(points.size());
+		sample(points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
+	constexpr void sample(std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		fractalSample<Fractal>([this](auto p, auto f, auto s) constexpr { raw(p, f, s); }, points, frequencies, samples, octaves, lacunarity, persistence);
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 2)
+	void sampleGrid2D(const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, Vec3ui(extent.x, extent.y, 1), samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 3)
+	void sampleGrid3D(const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, extent, samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 private:
@@ -424,16 +448,200 @@ private:
 	}
 
 
-	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
-	constexpr std::vector<F> raw(std::span<const T> points, std::span<const A> frequencies) const {
+	/*
+	 *  Pack kernels pick the simplex vertices through coordinate ranks instead of branches.
+	 *  An axis is stepped into at vertex k if it ranks above D - 1 - k, ties going to the earlier axis like in the scalar path.
+	 */
+	FloatPack raw(const FloatPack& x, const FloatPack& y) const {
 
-		std::vector<F> samples;
+		constexpr float toTriangle = 0.2113248654;
+		constexpr float toSquare = 0.36602540378;
 
-		for (u32 i = 0; i < points.size(); i++) {
-			samples.push_back(raw(points[i], frequencies[i]));
-		}
+		FloatPack skew = (x + y) * toSquare;
+		FloatPack skewx = x + skew;
+		FloatPack skewy = y + skew;
 
-		return samples;
+		FloatPack fx = skewx.floor();
+		FloatPack fy = skewy.floor();
+
+		IntPack ipx0 = fx.toInt();
+		IntPack ipy0 = fy.toInt();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+
+		IntPack hpx0 = ipx0 & hashMask;
+		IntPack hpy0 = ipy0 & hashMask;
+
+		auto part = [&](const IntPack& ox, const IntPack& oy) {
+
+			FloatPack unskew = (ipx0 + ox + ipy0 + oy).toFloat() * toTriangle;
+			FloatPack unskewx = px0 - ox.toFloat() + unskew;
+			FloatPack unskewy = py0 - oy.toFloat() + unskew;
+
+			IntPack g = hash(hpx0 + ox, hpy0 + oy) & grad2DMask;
+			FloatPack dot = unskewx * gradientComponent<2, 0>(g) + unskewy * gradientComponent<2, 1>(g);
+
+			return dot * falloff(0.5, unskewx, unskewy);
+
+		};
+
+		IntPack zero = IntPack::splat(0);
+		IntPack one = IntPack::splat(1);
+
+		IntPack ox = IntPack::fromMask(skewx - fx >= skewy - fy);
+		IntPack oy = one - ox;
+
+		FloatPack sample = part(zero, zero) + part(one, one);
+		sample = sample + part(ox, oy);
+
+		constexpr float scale = 32.990773983; // 2916 * sqrt(2) / 125
+
+		return applyFractal<Fractal>(sample * scale);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z) const {
+
+		constexpr float toTetrahedron = 1.0 / 6;
+		constexpr float toCube = 1.0 / 3;
+
+		FloatPack skew = (x + y + z) * toCube;
+		FloatPack skewx = x + skew;
+		FloatPack skewy = y + skew;
+		FloatPack skewz = z + skew;
+
+		FloatPack fx = skewx.floor();
+		FloatPack fy = skewy.floor();
+		FloatPack fz = skewz.floor();
+
+		IntPack ipx0 = fx.toInt();
+		IntPack ipy0 = fy.toInt();
+		IntPack ipz0 = fz.toInt();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+		FloatPack pz0 = z - fz;
+
+		IntPack hpx0 = ipx0 & hashMask;
+		IntPack hpy0 = ipy0 & hashMask;
+		IntPack hpz0 = ipz0 & hashMask;
+
+		auto part = [&](const IntPack& ox, const IntPack& oy, const IntPack& oz) {
+
+			FloatPack unskew = (ipx0 + ox + ipy0 + oy + ipz0 + oz).toFloat() * toTetrahedron;
+			FloatPack unskewx = px0 - ox.toFloat() + unskew;
+			FloatPack unskewy = py0 - oy.toFloat() + unskew;
+			FloatPack unskewz = pz0 - oz.toFloat() + unskew;
+
+			IntPack g = hash(hpx0 + ox, hpy0 + oy, hpz0 + oz) & grad3DMask;
+			FloatPack dot = unskewx * gradientComponent<3, 0>(g) + unskewy * gradientComponent<3, 1>(g) + unskewz * gradientComponent<3, 2>(g);
+
+			return dot * falloff(0.5, unskewx, unskewy, unskewz);
+
+		};
+
+		FloatPack diffx = skewx - fx;
+		FloatPack diffy = skewy - fy;
+		FloatPack diffz = skewz - fz;
+
+		IntPack rankx = IntPack::fromMask(diffx >= diffy) + IntPack::fromMask(diffx >= diffz);
+		IntPack ranky = IntPack::fromMask(diffy > diffx) + IntPack::fromMask(diffy >= diffz);
+		IntPack rankz = IntPack::fromMask(diffz > diffx) + IntPack::fromMask(diffz > diffy);
+
+		IntPack zero = IntPack::splat(0);
+		IntPack one = IntPack::splat(1);
+
+		FloatPack sample1 = part(zero, zero, zero);
+		FloatPack sample2 = part(one, one, one);
+		FloatPack sample3 = part((rankx > 1) & 1, (ranky > 1) & 1, (rankz > 1) & 1);
+		FloatPack sample4 = part((rankx > 0) & 1, (ranky > 0) & 1, (rankz > 0) & 1);
+
+		constexpr float scale = 30.6822935365; // 8192 * sqrt(3) / (327 * sqrt(2))
+
+		FloatPack sample = (sample1 + sample2 + sample3 + sample4) * scale;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z, const FloatPack& w) const {
+
+		constexpr float to5Cell = 0.13819660112;
+		constexpr float toTesseract = 0.30901699437;
+
+		FloatPack skew = (x + y + z + w) * toTesseract;
+		FloatPack skewx = x + skew;
+		FloatPack skewy = y + skew;
+		FloatPack skewz = z + skew;
+		FloatPack skeww = w + skew;
+
+		FloatPack fx = skewx.floor();
+		FloatPack fy = skewy.floor();
+		FloatPack fz = skewz.floor();
+		FloatPack fw = skeww.floor();
+
+		IntPack ipx0 = fx.toInt();
+		IntPack ipy0 = fy.toInt();
+		IntPack ipz0 = fz.toInt();
+		IntPack ipw0 = fw.toInt();
+
+		FloatPack px0 = x - fx;
+		FloatPack py0 = y - fy;
+		FloatPack pz0 = z - fz;
+		FloatPack pw0 = w - fw;
+
+		IntPack hpx0 = ipx0 & hashMask;
+		IntPack hpy0 = ipy0 & hashMask;
+		IntPack hpz0 = ipz0 & hashMask;
+		IntPack hpw0 = ipw0 & hashMask;
+
+		auto part = [&](const IntPack& ox, const IntPack& oy, const IntPack& oz, const IntPack& ow) {
+
+			FloatPack unskew = (ipx0 + ox + ipy0 + oy + ipz0 + oz + ipw0 + ow).toFloat() * to5Cell;
+			FloatPack unskewx = px0 - ox.toFloat() + unskew;
+			FloatPack unskewy = py0 - oy.toFloat() + unskew;
+			FloatPack unskewz = pz0 - oz.toFloat() + unskew;
+			FloatPack unskeww = pw0 - ow.toFloat() + unskew;
+
+			IntPack g = hash(hpx0 + ox, hpy0 + oy, hpz0 + oz, hpw0 + ow) & grad4DMask;
+			FloatPack dot = unskewx * gradientComponent<4, 0>(g) + unskewy * gradientComponent<4, 1>(g) + unskewz * gradientComponent<4, 2>(g) + unskeww * gradientComponent<4, 3>(g);
+
+			return dot * falloff(0.5, unskewx, unskewy, unskewz, unskeww);
+
+		};
+
+		FloatPack diffx = skewx - fx;
+		FloatPack diffy = skewy - fy;
+		FloatPack diffz = skewz - fz;
+		FloatPack diffw = skeww - fw;
+
+		IntPack rankx = IntPack::fromMask(diffx >= diffy) + IntPack::fromMask(diffx >= diffz) + IntPack::fromMask(diffx >= diffw);
+		IntPack ranky = IntPack::fromMask(diffy > diffx) + IntPack::fromMask(diffy >= diffz) + IntPack::fromMask(diffy >= diffw);
+		IntPack rankz = IntPack::fromMask(diffz > diffx) + IntPack::fromMask(diffz > diffy) + IntPack::fromMask(diffz >= diffw);
+		IntPack rankw = IntPack::fromMask(diffw > diffx) + IntPack::fromMask(diffw > diffy) + IntPack::fromMask(diffw > diffz);
+
+		IntPack zero = IntPack::splat(0);
+		IntPack one = IntPack::splat(1);
+
+		FloatPack sample1 = part(zero, zero, zero, zero);
+		FloatPack sample2 = part(one, one, one, one);
+		FloatPack sample3 = part((rankx > 2) & 1, (ranky > 2) & 1, (rankz > 2) & 1, (rankw > 2) & 1);
+		FloatPack sample4 = part((rankx > 1) & 1, (ranky > 1) & 1, (rankz > 1) & 1, (rankw > 1) & 1);
+		FloatPack sample5 = part((rankx > 0) & 1, (ranky > 0) & 1, (rankz > 0) & 1, (rankw > 0) & 1);
+
+		constexpr float scale = 27;
+
+		FloatPack sample = (sample1 + sample2 + sample3 + sample4 + sample5) * scale;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void raw(std::span<const T> points, std::span<const A> frequencies, std::span<F> samples) const {
+		batchSample(points, frequencies, samples, [this](const T& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 
@@ -449,6 +657,18 @@ private:
 		return a * a * a;
 	}
 
+	template<class... Args> requires TT::IsAllSame<FloatPack, Args...>
+	static FloatPack falloff(float a, const Args&... v) {
+
+		FloatPack t = FloatPack::splat(a);
+
+		((t = t - v * v), ...);
+
+		t = t.max(FloatPack::splat(0));
+
+		return t * t * t;
+	}
+
 };
 
 
@@ -24,6 +24,9 @@ class ValueNoiseBase : public NoiseBase {
 public:
 
 	using FlagT = ValueNoiseFlag;
+	static constexpr NoiseFractal FractalType = Fractal;
+	static constexpr bool Tileable = true;
+	static constexpr u32 TypeID = makeTypeID(NoiseFamily::Value, Fractal, u32(Flag));
 
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
@@ -33,7 +36,27 @@ public:
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
 	constexpr std::vector<F> sample(std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
-		return fractalSample<Fractal>([this](auto p, auto f) constexpr { return raw(p, f); }, points, frequencies, octaves, lacunarity, persistence);
+
+		std::vector<F> samples(points.size());
+		sample(points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
+	constexpr void sample(std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		fractalSample<Fractal>([this](auto p, auto f, auto s) constexpr { raw(p, f, s); }, points, frequencies, samples, octaves, lacunarity, persistence);
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 2)
+	void sampleGrid2D(const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, Vec3ui(extent.x, extent.y, 1), samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 3)
+	void sampleGrid3D(const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, extent, samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 private:
@@ -47,7 +70,7 @@ private:
 
 		I ip = Math::floor(point);
 
-		u32 hp0 = ip & hashMask;
+		u32 hp0 = ip & periodMask[0];
 
 		auto part = [&](u32 hp) constexpr {
 			return hash(hp) * hashScale<F>;
@@ -61,7 +84,7 @@ private:
 
 		} else {
 
-			u32 hp1 = hp0 + 1;
+			u32 hp1 = (hp0 + 1) & periodMask[0];
 
 			F p = point - ip;
 
@@ -84,8 +107,8 @@ private:
 		I ipx = Math::floor(x);
 		I ipy = Math::floor(y);
 
-		u32 hpx0 = ipx & hashMask;
-		u32 hpy0 = ipy & hashMask;
+		u32 hpx0 = ipx & periodMask[0];
+		u32 hpy0 = ipy & periodMask[1];
 
 		auto part = [&](u32 hpx, u32 hpy) constexpr {
 			return hash(hpx, hpy) * hashScale<F>;
@@ -99,8 +122,8 @@ private:
 
 		} else {
 
-			u32 hpx1 = hpx0 + 1;
-			u32 hpy1 = hpy0 + 1;
+			u32 hpx1 = (hpx0 + 1) & periodMask[0];
+			u32 hpy1 = (hpy0 + 1) & periodMask[1];
 
 			F px = x - ipx;
 			F py = y - ipy;
@@ -133,9 +156,9 @@ private:
 		I ipy = Math::floor(y);
 		I ipz = Math::floor(z);
 
-		u32 hpx0 = ipx & hashMask;
-		u32 hpy0 = ipy & hashMask;
-		u32 hpz0 = ipz & hashMask;
+		u32 hpx0 = ipx & periodMask[0];
+		u32 hpy0 = ipy & periodMask[1];
+		u32 hpz0 = ipz & periodMask[2];
 
 		auto part = [&](u32 hpx, u32 hpy, u32 hpz) constexpr {
 			return hash(hpx, hpy, hpz) * hashScale<F>;
@@ -149,9 +172,9 @@ private:
 
 		} else {
 
-			u32 hpx1 = hpx0 + 1;
-			u32 hpy1 = hpy0 + 1;
-			u32 hpz1 = hpz0 + 1;
+			u32 hpx1 = (hpx0 + 1) & periodMask[0];
+			u32 hpy1 = (hpy0 + 1) & periodMask[1];
+			u32 hpz1 = (hpz0 + 1) & periodMask[2];
 
 			F px = x - ipx;
 			F py = y - ipy;
@@ -194,10 +217,10 @@ private:
 		I ipz = Math::floor(z);
 		I ipw = Math::floor(w);
 
-		u32 hpx0 = ipx & hashMask;
-		u32 hpy0 = ipy & hashMask;
-		u32 hpz0 = ipz & hashMask;
-		u32 hpw0 = ipw & hashMask;
+		u32 hpx0 = ipx & periodMask[0];
+		u32 hpy0 = ipy & periodMask[1];
+		u32 hpz0 = ipz & periodMask[2];
+		u32 hpw0 = ipw & periodMask[3];
 
 		auto part = [&](u32 hpx, u32 hpy, u32 hpz, u32 hpw) constexpr {
 			return hash(hpx, hpy, hpz, hpw) * hashScale<F>;
@@ -211,10 +234,10 @@ private:
 
 		} else {
 
-			u32 hpx1 = hpx0 + 1;
-			u32 hpy1 = hpy0 + 1;
-			u32 hpz1 = hpz0 + 1;
-			u32 hpw1 = hpw0 + 1;
+			u32 hpx1 = (hpx0 + 1) & periodMask[0];
+			u32 hpy1 = (hpy0 + 1) & periodMask[1];
+			u32 hpz1 = (hpz0 + 1) & periodMask[2];
+			u32 hpw1 = (hpw0 + 1) & periodMask[3];
 
 			F px = x - ipx;
 			F py = y - ipy;
@@ -254,16 +277,180 @@ private:
 	}
 
 
-	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
-	constexpr std::vector<F> raw(std::span<const T> points, std::span<const A> frequencies) const {
+	FloatPack raw(const FloatPack& x, const FloatPack& y) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+
+		IntPack hpx0 = fx.toInt() & periodMask[0];
+		IntPack hpy0 = fy.toInt() & periodMask[1];
+
+		auto part = [&](const IntPack& hx, const IntPack& hpy) {
+			return rehash(hx, hpy).toFloat() * hashScale<float>;
+		};
+
+		IntPack hx0 = hash(hpx0);
+
+		FloatPack sample;
+
+		if constexpr (Flag == ValueNoiseFlag::None) {
+
+			sample = part(hx0, hpy0) * 2 - 1;
+
+		} else {
+
+			IntPack hpy1 = (hpy0 + 1) & periodMask[1];
+			IntPack hx1 = hash((hpx0 + 1) & periodMask[0]);
 
-		std::vector<F> samples;
+			FloatPack stepx = interpolate(x - fx);
 
-		for (u32 i = 0; i < points.size(); i++) {
-			samples.push_back(raw(points[i], frequencies[i]));
+			FloatPack sample0y = lerp(part(hx0, hpy0), part(hx1, hpy0), stepx);
+			FloatPack sample1y = lerp(part(hx0, hpy1), part(hx1, hpy1), stepx);
+
+			FloatPack stepy = interpolate(y - fy);
+
+			sample = lerp(sample0y, sample1y, stepy) * 2 - 1;
 		}
 
-		return samples;
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+
+		IntPack hpx0 = fx.toInt() & periodMask[0];
+		IntPack hpy0 = fy.toInt() & periodMask[1];
+		IntPack hpz0 = fz.toInt() & periodMask[2];
+
+		auto part = [&](const IntPack& hxy, const IntPack& hpz) {
+			return rehash(hxy, hpz).toFloat() * hashScale<float>;
+		};
+
+		IntPack hx0 = hash(hpx0);
+		IntPack hx0y0 = rehash(hx0, hpy0);
+
+		FloatPack sample;
+
+		if constexpr (Flag == ValueNoiseFlag::None) {
+
+			sample = part(hx0y0, hpz0) * 2 - 1;
+
+		} else {
+
+			IntPack hpy1 = (hpy0 + 1) & periodMask[1];
+			IntPack hpz1 = (hpz0 + 1) & periodMask[2];
+
+			IntPack hx1 = hash((hpx0 + 1) & periodMask[0]);
+			IntPack hx0y1 = rehash(hx0, hpy1);
+			IntPack hx1y0 = rehash(hx1, hpy0);
+			IntPack hx1y1 = rehash(hx1, hpy1);
+
+			FloatPack stepx = interpolate(x - fx);
+
+			FloatPack sample0x = lerp(part(hx0y0, hpz0), part(hx1y0, hpz0), stepx);
+			FloatPack sample1x = lerp(part(hx0y0, hpz1), part(hx1y0, hpz1), stepx);
+			FloatPack sample2x = lerp(part(hx0y1, hpz0), part(hx1y1, hpz0), stepx);
+			FloatPack sample3x = lerp(part(hx0y1, hpz1), part(hx1y1, hpz1), stepx);
+
+			FloatPack stepy = interpolate(y - fy);
+
+			FloatPack sample0y = lerp(sample0x, sample2x, stepy);
+			FloatPack sample1y = lerp(sample1x, sample3x, stepy);
+
+			FloatPack stepz = interpolate(z - fz);
+
+			sample = lerp(sample0y, sample1y, stepz) * 2 - 1;
+		}
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z, const FloatPack& w) const {
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+		FloatPack fw = w.floor();
+
+		IntPack hpx0 = fx.toInt() & periodMask[0];
+		IntPack hpy0 = fy.toInt() & periodMask[1];
+		IntPack hpz0 = fz.toInt() & periodMask[2];
+		IntPack hpw0 = fw.toInt() & periodMask[3];
+
+		auto part = [&](const IntPack& hxyz, const IntPack& hpw) {
+			return rehash(hxyz, hpw).toFloat() * hashScale<float>;
+		};
+
+		FloatPack sample;
+
+		if constexpr (Flag == ValueNoiseFlag::None) {
+
+			sample = part(hash(hpx0, hpy0, hpz0), hpw0) * 2 - 1;
+
+		} else {
+
+			IntPack hpy1 = (hpy0 + 1) & periodMask[1];
+			IntPack hpz1 = (hpz0 + 1) & periodMask[2];
+			IntPack hpw1 = (hpw0 + 1) & periodMask[3];
+
+			// hxyz[a][b][c] holds hash(hpxa, hpyb, hpzc), leaving a single gather per corner
+			IntPack hx[2] = { hash(hpx0), hash((hpx0 + 1) & periodMask[0]) };
+			IntPack hxy[2][2];
+			IntPack hxyz[2][2][2];
+
+			for (u32 a = 0; a < 2; a++) {
+				for (u32 b = 0; b < 2; b++) {
+
+					hxy[a][b] = rehash(hx[a], b ? hpy1 : hpy0);
+
+					for (u32 c = 0; c < 2; c++) {
+						hxyz[a][b][c] = rehash(hxy[a][b], c ? hpz1 : hpz0);
+					}
+
+				}
+			}
+
+			FloatPack stepx = interpolate(x - fx);
+
+			FloatPack sample0x = lerp(part(hxyz[0][0][0], hpw0), part(hxyz[1][0][0], hpw0), stepx);
+			FloatPack sample1x = lerp(part(hxyz[0][0][0], hpw1), part(hxyz[1][0][0], hpw1), stepx);
+			FloatPack sample2x = lerp(part(hxyz[0][0][1], hpw0), part(hxyz[1][0][1], hpw0), stepx);
+			FloatPack sample3x = lerp(part(hxyz[0][0][1], hpw1), part(hxyz[1][0][1], hpw1), stepx);
+			FloatPack sample4x = lerp(part(hxyz[0][1][0], hpw0), part(hxyz[1][1][0], hpw0), stepx);
+			FloatPack sample5x = lerp(part(hxyz[0][1][0], hpw1), part(hxyz[1][1][0], hpw1), stepx);
+			FloatPack sample6x = lerp(part(hxyz[0][1][1], hpw0), part(hxyz[1][1][1], hpw0), stepx);
+			FloatPack sample7x = lerp(part(hxyz[0][1][1], hpw1), part(hxyz[1][1][1], hpw1), stepx);
+
+			FloatPack stepy = interpolate(y - fy);
+
+			FloatPack sample0y = lerp(sample0x, sample4x, stepy);
+			FloatPack sample1y = lerp(sample1x, sample5x, stepy);
+			FloatPack sample2y = lerp(sample2x, sample6x, stepy);
+			FloatPack sample3y = lerp(sample3x, sample7x, stepy);
+
+			FloatPack stepz = interpolate(z - fz);
+
+			FloatPack sample0z = lerp(sample0y, sample2y, stepz);
+			FloatPack sample1z = lerp(sample1y, sample3y, stepz);
+
+			FloatPack stepw = interpolate(w - fw);
+
+			sample = lerp(sample0z, sample1z, stepw) * 2 - 1;
+		}
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void raw(std::span<const T> points, std::span<const A> frequencies, std::span<F> samples) const {
+		batchSample(points, frequencies, samples, [this](const T& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 
@@ -279,6 +466,14 @@ private:
 		}
 	};
 
+	static FloatPack interpolate(const FloatPack& t) {
+		if constexpr(Flag == ValueNoiseFlag::Smooth) {
+			return t * t * t * (t * (t * 6 - 15) + 10);
+		} else {
+			return t;
+		}
+	};
+
 };
 
 
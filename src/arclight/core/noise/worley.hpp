@@ -24,6 +24,9 @@ class WorleyNoiseBase : public NoiseBase {
 public:
 
 	using FlagT = WorleyNoiseFlag;
+	static constexpr NoiseFractal FractalType = Fractal;
+	static constexpr bool Tileable = true;
+	static constexpr u32 TypeID = makeTypeID(NoiseFamily::Worley, Fractal, u32(Flag));
 
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
@@ -33,7 +36,27 @@ public:
 
 	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32, CC::Float F = TT::CommonArithmeticType<T>>
 	constexpr std::vector<F> sample(std::span<const T> points, std::span<const A> frequencies, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
-		return fractalSample<Fractal>([this](auto p, auto f) constexpr { return raw(p, f); }, points, frequencies, octaves, lacunarity, persistence);
+
+		std::vector<F> samples(points.size());
+		sample(points, frequencies, std::span<F>(samples), octaves, lacunarity, persistence);
+
+		return samples;
+
+	}
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32>
+	constexpr void sample(std::span<const T> points, std::span<const A> frequencies, std::span<TT::CommonArithmeticType<T>> samples, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		fractalSample<Fractal>([this](auto p, auto f, auto s) constexpr { raw(p, f, s); }, points, frequencies, samples, octaves, lacunarity, persistence);
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 2)
+	void sampleGrid2D(const V& origin, const V& step, const Vec2ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, Vec3ui(extent.x, extent.y, 1), samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
+	}
+
+	template<CC::FloatVector V, CC::Arithmetic A, CC::Arithmetic L = u32, CC::Arithmetic P = u32> requires(V::Size == 3)
+	void sampleGrid3D(const V& origin, const V& step, const Vec3ui& extent, std::span<typename V::Type> samples, A frequency, u32 octaves = 1, L lacunarity = 1, P persistence = 1) const {
+		gridSample<Fractal>(origin, step, extent, samples, frequency, octaves, lacunarity, persistence, [this](const V& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
 	}
 
 private:
@@ -56,7 +79,7 @@ private:
 
 		for (I ofs = -1; ofs <= 1; ofs++) {
 
-			u32 h = Math::abs(ip + ofs) & hashMask;
+			u32 h = wrapCell(ip + ofs, 0);
 
 			F g = gradient<F>[hash(h) & grad1DMask];
 
@@ -98,8 +121,8 @@ private:
 		for (I ofsx = -1; ofsx <= 1; ofsx++) {
 			for (I ofsy = -1; ofsy <= 1; ofsy++) {
 
-				u32 hx = Math::abs(ipx + ofsx) & hashMask;
-				u32 hy = Math::abs(ipy + ofsy) & hashMask;
+				u32 hx = wrapCell(ipx + ofsx, 0);
+				u32 hy = wrapCell(ipy + ofsy, 1);
 
 				auto [gx, gy] = gradient<V>[hash(hx, hy) & grad2DMask];
 
@@ -147,9 +170,9 @@ private:
 			for (I ofsy = -1; ofsy <= 1; ofsy++) {
 				for (I ofsz = -1; ofsz <= 1; ofsz++) {
 
-					u32 hx = Math::abs(ipx + ofsx) & hashMask;
-					u32 hy = Math::abs(ipy + ofsy) & hashMask;
-					u32 hz = Math::abs(ipz + ofsz) & hashMask;
+					u32 hx = wrapCell(ipx + ofsx, 0);
+					u32 hy = wrapCell(ipy + ofsy, 1);
+					u32 hz = wrapCell(ipz + ofsz, 2);
 
 					auto [gx, gy, gz] = gradient<V>[hash(hx, hy, hz) & grad3DMask];
 
@@ -203,10 +226,10 @@ private:
 				for (I ofsz = -1; ofsz <= 1; ofsz++) {
 					for (I ofsw = -1; ofsw <= 1; ofsw++) {
 
-						u32 hx = Math::abs(ipx + ofsx) & hashMask;
-						u32 hy = Math::abs(ipy + ofsy) & hashMask;
-						u32 hz = Math::abs(ipz + ofsz) & hashMask;
-						u32 hw = Math::abs(ipw + ofsw) & hashMask;
+						u32 hx = wrapCell(ipx + ofsx, 0);
+						u32 hy = wrapCell(ipy + ofsy, 1);
+						u32 hz = wrapCell(ipz + ofsz, 2);
+						u32 hw = wrapCell(ipw + ofsw, 3);
 
 						auto [gx, gy, gz, gw] = gradient<V>[hash(hx, hy, hz, hw) & grad3DMask];
 
@@ -230,16 +253,166 @@ private:
 	}
 
 
-	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
-	constexpr std::vector<F> raw(std::span<const T> points, std::span<const A> frequencies) const {
+	FloatPack raw(const FloatPack& x, const FloatPack& y) const {
+
+		constexpr float max = 1.41421356237; // sqrt(2)
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
 
-		std::vector<F> samples;
+		IntPack ipx = fx.toInt();
+		IntPack ipy = fy.toInt();
 
-		for (u32 i = 0; i < points.size(); i++) {
-			samples.push_back(raw(points[i], frequencies[i]));
+		FloatPack px = x - fx;
+		FloatPack py = y - fy;
+
+		FloatPack first = FloatPack::splat(max);
+		FloatPack second = FloatPack::splat(max);
+
+		for (i32 ofsx = -1; ofsx <= 1; ofsx++) {
+
+			IntPack hx = hash(wrapCell(ipx + ofsx, 0));
+
+			for (i32 ofsy = -1; ofsy <= 1; ofsy++) {
+
+				IntPack g = rehash(hx, wrapCell(ipy + ofsy, 1)) & grad2DMask;
+
+				FloatPack dx = px - (gradientComponent<2, 0>(g) * 0.5 + (0.5 + ofsx));
+				FloatPack dy = py - (gradientComponent<2, 1>(g) * 0.5 + (0.5 + ofsy));
+
+				FloatPack dist = (dx * dx + dy * dy).sqrt();
+
+				updateDistances(first, second, dist);
+			}
 		}
 
-		return samples;
+		FloatPack sample = applyFlag(first, second) / max * 2 - 1;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z) const {
+
+		constexpr float max = 1.73205080756; // sqrt(3)
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+
+		IntPack ipx = fx.toInt();
+		IntPack ipy = fy.toInt();
+		IntPack ipz = fz.toInt();
+
+		FloatPack px = x - fx;
+		FloatPack py = y - fy;
+		FloatPack pz = z - fz;
+
+		FloatPack first = FloatPack::splat(max);
+		FloatPack second = FloatPack::splat(max);
+
+		for (i32 ofsx = -1; ofsx <= 1; ofsx++) {
+
+			IntPack hx = hash(wrapCell(ipx + ofsx, 0));
+
+			for (i32 ofsy = -1; ofsy <= 1; ofsy++) {
+
+				IntPack hxy = rehash(hx, wrapCell(ipy + ofsy, 1));
+
+				for (i32 ofsz = -1; ofsz <= 1; ofsz++) {
+
+					IntPack g = rehash(hxy, wrapCell(ipz + ofsz, 2)) & grad3DMask;
+
+					FloatPack dx = px - (gradientComponent<3, 0>(g) * 0.5 + (0.5 + ofsx));
+					FloatPack dy = py - (gradientComponent<3, 1>(g) * 0.5 + (0.5 + ofsy));
+					FloatPack dz = pz - (gradientComponent<3, 2>(g) * 0.5 + (0.5 + ofsz));
+
+					FloatPack dist = (dx * dx + dy * dy + dz * dz).sqrt();
+
+					updateDistances(first, second, dist);
+				}
+			}
+		}
+
+		FloatPack sample = applyFlag(first, second) / max * 2 - 1;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+	FloatPack raw(const FloatPack& x, const FloatPack& y, const FloatPack& z, const FloatPack& w) const {
+
+		constexpr float max = 2; // sqrt(4)
+
+		FloatPack fx = x.floor();
+		FloatPack fy = y.floor();
+		FloatPack fz = z.floor();
+		FloatPack fw = w.floor();
+
+		IntPack ipx = fx.toInt();
+		IntPack ipy = fy.toInt();
+		IntPack ipz = fz.toInt();
+		IntPack ipw = fw.toInt();
+
+		FloatPack px = x - fx;
+		FloatPack py = y - fy;
+		FloatPack pz = z - fz;
+		FloatPack pw = w - fw;
+
+		FloatPack first = FloatPack::splat(max);
+		FloatPack second = FloatPack::splat(max);
+
+		for (i32 ofsx = -1; ofsx <= 1; ofsx++) {
+
+			IntPack hx = hash(wrapCell(ipx + ofsx, 0));
+
+			for (i32 ofsy = -1; ofsy <= 1; ofsy++) {
+
+				IntPack hxy = rehash(hx, wrapCell(ipy + ofsy, 1));
+
+				for (i32 ofsz = -1; ofsz <= 1; ofsz++) {
+
+					IntPack hxyz = rehash(hxy, wrapCell(ipz + ofsz, 2));
+
+					for (i32 ofsw = -1; ofsw <= 1; ofsw++) {
+
+						// Like the scalar path, 4D cells only pick from the first 16 gradients
+						IntPack g = rehash(hxyz, wrapCell(ipw + ofsw, 3)) & grad3DMask;
+
+						FloatPack dx = px - (gradientComponent<4, 0, 16>(g) * 0.5 + (0.5 + ofsx));
+						FloatPack dy = py - (gradientComponent<4, 1, 16>(g) * 0.5 + (0.5 + ofsy));
+						FloatPack dz = pz - (gradientComponent<4, 2, 16>(g) * 0.5 + (0.5 + ofsz));
+						FloatPack dw = pw - (gradientComponent<4, 3, 16>(g) * 0.5 + (0.5 + ofsw));
+
+						FloatPack dist = (dx * dx + dy * dy + dz * dz + dw * dw).sqrt();
+
+						updateDistances(first, second, dist);
+					}
+				}
+			}
+		}
+
+		FloatPack sample = applyFlag(first, second) / max * 2 - 1;
+
+		return applyFractal<Fractal>(sample);
+
+	}
+
+
+	template<CC::FloatParam T, CC::Arithmetic A, CC::Float F = TT::CommonArithmeticType<T>>
+	constexpr void raw(std::span<const T> points, std::span<const A> frequencies, std::span<F> samples) const {
+		batchSample(points, frequencies, samples, [this](const T& p, A f) constexpr { return raw(p, f); }, [this](const auto&... c) { return raw(c...); });
+	}
+
+
+	// Negative cells mirror the positive ones unless the lattice is periodic, in which case they wrap around
+	template<CC::Integer I>
+	constexpr u32 wrapCell(I cell, u32 axis) const {
+		return (periodic ? cell : Math::abs(cell)) & periodMask[axis];
+	}
+
+	IntPack wrapCell(const IntPack& cell, u32 axis) const {
+		return (periodic ? cell : cell.abs()) & periodMask[axis];
 	}
 
 
@@ -261,6 +434,24 @@ private:
 		}
 	}
 
+	static void updateDistances(FloatPack& first, FloatPack& second, const FloatPack& dist) {
+		if constexpr (Flag == FlagT::None) {
+
+			first = first.min(dist);
+
+		} else {
+
+			second = second.min(dist);
+
+			// Math::less(dist, first)
+			FloatPack less = first - dist > dist.abs().max(first.abs()) * Math::epsilon;
+
+			second = FloatPack::select(less, first, second);
+			first = FloatPack::select(less, dist, first);
+
+		}
+	}
+
 	template<CC::Float F>
 	static constexpr F applyFlag(F first, F second) {
 		if constexpr (Flag == FlagT::Second) {
@@ -272,6 +463,16 @@ private:
 		}
 	}
 
+	static FloatPack applyFlag(const FloatPack& first, const FloatPack& second) {
+		if constexpr (Flag == FlagT::Second) {
+			return second;
+		} else if constexpr (Flag == FlagT::Diff) {
+			return second - first;
+		} else {
+			return first;
+		}
+	}
+
 };
 
 
@@ -81,6 +81,12 @@ Vec3f Camera::getDirection() const {
 
 
 
+Mat4f Camera::getViewMatrix() const {
+	return Mat4f::lookAt(position, position + direction);
+}
+
+
+
 void Camera::clampPitch() {
 	pitch = Math::clamp(pitch, Math::toRadians(-89.99), Math::toRadians(89.99));
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "math/matrix.hpp"
 #include "math/vector.hpp"
 
 
@@ -32,6 +33,8 @@ public:
 		return getPosition() + getDirection();
 	}
 
+	Mat4f getViewMatrix() const;
+
 private:
 
 	void clampPitch();
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "xmlc.hpp"
+#include "charscan.hpp"
 
 
 namespace Xml
@@ -68,6 +69,8 @@ namespace Xml
 			for (u32 i = 0; i < 256; i++) {
 				table[i] = 0;
 			}
+
+			classify();
 #endif
 		}
 
@@ -89,6 +92,7 @@ namespace Xml
 				characters[i] = chars[i];
 			}
 #endif
+			classify();
 		}
 
 #ifdef XML_TEMPLATE_CHAR_TYPE
@@ -105,6 +109,14 @@ namespace Xml
 			return apply(c);
 		}
 
+		// Skips accepted characters in whole blocks, the remaining tail is left to the caller
+#ifdef XML_TEMPLATE_CHAR_TYPE
+		template<CC::Char CharType>
+#endif
+		const CharType* scan(const CharType* p, const CharType* end) const {
+			return CharScan::skip(p, end, charClass, Invert);
+		}
+
 		constexpr auto operator!() const {
 #ifdef XML_CHAR_FILTER_LUT
 			CharFilter<!Invert> filter;
@@ -113,6 +125,8 @@ namespace Xml
 				filter.table[i] = table[i];
 			}
 
+			filter.charClass = charClass;
+
 			return std::move(filter);
 #else
 			return CharFilter<Count, !Invert>(characters);
@@ -148,6 +162,8 @@ namespace Xml
 			}
 #endif
 
+			filter.classify();
+
 			return std::move(filter);
 
 		}
@@ -175,12 +191,29 @@ namespace Xml
 			filter.characters[Count] = c;
 #endif
 
+			filter.classify();
+
 			return std::move(filter);
 
 		}
 
 	private:
 
+		// Rebuilds the vectorizable form of the character set
+		constexpr void classify() {
+#ifdef XML_CHAR_FILTER_LUT
+			charClass = CharScan::CharClass(table);
+#else
+			u8 table[256] = {};
+
+			for (u32 i = 0; i < Count; i++) {
+				table[u8(characters[i])] = 1;
+			}
+
+			charClass = CharScan::CharClass(table);
+#endif
+		}
+
 #ifdef XML_CHAR_FILTER_LUT
 #ifdef XML_TEMPLATE_CHAR_TYPE
 		template<CC::Char CharType>
@@ -206,6 +239,8 @@ namespace Xml
 		CharType characters[Count];
 #endif
 
+		CharScan::CharClass charClass;
+
 	};
 
 #ifdef XML_CHAR_FILTER_LUT
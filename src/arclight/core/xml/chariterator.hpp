@@ -9,6 +9,7 @@
 #pragma once
 
 #include "xmlc.hpp"
+#include "charfilter.hpp"
 
 
 namespace Xml
@@ -95,6 +96,10 @@ namespace Xml
 
 		constexpr bool skip(CharType c, bool invert = false) {
 
+			// Vector scans only pay off past the first character
+			if (!std::is_constant_evaluated() && !invert && cur < end && *cur != c)
+				cur = CharScan::find(cur, end, c);
+
 			while (valid() && (*cur != c) ^ invert)
 				cur++;
 
@@ -104,6 +109,9 @@ namespace Xml
 
 		constexpr bool skip(const FilterType auto& filter) {
 
+			if (!std::is_constant_evaluated() && cur < end && filter(*cur))
+				cur = filter.scan(cur, end);
+
 			while (valid() && filter(*cur))
 				cur++;
 
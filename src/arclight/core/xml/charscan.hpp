@@ -0,0 +1,200 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 charscan.hpp
+ */
+
+#pragma once
+
+#include "xmlc.hpp"
+#include "arcintrinsic.hpp"
+#include "util/bits.hpp"
+
+
+namespace Xml
+{
+
+	// Block scanners for single byte character types
+	// Scans only cover whole blocks and return either the first character stopping the scan or the start of the remaining tail,
+	// which the caller finishes scalar. NUL always stops a scan since character iterators treat it as the end of input.
+	namespace CharScan
+	{
+
+		// Vectorizable form of a character set, built at compile time for constant filters
+		// Membership of byte (h << 4 | l) is low[l] & high[h] != 0, every distinct row of low nibbles owns one bit of the tables.
+		// Sets with more than eight distinct rows are not classified, sets with more than 16 characters don't fit string instructions.
+		struct CharClass
+		{
+
+			constexpr CharClass() : low{}, high{}, chars{}, count(0), classified(true) {}
+
+			constexpr explicit CharClass(const u8(&table)[256]) : CharClass() {
+
+				u16 rows[8] = {};
+				u32 rowCount = 0;
+
+				for (u32 h = 0; h < 16; h++) {
+
+					u16 row = 0;
+
+					for (u32 l = 0; l < 16; l++) {
+
+						if (!table[h * 16 + l])
+							continue;
+
+						row |= 1 << l;
+
+						if (count < 16)
+							chars[count] = h * 16 + l;
+
+						count++;
+
+					}
+
+					if (!row || !classified)
+						continue;
+
+					u32 bit = 0;
+
+					while (bit < rowCount && rows[bit] != row)
+						bit++;
+
+					if (bit == 8) {
+						classified = false;
+						continue;
+					}
+
+					if (bit == rowCount)
+						rows[rowCount++] = row;
+
+					high[h] = 1 << bit;
+
+					for (u32 l = 0; l < 16; l++) {
+						if (row & (1 << l))
+							low[l] |= 1 << bit;
+					}
+
+				}
+
+			}
+
+			u8 low[16];
+			u8 high[16];
+			u8 chars[16];
+			u32 count;
+			bool classified;
+
+		};
+
+
+		// Skips characters unequal to c
+		template<CC::Char CharType>
+		inline const CharType* find(const CharType* p, const CharType* end, CharType c) {
+
+			if constexpr (sizeof(CharType) == 1) {
+
+#ifdef ARC_VECTORIZE_X86_AVX2
+				const __m256i needle = _mm256_set1_epi8(char(c));
+				const __m256i zero = _mm256_setzero_si256();
+
+				for (; end - p >= 32; p += 32) {
+
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+					u32 mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, needle), _mm256_cmpeq_epi8(v, zero)));
+
+					if (mask) {
+						return p + Bits::ctz(mask);
+					}
+
+				}
+#endif
+
+#ifdef ARC_VECTORIZE_X86_SSE2
+				const __m128i needle128 = _mm_set1_epi8(char(c));
+				const __m128i zero128 = _mm_setzero_si128();
+
+				for (; end - p >= 16; p += 16) {
+
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					u32 mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, needle128), _mm_cmpeq_epi8(v, zero128)));
+
+					if (mask) {
+						return p + Bits::ctz(mask);
+					}
+
+				}
+#endif
+
+			}
+
+			return p;
+
+		}
+
+		// Skips members of the class, or non-members if inverted
+		template<CC::Char CharType>
+		inline const CharType* skip(const CharType* p, const CharType* end, const CharClass& cls, bool invert) {
+
+			if constexpr (sizeof(CharType) == 1) {
+
+#ifdef ARC_VECTORIZE_X86_AVX2
+				if (cls.classified) {
+
+					const __m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.low)));
+					const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.high)));
+					const __m256i nibble = _mm256_set1_epi8(0x0F);
+					const __m256i zero = _mm256_setzero_si256();
+					const u32 flip = invert ? ~0u : 0;
+
+					for (; end - p >= 32; p += 32) {
+
+						__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+						__m256i l = _mm256_shuffle_epi8(low, _mm256_and_si256(v, nibble));
+						__m256i h = _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+
+						u32 outside = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(l, h), zero));
+						u32 mask = (outside ^ flip) | u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+
+						if (mask) {
+							return p + Bits::ctz(mask);
+						}
+
+					}
+
+				}
+#endif
+
+#ifdef ARC_VECTORIZE_X86_SSE4_2
+				if (cls.count <= 16) {
+
+					const __m128i set = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.chars));
+					const __m128i zero = _mm_setzero_si128();
+					const u32 flip = invert ? 0 : 0xFFFF;
+					const i32 count = cls.count;
+
+					for (; end - p >= 16; p += 16) {
+
+						__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+						u32 inside = _mm_cvtsi128_si32(_mm_cmpestrm(set, count, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK));
+						u32 mask = (inside ^ flip) | u32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+
+						if (mask) {
+							return p + Bits::ctz(mask);
+						}
+
+					}
+
+				}
+#endif
+
+			}
+
+			return p;
+
+		}
+
+	}
+
+}
@@ -14,7 +14,10 @@
 #include "stringref.hpp"
 #include "attribute.hpp"
 #include "node.hpp"
+#include "entity.hpp"
+#include "memory/arenaallocator.hpp"
 
+#include <span>
 #include <sstream>
 
 
@@ -51,49 +54,55 @@ namespace Xml
 
 		Document() :
 #ifdef XML_NODE_STORAGE_UNIFIED
-			root(*this, UINT64_MAX, NodeType::Element)
+			root(*this, UINT64_MAX, NodeType::Element),
 #else
-			root(*this, {}, NodeType::Element)
+			root(*this, {}, NodeType::Element),
 #endif
+			decoded(false)
 		{}
 
+		// Parses sv in situ: names and values refer to sv, which must outlive the document, and entities are left encoded
+		// Use decodeEntities() on values to decode them on demand
 		XML_TEMPLATE_INLINE SizeT read(const StringView& sv) {
 
-			CharIteratorT it(sv);
-			auto beg = it;
+			decoded = false;
 
-			if (it.cmp({ CharType(0xEF), CharType(0xBB), CharType(0xBF) }))
-				it += 3;
+			return parse(sv);
 
-			while (it.valid()) {
+		}
 
-				if (!it.skip(FiltersT::Space))
-					break;
+		// Parses buffer in situ and decodes entities of values in place, buffer must outlive the document
+		XML_TEMPLATE_INLINE SizeT readInPlace(std::span<CharType> buffer) {
 
-				// New node
-				if (it.cmp('<')) {
+			decoded = true;
 
-					auto& node = root.create();
+			return parse(StringView(buffer.data(), buffer.size()));
 
-					// Skip opening bracket
-					++it;
+		}
 
-#ifdef XML_NODE_STORAGE_UNIFIED
-					readNode(it, node.index);
-#else
-					readNode(it, node);
-#endif
-				}
+		// Takes ownership of source and parses it in place
+		XML_TEMPLATE_INLINE SizeT read(String&& s) {
 
-			}
+			source = std::move(s);
 
-			if (it.overflow())
-				throw XmlParseError("Text data iterator overflown");
+			return readInPlace(source);
 
-			return &it - &beg;
+		}
+
+		// Removes all nodes and releases their storage
+		XML_TEMPLATE_INLINE void clear() {
+
+			root.clear();
+			arena.clear();
+			source.clear();
 
 		}
 
+		// Returns true if entities in values have been decoded by the last read
+		constexpr bool isDecoded() const {
+			return decoded;
+		}
+
 		XML_TEMPLATE_INLINE void write(std::basic_ostream<CharType>& os, int indentWidth = 4, CharType indentChar = ' ') const {
 
 			writeNodes(os, root.getFirstChild(), indentWidth, indentChar);
@@ -120,6 +129,66 @@ namespace Xml
 
 	private:
 
+		// Upper bound of the node and attribute storage needed for sv
+		// Every '<' not opening a closing tag may start a node and every '=' may follow an attribute name
+		XML_TEMPLATE_INLINE static SizeT estimateStorageSize(const StringView& sv) {
+
+			SizeT nodes = 0;
+			SizeT attributes = 0;
+
+			for (SizeT i = 0; i < sv.size(); i++) {
+
+				nodes += sv[i] == CharType('<') && (i + 1 == sv.size() || sv[i + 1] != CharType('/'));
+				attributes += sv[i] == CharType('=');
+
+			}
+
+			return nodes * sizeof(NodeT) + attributes * sizeof(AttributeT) + 64;
+
+		}
+
+		XML_TEMPLATE_INLINE SizeT parse(const StringView& sv) {
+
+			// Size the first arena block for the whole document
+			if (!arena.getReservedSize()) {
+				arena = ArenaAllocator(estimateStorageSize(sv));
+			}
+
+			CharIteratorT it(sv);
+			auto beg = it;
+
+			if (it.cmp({ CharType(0xEF), CharType(0xBB), CharType(0xBF) }))
+				it += 3;
+
+			while (it.valid()) {
+
+				if (!it.skip(FiltersT::Space))
+					break;
+
+				// New node
+				if (it.cmp('<')) {
+
+					auto& node = root.create();
+
+					// Skip opening bracket
+					++it;
+
+#ifdef XML_NODE_STORAGE_UNIFIED
+					readNode(it, node.index);
+#else
+					readNode(it, node);
+#endif
+				}
+
+			}
+
+			if (it.overflow())
+				throw XmlParseError("Text data iterator overflown");
+
+			return &it - &beg;
+
+		}
+
 		XML_TEMPLATE_INLINE void writeIndent(std::basic_ostream<CharType>& os, int indentLevel, int indentWidth = 4, CharType indentChar = ' ') const {
 
 			os << String(indentLevel * indentWidth, indentChar);
@@ -134,8 +203,31 @@ namespace Xml
 			for (auto attr = node->getFirstAttribute(); attr; attr = attr->getNext()) {
 
 				os << CharType(' ');
-				os << *attr;
 
+				if (!decoded || attr->value.empty()) {
+					os << *attr;
+					continue;
+				}
+
+				auto quoteCh = selectQuoteChar(attr->value);
+
+				os << attr->name;
+				os << CharType('=');
+				os << quoteCh;
+				writeEscaped(os, attr->value.toStringView(), quoteCh);
+				os << quoteCh;
+
+			}
+
+		}
+
+		// Writes a node value, escaped again if its entities have been decoded
+		XML_TEMPLATE_INLINE void writeValue(std::basic_ostream<CharType>& os, const StringRefT& value) const {
+
+			if (decoded) {
+				writeEscaped(os, value.toStringView());
+			} else {
+				os << value;
 			}
 
 		}
@@ -200,12 +292,12 @@ namespace Xml
 
 							writeIndent(os, indentLevel + 1, indentWidth, indentChar);
 
-							os << node->value;
+							writeValue(os, node->value);
 
 							os << CharType('\n');
 						}
 						else {
-							os << node->value;
+							writeValue(os, node->value);
 						}
 					}
 					else {
@@ -235,6 +327,17 @@ namespace Xml
 
 		}
 
+		// Decodes the entities of a value in place if the source is writable
+		XML_TEMPLATE_INLINE StringRefT decode(StringRefT s) {
+
+			if (decoded && !s.empty()) {
+				s.size(decodeEntities(const_cast<CharType*>(s.data()), s.size()));
+			}
+
+			return s;
+
+		}
+
 		XML_TEMPLATE_INLINE StringRefT readAttributeName(CharIteratorT& it) {
 
 			StringRefT s;
@@ -293,7 +396,7 @@ namespace Xml
 				throw XmlParseError("Text data interrupted");
 			}
 
-			return s;
+			return decode(s);
 
 		}
 
@@ -567,15 +670,9 @@ namespace Xml
 
 					node.value.begin(&it);
 
-					while (it.valid()) {
-
-						if (it.cmp('<')) {
-							node.value.end(&it);
-
-							break;
-						}
-
-						++it;
+					if (it.skip('<')) {
+						node.value.end(&it);
+						node.value = decode(node.value);
 					}
 				}
 			}
@@ -645,12 +742,12 @@ namespace Xml
 	private:
 
 #ifdef XML_TEMPLATE_CHAR_TYPE
-		template<CC::Char CharType>
+		template<CC::Char C>
 #endif
 		friend class Node;
 
 #ifdef XML_TEMPLATE_CHAR_TYPE
-		template<CC::Char CharType>
+		template<CC::Char C>
 #endif
 		friend class Attribute;
 
@@ -677,10 +774,56 @@ namespace Xml
 
 #endif
 
+		ArenaAllocator arena;
+		String source;
 		NodeT root;
+		bool decoded;
 
 	};
 
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType>
+	Node<CharType>& Node<CharType>::create() {
+#else
+	Node& Node::create() {
+#endif
+
+		auto node = new (owner.arena.template allocate<NodeT>(1)) NodeT(owner, *this, NodeType::Element);
+
+		if (lastChild) {
+			lastChild->next = node;
+			node->previous = lastChild;
+		} else {
+			firstChild = node;
+		}
+
+		lastChild = node;
+
+		return *node;
+
+	}
+
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType>
+	Attribute<CharType>& Node<CharType>::createAttribute() {
+#else
+	Attribute& Node::createAttribute() {
+#endif
+
+		auto attr = new (owner.arena.template allocate<AttributeT>(1)) AttributeT(*this);
+
+		if (lastAttribute) {
+			lastAttribute->next = attr;
+		} else {
+			firstAttribute = attr;
+		}
+
+		lastAttribute = attr;
+
+		return *attr;
+
+	}
+
 #ifdef XML_TEMPLATE_CHAR_TYPE
 	template<CC::Char CharType>
 	std::basic_ostream<CharType>& operator<<(std::basic_ostream<CharType>& os, const Document<CharType>& document) {
@@ -703,7 +846,8 @@ namespace Xml
 
 		std::basic_string<CharType> s(std::istreambuf_iterator<CharType>(is), {});
 
-		SizeT read = document.read(s);
+		// The document keeps the source since its nodes refer to it
+		SizeT read = document.read(std::move(s));
 
 		return is.seekg(read);
 	
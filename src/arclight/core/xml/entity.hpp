@@ -0,0 +1,175 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 entity.hpp
+ */
+
+#pragma once
+
+#include "xmlc.hpp"
+#include "stringref.hpp"
+#include "locale/unicode.hpp"
+
+#include <algorithm>
+#include <ostream>
+
+
+namespace Xml
+{
+
+	// Decodes predefined entities and character references in place and returns the decoded size
+	// The decoded form is never longer than the encoded one, so data is rewritten front to back
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType>
+#endif
+	XML_TEMPLATE_INLINE SizeT decodeEntities(CharType* data, SizeT size) {
+
+		CharType* end = data + size;
+		CharType* in = const_cast<CharType*>(std::char_traits<CharType>::find(data, size, CharType('&')));
+
+		if (!in) {
+			return size;
+		}
+
+		CharType* out = in;
+
+		while (in != end) {
+
+			if (*in != CharType('&')) {
+				*out++ = *in++;
+				continue;
+			}
+
+			CharType* semicolon = std::find(in + 1, end, CharType(';'));
+
+			if (semicolon == end) {
+				throw XmlParseError("Unterminated entity reference");
+			}
+
+			CharType* name = in + 1;
+			SizeT length = semicolon - name;
+
+			auto is = [&](const char* entity) {
+				return std::char_traits<char>::length(entity) == length && std::equal(name, semicolon, entity);
+			};
+
+			if (is("lt")) {
+				*out++ = CharType('<');
+			} else if (is("gt")) {
+				*out++ = CharType('>');
+			} else if (is("amp")) {
+				*out++ = CharType('&');
+			} else if (is("apos")) {
+				*out++ = CharType('\'');
+			} else if (is("quot")) {
+				*out++ = CharType('"');
+			} else if (length > 1 && *name == CharType('#')) {
+
+				bool hex = name[1] == CharType('x');
+				u32 base = hex ? 16 : 10;
+				Unicode::Codepoint codepoint = 0;
+
+				if (hex && length == 2) {
+					throw XmlParseError("Invalid character reference");
+				}
+
+				for (CharType* p = name + 1 + hex; p != semicolon; p++) {
+
+					u32 c = *p;
+					u32 digit;
+
+					if (c >= '0' && c <= '9') {
+						digit = c - '0';
+					} else if (hex && (c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+						digit = (c | 0x20) - 'a' + 10;
+					} else {
+						throw XmlParseError("Invalid character reference");
+					}
+
+					codepoint = codepoint * base + digit;
+
+					if (codepoint > 0x10FFFF) {
+						throw XmlParseError("Character reference out of range");
+					}
+
+				}
+
+				if (!codepoint || (codepoint >= 0xD800 && codepoint < 0xE000)) {
+					throw XmlParseError("Character reference out of range");
+				}
+
+				out += Unicode::encode<Unicode::TypeEncoding<CharType>>(codepoint, out);
+
+			} else {
+				throw XmlParseError("Unknown entity reference");
+			}
+
+			in = semicolon + 1;
+
+		}
+
+		return out - data;
+
+	}
+
+	// Returns a decoded copy of the string
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType>
+	XML_TEMPLATE_INLINE std::basic_string<CharType> decodeEntities(const StringRef<CharType>& string) {
+#else
+	XML_TEMPLATE_INLINE std::basic_string<CharType> decodeEntities(const StringRef& string) {
+#endif
+
+		std::basic_string<CharType> s = string.toString();
+		s.resize(decodeEntities(s.data(), s.size()));
+
+		return s;
+
+	}
+
+	// Writes the string with markup characters and the given quote character replaced by entities
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType>
+#endif
+	XML_TEMPLATE_INLINE void writeEscaped(std::basic_ostream<CharType>& os, const std::basic_string_view<CharType>& sv, CharType quoteCh = CharType(0)) {
+
+		const CharType* beg = sv.data();
+		const CharType* end = beg + sv.size();
+
+		for (const CharType* it = beg; it != end; ++it) {
+
+			const char* entity;
+
+			switch (*it) {
+
+			case CharType('<'):	entity = "&lt;";	break;
+			case CharType('>'):	entity = "&gt;";	break;
+			case CharType('&'):	entity = "&amp;";	break;
+
+			default:
+
+				if (!quoteCh || *it != quoteCh)
+					continue;
+
+				entity = quoteCh == CharType('"') ? "&quot;" : "&apos;";
+				break;
+
+			}
+
+			os.write(beg, it - beg);
+
+			for (; *entity; entity++) {
+				os << CharType(*entity);
+			}
+
+			beg = it + 1;
+
+		}
+
+		os.write(beg, end - beg);
+
+	}
+
+}
@@ -0,0 +1,719 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 reader.hpp
+ */
+
+#pragma once
+
+#include "xmlc.hpp"
+#include "charfilter.hpp"
+#include "chariterator.hpp"
+#include "stringref.hpp"
+#include "entity.hpp"
+
+#include <cstring>
+#include <istream>
+
+
+namespace Xml
+{
+
+	enum class ReaderEvent
+	{
+		StartElement,	// <name
+		Attribute,		// name="value"
+		Text,			// Character data and CDATA sections
+		EndElement,		// </name> or />
+		EndOfInput
+	};
+
+
+	// Supplies a Reader with input in chunks of arbitrary size
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType = char>
+#endif
+	class InputSource
+	{
+	public:
+
+		virtual ~InputSource() = default;
+
+		// Fills at most size characters of data and returns their count, zero at the end of input
+		virtual SizeT read(CharType* data, SizeT size) = 0;
+
+	};
+
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType = char>
+	class StringInputSource : public InputSource<CharType>
+#else
+	class StringInputSource : public InputSource
+#endif
+	{
+	private:
+
+		using StringView	= std::basic_string_view<CharType>;
+
+	public:
+
+		constexpr explicit StringInputSource(const StringView& sv) :
+			string(sv),
+			position(0)
+		{}
+
+		XML_TEMPLATE_INLINE SizeT read(CharType* data, SizeT size) override {
+
+			SizeT count = std::min(size, string.size() - position);
+
+			std::memcpy(data, string.data() + position, count * sizeof(CharType));
+			position += count;
+
+			return count;
+
+		}
+
+	private:
+
+		StringView string;
+		SizeT position;
+
+	};
+
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType = char>
+	class StreamInputSource : public InputSource<CharType>
+#else
+	class StreamInputSource : public InputSource
+#endif
+	{
+	public:
+
+		explicit StreamInputSource(std::basic_istream<CharType>& stream) :
+			stream(stream)
+		{}
+
+		XML_TEMPLATE_INLINE SizeT read(CharType* data, SizeT size) override {
+
+			stream.read(data, size);
+
+			return stream.gcount();
+
+		}
+
+	private:
+
+		std::basic_istream<CharType>& stream;
+
+	};
+
+
+	// Pull parser over chunked input
+	// Tokens follow the rules of Document::read and are kept whole in an internal buffer that grows for tokens larger than itself.
+	// Names and values returned stay valid until the next call to next(), values have their entities decoded in place.
+	// Comments, processing instructions and DTD declarations are skipped.
+#ifdef XML_TEMPLATE_CHAR_TYPE
+	template<CC::Char CharType = char>
+#endif
+	class Reader
+	{
+	private:
+
+		using String		= std::basic_string<CharType>;
+		using StringView	= std::basic_string_view<CharType>;
+
+#ifdef XML_TEMPLATE_CHAR_TYPE
+		using FiltersT		= Filters<CharType>;
+		using StringRefT	= StringRef<CharType>;
+		using CharIteratorT = CharIterator<CharType>;
+		using InputSourceT	= InputSource<CharType>;
+#else
+		using FiltersT		= Filters;
+		using StringRefT	= StringRef;
+		using CharIteratorT = CharIterator;
+		using InputSourceT	= InputSource;
+#endif
+
+		enum class Result
+		{
+			Event,
+			Skipped,
+			Underflow
+		};
+
+	public:
+
+		static constexpr SizeT DefaultBufferSize = 64 * 1024;
+		static constexpr SizeT MaxTokenSize = 256 * 1024 * 1024;
+
+		explicit Reader(InputSourceT& source, SizeT bufferSize = DefaultBufferSize) :
+			source(source),
+			buffer(std::max(bufferSize, SizeT(16)), CharType(0)),
+			begin(0),
+			end(0),
+			offset(0),
+			eof(false),
+			event(ReaderEvent::EndOfInput),
+			nextAttribute(0),
+			pendingEnd(false),
+			skipping(false)
+		{}
+
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		// Advances to the next event
+		XML_TEMPLATE_INLINE ReaderEvent next() {
+
+			if (nextAttribute < attributes.size()) {
+
+				auto& attr = attributes[nextAttribute++];
+
+				name = attr.first;
+				value = attr.second;
+
+				return event = ReaderEvent::Attribute;
+
+			}
+
+			if (pendingEnd) {
+
+				pendingEnd = false;
+				name = element;
+				value.clear();
+
+				popName();
+
+				return event = ReaderEvent::EndElement;
+
+			}
+
+			if (event == ReaderEvent::EndOfInput && eof && begin == end) {
+				return event;
+			}
+
+			while (true) {
+
+				switch (parseToken()) {
+
+				case Result::Event:
+					return event;
+
+				case Result::Skipped:
+					break;
+
+				case Result::Underflow:
+
+					if (!refill()) {
+
+						// Only whitespace may follow the root element
+						if (nameOffsets.empty() && !containsText(StringView(buffer.data() + begin, end - begin))) {
+
+							offset += end - begin;
+							begin = end;
+							name.clear();
+							value.clear();
+
+							return event = ReaderEvent::EndOfInput;
+
+						}
+
+						throw XmlParseError("Unexpected end of data");
+
+					}
+
+					break;
+
+				}
+
+			}
+
+		}
+
+		// Skips the rest of the element whose StartElement or Attribute event was returned last, including its EndElement
+		XML_TEMPLATE_INLINE void skip() {
+
+			if (event != ReaderEvent::StartElement && event != ReaderEvent::Attribute) {
+				throw XmlParseError("No element to skip");
+			}
+
+			nextAttribute = attributes.size();
+
+			SizeT depth = nameOffsets.size() - 1;
+
+			skipping = true;
+
+			while (next() != ReaderEvent::EndElement || nameOffsets.size() > depth);
+
+			skipping = false;
+
+		}
+
+		constexpr ReaderEvent getEvent() const {
+			return event;
+		}
+
+		// Returns the element or attribute name
+		constexpr const StringRefT& getName() const {
+			return name;
+		}
+
+		// Returns the attribute value or text
+		constexpr const StringRefT& getValue() const {
+			return value;
+		}
+
+		// Returns the number of open elements
+		constexpr SizeT getDepth() const {
+			return nameOffsets.size();
+		}
+
+		// Returns the number of characters consumed
+		constexpr u64 getOffset() const {
+			return offset;
+		}
+
+	private:
+
+		// Parses the token at the start of the buffered data
+		XML_TEMPLATE_INLINE Result parseToken() {
+
+			const CharType* data = buffer.data() + begin;
+			CharIteratorT it(StringView(data, end - begin));
+
+			if (!it.valid()) {
+				return Result::Underflow;
+			}
+
+			// Skip a byte order mark
+			if (!offset) {
+
+				if constexpr (sizeof(CharType) == 1) {
+
+					if (it.remaining() < 3 && !eof) {
+						return Result::Underflow;
+					}
+
+					if (startsWith(it, { CharType(0xEF), CharType(0xBB), CharType(0xBF) })) {
+
+						consume(&it + 3);
+						return Result::Skipped;
+
+					}
+
+				} else if (it.cmp(CharType(0xFEFF))) {
+
+					consume(&it + 1);
+					return Result::Skipped;
+
+				}
+
+			}
+
+			if (!it.cmp('<')) {
+				return parseText(it);
+			}
+
+			if (it.remaining() < 2) {
+				return Result::Underflow;
+			}
+
+			if (it.cmp('/', 1)) {
+				return parseEndElement(it += 2);
+			}
+
+			if (it.cmp('?', 1)) {
+				return skipPast(it += 2, { '?', '>' });
+			}
+
+			if (it.cmp('!', 1)) {
+
+				++it;
+
+				// Wait until the token can be told apart
+				if (it.remaining() < 9 && !eof) {
+					return Result::Underflow;
+				}
+
+				if (startsWith(it, { '!', '-', '-' })) {
+					return skipPast(it += 3, { '-', '-', '>' });
+				}
+
+				if (startsWith(it, { '!', '[', 'C', 'D', 'A', 'T', 'A', '[' })) {
+					return parseCData(it += 8);
+				}
+
+				return skipPast(it, { '>' });
+
+			}
+
+			return parseStartElement(++it);
+
+		}
+
+		XML_TEMPLATE_INLINE Result parseText(CharIteratorT& it) {
+
+			const CharType* textBegin = &it;
+
+			if (!it.skip('<')) {
+				return Result::Underflow;
+			}
+
+			StringView text(textBegin, &it - textBegin);
+
+			consume(&it);
+
+			// Whitespace between elements is not reported
+			if (!containsText(text)) {
+				return Result::Skipped;
+			}
+
+			if (nameOffsets.empty()) {
+				throw XmlParseError("Unexpected text outside of the root element");
+			}
+
+			value = decode(text);
+			name.clear();
+
+			event = ReaderEvent::Text;
+
+			return Result::Event;
+
+		}
+
+		XML_TEMPLATE_INLINE Result parseCData(CharIteratorT& it) {
+
+			const CharType* textBegin = &it;
+
+			while (true) {
+
+				if (!it.skip(']')) {
+					return Result::Underflow;
+				}
+
+				if (it.remaining() < 3) {
+					return Result::Underflow;
+				}
+
+				if (it.cmp(']', 1) && it.cmp('>', 2)) {
+					break;
+				}
+
+				++it;
+
+			}
+
+			if (nameOffsets.empty()) {
+				throw XmlParseError("Unexpected CDATA section outside of the root element");
+			}
+
+			value = StringView(textBegin, &it - textBegin);
+			name.clear();
+
+			consume(&it + 3);
+
+			event = ReaderEvent::Text;
+
+			return Result::Event;
+
+		}
+
+		XML_TEMPLATE_INLINE Result parseStartElement(CharIteratorT& it) {
+
+			attributes.clear();
+			nextAttribute = 0;
+
+			if (it.cmp(FiltersT::Space)) {
+				throw XmlParseError("Expected element name");
+			}
+
+			StringRefT elementName;
+
+			elementName.begin(&it);
+
+			if (!it.skip(FiltersT::Name)) {
+				return Result::Underflow;
+			}
+
+			elementName.end(&it);
+
+			if (elementName.empty()) {
+				throw XmlParseError("Expected element name");
+			}
+
+			bool selfClosing = false;
+
+			while (true) {
+
+				if (!it.skip(FiltersT::Space)) {
+					return Result::Underflow;
+				}
+
+				if (it.cmp('>')) {
+					break;
+				}
+
+				if (it.cmp('/')) {
+
+					if (it.remaining() < 2) {
+						return Result::Underflow;
+					}
+
+					if (!it.cmp('>', 1)) {
+						throw XmlParseError("Unexpected self-closing token in element");
+					}
+
+					selfClosing = true;
+					++it;
+
+					break;
+
+				}
+
+				StringRefT attrName;
+
+				attrName.begin(&it);
+
+				if (!it.skip(FiltersT::AttributeName)) {
+					return Result::Underflow;
+				}
+
+				attrName.end(&it);
+
+				if (attrName.empty()) {
+					throw XmlParseError("Expected attribute name");
+				}
+
+				if (!it.skip(FiltersT::Space)) {
+					return Result::Underflow;
+				}
+
+				if (!it.cmp('=')) {
+					throw XmlParseError("Expected '=' character in attribute definition");
+				}
+
+				if (!(++it).skip(FiltersT::Space)) {
+					return Result::Underflow;
+				}
+
+				if (!it.cmp(FiltersT::Quote)) {
+					throw XmlParseError("Expected a single quote or double quote character");
+				}
+
+				CharType quoteCh = *it++;
+				StringRefT attrValue;
+
+				attrValue.begin(&it);
+
+				if (!it.skip(quoteCh)) {
+					return Result::Underflow;
+				}
+
+				attrValue.end(&it++);
+
+				attributes.emplace_back(attrName, attrValue);
+
+			}
+
+			// The tag is complete, nothing after this point may underflow
+			consume(&it + 1);
+
+			for (auto& attr : attributes) {
+				attr.second = decode(attr.second.toStringView());
+			}
+
+			pushName(elementName.toStringView());
+
+			name = elementName;
+			value.clear();
+			element = elementName;
+			pendingEnd = selfClosing;
+
+			event = ReaderEvent::StartElement;
+
+			return Result::Event;
+
+		}
+
+		XML_TEMPLATE_INLINE Result parseEndElement(CharIteratorT& it) {
+
+			StringRefT elementName;
+
+			elementName.begin(&it);
+
+			if (!it.skip(FiltersT::Name)) {
+				return Result::Underflow;
+			}
+
+			elementName.end(&it);
+
+			if (!it.skip(FiltersT::Space)) {
+				return Result::Underflow;
+			}
+
+			if (!it.cmp('>')) {
+				throw XmlParseError("Expected closing bracket");
+			}
+
+			if (nameOffsets.empty() || StringView(names).substr(nameOffsets.back()) != elementName.toStringView()) {
+				throw XmlParseError("Invalid closing element name");
+			}
+
+			consume(&it + 1);
+			popName();
+
+			name = elementName;
+			value.clear();
+
+			event = ReaderEvent::EndElement;
+
+			return Result::Event;
+
+		}
+
+		// Skips up to and including the closing sequence
+		XML_TEMPLATE_INLINE Result skipPast(CharIteratorT& it, const std::initializer_list<CharType>& closingSequence) {
+
+			CharType first = *closingSequence.begin();
+			SizeT length = closingSequence.size();
+
+			while (true) {
+
+				if (!it.skip(first)) {
+					return Result::Underflow;
+				}
+
+				if (it.remaining() < length) {
+					return Result::Underflow;
+				}
+
+				if (startsWith(it, closingSequence)) {
+					break;
+				}
+
+				++it;
+
+			}
+
+			consume(&it + length);
+
+			return Result::Skipped;
+
+		}
+
+
+		// Unlike CharIterator::cmp, matches a sequence ending exactly at the end of the data
+		XML_TEMPLATE_INLINE static bool startsWith(const CharIteratorT& it, const std::initializer_list<CharType>& sequence) {
+
+			if (it.remaining() < sequence.size()) {
+				return false;
+			}
+
+			return std::equal(sequence.begin(), sequence.end(), &it);
+
+		}
+
+		XML_TEMPLATE_INLINE static bool containsText(const StringView& sv) {
+
+			CharIteratorT it(sv);
+
+			return it.skip(FiltersT::Space);
+
+		}
+
+		XML_TEMPLATE_INLINE StringRefT decode(const StringView& sv) {
+
+			StringRefT s(sv);
+
+			if (!skipping && !s.empty()) {
+				s.size(decodeEntities(const_cast<CharType*>(s.data()), s.size()));
+			}
+
+			return s;
+
+		}
+
+		XML_TEMPLATE_INLINE void consume(const CharType* p) {
+
+			SizeT position = p - buffer.data();
+
+			offset += position - begin;
+			begin = position;
+
+		}
+
+		XML_TEMPLATE_INLINE void pushName(const StringView& sv) {
+
+			nameOffsets.push_back(names.size());
+			names.append(sv);
+
+		}
+
+		XML_TEMPLATE_INLINE void popName() {
+
+			names.resize(nameOffsets.back());
+			nameOffsets.pop_back();
+
+		}
+
+		// Moves the unconsumed data to the front and reads more, growing the buffer if the data fills it
+		XML_TEMPLATE_INLINE bool refill() {
+
+			if (eof) {
+				return false;
+			}
+
+			if (begin) {
+
+				std::memmove(buffer.data(), buffer.data() + begin, (end - begin) * sizeof(CharType));
+				end -= begin;
+				begin = 0;
+
+			}
+
+			if (end == buffer.size()) {
+
+				if (buffer.size() >= MaxTokenSize) {
+					throw XmlParseError("Token exceeds the maximum size");
+				}
+
+				buffer.resize(std::min(buffer.size() * 2, MaxTokenSize));
+
+			}
+
+			SizeT count = source.read(buffer.data() + end, buffer.size() - end);
+
+			end += count;
+			eof = !count;
+
+			return count;
+
+		}
+
+
+		InputSourceT& source;
+
+		String buffer;
+		SizeT begin;
+		SizeT end;
+		u64 offset;
+		bool eof;
+
+		ReaderEvent event;
+		StringRefT name;
+		StringRefT value;
+		StringRefT element;
+
+		std::vector<std::pair<StringRefT, StringRefT>> attributes;
+		SizeT nextAttribute;
+		bool pendingEnd;
+		bool skipping;
+
+		String names;
+		std::vector<SizeT> nameOffsets;
+
+	};
+
+}
@@ -12,3 +12,5 @@
 #include "attribute.hpp"
 #include "node.hpp"
 #include "document.hpp"
+#include "entity.hpp"
+#include "reader.hpp"
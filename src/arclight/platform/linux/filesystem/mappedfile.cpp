@@ -0,0 +1,59 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mappedfile.cpp
+ */
+
+#include "filesystem/mappedfile.hpp"
+#include "util/log.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+
+const u8* MappedFile::mapFile(const Path& path, SizeT size, AccessHint hint) {
+
+	int fd = ::open(path.toString().c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd == -1) {
+		return nullptr;
+	}
+
+	void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps its own reference to the file
+	::close(fd);
+
+	if (address == MAP_FAILED) {
+		return nullptr;
+	}
+
+	if (hint == AccessHint::Sequential) {
+
+		// Decoders walk the file front to back, so read ahead aggressively and start faulting pages in now
+		madvise(address, size, MADV_SEQUENTIAL);
+		madvise(address, size, MADV_WILLNEED);
+
+	} else {
+
+		madvise(address, size, MADV_RANDOM);
+
+	}
+
+	return static_cast<const u8*>(address);
+
+}
+
+
+
+void MappedFile::unmapFile(const u8* address, SizeT size) {
+
+	if (munmap(const_cast<u8*>(address), size) == -1) {
+		LogE("MappedFile") << "Failed to unmap file";
+	}
+
+}
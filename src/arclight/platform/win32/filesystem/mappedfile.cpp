@@ -0,0 +1,64 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 mappedfile.cpp
+ */
+
+#include "filesystem/mappedfile.hpp"
+#include "util/log.hpp"
+
+#include <Windows.h>
+
+
+
+const u8* MappedFile::mapFile(const Path& path, SizeT size, AccessHint hint) {
+
+	DWORD flags = hint == AccessHint::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE file = CreateFileW(path.getHandle().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!mapping) {
+
+		CloseHandle(file);
+		return nullptr;
+
+	}
+
+	void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+
+	// The view keeps both the mapping and the file alive
+	CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (!address) {
+		return nullptr;
+	}
+
+	if (hint == AccessHint::Sequential) {
+
+		// Equivalent of MADV_WILLNEED: start faulting the whole view in asynchronously
+		WIN32_MEMORY_RANGE_ENTRY range = { address, size };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+	}
+
+	return static_cast<const u8*>(address);
+
+}
+
+
+
+void MappedFile::unmapFile(const u8* address, [[maybe_unused]] SizeT size) {
+
+	if (!UnmapViewOfFile(address)) {
+		LogE("MappedFile") << "Failed to unmap file";
+	}
+
+}
@@ -0,0 +1,51 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 benchmark.cpp
+ */
+
+#include "benchmark.hpp"
+
+
+
+double BenchmarkResult::getMegabytesPerSecond() const {
+	return bestTime > 0 ? bytes / bestTime / 1E6 : 0;
+}
+
+
+
+double BenchmarkResult::getMegapixelsPerSecond() const {
+	return bestTime > 0 ? pixels / bestTime / 1E6 : 0;
+}
+
+
+
+const char* BenchmarkResult::getStatusName(Status status) {
+
+	switch (status) {
+		case Status::Ok:			return "ok";
+		case Status::Unsupported:	return "unsupported";
+		case Status::Error:			return "error";
+		default:					return "unknown";
+	}
+
+}
+
+
+
+void Benchmark::finish(BenchmarkResult& result, std::vector<double>& times) const {
+
+	result.iterations = times.size();
+
+	if (times.empty()) {
+		return;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	result.bestTime = times.front();
+	result.medianTime = times[times.size() / 2];
+
+}
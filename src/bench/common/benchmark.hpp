@@ -0,0 +1,134 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 benchmark.hpp
+ */
+
+#pragma once
+
+#include "time/timer.hpp"
+#include "common/exception.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+
+
+
+struct BenchmarkResult {
+
+	enum class Status {
+		Ok,
+		Unsupported,
+		Error
+	};
+
+	std::string name;
+	std::string category;
+	Status status = Status::Ok;
+	std::string message;
+
+	u64 bytes = 0;			// Bytes consumed (decoders) or produced (encoders) per iteration
+	u64 pixels = 0;
+	u32 iterations = 0;
+	double bestTime = 0;	// Seconds per iteration
+	double medianTime = 0;
+
+	std::string checksum;
+
+	double getMegabytesPerSecond() const;
+	double getMegapixelsPerSecond() const;
+
+	static const char* getStatusName(Status status);
+
+};
+
+
+
+/*
+ *  Repeats a workload until both the minimum iteration count and the minimum measurement time have been reached
+ *  Throughput is reported from the fastest iteration, which is the least disturbed by scheduling noise.
+ */
+class Benchmark {
+
+public:
+
+	struct Options {
+
+		u32 warmupIterations = 2;
+		u32 minIterations = 5;
+		u32 maxIterations = 10000;
+		double minTime = 0.25;		// Seconds
+
+	};
+
+	explicit Benchmark(const Options& options) : options(options) {}
+
+	template<class F>
+	BenchmarkResult run(const std::string& name, const std::string& category, u64 bytes, u64 pixels, F&& workload) const;
+
+private:
+
+	void finish(BenchmarkResult& result, std::vector<double>& times) const;
+
+	Options options;
+
+};
+
+
+
+template<class F>
+BenchmarkResult Benchmark::run(const std::string& name, const std::string& category, u64 bytes, u64 pixels, F&& workload) const {
+
+	BenchmarkResult result;
+	result.name = name;
+	result.category = category;
+	result.bytes = bytes;
+	result.pixels = pixels;
+
+	std::vector<double> times;
+
+	try {
+
+		for (u32 i = 0; i < options.warmupIterations; i++) {
+			workload();
+		}
+
+		Timer timer;
+		double total = 0;
+
+		while (times.size() < options.maxIterations && (times.size() < options.minIterations || total < options.minTime)) {
+
+			timer.start();
+			workload();
+
+			double time = timer.getElapsedTime(Time::Unit::Nanoseconds) / 1E9;
+
+			times.push_back(time);
+			total += time;
+
+		}
+
+	} catch (const UnsupportedOperationException& e) {
+
+		result.status = BenchmarkResult::Status::Unsupported;
+		result.message = e.what();
+		return result;
+
+	} catch (const std::exception& e) {
+
+		result.status = BenchmarkResult::Status::Error;
+		result.message = e.what();
+		return result;
+
+	}
+
+	finish(result, times);
+
+	return result;
+
+}
@@ -0,0 +1,706 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 corpus.cpp
+ */
+
+#include "corpus.hpp"
+#include "jpegwriter.hpp"
+#include "image/imageio.hpp"
+#include "image/encode/ppmencoder.hpp"
+#include "filesystem/directory.hpp"
+#include "random/xorshift.hpp"
+#include "math/math.hpp"
+
+
+
+namespace {
+
+	void write8(std::vector<u8>& out, u32 value) {
+		out.push_back(value);
+	}
+
+	void write16(std::vector<u8>& out, u32 value) {
+
+		write8(out, value);
+		write8(out, value >> 8);
+
+	}
+
+	void write32(std::vector<u8>& out, u32 value) {
+
+		write16(out, value);
+		write16(out, value >> 16);
+
+	}
+
+	void write32BE(std::vector<u8>& out, u32 value) {
+
+		write8(out, value >> 24);
+		write8(out, value >> 16);
+		write8(out, value >> 8);
+		write8(out, value);
+
+	}
+
+	void pad(std::vector<u8>& out, SizeT alignment) {
+		out.resize((out.size() + alignment - 1) / alignment * alignment);
+	}
+
+
+	// 3-3-2 quantization, produces long index runs on gradients and flat shapes
+	u8 quantize332(const PixelRGBA8& p) {
+		return (p.getRed() & 0xE0) | (p.getGreen() & 0xE0) >> 3 | p.getBlue() >> 6;
+	}
+
+	u32 getColor332(u32 index) {
+
+		u32 r = (index >> 5) * 255 / 7;
+		u32 g = (index >> 2 & 0x7) * 255 / 7;
+		u32 b = (index & 0x3) * 255 / 3;
+
+		return r << 16 | g << 8 | b;
+
+	}
+
+	u8 getLuminance(const PixelRGBA8& p) {
+		return (p.getRed() * 77 + p.getGreen() * 150 + p.getBlue() * 29) >> 8;
+	}
+
+
+
+	enum class BitmapLayout {
+		BGR24,
+		BGRA32,
+		Masked32,
+		Indexed8,
+		Indexed4,
+		RLE8
+	};
+
+	std::vector<u8> encodeRLE8Row(std::span<const u8> row) {
+
+		std::vector<u8> out;
+		SizeT x = 0;
+
+		while (x < row.size()) {
+
+			SizeT run = 1;
+
+			while (x + run < row.size() && run < 255 && row[x + run] == row[x]) {
+				run++;
+			}
+
+			if (run >= 2) {
+
+				write8(out, run);
+				write8(out, row[x]);
+				x += run;
+				continue;
+
+			}
+
+			// Gather literals until the next run starts, absolute mode needs at least 3 of them
+			SizeT literals = 1;
+
+			while (x + literals < row.size() && literals < 255 && !(x + literals + 1 < row.size() && row[x + literals] == row[x + literals + 1])) {
+				literals++;
+			}
+
+			if (literals < 3) {
+
+				for (SizeT i = 0; i < literals; i++) {
+
+					write8(out, 1);
+					write8(out, row[x + i]);
+
+				}
+
+			} else {
+
+				write8(out, 0);
+				write8(out, literals);
+				out.insert(out.end(), row.begin() + x, row.begin() + x + literals);
+				pad(out, 2);
+
+			}
+
+			x += literals;
+
+		}
+
+		return out;
+
+	}
+
+	std::vector<u8> writeBitmap(const Image<Pixel::RGBA8>& image, BitmapLayout layout, bool topDown) {
+
+		u32 width = image.getWidth();
+		u32 height = image.getHeight();
+
+		u32 bpp = 24;
+		u32 compression = 0;
+		u32 paletteColors = 0;
+		bool v4 = false;
+
+		switch (layout) {
+			case BitmapLayout::BGR24:		bpp = 24; break;
+			case BitmapLayout::BGRA32:		bpp = 32; break;
+			case BitmapLayout::Masked32:	bpp = 32; compression = 3; v4 = true; break;
+			case BitmapLayout::Indexed8:	bpp = 8; paletteColors = 256; break;
+			case BitmapLayout::Indexed4:	bpp = 4; paletteColors = 16; break;
+			case BitmapLayout::RLE8:		bpp = 8; paletteColors = 256; compression = 1; break;
+		}
+
+		std::vector<u8> pixels;
+		u32 rowBytes = (width * bpp + 31) / 32 * 4;
+
+		for (u32 i = 0; i < height; i++) {
+
+			u32 y = topDown ? i : height - 1 - i;
+			auto row = image.view().row(y);
+			SizeT rowStart = pixels.size();
+
+			if (layout == BitmapLayout::RLE8) {
+
+				std::vector<u8> indices(width);
+				std::transform(row.begin(), row.end(), indices.begin(), quantize332);
+
+				auto encoded = encodeRLE8Row(indices);
+				pixels.insert(pixels.end(), encoded.begin(), encoded.end());
+
+				// End of line, or end of bitmap after the last row
+				write8(pixels, 0);
+				write8(pixels, i == height - 1);
+
+				continue;
+
+			}
+
+			for (u32 x = 0; x < width; x++) {
+
+				const PixelRGBA8& p = row[x];
+
+				switch (layout) {
+
+					case BitmapLayout::BGR24:
+						write8(pixels, p.getBlue());
+						write8(pixels, p.getGreen());
+						write8(pixels, p.getRed());
+						break;
+
+					case BitmapLayout::BGRA32:
+					case BitmapLayout::Masked32:
+						write8(pixels, p.getBlue());
+						write8(pixels, p.getGreen());
+						write8(pixels, p.getRed());
+						write8(pixels, p.getAlpha());
+						break;
+
+					case BitmapLayout::Indexed8:
+						write8(pixels, quantize332(p));
+						break;
+
+					case BitmapLayout::Indexed4:
+
+						if (x % 2) {
+							pixels.back() |= getLuminance(p) >> 4;
+						} else {
+							write8(pixels, getLuminance(p) & 0xF0);
+						}
+
+						break;
+
+					default:
+						break;
+
+				}
+
+			}
+
+			pixels.resize(rowStart + rowBytes);
+
+		}
+
+		u32 infoSize = v4 ? 108 : 40;
+		u32 dataOffset = 14 + infoSize + paletteColors * 4;
+
+		std::vector<u8> out;
+		out.reserve(dataOffset + pixels.size());
+
+		write8(out, 'B');
+		write8(out, 'M');
+		write32(out, dataOffset + pixels.size());
+		write32(out, 0);
+		write32(out, dataOffset);
+
+		write32(out, infoSize);
+		write32(out, width);
+		write32(out, topDown ? -i32(height) : i32(height));
+		write16(out, 1);
+		write16(out, bpp);
+		write32(out, compression);
+		write32(out, pixels.size());
+		write32(out, 2835);
+		write32(out, 2835);
+		write32(out, paletteColors);
+		write32(out, 0);
+
+		if (v4) {
+
+			write32(out, 0x00FF0000);
+			write32(out, 0x0000FF00);
+			write32(out, 0x000000FF);
+			write32(out, 0xFF000000);
+			write32(out, 0);				// Calibrated RGB
+
+			out.resize(out.size() + 12 * 4);	// Endpoints and gamma
+
+		}
+
+		for (u32 i = 0; i < paletteColors; i++) {
+			write32(out, bpp == 8 ? getColor332(i) : i * 17 * 0x010101);
+		}
+
+		out.insert(out.end(), pixels.begin(), pixels.end());
+
+		return out;
+
+	}
+
+
+
+	enum class TGALayout {
+		BGR24,
+		BGRA32,
+		BGR24RLE,
+		ColorMap8,
+		Grayscale8
+	};
+
+	std::vector<u8> writeTGA(const Image<Pixel::RGBA8>& image, TGALayout layout, bool topDown) {
+
+		u32 width = image.getWidth();
+		u32 height = image.getHeight();
+
+		u32 type = 2;
+		u32 depth = 24;
+		u32 alphaBits = 0;
+		bool colorMap = false;
+
+		switch (layout) {
+			case TGALayout::BGR24:			type = 2; depth = 24; break;
+			case TGALayout::BGRA32:			type = 2; depth = 32; alphaBits = 8; break;
+			case TGALayout::BGR24RLE:		type = 10; depth = 24; break;
+			case TGALayout::ColorMap8:		type = 1; depth = 8; colorMap = true; break;
+			case TGALayout::Grayscale8:		type = 3; depth = 8; break;
+		}
+
+		std::vector<u8> out;
+
+		write8(out, 0);
+		write8(out, colorMap);
+		write8(out, type);
+		write16(out, 0);
+		write16(out, colorMap ? 256 : 0);
+		write8(out, colorMap ? 24 : 0);
+		write16(out, 0);
+		write16(out, 0);
+		write16(out, width);
+		write16(out, height);
+		write8(out, depth);
+		write8(out, alphaBits | (topDown ? 0x20 : 0));
+
+		if (colorMap) {
+
+			for (u32 i = 0; i < 256; i++) {
+
+				u32 color = getColor332(i);
+
+				write8(out, color);
+				write8(out, color >> 8);
+				write8(out, color >> 16);
+
+			}
+
+		}
+
+		for (u32 i = 0; i < height; i++) {
+
+			auto row = image.view().row(topDown ? i : height - 1 - i);
+
+			if (layout == TGALayout::BGR24RLE) {
+
+				// Packets never cross scanlines
+				for (u32 x = 0; x < width;) {
+
+					auto same = [&](u32 a, u32 b) {
+						return row[a].getRed() == row[b].getRed() && row[a].getGreen() == row[b].getGreen() && row[a].getBlue() == row[b].getBlue();
+					};
+
+					u32 run = 1;
+
+					while (x + run < width && run < 128 && same(x, x + run)) {
+						run++;
+					}
+
+					u32 count = run;
+
+					if (run == 1) {
+
+						while (x + count < width && count < 128 && !(x + count + 1 < width && same(x + count, x + count + 1))) {
+							count++;
+						}
+
+					}
+
+					write8(out, (count - 1) | (run > 1 ? 0x80 : 0));
+
+					for (u32 j = 0; j < (run > 1 ? 1 : count); j++) {
+
+						write8(out, row[x + j].getBlue());
+						write8(out, row[x + j].getGreen());
+						write8(out, row[x + j].getRed());
+
+					}
+
+					x += count;
+
+				}
+
+				continue;
+
+			}
+
+			for (const PixelRGBA8& p : row) {
+
+				switch (layout) {
+
+					case TGALayout::BGR24:
+						write8(out, p.getBlue());
+						write8(out, p.getGreen());
+						write8(out, p.getRed());
+						break;
+
+					case TGALayout::BGRA32:
+						write8(out, p.getBlue());
+						write8(out, p.getGreen());
+						write8(out, p.getRed());
+						write8(out, p.getAlpha());
+						break;
+
+					case TGALayout::ColorMap8:
+						write8(out, quantize332(p));
+						break;
+
+					case TGALayout::Grayscale8:
+						write8(out, getLuminance(p));
+						break;
+
+					default:
+						break;
+
+				}
+
+			}
+
+		}
+
+		return out;
+
+	}
+
+
+
+	std::vector<u8> writeQOI(const Image<Pixel::RGBA8>& image, bool alpha) {
+
+		std::vector<u8> out;
+
+		write32BE(out, 0x716F6966);
+		write32BE(out, image.getWidth());
+		write32BE(out, image.getHeight());
+		write8(out, alpha ? 4 : 3);
+		write8(out, 0);
+
+		PixelRGBA8 index[64];
+		bool indexValid[64] = {};
+		PixelRGBA8 prev(0, 0, 0, 255);
+		u32 run = 0;
+
+		auto equal = [](const PixelRGBA8& a, const PixelRGBA8& b) {
+			return a.getRed() == b.getRed() && a.getGreen() == b.getGreen() && a.getBlue() == b.getBlue() && a.getAlpha() == b.getAlpha();
+		};
+
+		for (const PixelRGBA8& source : image.getImageBuffer()) {
+
+			PixelRGBA8 p = source;
+
+			if (!alpha) {
+				p.setAlpha(255);
+			}
+
+			if (equal(p, prev)) {
+
+				if (++run == 62) {
+
+					write8(out, 0xC0 | (run - 1));
+					run = 0;
+
+				}
+
+				continue;
+
+			}
+
+			if (run) {
+
+				write8(out, 0xC0 | (run - 1));
+				run = 0;
+
+			}
+
+			u32 hash = (p.getRed() * 3 + p.getGreen() * 5 + p.getBlue() * 7 + p.getAlpha() * 11) % 64;
+
+			// Only emit index hits for slots we filled, the all-zero initial entries are decoded inconsistently across implementations
+			if (indexValid[hash] && equal(index[hash], p)) {
+
+				write8(out, hash);
+
+			} else {
+
+				index[hash] = p;
+				indexValid[hash] = true;
+
+				if (p.getAlpha() == prev.getAlpha()) {
+
+					i32 dr = i8(p.getRed() - prev.getRed());
+					i32 dg = i8(p.getGreen() - prev.getGreen());
+					i32 db = i8(p.getBlue() - prev.getBlue());
+					i32 drg = dr - dg;
+					i32 dbg = db - dg;
+
+					if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+
+						write8(out, 0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+
+					} else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+
+						write8(out, 0x80 | (dg + 32));
+						write8(out, (drg + 8) << 4 | (dbg + 8));
+
+					} else {
+
+						write8(out, 0xFE);
+						write8(out, p.getRed());
+						write8(out, p.getGreen());
+						write8(out, p.getBlue());
+
+					}
+
+				} else {
+
+					write8(out, 0xFF);
+					write8(out, p.getRed());
+					write8(out, p.getGreen());
+					write8(out, p.getBlue());
+					write8(out, p.getAlpha());
+
+				}
+
+			}
+
+			prev = p;
+
+		}
+
+		if (run) {
+			write8(out, 0xC0 | (run - 1));
+		}
+
+		out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+		return out;
+
+	}
+
+}
+
+
+
+Image<Pixel::RGBA8> Corpus::generateImage(u32 width, u32 height, u32 seed) {
+
+	struct Circle {
+		i32 x, y;
+		i32 radius;
+		PixelRGBA8 color;
+	};
+
+	XorShift32 random(seed);
+	Image<Pixel::RGBA8> image(width, height);
+
+	std::vector<Circle> circles(8);
+
+	for (Circle& circle : circles) {
+
+		circle.x = random.next() % width;
+		circle.y = random.next() % height;
+		circle.radius = 4 + random.next() % (Math::max(width, height) / 6 + 1);
+		circle.color = PixelRGBA8(random.next(), random.next(), random.next(), 255);
+
+	}
+
+	for (u32 y = 0; y < height; y++) {
+
+		auto row = image.view().row(y);
+
+		for (u32 x = 0; x < width; x++) {
+
+			PixelRGBA8 p(x * 255 / width, y * 255 / height, (x + y) * 255 / (width + height), y < height / 2 ? 255 : x * 255 / width);
+
+			for (const Circle& circle : circles) {
+
+				i32 dx = i32(x) - circle.x;
+				i32 dy = i32(y) - circle.y;
+
+				if (dx * dx + dy * dy <= circle.radius * circle.radius) {
+					p.setRGB(circle.color.getRed(), circle.color.getGreen(), circle.color.getBlue());
+				}
+
+			}
+
+			// High-entropy patch in the lower right quadrant
+			if (x >= width * 3 / 4 && y >= height * 3 / 4) {
+
+				u32 noise = random.next();
+				p.setRGB(noise, noise >> 8, noise >> 16);
+
+			}
+
+			row[x] = p;
+
+		}
+
+	}
+
+	return image;
+
+}
+
+
+
+std::vector<CorpusEntry> Corpus::generate(u32 width, u32 height) {
+
+	width = Math::max((width + 15) / 16 * 16, 16u);
+	height = Math::max((height + 15) / 16 * 16, 16u);
+
+	Image<Pixel::RGBA8> image = generateImage(width, height);
+	Image<Pixel::RGB8> opaque = image.convert<Pixel::RGB8>();
+
+	std::vector<CorpusEntry> corpus;
+
+	auto add = [&](const std::string& name, CorpusFormat format, std::vector<u8>&& data) {
+		corpus.push_back({ name, format, width, height, std::move(data) });
+	};
+
+	add("bmp-bgr24", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::BGR24, false));
+	add("bmp-bgr24-topdown", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::BGR24, true));
+	add("bmp-bgra32", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::BGRA32, false));
+	add("bmp-masked32", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::Masked32, false));
+	add("bmp-indexed8", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::Indexed8, false));
+	add("bmp-indexed4", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::Indexed4, false));
+	add("bmp-rle8", CorpusFormat::Bitmap, writeBitmap(image, BitmapLayout::RLE8, false));
+
+	add("tga-bgr24", CorpusFormat::TGA, writeTGA(image, TGALayout::BGR24, false));
+	add("tga-bgr24-topleft", CorpusFormat::TGA, writeTGA(image, TGALayout::BGR24, true));
+	add("tga-bgra32", CorpusFormat::TGA, writeTGA(image, TGALayout::BGRA32, false));
+	add("tga-bgr24-rle", CorpusFormat::TGA, writeTGA(image, TGALayout::BGR24RLE, false));
+	add("tga-colormap8", CorpusFormat::TGA, writeTGA(image, TGALayout::ColorMap8, false));
+	add("tga-gray8", CorpusFormat::TGA, writeTGA(image, TGALayout::Grayscale8, false));
+
+	add("qoi-rgb", CorpusFormat::QOI, writeQOI(image, false));
+	add("qoi-rgba", CorpusFormat::QOI, writeQOI(image, true));
+
+	add("ppm-p6", CorpusFormat::PPM, std::vector<u8>(ImageIO::save<Pixel::RGB8, PPMEncoder>(opaque)));
+
+	struct JPEGVariant {
+		const char* name;
+		JPEGWriter::Options options;
+	};
+
+	using JPEG::Encoding;
+	using JPEG::FrameType;
+
+	const JPEGVariant jpegVariants[] = {
+		{ "jpeg-444",				{ FrameType::Sequential, Encoding::Huffman, false, 1, 1, 0 } },
+		{ "jpeg-422",				{ FrameType::Sequential, Encoding::Huffman, false, 2, 1, 0 } },
+		{ "jpeg-440",				{ FrameType::Sequential, Encoding::Huffman, false, 1, 2, 0 } },
+		{ "jpeg-420",				{ FrameType::Sequential, Encoding::Huffman, false, 2, 2, 0 } },
+		{ "jpeg-gray",			{ FrameType::Sequential, Encoding::Huffman, true, 1, 1, 0 } },
+		{ "jpeg-444-rst1",		{ FrameType::Sequential, Encoding::Huffman, false, 1, 1, 1 } },
+		{ "jpeg-420-rst8",		{ FrameType::Sequential, Encoding::Huffman, false, 2, 2, 8 } },
+		{ "jpeg-444-q100",		{ FrameType::Sequential, Encoding::Huffman, false, 1, 1, 0, 100 } },
+		{ "jpeg-arith-444",		{ FrameType::Sequential, Encoding::Arithmetic, false, 1, 1, 0 } },
+		{ "jpeg-arith-420",		{ FrameType::Sequential, Encoding::Arithmetic, false, 2, 2, 0 } },
+		{ "jpeg-arith-gray",		{ FrameType::Sequential, Encoding::Arithmetic, true, 1, 1, 0 } },
+		{ "jpeg-arith-rst8",		{ FrameType::Sequential, Encoding::Arithmetic, false, 1, 1, 8 } },
+		{ "jpeg-lossless-p1",		{ FrameType::Lossless, Encoding::Huffman, false, 1, 1, 0, 85, 1 } },
+		{ "jpeg-lossless-p4",		{ FrameType::Lossless, Encoding::Huffman, false, 1, 1, 0, 85, 4 } },
+		{ "jpeg-lossless-p7",		{ FrameType::Lossless, Encoding::Huffman, false, 1, 1, 0, 85, 7 } },
+		{ "jpeg-lossless-gray",	{ FrameType::Lossless, Encoding::Huffman, true, 1, 1, 0, 85, 1 } }
+	};
+
+	for (const JPEGVariant& variant : jpegVariants) {
+		add(variant.name, CorpusFormat::JPEG, JPEGWriter(variant.options).write(opaque));
+	}
+
+	return corpus;
+
+}
+
+
+
+void Corpus::save(const std::vector<CorpusEntry>& corpus, const Path& directory) {
+
+	Directory dir(directory);
+
+	if (!dir.exists() && !dir.create()) {
+		throw ImageException("Failed to create corpus directory " + directory.toString());
+	}
+
+	for (const CorpusEntry& entry : corpus) {
+		ImageIO::Detail::saveFile(directory / Path(entry.name + "." + getExtension(entry.format)), entry.data);
+	}
+
+}
+
+
+
+const char* Corpus::getExtension(CorpusFormat format) {
+
+	switch (format) {
+		case CorpusFormat::Bitmap:	return "bmp";
+		case CorpusFormat::TGA:		return "tga";
+		case CorpusFormat::QOI:		return "qoi";
+		case CorpusFormat::PPM:		return "ppm";
+		case CorpusFormat::JPEG:	return "jpg";
+		default:					return "bin";
+	}
+
+}
+
+
+
+const char* Corpus::getFormatName(CorpusFormat format) {
+
+	switch (format) {
+		case CorpusFormat::Bitmap:	return "BMP";
+		case CorpusFormat::TGA:		return "TGA";
+		case CorpusFormat::QOI:		return "QOI";
+		case CorpusFormat::PPM:		return "PPM";
+		case CorpusFormat::JPEG:	return "JPEG";
+		default:					return "Unknown";
+	}
+
+}
@@ -0,0 +1,59 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 corpus.hpp
+ */
+
+#pragma once
+
+#include "image/image.hpp"
+#include "filesystem/path.hpp"
+#include "types.hpp"
+
+#include <string>
+#include <vector>
+
+
+
+enum class CorpusFormat {
+	Bitmap,
+	TGA,
+	QOI,
+	PPM,
+	JPEG
+};
+
+
+struct CorpusEntry {
+
+	std::string name;
+	CorpusFormat format;
+	u32 width;
+	u32 height;
+	std::vector<u8> data;
+
+};
+
+
+
+/*
+ *  Synthetic conformance corpus
+ *  Every entry is generated in memory from a fixed seed, so runs on different machines decode byte-identical files.
+ *  Dimensions are rounded up to multiples of 16 to keep every JPEG subsampling mode free of partial MCUs.
+ */
+namespace Corpus {
+
+	// Gradients, hard-edged shapes, a noise patch and a varying alpha channel
+	Image<Pixel::RGBA8> generateImage(u32 width, u32 height, u32 seed = 1);
+
+	std::vector<CorpusEntry> generate(u32 width, u32 height);
+
+	// Writes every entry as <directory>/<name>.<extension>
+	void save(const std::vector<CorpusEntry>& corpus, const Path& directory);
+
+	const char* getExtension(CorpusFormat format);
+	const char* getFormatName(CorpusFormat format);
+
+}
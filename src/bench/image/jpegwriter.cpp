@@ -0,0 +1,1085 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 jpegwriter.cpp
+ */
+
+#include "jpegwriter.hpp"
+#include "math/math.hpp"
+#include "util/bits.hpp"
+#include "common/exception.hpp"
+
+#include <cmath>
+
+
+
+using namespace JPEG;
+
+
+
+// ITU T.81 Annex K reference tables
+constexpr u8 luminanceQuantization[64] = {
+	16, 11, 10, 16,  24,  40,  51,  61,
+	12, 12, 14, 19,  26,  58,  60,  55,
+	14, 13, 16, 24,  40,  57,  69,  56,
+	14, 17, 22, 29,  51,  87,  80,  62,
+	18, 22, 37, 56,  68, 109, 103,  77,
+	24, 35, 55, 64,  81, 104, 113,  92,
+	49, 64, 78, 87, 103, 121, 120, 101,
+	72, 92, 95, 98, 112, 100, 103,  99
+};
+
+constexpr u8 chrominanceQuantization[64] = {
+	17, 18, 24, 47, 99, 99, 99, 99,
+	18, 21, 26, 66, 99, 99, 99, 99,
+	24, 26, 56, 99, 99, 99, 99, 99,
+	47, 66, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99
+};
+
+constexpr u8 dcLuminanceBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+constexpr u8 dcChrominanceBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+constexpr u8 dcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+constexpr u8 acLuminanceBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+constexpr u8 acLuminanceValues[162] = {
+	0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+	0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+	0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+	0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+	0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+	0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+	0xF9, 0xFA
+};
+
+constexpr u8 acChrominanceBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+constexpr u8 acChrominanceValues[162] = {
+	0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+	0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+	0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+	0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+	0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+	0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+	0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+	0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+	0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+	0xF9, 0xFA
+};
+
+// Arithmetic conditioning written into DAC, see T.81 F.1.4.4
+constexpr u32 dcConditioningLower = 0;
+constexpr u32 dcConditioningUpper = 1;
+
+// DC differences up to dcSmallBound are zero/small, above dcLargeBound large, T.81 F.1.4.4.1.2
+// The small bound is 2^(L-1), or 0 for L = 0, so it is derived without shifting by L - 1
+constexpr i32 dcSmallBound = (1 << dcConditioningLower) >> 1;
+constexpr i32 dcLargeBound = 1 << dcConditioningUpper;
+constexpr u32 acConditioningKx = 5;
+
+// Fixed probability estimate used for AC signs
+constexpr u16 fixedLPSEstimate = 0x5A1D;
+
+
+
+static void buildHuffmanCodes(auto& codes, const u8* bits, const u8* values) {
+
+	u32 code = 0;
+	u32 k = 0;
+
+	codes.code.fill(0);
+	codes.length.fill(0);
+
+	for (u32 length = 1; length <= 16; length++) {
+
+		for (u32 i = 0; i < bits[length - 1]; i++) {
+
+			codes.code[values[k]] = code++;
+			codes.length[values[k]] = length;
+			k++;
+
+		}
+
+		code <<= 1;
+
+	}
+
+}
+
+static void writeHuffmanSegment(std::vector<u8>& buffer, u8 settings, const u8* bits, const u8* values) {
+
+	u32 count = 0;
+
+	for (u32 i = 0; i < 16; i++) {
+		count += bits[i];
+	}
+
+	u32 length = 2 + 1 + 16 + count;
+
+	buffer.insert(buffer.end(), { 0xFF, 0xC4, u8(length >> 8), u8(length), settings });
+	buffer.insert(buffer.end(), bits, bits + 16);
+	buffer.insert(buffer.end(), values, values + count);
+
+}
+
+static u32 getCategory(i32 value) {
+	return value ? 32 - Bits::clz(u32(Math::abs(value))) : 0;
+}
+
+
+
+JPEGWriter::JPEGWriter(const Options& options) : options(options), width(0), height(0), mcusX(0), mcusY(0), quantization{}, dcCodes{}, acCodes{},
+	bitData(0), bitCount(0), c(0), a(0), ct(0), stackedFF(0), stackedZero(0), pendingByte(-1) {
+
+	u32 quality = Math::clamp(options.quality, 1u, 100u);
+	u32 scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+	for (u32 k = 0; k < 64; k++) {
+
+		u32 natural = dezigzagTable[k];
+
+		quantization[0][k] = Math::clamp((luminanceQuantization[natural] * scale + 50) / 100, 1u, 255u);
+		quantization[1][k] = Math::clamp((chrominanceQuantization[natural] * scale + 50) / 100, 1u, 255u);
+
+	}
+
+	buildHuffmanCodes(dcCodes[0], dcLuminanceBits, dcValues);
+	buildHuffmanCodes(dcCodes[1], dcChrominanceBits, dcValues);
+	buildHuffmanCodes(acCodes[0], acLuminanceBits, acLuminanceValues);
+	buildHuffmanCodes(acCodes[1], acChrominanceBits, acChrominanceValues);
+
+}
+
+
+
+std::vector<u8> JPEGWriter::write(const Image<Pixel::RGB8>& image) {
+
+	bool lossless = options.type == FrameType::Lossless;
+
+	if (lossless && options.encoding == Encoding::Arithmetic) {
+		throw UnsupportedOperationException("Lossless arithmetic coding is not supported");
+	}
+
+	buffer.clear();
+	preparePlanes(image);
+
+	writeHeaders();
+
+	if (lossless) {
+		encodeLossless();
+	} else {
+		encodeSequential();
+	}
+
+	writeWord(Markers::EOI);
+
+	return std::move(buffer);
+
+}
+
+
+
+void JPEGWriter::preparePlanes(const Image<Pixel::RGB8>& image) {
+
+	width = image.getWidth();
+	height = image.getHeight();
+
+	bool lossless = options.type == FrameType::Lossless;
+	u32 maxSamplesX = options.grayscale || lossless ? 1 : options.lumaSamplesX;
+	u32 maxSamplesY = options.grayscale || lossless ? 1 : options.lumaSamplesY;
+	u32 blockSize = lossless ? 1 : 8;
+
+	mcusX = (width + maxSamplesX * blockSize - 1) / (maxSamplesX * blockSize);
+	mcusY = (height + maxSamplesY * blockSize - 1) / (maxSamplesY * blockSize);
+
+	components.clear();
+	components.push_back({ 1, maxSamplesX, maxSamplesY, 0 });
+
+	if (!options.grayscale) {
+
+		components.push_back({ 2, 1, 1, 1 });
+		components.push_back({ 3, 1, 1, 1 });
+
+	}
+
+	for (u32 i = 0; i < components.size(); i++) {
+
+		Component& component = components[i];
+
+		// Planes are padded to whole MCUs by replicating the image edges
+		component.width = mcusX * component.samplesX * blockSize;
+		component.height = mcusY * component.samplesY * blockSize;
+		component.samples.resize(component.width * component.height);
+
+		u32 boxX = maxSamplesX / component.samplesX;
+		u32 boxY = maxSamplesY / component.samplesY;
+
+		for (u32 y = 0; y < component.height; y++) {
+
+			for (u32 x = 0; x < component.width; x++) {
+
+				double sum = 0;
+
+				for (u32 by = 0; by < boxY; by++) {
+
+					for (u32 bx = 0; bx < boxX; bx++) {
+
+						const PixelRGB8& p = image.getPixel(Math::min(x * boxX + bx, width - 1), Math::min(y * boxY + by, height - 1));
+
+						double r = p.getRed();
+						double g = p.getGreen();
+						double b = p.getBlue();
+
+						switch (i) {
+							case 0:		sum += options.grayscale ? (r + g + b) / 3.0 : 0.299 * r + 0.587 * g + 0.114 * b; break;
+							case 1:		sum += -0.168736 * r - 0.331264 * g + 0.5 * b + 128; break;
+							default:	sum += 0.5 * r - 0.418688 * g - 0.081312 * b + 128; break;
+						}
+
+					}
+
+				}
+
+				component.samples[y * component.width + x] = Math::clamp(static_cast<i32>(std::lround(sum / (boxX * boxY))), 0, 255);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeHeaders() {
+
+	writeWord(Markers::SOI);
+
+	if (options.type != FrameType::Lossless) {
+		writeQuantizationTables();
+	}
+
+	if (options.encoding == Encoding::Huffman) {
+		writeHuffmanTables();
+	} else {
+		writeArithmeticConditioning();
+	}
+
+	if (options.restartInterval) {
+
+		writeWord(Markers::DRI);
+		writeWord(4);
+		writeWord(options.restartInterval);
+
+	}
+
+	writeFrameHeader();
+	writeScanHeader();
+
+}
+
+
+
+void JPEGWriter::writeQuantizationTables() {
+
+	u32 tables = options.grayscale ? 1 : 2;
+
+	writeWord(Markers::DQT);
+	writeWord(2 + tables * 65);
+
+	for (u32 i = 0; i < tables; i++) {
+
+		writeByte(i);
+
+		for (u32 k = 0; k < 64; k++) {
+			writeByte(quantization[i][k]);
+		}
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeHuffmanTables() {
+
+	writeHuffmanSegment(buffer, 0x00, dcLuminanceBits, dcValues);
+
+	if (options.type != FrameType::Lossless) {
+		writeHuffmanSegment(buffer, 0x10, acLuminanceBits, acLuminanceValues);
+	}
+
+	if (!options.grayscale) {
+
+		writeHuffmanSegment(buffer, 0x01, dcChrominanceBits, dcValues);
+
+		if (options.type != FrameType::Lossless) {
+			writeHuffmanSegment(buffer, 0x11, acChrominanceBits, acChrominanceValues);
+		}
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeArithmeticConditioning() {
+
+	u32 tables = options.grayscale ? 1 : 2;
+
+	writeWord(Markers::DAC);
+	writeWord(2 + tables * 4);
+
+	for (u32 i = 0; i < tables; i++) {
+
+		writeByte(0x00 | i);
+		writeByte(dcConditioningUpper << 4 | dcConditioningLower);
+		writeByte(0x10 | i);
+		writeByte(acConditioningKx);
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeFrameHeader() {
+
+	u16 marker = Markers::SOF0;
+
+	if (options.type == FrameType::Lossless) {
+		marker = Markers::SOF3;
+	} else if (options.encoding == Encoding::Arithmetic) {
+		marker = Markers::SOF9;
+	}
+
+	writeWord(marker);
+	writeWord(8 + components.size() * 3);
+	writeByte(8);
+	writeWord(height);
+	writeWord(width);
+	writeByte(components.size());
+
+	for (const Component& component : components) {
+
+		writeByte(component.id);
+		writeByte(component.samplesX << 4 | component.samplesY);
+		writeByte(options.type == FrameType::Lossless ? 0 : component.table);
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeScanHeader() {
+
+	bool lossless = options.type == FrameType::Lossless;
+
+	writeWord(Markers::SOS);
+	writeWord(6 + components.size() * 2);
+	writeByte(components.size());
+
+	for (const Component& component : components) {
+
+		writeByte(component.id);
+		writeByte(component.table << 4 | (lossless ? 0 : component.table));
+
+	}
+
+	writeByte(lossless ? options.predictor : 0);
+	writeByte(lossless ? 0 : 63);
+	writeByte(0);
+
+}
+
+
+
+void JPEGWriter::encodeSequential() {
+
+	u32 totalMCUs = mcusX * mcusY;
+	u32 restartIndex = 0;
+
+	resetEntropyCoder();
+
+	for (u32 mcu = 0; mcu < totalMCUs; mcu++) {
+
+		if (options.restartInterval && mcu && mcu % options.restartInterval == 0) {
+
+			finishEntropySegment();
+			writeWord(Markers::RST0 + (restartIndex++ & 7));
+			resetEntropyCoder();
+
+		}
+
+		u32 mcuX = mcu % mcusX;
+		u32 mcuY = mcu / mcusX;
+
+		for (Component& component : components) {
+
+			for (u32 sy = 0; sy < component.samplesY; sy++) {
+
+				for (u32 sx = 0; sx < component.samplesX; sx++) {
+					encodeBlock(component, mcuX * component.samplesX + sx, mcuY * component.samplesY + sy);
+				}
+
+			}
+
+		}
+
+	}
+
+	finishEntropySegment();
+
+}
+
+
+
+void JPEGWriter::encodeLossless() {
+
+	resetEntropyCoder();
+
+	auto sample = [](const Component& component, u32 x, u32 y) {
+		return component.samples[y * component.width + x];
+	};
+
+	for (u32 y = 0; y < height; y++) {
+
+		for (u32 x = 0; x < width; x++) {
+
+			for (Component& component : components) {
+
+				i32 ra = x ? sample(component, x - 1, y) : 0;
+				i32 rb = y ? sample(component, x, y - 1) : 0;
+				i32 rc = x && y ? sample(component, x - 1, y - 1) : 0;
+				i32 prediction = 0;
+
+				// The first row predicts from the left, the first column from above
+				u32 predictor = y == 0 ? (x == 0 ? 0 : 1) : (x == 0 ? 2 : options.predictor);
+
+				switch (predictor) {
+					case 0:		prediction = 1 << 7; break;
+					case 1:		prediction = ra; break;
+					case 2:		prediction = rb; break;
+					case 3:		prediction = rc; break;
+					case 4:		prediction = ra + rb - rc; break;
+					case 5:		prediction = ra + ((rb - rc) >> 1); break;
+					case 6:		prediction = rb + ((ra - rc) >> 1); break;
+					default:	prediction = (ra + rb) >> 1; break;
+				}
+
+				i32 difference = sample(component, x, y) - prediction;
+				u32 category = getCategory(difference);
+
+				writeValue(dcCodes[component.table], category, difference, category);
+
+			}
+
+		}
+
+	}
+
+	finishEntropySegment();
+
+}
+
+
+
+void JPEGWriter::encodeBlock(Component& component, u32 blockX, u32 blockY) {
+
+	// Scaled DCT-II basis, row u holds C(u) / 2 * cos((2x + 1)u * pi / 16)
+	static const auto basis = []() {
+
+		std::array<double, 64> b;
+
+		for (u32 u = 0; u < 8; u++) {
+
+			for (u32 x = 0; x < 8; x++) {
+				b[u * 8 + x] = (u ? 0.5 : 0.5 / std::sqrt(2.0)) * std::cos((2 * x + 1) * u * Math::pi / 16);
+			}
+
+		}
+
+		return b;
+
+	}();
+
+	double rows[64];
+	i32 block[64];
+
+	const i32* samples = component.samples.data() + blockY * 8 * component.width + blockX * 8;
+
+	for (u32 y = 0; y < 8; y++) {
+
+		for (u32 u = 0; u < 8; u++) {
+
+			double sum = 0;
+
+			for (u32 x = 0; x < 8; x++) {
+				sum += basis[u * 8 + x] * (samples[y * component.width + x] - 128);
+			}
+
+			rows[y * 8 + u] = sum;
+
+		}
+
+	}
+
+	const auto& table = quantization[component.table];
+
+	for (u32 k = 0; k < 64; k++) {
+
+		u32 natural = dezigzagTable[k];
+		u32 v = natural / 8;
+		u32 u = natural % 8;
+
+		double sum = 0;
+
+		for (u32 y = 0; y < 8; y++) {
+			sum += basis[v * 8 + y] * rows[y * 8 + u];
+		}
+
+		block[k] = static_cast<i32>(std::lround(sum / table[k]));
+
+	}
+
+	if (options.encoding == Encoding::Huffman) {
+		encodeHuffmanBlock(component, block);
+	} else {
+		encodeArithmeticBlock(component, block);
+	}
+
+}
+
+
+
+void JPEGWriter::encodeHuffmanBlock(Component& component, const i32* block) {
+
+	const HuffmanCodes& dc = dcCodes[component.table];
+	const HuffmanCodes& ac = acCodes[component.table];
+
+	i32 difference = block[0] - component.prediction;
+	component.prediction = block[0];
+
+	u32 category = getCategory(difference);
+	writeValue(dc, category, difference, category);
+
+	u32 zeroes = 0;
+
+	for (u32 k = 1; k < 64; k++) {
+
+		if (!block[k]) {
+
+			zeroes++;
+			continue;
+
+		}
+
+		while (zeroes >= 16) {
+
+			writeBits(ac.code[0xF0], ac.length[0xF0]);
+			zeroes -= 16;
+
+		}
+
+		category = getCategory(block[k]);
+		writeValue(ac, zeroes << 4 | category, block[k], category);
+
+		zeroes = 0;
+
+	}
+
+	if (zeroes) {
+		writeBits(ac.code[0x00], ac.length[0x00]);
+	}
+
+}
+
+
+
+void JPEGWriter::encodeArithmeticBlock(Component& component, const i32* block) {
+
+	auto& dc = dcBins[component.table];
+	auto& ac = acBins[component.table];
+
+	// DC, T.81 F.1.4.1
+	{
+		i32 absPrevDifference = Math::abs(component.prevDifference);
+		u32 baseBin = 0;
+
+		if (absPrevDifference > dcSmallBound) {
+
+			if (absPrevDifference > dcLargeBound) {
+				baseBin = component.prevDifference >= 0 ? 12 : 16;
+			} else {
+				baseBin = component.prevDifference >= 0 ? 4 : 8;
+			}
+
+		}
+
+		i32 difference = block[0] - component.prediction;
+		component.prediction = block[0];
+		component.prevDifference = difference;
+
+		if (!difference) {
+
+			encodeBin(dc[baseBin], false);
+
+		} else {
+
+			encodeBin(dc[baseBin], true);
+			encodeBin(dc[baseBin + 1], difference < 0);
+
+			u32 v = Math::abs(difference) - 1;
+			u32 bin = baseBin + (difference < 0 ? 3 : 2);
+			u32 m = 0;
+
+			if (v) {
+
+				encodeBin(dc[bin], true);
+
+				m = 1;
+				bin = 20;
+
+				for (u32 v2 = v >> 1; v2; v2 >>= 1) {
+
+					encodeBin(dc[bin], true);
+
+					m <<= 1;
+					bin++;
+
+				}
+
+			}
+
+			encodeBin(dc[bin], false);
+			bin += 14;
+
+			while (m >>= 1) {
+				encodeBin(dc[bin], v & m);
+			}
+
+		}
+	}
+
+	// AC, T.81 F.1.4.2
+	u32 end = 63;
+
+	while (end > 0 && !block[end]) {
+		end--;
+	}
+
+	u32 k = 1;
+
+	for (; k <= end; k++) {
+
+		u32 baseBin = 3 * (k - 1);
+
+		encodeBin(ac[baseBin], false);
+
+		while (!block[k]) {
+
+			encodeBin(ac[baseBin + 1], false);
+
+			baseBin += 3;
+			k++;
+
+		}
+
+		encodeBin(ac[baseBin + 1], true);
+		encodeFixed(fixedLPSEstimate, block[k] < 0);
+
+		u32 v = Math::abs(block[k]) - 1;
+		u32 bin = baseBin + 2;
+		u32 m = 0;
+
+		if (v) {
+
+			encodeBin(ac[bin], true);
+			m = 1;
+
+			if (u32 v2 = v >> 1) {
+
+				encodeBin(ac[bin], true);
+
+				m <<= 1;
+				bin = k <= acConditioningKx ? 189 : 217;
+
+				while (v2 >>= 1) {
+
+					encodeBin(ac[bin], true);
+
+					m <<= 1;
+					bin++;
+
+				}
+
+			}
+
+		}
+
+		encodeBin(ac[bin], false);
+		bin += 14;
+
+		while (m >>= 1) {
+			encodeBin(ac[bin], v & m);
+		}
+
+	}
+
+	if (k <= 63) {
+		encodeBin(ac[3 * (k - 1)], true);
+	}
+
+}
+
+
+
+void JPEGWriter::resetEntropyCoder() {
+
+	for (Component& component : components) {
+
+		component.prediction = 0;
+		component.prevDifference = 0;
+
+	}
+
+	bitData = 0;
+	bitCount = 0;
+
+	c = 0;
+	a = 0x10000;
+	ct = 11;
+	stackedFF = 0;
+	stackedZero = 0;
+	pendingByte = -1;
+
+	for (auto& bins : dcBins) {
+		bins.fill({});
+	}
+
+	for (auto& bins : acBins) {
+		bins.fill({});
+	}
+
+}
+
+
+
+void JPEGWriter::finishEntropySegment() {
+
+	if (options.encoding == Encoding::Huffman) {
+		flushBits();
+	} else {
+		finishArithmetic();
+	}
+
+}
+
+
+
+void JPEGWriter::writeByte(u8 byte) {
+	buffer.push_back(byte);
+}
+
+
+
+void JPEGWriter::writeWord(u16 word) {
+
+	buffer.push_back(word >> 8);
+	buffer.push_back(word & 0xFF);
+
+}
+
+
+
+void JPEGWriter::writeEntropyByte(u8 byte) {
+
+	buffer.push_back(byte);
+
+	// Byte stuffing
+	if (byte == 0xFF) {
+		buffer.push_back(0x00);
+	}
+
+}
+
+
+
+void JPEGWriter::writeBits(u32 bits, u32 count) {
+
+	bitData = (bitData << count) | Bits::mask(bits, 0, count);
+	bitCount += count;
+
+	while (bitCount >= 8) {
+
+		bitCount -= 8;
+		writeEntropyByte(bitData >> bitCount);
+
+	}
+
+}
+
+
+
+void JPEGWriter::writeValue(const HuffmanCodes& codes, u32 symbol, i32 value, u32 category) {
+
+	writeBits(codes.code[symbol], codes.length[symbol]);
+
+	// Negative values are sent as value - 1 in category bits
+	if (category) {
+		writeBits(value < 0 ? value - 1 : value, category);
+	}
+
+}
+
+
+
+void JPEGWriter::flushBits() {
+
+	// Pad with ones
+	if (bitCount) {
+		writeBits(0x7F, 8 - bitCount);
+	}
+
+	bitData = 0;
+	bitCount = 0;
+
+}
+
+
+
+void JPEGWriter::encodeBin(Bin& bin, bool value) {
+
+	const ArithmeticStateTransition& state = arithmeticTransitionTable[bin.index];
+	u32 qe = state.lpsEstimate;
+
+	a -= qe;
+
+	if (value != bin.mps) {
+
+		// LPS, exchanged with the MPS if its interval would be larger
+		if (a >= qe) {
+
+			c += a;
+			a = qe;
+
+		}
+
+		if (state.exchange) {
+			bin.mps = !bin.mps;
+		}
+
+		bin.index = state.nextLPS;
+
+	} else {
+
+		if (a >= 0x8000) {
+			return;
+		}
+
+		if (a < qe) {
+
+			c += a;
+			a = qe;
+
+		}
+
+		bin.index = state.nextMPS;
+
+	}
+
+	renormalize();
+
+}
+
+
+
+void JPEGWriter::encodeFixed(u16 lpsEstimate, bool value) {
+
+	u32 qe = lpsEstimate;
+
+	a -= qe;
+
+	if (value) {
+
+		if (a >= qe) {
+
+			c += a;
+			a = qe;
+
+		}
+
+	} else {
+
+		if (a >= 0x8000) {
+			return;
+		}
+
+		if (a < qe) {
+
+			c += a;
+			a = qe;
+
+		}
+
+	}
+
+	renormalize();
+
+}
+
+
+
+void JPEGWriter::renormalize() {
+
+	auto flushZeroes = [this]() {
+
+		for (; stackedZero; stackedZero--) {
+			writeByte(0x00);
+		}
+
+	};
+
+	do {
+
+		a <<= 1;
+		c <<= 1;
+
+		if (--ct == 0) {
+
+			u32 temp = c >> 19;
+
+			if (temp > 0xFF) {
+
+				// Carry propagates into the pending byte, stacked 0xFF bytes become zeroes
+				if (pendingByte >= 0) {
+
+					flushZeroes();
+					writeEntropyByte(pendingByte + 1);
+
+				}
+
+				stackedZero += stackedFF;
+				stackedFF = 0;
+				pendingByte = temp & 0xFF;
+
+			} else if (temp == 0xFF) {
+
+				stackedFF++;
+
+			} else {
+
+				if (pendingByte == 0) {
+
+					stackedZero++;
+
+				} else if (pendingByte > 0) {
+
+					flushZeroes();
+					writeEntropyByte(pendingByte);
+
+				}
+
+				if (stackedFF) {
+
+					flushZeroes();
+
+					for (; stackedFF; stackedFF--) {
+						writeEntropyByte(0xFF);
+					}
+
+				}
+
+				pendingByte = temp & 0xFF;
+
+			}
+
+			c &= 0x7FFFF;
+			ct += 8;
+
+		}
+
+	} while (a < 0x8000);
+
+}
+
+
+
+void JPEGWriter::finishArithmetic() {
+
+	auto flushZeroes = [this]() {
+
+		for (; stackedZero; stackedZero--) {
+			writeByte(0x00);
+		}
+
+	};
+
+	// Pick the value inside the final interval with the most trailing zero bits, T.81 D.1.8
+	u32 temp = (a - 1 + c) & 0xFFFF0000;
+	c = temp < c ? temp + 0x8000 : temp;
+	c <<= ct;
+
+	if (c & 0xF8000000) {
+
+		if (pendingByte >= 0) {
+
+			flushZeroes();
+			writeEntropyByte(pendingByte + 1);
+
+		}
+
+		stackedZero += stackedFF;
+		stackedFF = 0;
+
+	} else {
+
+		if (pendingByte == 0) {
+
+			stackedZero++;
+
+		} else if (pendingByte > 0) {
+
+			flushZeroes();
+			writeEntropyByte(pendingByte);
+
+		}
+
+		if (stackedFF) {
+
+			flushZeroes();
+
+			for (; stackedFF; stackedFF--) {
+				writeEntropyByte(0xFF);
+			}
+
+		}
+
+	}
+
+	// Trailing zero bytes are implied by the decoder
+	if (c & 0x7FFF800) {
+
+		flushZeroes();
+		writeEntropyByte((c >> 19) & 0xFF);
+
+		if (c & 0x7F800) {
+			writeEntropyByte((c >> 11) & 0xFF);
+		}
+
+	}
+
+	stackedZero = 0;
+
+}
@@ -0,0 +1,131 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 jpegwriter.hpp
+ */
+
+#pragma once
+
+#include "image/image.hpp"
+#include "image/decode/jpeg.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <vector>
+
+
+
+/*
+ *  Small JPEG writer used to synthesize the benchmark corpus
+ *  Covers the coding modes JPEGDecoder implements: sequential DCT with Huffman or arithmetic coding and lossless Huffman coding.
+ *  Favours simplicity over speed and compression ratio, images must be a multiple of the MCU size.
+ */
+class JPEGWriter {
+
+public:
+
+	struct Options {
+
+		JPEG::FrameType type = JPEG::FrameType::Sequential;
+		JPEG::Encoding encoding = JPEG::Encoding::Huffman;
+
+		bool grayscale = false;
+		u32 lumaSamplesX = 1;		// Chroma is sampled once per MCU
+		u32 lumaSamplesY = 1;
+		u32 restartInterval = 0;	// MCUs per restart interval, 0 disables restart markers
+		u32 quality = 85;
+		u32 predictor = 1;			// Lossless predictor 1 - 7
+
+	};
+
+	explicit JPEGWriter(const Options& options);
+
+	std::vector<u8> write(const Image<Pixel::RGB8>& image);
+
+private:
+
+	struct HuffmanCodes {
+
+		std::array<u16, 256> code;
+		std::array<u8, 256> length;
+
+	};
+
+	struct Component {
+
+		Component(u8 id, u32 samplesX, u32 samplesY, u32 table) :
+			id(id), samplesX(samplesX), samplesY(samplesY), table(table), width(0), height(0), prediction(0), prevDifference(0) {}
+
+		u8 id;
+		u32 samplesX;
+		u32 samplesY;
+		u32 table;
+
+		u32 width;
+		u32 height;
+		std::vector<i32> samples;
+
+		i32 prediction;
+		i32 prevDifference;
+
+	};
+
+	void preparePlanes(const Image<Pixel::RGB8>& image);
+
+	void writeHeaders();
+	void writeQuantizationTables();
+	void writeHuffmanTables();
+	void writeArithmeticConditioning();
+	void writeFrameHeader();
+	void writeScanHeader();
+
+	void encodeSequential();
+	void encodeLossless();
+	void encodeBlock(Component& component, u32 blockX, u32 blockY);
+	void encodeHuffmanBlock(Component& component, const i32* block);
+	void encodeArithmeticBlock(Component& component, const i32* block);
+
+	void resetEntropyCoder();
+	void finishEntropySegment();
+
+	void writeByte(u8 byte);
+	void writeWord(u16 word);
+	void writeEntropyByte(u8 byte);
+
+	void writeBits(u32 bits, u32 count);
+	void writeValue(const HuffmanCodes& codes, u32 symbol, i32 value, u32 category);
+	void flushBits();
+
+	void encodeBin(JPEG::Bin& bin, bool value);
+	void encodeFixed(u16 lpsEstimate, bool value);
+	void renormalize();
+	void finishArithmetic();
+
+	Options options;
+	std::vector<u8> buffer;
+	std::vector<Component> components;
+
+	u32 width, height;
+	u32 mcusX, mcusY;
+
+	std::array<std::array<u16, 64>, 2> quantization;	// Zigzag order
+	std::array<HuffmanCodes, 2> dcCodes;
+	std::array<HuffmanCodes, 2> acCodes;
+
+	// Huffman state
+	u32 bitData;
+	u32 bitCount;
+
+	// Arithmetic state (T.81 Annex D)
+	u32 c, a;
+	i32 ct;
+	u32 stackedFF;
+	u32 stackedZero;
+	i32 pendingByte;
+
+	std::array<std::array<JPEG::Bin, 49>, 2> dcBins;
+	std::array<std::array<JPEG::Bin, 245>, 2> acBins;
+
+};
@@ -0,0 +1,420 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 main.cpp
+ */
+
+#include "../common/benchmark.hpp"
+#include "corpus.hpp"
+#include "pixelwise.hpp"
+#include "image/imageio.hpp"
+#include "image/encode/ppmencoder.hpp"
+#include "image/filter/contrast.hpp"
+#include "image/filter/convolution.hpp"
+#include "image/filter/exponential.hpp"
+#include "image/filter/grayscale.hpp"
+#include "image/filter/invert.hpp"
+#include "image/filter/multiply.hpp"
+#include "image/filter/sepia.hpp"
+#include "crypto/hash/sha1.hpp"
+#include "json/json.hpp"
+#include "util/argumentparser.hpp"
+#include "util/log.hpp"
+
+#include <functional>
+#include <map>
+
+
+
+/*
+ *  bench_image
+ *  Measures every decoder on the synthetic corpus, the encoders, the filters and pixel conversions.
+ *  Uncompressed BMP and TGA files are additionally decoded pixel by pixel (decode-pixelwise/) as the baseline for row-wise decoding.
+ *  With --checksum, the output of every case is hashed so that optimizations can be checked for bit-exactness against a --reference run.
+ *  Arguments must be passed in layout order.
+ */
+constexpr const char* argumentLayout = "[--iterations uint] , [--time uint] , [--size uint] , [--filter string] , [--json string] , [--checksum] , [--reference string] , [--corpus string]";
+
+
+
+struct BenchmarkCase {
+
+	std::string name;
+	std::string category;
+	u64 bytes;
+	u64 pixels;
+	std::function<void()> workload;
+	std::function<std::span<const u8>()> output;
+
+};
+
+
+
+template<CC::ImageDecoder Decoder>
+static BenchmarkCase createDecoderCase(const CorpusEntry& entry, RawImage& sink) {
+
+	return {
+		"decode/" + entry.name,
+		"decoder",
+		entry.data.size(),
+		u64(entry.width) * entry.height,
+		[&entry, &sink]() {
+
+			Decoder decoder(std::nullopt);
+			decoder.decode(entry.data);
+			sink = std::move(decoder.getImage());
+
+		},
+		[&sink]() {
+			return sink.getRawBuffer();
+		}
+	};
+
+}
+
+
+static BenchmarkCase createPixelwiseDecoderCase(const CorpusEntry& entry, RawImage& sink) {
+
+	return {
+		"decode-pixelwise/" + entry.name,
+		"decoder",
+		entry.data.size(),
+		u64(entry.width) * entry.height,
+		[&entry, &sink]() {
+			sink = Pixelwise::decode(entry);
+		},
+		[&sink]() {
+			return sink.getRawBuffer();
+		}
+	};
+
+}
+
+
+template<class Filter, Pixel P, class... Args>
+static BenchmarkCase createFilterCase(const std::string& name, const Image<P>& source, Image<P>& sink, Args... args) {
+
+	u64 pixels = source.pixelCount();
+
+	return {
+		"filter/" + name,
+		"filter",
+		pixels * PixelFormat<P>::BytesPerPixel,
+		pixels,
+		[&source, &sink, args...]() {
+
+			// The source is restored every iteration so that repeated runs don't converge to a saturated image
+			source.view().copyTo(sink.view());
+			sink.template applyFilter<Filter>(args...);
+
+		},
+		[&sink]() {
+			return std::span<const u8>(Bits::toByteArray(sink.getImageBuffer().data()), sink.getImageBuffer().size_bytes());
+		}
+	};
+
+}
+
+
+template<Pixel P, Pixel Q>
+static BenchmarkCase createConversionCase(const std::string& name, const Image<P>& source, Image<Q>& sink) {
+
+	u64 pixels = source.pixelCount();
+
+	return {
+		"convert/" + name,
+		"conversion",
+		pixels * PixelFormat<P>::BytesPerPixel,
+		pixels,
+		[&source, &sink]() {
+			source.view().convertTo(sink.view());
+		},
+		[&sink]() {
+			return std::span<const u8>(Bits::toByteArray(sink.getImageBuffer().data()), sink.getImageBuffer().size_bytes());
+		}
+	};
+
+}
+
+
+template<Pixel P>
+static BenchmarkCase createResampleCase(const std::string& name, const Image<P>& source, Image<P>& sink, ImageScaling scaling) {
+
+	return {
+		"resample/" + name,
+		"conversion",
+		source.pixelCount() * PixelFormat<P>::BytesPerPixel,
+		sink.pixelCount(),
+		[&source, &sink, scaling]() {
+			source.view().resampleTo(sink.view(), scaling);
+		},
+		[&sink]() {
+			return std::span<const u8>(Bits::toByteArray(sink.getImageBuffer().data()), sink.getImageBuffer().size_bytes());
+		}
+	};
+
+}
+
+
+template<Pixel P>
+static BenchmarkCase createEncoderCase(const std::string& name, const Image<P>& source, std::vector<u8>& sink) {
+
+	u64 pixels = source.pixelCount();
+
+	return {
+		"encode/" + name,
+		"encoder",
+		pixels * PixelFormat<P>::BytesPerPixel,
+		pixels,
+		[&source, &sink]() {
+
+			PPMEncoder encoder(std::nullopt);
+			encoder.encode(source.view());
+			sink = encoder.getBuffer();
+
+		},
+		[&sink]() {
+			return std::span<const u8>(sink);
+		}
+	};
+
+}
+
+
+
+static bool loadReferenceChecksums(const Path& path, u32 width, u32 height, std::map<std::string, std::string>& checksums) {
+
+	JsonDocument document = JsonDocument::fromFile(path);
+	const JsonObject& root = document.getRoot().toObject();
+
+	// Checksums are only comparable for identically sized corpora
+	if (root["width"].toNumber<u32>() != width || root["height"].toNumber<u32>() != height) {
+
+		LogE("Bench") << "Reference was recorded at " << root["width"].toNumber<u32>() << "x" << root["height"].toNumber<u32>() << ", pass a matching --size";
+		return false;
+
+	}
+
+	for (const JsonValue& value : root["results"].toArray()) {
+
+		const JsonObject& result = value.toObject();
+
+		if (result.contains("checksum")) {
+			checksums[result["name"].toString()] = result["checksum"].toString();
+		}
+
+	}
+
+	return true;
+
+}
+
+
+static void writeResults(const Path& path, const std::vector<BenchmarkResult>& results, u32 width, u32 height) {
+
+	JsonArray array;
+
+	for (const BenchmarkResult& result : results) {
+
+		JsonObject object;
+
+		object.insert("name", JsonValue(result.name));
+		object.insert("category", JsonValue(result.category));
+		object.insert("status", JsonValue(BenchmarkResult::getStatusName(result.status)));
+
+		if (result.status == BenchmarkResult::Status::Ok) {
+
+			object.insert("bytes", JsonValue(result.bytes));
+			object.insert("pixels", JsonValue(result.pixels));
+			object.insert("iterations", JsonValue(result.iterations));
+			object.insert("best_ns", JsonValue(u64(result.bestTime * 1E9)));
+			object.insert("median_ns", JsonValue(u64(result.medianTime * 1E9)));
+			object.insert("mb_per_s", JsonValue(result.getMegabytesPerSecond()));
+			object.insert("mp_per_s", JsonValue(result.getMegapixelsPerSecond()));
+
+			if (!result.checksum.empty()) {
+				object.insert("checksum", JsonValue(result.checksum));
+			}
+
+		} else {
+
+			object.insert("message", JsonValue(result.message));
+
+		}
+
+		array.append(JsonValue(object));
+
+	}
+
+	JsonObject root;
+	root.insert("width", JsonValue(width));
+	root.insert("height", JsonValue(height));
+	root.insert("results", JsonValue(array));
+
+	std::string json = JsonDocument(root).write();
+	ImageIO::Detail::saveFile(path, std::span<const u8>(Bits::toByteArray(json.data()), json.size()));
+
+}
+
+
+
+u32 arcMain(const std::vector<std::string>& args) {
+
+	ArgumentParser parser;
+
+	try {
+
+		parser.parse(args, argumentLayout);
+
+	} catch (const std::exception& e) {
+
+		LogE("Bench") << e.what();
+		LogI("Bench") << "Usage: bench_image " << argumentLayout;
+		return 1;
+
+	}
+
+	Benchmark::Options options;
+	options.minIterations = parser.getUInt("--iterations", options.minIterations);
+	options.minTime = parser.getUInt("--time", options.minTime * 1000) / 1000.0;
+
+	u32 size = parser.getUInt("--size", 512);
+	std::string filter = parser.getString("--filter", "");
+	bool checksum = parser.getFlag("--checksum") || parser.contains("--reference");
+
+	std::vector<CorpusEntry> corpus = Corpus::generate(size, size);
+
+	if (parser.contains("--corpus")) {
+
+		Corpus::save(corpus, Path(parser.getString("--corpus")));
+		LogI("Bench") << "Saved " << corpus.size() << " corpus files to " << parser.getString("--corpus");
+
+	}
+
+	u32 width = corpus.front().width;
+	u32 height = corpus.front().height;
+
+	// Case inputs and outputs have to stay at fixed addresses, the case functions capture them by reference
+	Image<Pixel::RGBA8> sourceRGBA = Corpus::generateImage(width, height);
+	Image<Pixel::RGB8> sourceRGB = sourceRGBA.convert<Pixel::RGB8>();
+
+	std::vector<RawImage> decoded(corpus.size());
+	std::vector<RawImage> decodedPixelwise(corpus.size());
+	std::vector<u8> encodedRGB, encodedRGBA;
+	Image<Pixel::RGBA8> filtered(width, height);
+	Image<Pixel::RGB8> convertedRGB(width, height);
+	Image<Pixel::BGRA8> convertedBGRA(width, height);
+	Image<Pixel::RGBA8> upsampled(width * 2, height * 2);
+	Image<Pixel::RGBA8> downsampled(width / 2, height / 2);
+
+	std::vector<BenchmarkCase> cases;
+
+	for (SizeT i = 0; i < corpus.size(); i++) {
+
+		const CorpusEntry& entry = corpus[i];
+
+		switch (entry.format) {
+			case CorpusFormat::Bitmap:	cases.push_back(createDecoderCase<BitmapDecoder>(entry, decoded[i])); break;
+			case CorpusFormat::TGA:		cases.push_back(createDecoderCase<TGADecoder>(entry, decoded[i])); break;
+			case CorpusFormat::QOI:		cases.push_back(createDecoderCase<QOIDecoder>(entry, decoded[i])); break;
+			case CorpusFormat::PPM:		cases.push_back(createDecoderCase<PPMDecoder>(entry, decoded[i])); break;
+			case CorpusFormat::JPEG:	cases.push_back(createDecoderCase<JPEGDecoder>(entry, decoded[i])); break;
+		}
+
+		if (Pixelwise::supports(entry)) {
+			cases.push_back(createPixelwiseDecoderCase(entry, decodedPixelwise[i]));
+		}
+
+	}
+
+	cases.push_back(createEncoderCase("ppm-rgb8", sourceRGB, encodedRGB));
+	cases.push_back(createEncoderCase("ppm-rgba8", sourceRGBA, encodedRGBA));
+
+	Mat3<double> sharpen(0, -1, 0, -1, 5, -1, 0, -1, 0);
+
+	cases.push_back(createFilterCase<InversionFilter>("invert", sourceRGBA, filtered));
+	cases.push_back(createFilterCase<GrayscaleFilter>("grayscale", sourceRGBA, filtered));
+	cases.push_back(createFilterCase<SepiaFilter>("sepia", sourceRGBA, filtered));
+	cases.push_back(createFilterCase<ContrastFilter>("contrast", sourceRGBA, filtered, 1.5));
+	cases.push_back(createFilterCase<ExponentialFilter>("exponential", sourceRGBA, filtered, 2.2));
+	cases.push_back(createFilterCase<MultiplicationFilter>("multiply", sourceRGBA, filtered, u32(MultiplicationFilter::Red), 0.5));
+	cases.push_back(createFilterCase<ConvolutionFilter>("convolution", sourceRGBA, filtered, sharpen, u32(ConvolutionFilter::Red | ConvolutionFilter::Green | ConvolutionFilter::Blue), ConvolutionFilter::Clamp));
+
+	cases.push_back(createConversionCase("rgba8-rgb8", sourceRGBA, convertedRGB));
+	cases.push_back(createConversionCase("rgba8-bgra8", sourceRGBA, convertedBGRA));
+	cases.push_back(createResampleCase("nearest-2x", sourceRGBA, upsampled, ImageScaling::Nearest));
+	cases.push_back(createResampleCase("bilinear-2x", sourceRGBA, upsampled, ImageScaling::Bilinear));
+	cases.push_back(createResampleCase("bilinear-half", sourceRGBA, downsampled, ImageScaling::Bilinear));
+
+	std::map<std::string, std::string> reference;
+
+	if (parser.contains("--reference") && !loadReferenceChecksums(Path(parser.getString("--reference")), width, height, reference)) {
+		return 1;
+	}
+
+	Benchmark benchmark(options);
+	std::vector<BenchmarkResult> results;
+
+	LogI("Bench") << "Corpus " << width << "x" << height << ", " << corpus.size() << " files";
+
+	for (const BenchmarkCase& c : cases) {
+
+		if (!filter.empty() && c.name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		BenchmarkResult result = benchmark.run(c.name, c.category, c.bytes, c.pixels, c.workload);
+
+		if (result.status == BenchmarkResult::Status::Ok) {
+
+			if (checksum) {
+				result.checksum = SHA1::hash(c.output()).toString();
+			}
+
+			LogI("Bench").print("%-36s %10.2f MB/s %10.2f MP/s  (median %.3f ms, %u runs) %s", c.name.c_str(), result.getMegabytesPerSecond(),
+								result.getMegapixelsPerSecond(), result.medianTime * 1000, result.iterations, result.checksum.c_str());
+
+		} else {
+
+			LogW("Bench").print("%-36s %s: %s", c.name.c_str(), BenchmarkResult::getStatusName(result.status), result.message.c_str());
+
+		}
+
+		results.push_back(std::move(result));
+
+	}
+
+	if (parser.contains("--json")) {
+		writeResults(Path(parser.getString("--json")), results, width, height);
+	}
+
+	if (parser.contains("--reference")) {
+
+		u32 mismatches = 0;
+
+		for (const BenchmarkResult& result : results) {
+
+			auto it = reference.find(result.name);
+
+			if (it != reference.end() && !result.checksum.empty() && it->second != result.checksum) {
+
+				LogE("Bench") << "Checksum mismatch in " << result.name << ": expected " << it->second << ", got " << result.checksum;
+				mismatches++;
+
+			}
+
+		}
+
+		if (mismatches) {
+			return 2;
+		}
+
+		LogI("Bench") << "All checksums match the reference";
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,135 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 pixelwise.cpp
+ */
+
+#include "pixelwise.hpp"
+#include "image/image.hpp"
+#include "stream/binaryreader.hpp"
+#include "math/math.hpp"
+
+
+
+namespace {
+
+	RawImage decodeBitmap(std::span<const u8> data) {
+
+		BinaryReader reader(data);
+
+		reader.seekTo(10);
+		u32 offset = reader.read<u32>();
+
+		reader.seekTo(18);
+		i32 width = reader.read<i32>();
+		i32 height = reader.read<i32>();
+
+		reader.seekTo(28);
+		u32 bytesPerPixel = reader.read<u16>() / 8;
+
+		bool topDown = height < 0;
+		u32 rows = Math::abs(height);
+		u32 padding = Math::alignUp(width * bytesPerPixel, 4) - width * bytesPerPixel;
+
+		reader.seekTo(offset);
+
+		auto load = [&]<Pixel P>() {
+
+			Image<P> image(width, rows);
+			u8 pixel[4];
+
+			for (u32 y = 0; y < rows; y++) {
+
+				u32 ry = topDown ? rows - y - 1 : y;
+
+				for (u32 x = 0; x < u32(width); x++) {
+
+					reader.read<u8>({ pixel, bytesPerPixel });
+					image.setPixel(x, ry, PixelType<P>({ pixel, bytesPerPixel }));
+
+				}
+
+				reader.seek(padding);
+
+			}
+
+			return image.makeRaw();
+
+		};
+
+		return bytesPerPixel == 3 ? load.template operator()<Pixel::BGR8>() : load.template operator()<Pixel::BGRA8>();
+
+	}
+
+	RawImage decodeTGA(std::span<const u8> data) {
+
+		BinaryReader reader(data);
+
+		u8 idLength = reader.read<u8>();
+
+		reader.seekTo(12);
+		u32 width = reader.read<u16>();
+		u32 height = reader.read<u16>();
+		u32 bytesPerPixel = reader.read<u8>() / 8;
+		u8 descriptor = reader.read<u8>();
+
+		reader.seek(idLength);
+
+		auto load = [&]<Pixel P>() {
+
+			Image<Pixel::BGRA8> image(width, height);
+			u8 pixel[4];
+
+			for (u32 y = 0; y < height; y++) {
+
+				u32 ry = (descriptor & 0x20) ? y : height - y - 1;
+
+				for (u32 x = 0; x < width; x++) {
+
+					u32 rx = (descriptor & 0x10) ? width - x - 1 : x;
+
+					reader.read<u8>({ pixel, bytesPerPixel });
+					image.setPixel(rx, ry, PixelConverter::convert<Pixel::BGRA8>(PixelType<P>({ pixel, bytesPerPixel })));
+
+				}
+
+			}
+
+			return image.makeRaw();
+
+		};
+
+		return bytesPerPixel == 3 ? load.template operator()<Pixel::BGR8>() : load.template operator()<Pixel::BGRA8>();
+
+	}
+
+}
+
+
+
+bool Pixelwise::supports(const CorpusEntry& entry) {
+
+	const std::vector<u8>& data = entry.data;
+
+	switch (entry.format) {
+
+		// BI_RGB with 24 or 32 bits per pixel
+		case CorpusFormat::Bitmap:
+			return data.size() > 34 && (data[28] == 24 || data[28] == 32) && data[30] == 0;
+
+		// Uncompressed true color without color map
+		case CorpusFormat::TGA:
+			return data.size() > 18 && data[1] == 0 && data[2] == 2 && (data[16] == 24 || data[16] == 32);
+
+		default:
+			return false;
+
+	}
+
+}
+
+RawImage Pixelwise::decode(const CorpusEntry& entry) {
+	return entry.format == CorpusFormat::Bitmap ? decodeBitmap(entry.data) : decodeTGA(entry.data);
+}
@@ -0,0 +1,28 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 pixelwise.hpp
+ */
+
+#pragma once
+
+#include "corpus.hpp"
+#include "image/rawimage.hpp"
+
+
+
+/*
+ *  Per-pixel reference decoders
+ *  Decode the uncompressed true color BMP and TGA layouts the way the decoders did before they transferred whole rows:
+ *  one BinaryReader read and one setPixel call per pixel. They serve as the baseline for the matching decode/ cases and
+ *  produce identical images, so with --checksum both cases of a pair must hash to the same value.
+ */
+namespace Pixelwise {
+
+	bool supports(const CorpusEntry& entry);
+
+	RawImage decode(const CorpusEntry& entry);
+
+}
@@ -0,0 +1,318 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 main.cpp
+ */
+
+#include "../common/benchmark.hpp"
+#include "json/json.hpp"
+#include "json/flatdocument.hpp"
+#include "json/structuralindex.hpp"
+#include "filesystem/mappedfile.hpp"
+#include "filesystem/path.hpp"
+#include "random/xorshift.hpp"
+#include "util/argumentparser.hpp"
+#include "util/log.hpp"
+
+#include <functional>
+#include <map>
+#include <memory>
+
+
+
+/*
+ *  bench_json
+ *  Parses synthetic documents of --size megabytes: a numeric array, an array of escaped strings and an array of records.
+ *  With --file, the given file is benchmarked as well.
+ *  The arena-backed flat document and building the structural index alone are reported next to the full document read.
+ *  The cursor case walks the top level elements on demand, skipping the content of each.
+ *  The reader case pulls every event through the streaming reader's 64 KiB buffer.
+ *  The round-trip groups serialize the parsed document and decode it back, as compact text, CBOR and MessagePack.
+ *  Every case is reported with its speedup over the first case of the same group.
+ *  Arguments must be passed in layout order.
+ */
+constexpr const char* argumentLayout = "[--iterations uint] , [--time uint] , [--size uint] , [--file string] , [--filter string]";
+
+
+
+struct BenchmarkCase {
+
+	std::string group;
+	std::string variant;
+	const std::string* document;
+	std::function<void(const std::string&)> workload;
+
+};
+
+
+
+static std::string generateNumbers(SizeT size, XorShift32& random) {
+
+	std::string json = "[";
+
+	while (json.size() < size) {
+
+		u32 r = random.next();
+
+		switch (r % 4) {
+
+			case 0:		json += std::to_string(i32(random.next()));							break;
+			case 1:		json += std::to_string(r >> 8);										break;
+			case 2:		json += std::to_string(random.next() / 1024.0);						break;
+			default:	json += std::to_string(r % 1000) + "." + std::to_string(r >> 20) + "e-" + std::to_string(r % 12);	break;
+
+		}
+
+		json += ", ";
+
+	}
+
+	json += "0]";
+
+	return json;
+
+}
+
+
+static std::string generateStrings(SizeT size, XorShift32& random) {
+
+	constexpr const char* words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "\\\"quoted\\\"", "tab\\t", "line\\n", "\\u00e9t\\u00e9", "\\ud83d\\ude00", "path\\/to"};
+
+	std::string json = "[";
+
+	while (json.size() < size) {
+
+		json += '"';
+
+		for (u32 i = 0, count = random.next() % 12 + 1; i < count; i++) {
+
+			json += words[random.next() % std::size(words)];
+			json += ' ';
+
+		}
+
+		json += "\", ";
+
+	}
+
+	json += "\"\"]";
+
+	return json;
+
+}
+
+
+static std::string generateRecords(SizeT size, XorShift32& random) {
+
+	std::string json = "[";
+
+	for (u32 id = 0; json.size() < size; id++) {
+
+		json += "{\"id\": " + std::to_string(id);
+		json += ", \"name\": \"entity_" + std::to_string(random.next() % 100000) + "\"";
+		json += ", \"position\": [" + std::to_string(random.next() / 65536.0) + ", " + std::to_string(random.next() / 65536.0) + ", " + std::to_string(random.next() / 65536.0) + "]";
+		json += ", \"active\": " + std::string(random.next() & 1 ? "true" : "false");
+		json += ", \"parent\": null}, ";
+
+	}
+
+	json += "{}]";
+
+	return json;
+
+}
+
+
+
+u32 arcMain(const std::vector<std::string>& args) {
+
+	ArgumentParser parser;
+
+	try {
+
+		parser.parse(args, argumentLayout);
+
+	} catch (const std::exception& e) {
+
+		LogE("Bench") << e.what();
+		LogI("Bench") << "Usage: bench_json " << argumentLayout;
+		return 1;
+
+	}
+
+	Benchmark::Options options;
+	options.minIterations = parser.getUInt("--iterations", options.minIterations);
+	options.minTime = parser.getUInt("--time", options.minTime * 1000) / 1000.0;
+
+	SizeT size = parser.getUInt("--size", 100) * 1024 * 1024;
+	std::string file = parser.getString("--file", "");
+	std::string filter = parser.getString("--filter", "");
+
+	XorShift32 random(0x4A534F4E);
+
+	std::map<std::string, std::string> documents;
+	documents["numbers"] = generateNumbers(size, random);
+	documents["strings"] = generateStrings(size, random);
+	documents["records"] = generateRecords(size, random);
+
+	if (!file.empty()) {
+
+		MappedFile mapped {Path(file)};
+		std::span<const u8> bytes = mapped.data();
+
+		documents["file"] = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+	}
+
+	std::vector<BenchmarkCase> cases;
+
+	for (const auto& [name, document] : documents) {
+
+		cases.push_back({name, "document", &document, [](const std::string& json) {
+
+			JsonDocument document(json);
+
+			if (document.empty()) {
+				throw JsonSyntaxError("Empty document");
+			}
+
+		}});
+
+		cases.push_back({name, "flat", &document, [](const std::string& json) {
+
+			JsonFlatDocument document(json);
+
+			if (document.empty()) {
+				throw JsonSyntaxError("Empty document");
+			}
+
+		}});
+
+		cases.push_back({name, "cursor", &document, [](const std::string& json) {
+
+			JsonCursor root(json);
+			SizeT count = 0;
+
+			if (root.isObject()) {
+
+				for (const JsonCursor::Member& member : root.getMembers()) {
+					count += member.value.isValid();
+				}
+
+			} else {
+
+				for (JsonCursor element : root.getElements()) {
+					count += element.isValid();
+				}
+
+			}
+
+			if (count == 0) {
+				throw JsonSyntaxError("Empty document");
+			}
+
+		}});
+
+		cases.push_back({name, "reader", &document, [](const std::string& json) {
+
+			JsonStringSource source(json);
+			JsonReader reader(source);
+
+			while (reader.next() != JsonEvent::EndOfInput);
+
+		}});
+
+		cases.push_back({name, "index", &document, [](const std::string& json) {
+
+			JsonStructuralIndex index;
+
+			if (!index.build(json)) {
+				throw JsonSyntaxError("Failed to index document");
+			}
+
+		}});
+
+		auto value = std::make_shared<JsonValue>(JsonDocument(document).getRoot());
+		std::string group = name + "-roundtrip";
+
+		JsonWriter text(true);
+		text.write(*value);
+
+		LogI("Bench").print("%-28s text %zu, cbor %zu, msgpack %zu bytes", group.c_str(), text.release().size(), CborCodec::getEncodedSize(*value), MessagePackCodec::getEncodedSize(*value));
+
+		cases.push_back({group, "text", &document, [value](const std::string&) {
+
+			JsonWriter writer(true);
+			writer.write(*value);
+
+			JsonDocument document(writer.release());
+
+			if (document.empty()) {
+				throw JsonSyntaxError("Empty document");
+			}
+
+		}});
+
+		cases.push_back({group, "cbor", &document, [value](const std::string&) {
+
+			std::vector<u8> data = CborCodec::encode(*value);
+
+			if (CborCodec::decode(data).getType() != value->getType()) {
+				throw JsonSyntaxError("CBOR round trip failed");
+			}
+
+		}});
+
+		cases.push_back({group, "msgpack", &document, [value](const std::string&) {
+
+			std::vector<u8> data = MessagePackCodec::encode(*value);
+
+			if (MessagePackCodec::decode(data).getType() != value->getType()) {
+				throw JsonSyntaxError("MessagePack round trip failed");
+			}
+
+		}});
+
+	}
+
+	Benchmark benchmark(options);
+	std::map<std::string, double> baselineTimes;
+
+	for (const BenchmarkCase& c : cases) {
+
+		std::string name = c.group + "/" + c.variant;
+
+		if (!filter.empty() && name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		BenchmarkResult result = benchmark.run(name, c.group, c.document->size(), 0, [&]() { c.workload(*c.document); });
+
+		if (result.status != BenchmarkResult::Status::Ok) {
+
+			LogW("Bench").print("%-28s %s: %s", name.c_str(), BenchmarkResult::getStatusName(result.status), result.message.c_str());
+			continue;
+
+		}
+
+		auto it = baselineTimes.find(c.group);
+
+		if (it == baselineTimes.end()) {
+
+			baselineTimes[c.group] = result.bestTime;
+			LogI("Bench").print("%-28s %10.2f MB/s  (median %.3f ms, %u runs)", name.c_str(), result.getMegabytesPerSecond(), result.medianTime * 1000, result.iterations);
+
+		} else {
+
+			double speedup = result.bestTime > 0 ? it->second / result.bestTime : 0;
+			LogI("Bench").print("%-28s %10.2f MB/s  (median %.3f ms, %u runs) %.2fx", name.c_str(), result.getMegabytesPerSecond(), result.medianTime * 1000, result.iterations, speedup);
+
+		}
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,395 @@
+/*
+ *	 Copyright (c) 2022 - Arclight Team
+ *
+ *	 This file is part of Arclight. All rights reserved.
+ *
+ *	 main.cpp
+ */
+
+#include "../common/benchmark.hpp"
+#include "math/bvh.hpp"
+#include "math/culling.hpp"
+#include "math/div/mathexpression.hpp"
+#include "math/matrixbatch.hpp"
+#include "random/xorshift.hpp"
+#include "util/argumentparser.hpp"
+#include "util/log.hpp"
+
+#include <functional>
+#include <map>
+
+
+
+/*
+ *  bench_math
+ *  Compares the bulk matrix kernels against looping over the Mat4 member functions on the same data,
+ *  BVH builds, raycasts and box queries against serial or brute force equivalents, batch culling against per-object tests,
+ *  and compiled math expressions against the same formula written natively.
+ *  Every case is reported with its speedup over the first case of the same group.
+ *  Arguments must be passed in layout order.
+ */
+constexpr const char* argumentLayout = "[--iterations uint] , [--time uint] , [--count uint] , [--primitives uint] , [--rays uint] , [--filter string]";
+
+
+
+struct BenchmarkCase {
+
+	std::string group;
+	std::string variant;
+	u64 bytes;
+	u64 elements;
+	std::function<void()> workload;
+
+};
+
+
+
+static float randomFloat(XorShift32& random) {
+	return (random.next() >> 8) / float(1 << 24) * 2.0f - 1.0f;
+}
+
+
+// Diagonally dominant, hence invertible
+static Mat4f randomMatrix(XorShift32& random) {
+
+	Mat4f m;
+
+	for (u32 i = 0; i < 4; i++) {
+		for (u32 j = 0; j < 4; j++) {
+			m[i][j] = randomFloat(random) + (i == j ? 4.0f : 0.0f);
+		}
+	}
+
+	return m;
+
+}
+
+
+
+u32 arcMain(const std::vector<std::string>& args) {
+
+	ArgumentParser parser;
+
+	try {
+
+		parser.parse(args, argumentLayout);
+
+	} catch (const std::exception& e) {
+
+		LogE("Bench") << e.what();
+		LogI("Bench") << "Usage: bench_math " << argumentLayout;
+		return 1;
+
+	}
+
+	Benchmark::Options options;
+	options.minIterations = parser.getUInt("--iterations", options.minIterations);
+	options.minTime = parser.getUInt("--time", options.minTime * 1000) / 1000.0;
+
+	SizeT count = parser.getUInt("--count", 16384);
+	SizeT primitiveCount = parser.getUInt("--primitives", 1000000);
+	SizeT rayCount = parser.getUInt("--rays", 256);
+	std::string filter = parser.getString("--filter", "");
+
+	XorShift32 random(0x4D415448);
+
+	std::vector<Mat4f> matricesA(count), matricesB(count), matricesOut(count);
+	std::vector<Mat3f> normalsOut(count);
+	std::vector<Vec4f> vectors4(count), vectors4Out(count);
+	std::vector<Vec3f> vectors3(count), vectors3Out(count);
+
+	for (SizeT i = 0; i < count; i++) {
+
+		matricesA[i] = randomMatrix(random);
+		matricesB[i] = randomMatrix(random);
+		vectors4[i] = Vec4f(randomFloat(random), randomFloat(random), randomFloat(random), 1);
+		vectors3[i] = Vec3f(randomFloat(random), randomFloat(random), randomFloat(random));
+
+	}
+
+	const Mat4f& transform = matricesA.front();
+
+	u64 vec4Bytes = count * sizeof(Vec4f) * 2;
+	u64 vec3Bytes = count * sizeof(Vec3f) * 2;
+	u64 multiplyBytes = count * sizeof(Mat4f) * 3;
+	u64 inverseBytes = count * sizeof(Mat4f) * 2;
+	u64 normalBytes = count * (sizeof(Mat4f) + sizeof(Mat3f));
+
+	//Small spheres scattered in a cube, probed by rays and boxes through the same volume
+	std::vector<SphereF> spheres(primitiveCount);
+	std::vector<BVH<SphereF>::Ray> rays(rayCount);
+	std::vector<BoxF> boxes(rayCount);
+	std::vector<std::optional<BVH<SphereF>::Hit>> hits(rayCount);
+	std::vector<u32> queryIndices, queryOffsets;
+
+	for (SizeT i = 0; i < primitiveCount; i++) {
+		spheres[i] = SphereF(0.05f + (random.next() >> 8) / float(1 << 24) * 0.2f, Vec3f(randomFloat(random), randomFloat(random), randomFloat(random)) * 100.0f);
+	}
+
+	for (SizeT i = 0; i < rayCount; i++) {
+
+		Vec3f origin = Vec3f(randomFloat(random), randomFloat(random), randomFloat(random)) * 100.0f;
+		Vec3f direction = Vec3f(randomFloat(random), randomFloat(random), randomFloat(random)).normalized();
+
+		rays[i] = {origin, direction};
+		boxes[i] = BoxF(Vec3f(2.0f), origin);
+
+	}
+
+	//Culling reuses the spheres and their bounding boxes against a camera looking into the cube
+	std::vector<BoxF> sphereBoxes(primitiveCount);
+
+	for (SizeT i = 0; i < primitiveCount; i++) {
+		sphereBoxes[i] = spheres[i].boundingBox();
+	}
+
+	FrustumF frustum = FrustumF::fromMatrix(Mat4f::perspective(Math::toRadians(70.0f), 16.0f / 9.0f, 0.1f, 150.0f) * Mat4f::lookAt(Vec3f(-120, 0, 0), Vec3f(0)));
+	Culling::SphereSet<float> sphereSet(spheres);
+	Culling::BoxSet<float> boxSet(sphereBoxes);
+	std::vector<u8> visibility(Culling::maskSize(primitiveCount));
+
+	MathExpression expression("x * 2 + y / 4 - 1 / x + max(x, y) * 3 - 0.5");
+	std::vector<double> expressionX(count), expressionY(count), expressionOut(count);
+
+	for (SizeT i = 0; i < count; i++) {
+
+		expressionX[i] = randomFloat(random) * 8;
+		expressionY[i] = randomFloat(random) * 8;
+
+	}
+
+	std::span<const double> expressionVariables[] = {expressionX, expressionY};
+	u64 expressionBytes = count * sizeof(double) * 3;
+
+	BVH<SphereF> bvh(spheres, 0);
+	u64 bvhBytes = primitiveCount * sizeof(SphereF);
+
+	std::vector<BenchmarkCase> cases = {
+
+		{"transform-vec4", "member", vec4Bytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+				vectors4Out[i] = transform * vectors4[i];
+			}
+
+		}},
+
+		{"transform-vec4", "batch", vec4Bytes, count, [&]() {
+			MatrixBatch::transform(transform, vectors4, vectors4Out);
+		}},
+
+		{"transform-point3", "member", vec3Bytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+
+				Vec4f v = transform * Vec4f(vectors3[i].x, vectors3[i].y, vectors3[i].z, 1);
+				vectors3Out[i] = Vec3f(v.x, v.y, v.z);
+
+			}
+
+		}},
+
+		{"transform-point3", "batch", vec3Bytes, count, [&]() {
+			MatrixBatch::transformPoints(transform, vectors3, vectors3Out);
+		}},
+
+		{"multiply", "member", multiplyBytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+				matricesOut[i] = matricesA[i] * matricesB[i];
+			}
+
+		}},
+
+		{"multiply", "batch", multiplyBytes, count, [&]() {
+			MatrixBatch::multiply<float>(matricesA, matricesB, matricesOut);
+		}},
+
+		{"inverse", "member", inverseBytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+				matricesOut[i] = matricesA[i].inverse();
+			}
+
+		}},
+
+		{"inverse", "batch", inverseBytes, count, [&]() {
+			MatrixBatch::invert<float>(matricesA, matricesOut);
+		}},
+
+		{"normal-matrix", "member", normalBytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+				normalsOut[i] = matricesA[i].toMat3().inverse().transposed();
+			}
+
+		}},
+
+		{"normal-matrix", "batch", normalBytes, count, [&]() {
+			MatrixBatch::normalMatrix<float>(matricesA, normalsOut);
+		}},
+
+		{"expression", "native", expressionBytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+
+				double x = expressionX[i];
+				double y = expressionY[i];
+
+				expressionOut[i] = x * 2 + y / 4 - 1 / x + Math::max(x, y) * 3 - 0.5;
+
+			}
+
+		}},
+
+		{"expression", "member", expressionBytes, count, [&]() {
+
+			for (SizeT i = 0; i < count; i++) {
+				expressionOut[i] = expression.evaluate({expressionX[i], expressionY[i]});
+			}
+
+		}},
+
+		{"expression", "batch", expressionBytes, count, [&]() {
+			expression.evaluate(expressionVariables, expressionOut);
+		}},
+
+		{"cull-sphere", "member", bvhBytes, primitiveCount, [&]() {
+
+			for (SizeT i = 0; i < primitiveCount; i++) {
+				visibility[i / Culling::Lanes] = (visibility[i / Culling::Lanes] & ~(1 << i % Culling::Lanes)) | frustum.intersects(spheres[i]) << i % Culling::Lanes;
+			}
+
+		}},
+
+		{"cull-sphere", "batch", bvhBytes, primitiveCount, [&]() {
+			Culling::cull(frustum, sphereSet, visibility);
+		}},
+
+		{"cull-box", "member", primitiveCount * sizeof(BoxF), primitiveCount, [&]() {
+
+			for (SizeT i = 0; i < primitiveCount; i++) {
+				visibility[i / Culling::Lanes] = (visibility[i / Culling::Lanes] & ~(1 << i % Culling::Lanes)) | frustum.intersects(sphereBoxes[i]) << i % Culling::Lanes;
+			}
+
+		}},
+
+		{"cull-box", "batch", primitiveCount * sizeof(BoxF), primitiveCount, [&]() {
+			Culling::cull(frustum, boxSet, visibility);
+		}},
+
+		{"bvh-build", "serial", bvhBytes, primitiveCount, [&]() {
+			bvh.build(spheres, 1);
+		}},
+
+		{"bvh-build", "parallel", bvhBytes, primitiveCount, [&]() {
+			bvh.build(spheres, 0);
+		}},
+
+		{"bvh-refit", "refit", bvhBytes, primitiveCount, [&]() {
+			bvh.refit(spheres);
+		}},
+
+		{"bvh-raycast", "scan", bvhBytes, rayCount, [&]() {
+
+			for (SizeT i = 0; i < rayCount; i++) {
+
+				const auto& ray = rays[i];
+				Vec3f inverse = Vec3f(1.0f) / ray.direction;
+				hits[i].reset();
+
+				for (SizeT j = 0; j < primitiveCount; j++) {
+
+					float tMax = hits[i] ? hits[i]->t : ray.tMax;
+					auto t = BVHPrimitive::intersect(spheres[j], ray.origin, ray.direction, inverse, ray.tMin, tMax);
+
+					if (t) {
+						hits[i] = BVH<SphereF>::Hit{u32(j), *t};
+					}
+
+				}
+
+			}
+
+		}},
+
+		{"bvh-raycast", "bvh", bvhBytes, rayCount, [&]() {
+			bvh.raycast(rays, spheres, hits, 1);
+		}},
+
+		{"bvh-raycast", "bvh-parallel", bvhBytes, rayCount, [&]() {
+			bvh.raycast(rays, spheres, hits, 0);
+		}},
+
+		{"bvh-query", "scan", bvhBytes, rayCount, [&]() {
+
+			queryIndices.clear();
+			queryOffsets.assign(1, 0);
+
+			for (SizeT i = 0; i < rayCount; i++) {
+
+				for (SizeT j = 0; j < primitiveCount; j++) {
+
+					if (BVHPrimitive::overlaps(spheres[j], boxes[i].start(), boxes[i].end())) {
+						queryIndices.push_back(j);
+					}
+
+				}
+
+				queryOffsets.push_back(queryIndices.size());
+
+			}
+
+		}},
+
+		{"bvh-query", "bvh", bvhBytes, rayCount, [&]() {
+			bvh.query(boxes, spheres, queryIndices, queryOffsets);
+		}}
+
+	};
+
+	Benchmark benchmark(options);
+	std::map<std::string, double> baselineTimes;
+
+	LogI("Bench") << "Element count " << count;
+
+	for (const BenchmarkCase& c : cases) {
+
+		std::string name = c.group + "/" + c.variant;
+
+		if (!filter.empty() && name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		BenchmarkResult result = benchmark.run(name, c.group, c.bytes, 0, c.workload);
+
+		if (result.status != BenchmarkResult::Status::Ok) {
+
+			LogW("Bench").print("%-28s %s: %s", name.c_str(), BenchmarkResult::getStatusName(result.status), result.message.c_str());
+			continue;
+
+		}
+
+		double elementsPerSecond = result.bestTime > 0 ? c.elements / result.bestTime / 1E6 : 0;
+
+		auto it = baselineTimes.find(c.group);
+
+		if (it == baselineTimes.end()) {
+
+			baselineTimes[c.group] = result.bestTime;
+			LogI("Bench").print("%-28s %10.2f M/s %10.2f MB/s  (median %.3f ms, %u runs)", name.c_str(), elementsPerSecond,
+								result.getMegabytesPerSecond(), result.medianTime * 1000, result.iterations);
+
+		} else {
+
+			double speedup = result.bestTime > 0 ? it->second / result.bestTime : 0;
+			LogI("Bench").print("%-28s %10.2f M/s %10.2f MB/s  (median %.3f ms, %u runs) %.2fx", name.c_str(), elementsPerSecond,
+								result.getMegabytesPerSecond(), result.medianTime * 1000, result.iterations, speedup);
+
+		}
+
+	}
+
+	return 0;
+
+}